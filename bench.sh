@@ -16,6 +16,7 @@ function usage()
     echo -e "-l, --list    \t displays the list of the available benchmarks"
     echo -e "-b, --backoff, --backoff_high \t set a backoff upper bound for lock-free and Sim-based algorithms"
     echo -e "-bl, --backoff_low            \t set a backoff lower bound (only for msqueue, lfstack and lfuobject benchmarks)"
+    echo -e "-c, --combining_latency       \t set the target length (in ns) of a combining round; the help bound of the combining objects is adapted to it"
     echo -e ""
     echo -e "-h, --help    \t displays this help and exits"
     echo -e ""
@@ -27,6 +28,7 @@ MAX_PTHREADS=$(nproc)
 FIBERS=""
 BACKOFF=""
 MIN_BACKOFF=""
+COMBINING_LATENCY=""
 ITERATIONS=10
 RUNS=""
 LIST=0
@@ -78,6 +80,10 @@ while [ "$1" != "" ]; do
             MIN_BACKOFF="-l $VALUE"
             SHIFT=1
             ;;
+        -c | --combining_latency)
+            COMBINING_LATENCY="-c $VALUE"
+            SHIFT=1
+            ;;
         -i | --iterations)
             ITERATIONS=$VALUE
             SHIFT=1
@@ -165,7 +171,7 @@ for PTHREADS in "${PTHREADS_ARRAY[@]}"; do
     
     # Redirect stdout to res.txt, stderr to /dev/null
     for (( i=1; i<=$ITERATIONS; i++ ));do
-        $SCRIPTPATH/build/bin/$FILE -t $PTHREADS $WORKLOAD $FIBERS $RUNS $NUMA_NODES $BACKOFF $MIN_BACKOFF 1>> res.txt 2> /dev/null;
+        $SCRIPTPATH/build/bin/$FILE -t $PTHREADS $WORKLOAD $FIBERS $RUNS $NUMA_NODES $BACKOFF $MIN_BACKOFF $COMBINING_LATENCY 1>> res.txt 2> /dev/null;
     done
 
     awk 'BEGIN {debug_prefix="";
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <config.h>
+#include <primitives.h>
+#include <fastrand.h>
+#include <threadtools.h>
+#include <ccsynch.h>
+#include <dsmsynch.h>
+#include <hsynch.h>
+#include <async.h>
+#include <barrier.h>
+#include <bench_args.h>
+#include <fam.h>
+
+// Each operation of this benchmark is a transaction that applies a fetchAndMultiply request to each one of
+// ASYNC_OBJECTS combining objects (i.e. a CC-Synch, a DSM-Synch and an H-Synch instance). The requests of a
+// transaction are submitted at once and they are collected by synchTicketWaitAll, thus their waits overlap.
+#define ASYNC_OBJECTS 3
+
+volatile ObjectState *objects[ASYNC_OBJECTS] CACHE_ALIGN;
+CCSynchStruct *cc_combiner;
+DSMSynchStruct *dsm_combiner;
+HSynchStruct *h_combiner;
+int64_t d1, d2;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+
+inline static void *Execute(void *Arg) {
+    CCSynchThreadState *cc_state;
+    DSMSynchThreadState *dsm_state;
+    HSynchThreadState *h_state;
+    SynchTicket tickets[ASYNC_OBJECTS];
+    RetVal rets[ASYNC_OBJECTS];
+    long i, rnum;
+    volatile long j;
+    int id = synchGetThreadId();
+
+    synchFastRandomSetSeed(id + 1);
+    cc_state = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(CCSynchThreadState));
+    dsm_state = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(DSMSynchThreadState));
+    h_state = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(HSynchThreadState));
+    CCSynchThreadStateInit(cc_combiner, cc_state, (int)id);
+    DSMSynchThreadStateInit(dsm_combiner, dsm_state, (int)id);
+    HSynchThreadStateInit(h_combiner, h_state, (int)id);
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    for (i = 0; i < bench_args.runs; i++) {
+        // submit a fetchAndMultiply request to each object and then wait for all of them
+        CCSynchSubmitOp(cc_combiner, cc_state, fetchAndMultiply, (void *)objects[0], (ArgVal)id, id, &tickets[0]);
+        DSMSynchSubmitOp(dsm_combiner, dsm_state, fetchAndMultiply, (void *)objects[1], (ArgVal)id, id, &tickets[1]);
+        HSynchSubmitOp(h_combiner, h_state, fetchAndMultiply, (void *)objects[2], (ArgVal)id, id, &tickets[2]);
+        synchTicketWaitAll(tickets, ASYNC_OBJECTS, rets);
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+    }
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    int i;
+
+    synchParseArguments(&bench_args, argc, argv);
+    cc_combiner = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(CCSynchStruct));
+    dsm_combiner = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(DSMSynchStruct));
+    h_combiner = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(HSynchStruct));
+    for (i = 0; i < ASYNC_OBJECTS; i++) {
+        objects[i] = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(ObjectState));
+        objects[i]->state_f = 1.0;
+    }
+    CCSynchStructInit(cc_combiner, bench_args.nthreads);
+    DSMSynchStructInit(dsm_combiner, bench_args.nthreads);
+    HSynchStructInit(h_combiner, bench_args.nthreads, bench_args.numa_nodes);
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions transactions/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+
+#ifdef DEBUG
+    // Each transaction applies a single request to each object, thus the states of all the objects should be equal
+    fprintf(stderr, "DEBUG: CC-Synch state: %ld -- DSM-Synch state: %ld -- H-Synch state: %ld\n", cc_combiner->counter, dsm_combiner->counter,
+            h_combiner->counter);
+    fprintf(stderr, "DEBUG: Object state: %ld\n", (cc_combiner->counter == dsm_combiner->counter && dsm_combiner->counter == h_combiner->counter) ? cc_combiner->counter : -1);
+    fprintf(stderr, "DEBUG: rounds: %d\n", cc_combiner->rounds + dsm_combiner->rounds + h_combiner->rounds);
+    fprintf(stderr, "DEBUG: Average helping: %f\n",
+            (float)(cc_combiner->counter + dsm_combiner->counter + h_combiner->counter) / (cc_combiner->rounds + dsm_combiner->rounds + h_combiner->rounds));
+#endif
+
+    return 0;
+}
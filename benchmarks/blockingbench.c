@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <config.h>
+#include <primitives.h>
+#include <fastrand.h>
+#include <threadtools.h>
+#include <barrier.h>
+#include <bench_args.h>
+#include <ccqueue.h>
+#include <lcrq.h>
+
+// This benchmark exercises the blocking and the timed dequeue operations (see eventcount.h). The first half of the
+// threads are producers that enqueue each element to an LCRQ and to a CC-Queue instance, i.e. to a queue that notifies
+// the waiting threads after a Compare&Swap (see synchEventCountNotifyAfterRMW) and to a combining queue. The rest of
+// the threads are consumers that dequeue the elements by LCRQDequeueBlocking and CCQueueApplyDequeueTimed. Since the
+// consumers do not execute any local work, they often find the queues empty and they have to be woken up.
+// At the end, each thread dequeues from the empty queues by the timed operations, which should time out.
+#define BLOCKING_TIMEOUT_NS 1000000
+
+LCRQStruct *lcrq_object CACHE_ALIGN;
+CCQueueStruct *ccqueue_object CACHE_ALIGN;
+int64_t dequeued CACHE_ALIGN, dequeued_sum, timeouts, invalid_timeouts;
+int64_t d1 CACHE_ALIGN, d2;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+
+inline static void *Execute(void *Arg) {
+    LCRQThreadState lcrq_state;
+    CCQueueThreadState *cc_state;
+    int64_t total = bench_args.runs * bench_args.nthreads, nproducers = bench_args.nthreads / 2;
+    int64_t consumers = bench_args.nthreads - nproducers, count = 0, sum = 0, timed_out = 0, invalid = 0, start;
+    long i, rnum;
+    volatile int j;
+    RetVal ret;
+    int id = synchGetThreadId();
+
+    synchFastRandomSetSeed(id + 1);
+    LCRQThreadStateInit(lcrq_object, &lcrq_state, id);
+    cc_state = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(CCQueueThreadState));
+    CCQueueThreadStateInit(ccqueue_object, cc_state, id);
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    if (id < nproducers || nproducers == 0) {
+        // each value is enqueued once to each queue, thus the sum of the dequeued values is known in advance
+        for (i = id; i < total; i += (nproducers == 0) ? 1 : nproducers) {
+            LCRQEnqueue(lcrq_object, &lcrq_state, (ArgVal)(i + 1), id);
+            CCQueueApplyEnqueue(ccqueue_object, cc_state, (ArgVal)(i + 1), id);
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+        }
+    }
+    if (id >= nproducers) {
+        int64_t quota = total / consumers + ((id - nproducers) < total % consumers);
+
+        for (i = 0; i < quota; i++) {
+            sum += LCRQDequeueBlocking(lcrq_object, &lcrq_state, id);
+            while ((ret = CCQueueApplyDequeueTimed(ccqueue_object, cc_state, BLOCKING_TIMEOUT_NS, id)) == EMPTY_QUEUE)
+                timed_out++;
+            sum += ret;
+            count++;
+        }
+    }
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+
+    // the queues are empty, thus the timed dequeues should return EMPTY_QUEUE after BLOCKING_TIMEOUT_NS
+    start = synchGetTimeNanos();
+    if (LCRQDequeueTimed(lcrq_object, &lcrq_state, BLOCKING_TIMEOUT_NS, id) != EMPTY_QUEUE || synchGetTimeNanos() - start < BLOCKING_TIMEOUT_NS)
+        invalid++;
+    start = synchGetTimeNanos();
+    if (CCQueueApplyDequeueTimed(ccqueue_object, cc_state, BLOCKING_TIMEOUT_NS, id) != EMPTY_QUEUE ||
+        synchGetTimeNanos() - start < BLOCKING_TIMEOUT_NS)
+        invalid++;
+
+    synchFAA64(&dequeued, count);
+    synchFAA64(&dequeued_sum, sum);
+    synchFAA64(&timeouts, timed_out);
+    synchFAA64(&invalid_timeouts, invalid);
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    synchParseArguments(&bench_args, argc, argv);
+    lcrq_object = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(LCRQStruct));
+    ccqueue_object = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(CCQueueStruct));
+    LCRQInit(lcrq_object, bench_args.nthreads, RING_POW);
+    CCQueueStructInit(ccqueue_object, bench_args.nthreads);
+
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), 4 * bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+
+#ifdef DEBUG
+    int64_t total = bench_args.runs * bench_args.nthreads;
+
+    fprintf(stderr, "DEBUG: timed dequeues that timed out while waiting for a producer: %ld\n", (long)timeouts);
+    fprintf(stderr, "DEBUG: timed dequeues on the empty queues that did not time out properly: %ld\n", (long)invalid_timeouts);
+    // each consumer has dequeued each element from both queues and all the timed dequeues on the empty queues have timed out
+    fprintf(stderr, "DEBUG: Object state: %ld\n", (dequeued == total && dequeued_sum == total * (total + 1) && invalid_timeouts == 0) ? (long)total : -1L);
+#endif
+
+    return 0;
+}
@@ -19,6 +19,9 @@ int64_t d1, d2;
 SynchBarrier bar CACHE_ALIGN;
 SynchBenchArgs bench_args CACHE_ALIGN;
 
+// fetchAndMultiply is inlined in the combining loop
+CCSYNCH_DEFINE_APPLY_OP(CCSynchApplyFetchAndMultiply, fetchAndMultiply)
+
 inline static void *Execute(void *Arg) {
     CCSynchThreadState *th_state;
     long i, rnum;
@@ -33,7 +36,7 @@ inline static void *Execute(void *Arg) {
 
     for (i = 0; i < bench_args.runs; i++) {
         // perform a fetchAndMultiply operation
-        CCSynchApplyOp(object_combiner, th_state, fetchAndMultiply, (void *)object, (ArgVal)id, id);
+        CCSynchApplyFetchAndMultiply(object_combiner, th_state, (void *)object, (ArgVal)id, id);
         rnum = synchFastRandomRange(1, bench_args.max_work);
         for (j = 0; j < rnum; j++)
             ;
@@ -50,6 +53,7 @@ int main(int argc, char *argv[]) {
     object = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(ObjectState));
     object->state_f = 1.0;
     CCSynchStructInit(object_combiner, bench_args.nthreads);
+    CCSynchStructSetHelpPolicy(object_combiner, bench_args.combining_latency, SYNCH_HELP_BOUND_DEFAULT, SYNCH_HELP_BOUND_DEFAULT);
 
     synchBarrierSet(&bar, bench_args.nthreads);
     synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
@@ -57,6 +61,12 @@ int main(int argc, char *argv[]) {
 
     printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
     synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+    if (bench_args.combining_latency != 0) {
+        SynchHelpBound help_stats;
+
+        CCSynchGetHelpStats(object_combiner, &help_stats);
+        synchPrintHelpStats(&help_stats);
+    }
 
 #ifdef DEBUG
     fprintf(stderr, "DEBUG: Object float state: %f\n", object->state_f);
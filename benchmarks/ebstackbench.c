@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <ebstack.h>
+#include <barrier.h>
+#include <bench_args.h>
+#include <fastrand.h>
+#include <threadtools.h>
+
+EBStackStruct stack CACHE_ALIGN;
+int64_t eliminated CACHE_ALIGN;
+int64_t popped CACHE_ALIGN, popped_sum;
+int64_t d1 CACHE_ALIGN, d2;
+int MIN_BAK, MAX_BAK;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+
+inline static void *Execute(void *Arg) {
+    EBStackThreadState *th_state;
+    long i;
+    int id = synchGetThreadId();
+    long rnum;
+    volatile long j;
+    int64_t pops = 0, sum = 0;
+    int64_t total = bench_args.runs * bench_args.nthreads, producers = bench_args.producers, consumers = bench_args.nthreads - producers;
+    RetVal ret;
+
+    synchFastRandomSetSeed(id + 1);
+    th_state = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(EBStackThreadState));
+    EBStackThreadStateInit(&stack, th_state, bench_args.backoff_low, bench_args.backoff_high, id);
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    if (producers == 0) {
+        for (i = 0; i < bench_args.runs; i++) {
+            // each pushed value is unique, thus a lost or a duplicated element changes the sum of the popped values
+            EBStackPush(&stack, th_state, id * bench_args.runs + i + 1);
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+            ret = EBStackPop(&stack, th_state);
+            if (ret != EMPTY_STACK) {
+                pops++;
+                sum += ret;
+            }
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+            if (bench_args.report_memory && id == 0 && (i + 1) % SYNCH_MEMORY_REPORT_PERIOD == 0)
+                fprintf(stderr, "resident memory: %.2f MB after %ld pairs of operations of thread 0\n", synchGetResidentMemory() / (1024.0 * 1024.0), i + 1);
+        }
+    } else if (id < producers) {
+        // the nodes are allocated by the producers and retired by the consumers (see ebr.h)
+        for (i = id; i < total; i += producers) {
+            EBStackPush(&stack, th_state, i + 1);
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+            if (bench_args.report_memory && id == 0 && (i / producers + 1) % SYNCH_MEMORY_REPORT_PERIOD == 0)
+                fprintf(stderr, "resident memory: %.2f MB after %ld pushes of thread 0\n", synchGetResidentMemory() / (1024.0 * 1024.0), i / producers + 1);
+        }
+    } else {
+        int64_t quota = total / consumers + ((id - producers) < total % consumers);
+
+        for (i = 0; i < quota; i++) {
+            sum += EBStackPopBlocking(&stack, th_state);
+            pops++;
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+        }
+    }
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+    synchFAA64(&eliminated, th_state->eliminated);
+    synchFAA64(&popped, pops);
+    synchFAA64(&popped_sum, sum);
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    synchParseArguments(&bench_args, argc, argv);
+
+    EBStackInit(&stack, bench_args.nthreads);
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), 2 * bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+    if (bench_args.report_memory)
+        fprintf(stderr, "resident memory: %.2f MB at the end of the experiment\n", synchGetResidentMemory() / (1024.0 * 1024.0));
+
+#ifdef DEBUG
+    int64_t total = (int64_t)bench_args.runs * bench_args.nthreads;
+    long counter = 0;
+
+    while (stack.stack.top != NULL) {
+        counter++;
+        popped_sum += stack.stack.top->val;
+        stack.stack.top = stack.stack.top->next;
+    }
+
+    fprintf(stderr, "DEBUG: %ld nodes were left in the stack\n", counter);
+    // every pop is applied, while a push is applied in case that its value is either popped or left in the stack
+    fprintf(stderr, "DEBUG: Object state: %ld\n", (popped_sum == total * (total + 1) / 2) ? (long)(total + popped + counter) : -1L);
+    fprintf(stderr, "DEBUG: eliminated push/pop operations: %ld\n", eliminated);
+#endif
+
+    return 0;
+}
@@ -48,6 +48,8 @@ inline static void *Execute(void *Arg) {
 }
 
 int main(int argc, char *argv[]) {
+    SynchElimStats elim_stats;
+
     synchParseArguments(&bench_args, argc, argv);
     object_struct = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(FCStackStruct));
     FCStackInit(object_struct, bench_args.nthreads);
@@ -57,6 +59,9 @@ int main(int argc, char *argv[]) {
 
     printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), 2 * bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
     synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+    FCStackGetElimStats(object_struct, &elim_stats);
+    fprintf(stderr, "elimination buffer hits: %lu (%.2f%% of the pops)\n", (unsigned long)elim_stats.hits,
+            (elim_stats.pops != 0) ? 100.0 * elim_stats.hits / elim_stats.pops : 0.0);
 
 #ifdef DEBUG
     fprintf(stderr, "DEBUG: Object state: %ld\n", object_struct->object_struct.counter);
@@ -68,6 +73,7 @@ int main(int argc, char *argv[]) {
         top = top->next;
         counter++;
     }
+    counter += object_struct->elim.size;                                                // the topmost elements are stored in the elimination buffer
     fprintf(stderr, "DEBUG: %ld nodes left in the queue\n", counter);
 #endif
 
@@ -19,6 +19,9 @@ int64_t d1, d2;
 SynchBarrier bar CACHE_ALIGN;
 SynchBenchArgs bench_args CACHE_ALIGN;
 
+// fetchAndMultiply is inlined in the combining loop
+HSYNCH_DEFINE_APPLY_OP(HSynchApplyFetchAndMultiply, fetchAndMultiply)
+
 inline static void *Execute(void *Arg) {
     HSynchThreadState th_state;
     long i, rnum;
@@ -32,7 +35,7 @@ inline static void *Execute(void *Arg) {
 
     for (i = 0; i < bench_args.runs; i++) {
         // perform a fetchAndMultiply operation
-        HSynchApplyOp(object_combiner, &th_state, fetchAndMultiply, (void *)object, (ArgVal)id, id);
+        HSynchApplyFetchAndMultiply(object_combiner, &th_state, (void *)object, (ArgVal)id, id);
         rnum = synchFastRandomRange(1, bench_args.max_work);
         for (j = 0; j < rnum; j++)
             ;
@@ -49,12 +52,19 @@ int main(int argc, char *argv[]) {
     object = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(ObjectState));
     object->state_f = 1.0;
     HSynchStructInit(object_combiner, bench_args.nthreads, bench_args.numa_nodes);
+    HSynchStructSetHelpPolicy(object_combiner, bench_args.combining_latency, SYNCH_HELP_BOUND_DEFAULT, SYNCH_HELP_BOUND_DEFAULT);
     synchBarrierSet(&bar, bench_args.nthreads);
     synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
     synchJoinThreadsN(bench_args.nthreads);
 
     printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
     synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+    if (bench_args.combining_latency != 0) {
+        SynchHelpBound help_stats;
+
+        HSynchGetHelpStats(object_combiner, &help_stats);
+        synchPrintHelpStats(&help_stats);
+    }
 
 #ifdef DEBUG
     fprintf(stderr, "DEBUG: Object state: %ld\n", object_combiner->counter);
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+
+#include <config.h>
+#include <primitives.h>
+#include <fastrand.h>
+#include <threadtools.h>
+#include <barrier.h>
+#include <bench_args.h>
+#include <lcrq.h>
+
+/// @brief The number of elements that each thread enqueues (and then dequeues) in a single batch.
+#ifndef LCRQ_BENCH_BATCH_SIZE
+#    define LCRQ_BENCH_BATCH_SIZE 64
+#endif
+
+LCRQStruct *queue_object CACHE_ALIGN;
+int64_t d1 CACHE_ALIGN, d2;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+
+inline static void *Execute(void *Arg) {
+    LCRQThreadState thread_state;
+    ArgVal values[LCRQ_BENCH_BATCH_SIZE];
+    RetVal out[LCRQ_BENCH_BATCH_SIZE];
+    long i, k, n, rnum;
+    volatile int j;
+    int id = synchGetThreadId();
+
+    LCRQThreadStateInit(queue_object, &thread_state, id);
+    synchFastRandomSetSeed(id + 1);
+    for (k = 0; k < LCRQ_BENCH_BATCH_SIZE; k++)
+        values[k] = id;
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    for (i = 0; i < bench_args.runs; i += n) {
+        n = (bench_args.runs - i < LCRQ_BENCH_BATCH_SIZE) ? bench_args.runs - i : LCRQ_BENCH_BATCH_SIZE;
+        // perform a batch of enqueue operations
+        LCRQEnqueueBatch(queue_object, &thread_state, values, n, id);
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+        // perform a batch of dequeue operations
+        LCRQDequeueBatch(queue_object, &thread_state, out, n, id);
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+    }
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+
+    LCRQCollectStats(queue_object, &thread_state);
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    synchParseArguments(&bench_args, argc, argv);
+    queue_object = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(LCRQStruct));
+    LCRQInit(queue_object, bench_args.nthreads, RING_POW);
+
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+    d2 = synchGetTimeMillis();
+
+#ifdef DEBUG
+    LCRQThreadState thread_state;
+    long counter = 0;
+
+    LCRQThreadStateInit(queue_object, &thread_state, 0);
+
+    // As in lcrqbench.c, the actual validation is the number of nodes left at the end of benchmark.
+    fprintf(stderr, "DEBUG: Enqueue: Object state: %ld\n", bench_args.nthreads * bench_args.runs);
+    fprintf(stderr, "DEBUG: Dequeue: Object state: %ld\n", bench_args.nthreads * bench_args.runs);
+
+    // The actual queue validation code.
+    while (LCRQDequeue(queue_object, &thread_state, 0) != EMPTY_QUEUE) {
+        counter++;
+    }
+    fprintf(stderr, "DEBUG: %ld nodes were left in the queue\n", counter);
+#endif
+    fprintf(stderr, "rings: opens=%ld closes=%ld unsafes=%ld recycles=%ld\n", queue_object->opens, queue_object->closes,
+            queue_object->unsafes, queue_object->recycles);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int) (d2 - d1), 2 * bench_args.runs * bench_args.nthreads/(1000.0*(d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+
+    return 0;
+}
@@ -21,7 +21,7 @@ inline static void *Execute(void *Arg) {
     volatile int j;
     int id = synchGetThreadId();
 
-    LCRQThreadStateInit(&thread_state, id);
+    LCRQThreadStateInit(queue_object, &thread_state, id);
     synchFastRandomSetSeed(id + 1);
     synchBarrierWait(&bar);
     if (id == 0) d1 = synchGetTimeMillis();
@@ -41,10 +41,7 @@ inline static void *Execute(void *Arg) {
     synchBarrierWait(&bar);
     if (id == 0) d2 = synchGetTimeMillis();
 
-#ifdef DEBUG
-    synchFAA64(&queue_object->closes, thread_state.mycloses);
-    synchFAA64(&queue_object->unsafes, thread_state.myunsafes);
-#endif
+    LCRQCollectStats(queue_object, &thread_state);
 
     return NULL;
 }
@@ -52,7 +49,7 @@ inline static void *Execute(void *Arg) {
 int main(int argc, char *argv[]) {
     synchParseArguments(&bench_args, argc, argv);
     queue_object = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(LCRQStruct));
-    LCRQInit(queue_object, bench_args.nthreads);
+    LCRQInit(queue_object, bench_args.nthreads, RING_POW);
 
     synchBarrierSet(&bar, bench_args.nthreads);
     synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
@@ -64,7 +61,7 @@ int main(int argc, char *argv[]) {
     RetVal ret;
     long counter = 0;
 
-    LCRQThreadStateInit(&thread_state, 0);
+    LCRQThreadStateInit(queue_object, &thread_state, 0);
 
     // Currently, we don't have a state validation number as in the case of the combining queues.
     // Thus, we simply print the number of threads * number of runs per thread.
@@ -77,8 +74,9 @@ int main(int argc, char *argv[]) {
         counter++;
     }
     fprintf(stderr, "DEBUG: %ld nodes were left in the queue\n", counter);
-    fprintf(stderr, "DEBUG: closes=%ld unsafes=%ld\n", queue_object->closes, queue_object->unsafes);
 #endif
+    fprintf(stderr, "rings: opens=%ld closes=%ld unsafes=%ld recycles=%ld\n", queue_object->opens, queue_object->closes,
+            queue_object->unsafes, queue_object->recycles);
 
     printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int) (d2 - d1), 2 * bench_args.runs * bench_args.nthreads/(1000.0*(d2 - d1)));
     synchPrintStats(bench_args.nthreads, bench_args.total_runs);
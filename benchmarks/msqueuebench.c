@@ -25,22 +25,46 @@ inline static void *Execute(void *Arg) {
     int id = synchGetThreadId();
     long rnum;
     volatile long j;
+    int64_t total = bench_args.runs * bench_args.nthreads, producers = bench_args.producers, consumers = bench_args.nthreads - producers;
 
     th_state = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(MSQueueThreadState));
-    MSQueueThreadStateInit(th_state, bench_args.backoff_low, bench_args.backoff_high);
+    MSQueueThreadStateInit(&queue, th_state, bench_args.backoff_low, bench_args.backoff_high, id);
     synchFastRandomSetSeed(id + 1);
     synchBarrierWait(&bar);
     if (id == 0) d1 = synchGetTimeMillis();
 
-    for (i = 0; i < bench_args.runs; i++) {
-        MSQueueEnqueue(&queue, th_state, id);
-        rnum = synchFastRandomRange(1, bench_args.max_work);
-        for (j = 0; j < rnum; j++)
-            ;
-        MSQueueDequeue(&queue, th_state);
-        rnum = synchFastRandomRange(1, bench_args.max_work);
-        for (j = 0; j < rnum; j++)
-            ;
+    if (producers == 0) {
+        for (i = 0; i < bench_args.runs; i++) {
+            MSQueueEnqueue(&queue, th_state, id);
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+            MSQueueDequeue(&queue, th_state);
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+            if (bench_args.report_memory && id == 0 && (i + 1) % SYNCH_MEMORY_REPORT_PERIOD == 0)
+                fprintf(stderr, "resident memory: %.2f MB after %ld pairs of operations of thread 0\n", synchGetResidentMemory() / (1024.0 * 1024.0), i + 1);
+        }
+    } else if (id < producers) {
+        // the nodes are allocated by the producers and retired by the consumers (see ebr.h)
+        for (i = id; i < total; i += producers) {
+            MSQueueEnqueue(&queue, th_state, id);
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+            if (bench_args.report_memory && id == 0 && (i / producers + 1) % SYNCH_MEMORY_REPORT_PERIOD == 0)
+                fprintf(stderr, "resident memory: %.2f MB after %ld enqueues of thread 0\n", synchGetResidentMemory() / (1024.0 * 1024.0), i / producers + 1);
+        }
+    } else {
+        int64_t quota = total / consumers + ((id - producers) < total % consumers);
+
+        for (i = 0; i < quota; i++) {
+            MSQueueDequeueBlocking(&queue, th_state);
+            rnum = synchFastRandomRange(1, bench_args.max_work);
+            for (j = 0; j < rnum; j++)
+                ;
+        }
     }
     synchBarrierWait(&bar);
     if (id == 0) d2 = synchGetTimeMillis();
@@ -51,13 +75,15 @@ inline static void *Execute(void *Arg) {
 int main(int argc, char *argv[]) {
     synchParseArguments(&bench_args, argc, argv);
 
-    MSQueueInit(&queue);
+    MSQueueInit(&queue, bench_args.nthreads);
     synchBarrierSet(&bar, bench_args.nthreads);
     synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
     synchJoinThreadsN(bench_args.nthreads);
 
     printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), 2 * bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
     synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+    if (bench_args.report_memory)
+        fprintf(stderr, "resident memory: %.2f MB at the end of the experiment\n", synchGetResidentMemory() / (1024.0 * 1024.0));
 #ifdef DEBUG
     long counter = 0;
 
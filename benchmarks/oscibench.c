@@ -19,6 +19,9 @@ int64_t d1 CACHE_ALIGN, d2;
 SynchBarrier bar CACHE_ALIGN;
 SynchBenchArgs bench_args CACHE_ALIGN;
 
+// fetchAndMultiply is inlined in the combining loop
+OSCI_DEFINE_APPLY_OP(OsciApplyFetchAndMultiply, fetchAndMultiply)
+
 inline static void *Execute(void *Arg) {
     OsciThreadState *th_state;
     long i, rnum;
@@ -32,7 +35,7 @@ inline static void *Execute(void *Arg) {
     if (id == 0) d1 = synchGetTimeMillis();
 
     for (i = 0; i < bench_args.runs; i++) {
-        OsciApplyOp(&object_lock, th_state, fetchAndMultiply, (void *)&object, (ArgVal)id, id);
+        OsciApplyFetchAndMultiply(&object_lock, th_state, (void *)&object, (ArgVal)id, id);
         rnum = synchFastRandomRange(1, bench_args.max_work);
         for (j = 0; j < rnum; j++)
             ;
@@ -47,12 +50,19 @@ int main(int argc, char *argv[]) {
     synchParseArguments(&bench_args, argc, argv);
     object.state_f = 1.0;
     OsciInit(&object_lock, bench_args.nthreads, bench_args.fibers_per_thread);
+    OsciSetHelpPolicy(&object_lock, bench_args.combining_latency, SYNCH_HELP_BOUND_DEFAULT, SYNCH_HELP_BOUND_DEFAULT);
     synchBarrierSet(&bar, bench_args.nthreads);
     synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
     synchJoinThreadsN(bench_args.nthreads);
 
     printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
     synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+    if (bench_args.combining_latency != 0) {
+        SynchHelpBound help_stats;
+
+        OsciGetHelpStats(&object_lock, &help_stats);
+        synchPrintHelpStats(&help_stats);
+    }
 
 #ifdef DEBUG
     fprintf(stderr, "DEBUG: Object state: %ld\n", object_lock.counter);
@@ -58,12 +58,19 @@ int main(int argc, char *argv[]) {
     synchParseArguments(&bench_args, argc, argv);
 
     OyamaInit((OyamaStruct *)&object_lock, bench_args.nthreads);
+    OyamaSetHelpPolicy((OyamaStruct *)&object_lock, bench_args.combining_latency, SYNCH_HELP_BOUND_DEFAULT, SYNCH_HELP_BOUND_DEFAULT);
     synchBarrierSet(&bar, bench_args.nthreads);
     synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
     synchJoinThreadsN(bench_args.nthreads);
 
     printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
     synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+    if (bench_args.combining_latency != 0) {
+        SynchHelpBound help_stats;
+
+        OyamaGetHelpStats((OyamaStruct *)&object_lock, &help_stats);
+        synchPrintHelpStats(&help_stats);
+    }
 
 #ifdef DEBUG
     fprintf(stderr, "DEBUG: Object state: %d\n", object_lock.counter);
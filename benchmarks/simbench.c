@@ -16,6 +16,9 @@ SynchBarrier bar CACHE_ALIGN;
 SynchBenchArgs bench_args CACHE_ALIGN;
 int MAX_BACK CACHE_ALIGN;
 
+// fetchAndMultiply is inlined in the combining loop
+SIM_DEFINE_APPLY_OP(SimApplyFetchAndMultiply, fetchAndMultiply)
+
 inline static void *Execute(void *Arg) {
     SimThreadState th_state;
     long i, rnum;
@@ -28,7 +31,7 @@ inline static void *Execute(void *Arg) {
     if (id == 0) d1 = synchGetTimeMillis();
 
     for (i = 0; i < bench_args.runs; i++) {
-        SimApplyOp(sim_struct, &th_state, fetchAndMultiply, (Object)(id + 1), id);
+        SimApplyFetchAndMultiply(sim_struct, &th_state, (Object)(id + 1), id);
         rnum = synchFastRandomRange(1, bench_args.max_work);
         for (j = 0; j < rnum; j++)
             ;
@@ -42,7 +45,7 @@ inline static void *Execute(void *Arg) {
 int main(int argc, char *argv[]) {
     synchParseArguments(&bench_args, argc, argv);
     sim_struct = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimStruct));
-    synchSimStructInit(sim_struct, bench_args.nthreads, bench_args.backoff_high);
+    synchSimStructInit(sim_struct, bench_args.nthreads, bench_args.backoff_high, sizeof(ObjectState), 0, NULL);
     synchBarrierSet(&bar, bench_args.nthreads);
     synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
     synchJoinThreadsN(bench_args.nthreads);
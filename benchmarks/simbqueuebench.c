@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include <config.h>
+#include <primitives.h>
+#include <fastrand.h>
+#include <threadtools.h>
+#include <simbqueue.h>
+#include <barrier.h>
+#include <bench_args.h>
+
+/// @brief The capacity of the queue; it is increased to the number of threads, in case that it is smaller.
+#ifndef SIM_BENCH_QUEUE_CAPACITY
+#    define SIM_BENCH_QUEUE_CAPACITY 1024
+#endif
+
+SimBQueueStruct *queue;
+int64_t d1, d2;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+
+static void *Execute(void *Arg) {
+    SimBQueueThreadState *th_state;
+    long i = 0;
+    int id = synchGetThreadId();
+    long rnum;
+    volatile int j = 0;
+
+    synchFastRandomSetSeed(id + 1);
+    th_state = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimBQueueThreadState));
+    SimBQueueThreadStateInit(queue, th_state, id);
+
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    for (i = 0; i < bench_args.runs; i++) {
+        SimBQueueEnqueue(queue, th_state, id, id);
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+        SimBQueueDequeue(queue, th_state, id);
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+    }
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    synchParseArguments(&bench_args, argc, argv);
+    queue = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimBQueueStruct));
+    // each thread has at most one element in the queue, thus no enqueue fails
+    SimBQueueStructInit(queue, bench_args.nthreads, bench_args.backoff_high,
+                        bench_args.nthreads > SIM_BENCH_QUEUE_CAPACITY ? bench_args.nthreads : SIM_BENCH_QUEUE_CAPACITY);
+
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), 2 * bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+
+#ifdef DEBUG
+    uint64_t tail = queue->enq_pool[queue->enq_sp.struct_data.index]->tail;
+    uint64_t head = queue->deq_pool[queue->deq_sp.struct_data.index]->head;
+
+    fprintf(stderr, "DEBUG: Enqueue: Object state: %ld\n", (long)queue->enq_pool[queue->enq_sp.struct_data.index]->counter);
+    fprintf(stderr, "DEBUG: Dequeue: Object state: %ld\n", (long)queue->deq_pool[queue->deq_sp.struct_data.index]->counter);
+    fprintf(stderr, "DEBUG: %ld nodes were left in the queue\n", (long)(tail - head));
+#endif
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include <sim.h>
+#include <barrier.h>
+#include <bench_args.h>
+#include <fastrand.h>
+#include <threadtools.h>
+
+/// @brief The number of counters (of 64 bits each) of the simulated object, i.e. a 16 KB object's state.
+#ifndef SIM_BENCH_COUNTERS
+#    define SIM_BENCH_COUNTERS 2048
+#endif
+
+/// @brief The copy mode used by the benchmark. Define it as SIM_COPY_FULL for comparing against the default copy mode.
+#ifndef SIM_BENCH_COPY_MODE
+#    define SIM_BENCH_COPY_MODE SIM_COPY_DELTA
+#endif
+
+typedef struct CounterArray {
+    int64_t counter[SIM_BENCH_COUNTERS];
+} CounterArray;
+
+SimStruct *sim_struct CACHE_ALIGN;
+int64_t d1 CACHE_ALIGN, d2;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+
+inline static RetVal fetchAndIncrement(void *state, ArgVal arg, int pid) {
+    CounterArray *obj = (CounterArray *)state;
+    RetVal res;
+
+    res = obj->counter[arg];
+    obj->counter[arg] += 1;
+    SimStateWriteBarrier(state, &obj->counter[arg], sizeof(int64_t));
+
+    return res;
+}
+
+inline static void *Execute(void *Arg) {
+    SimThreadState th_state;
+    long i, rnum;
+    int id = synchGetThreadId();
+    volatile long j;
+
+    SimThreadStateInit(&th_state, bench_args.nthreads, id);
+    synchFastRandomSetSeed((unsigned long)id + 1);
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    for (i = 0; i < bench_args.runs; i++) {
+        SimApplyOp(sim_struct, &th_state, fetchAndIncrement, (Object)synchFastRandomRange(0, SIM_BENCH_COUNTERS), id);
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+    }
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    synchParseArguments(&bench_args, argc, argv);
+    sim_struct = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimStruct));
+    synchSimStructInit(sim_struct, bench_args.nthreads, bench_args.backoff_high, sizeof(CounterArray), CACHE_LINE_SIZE, NULL);
+    synchSimStructSetCopyMode(sim_struct, SIM_BENCH_COPY_MODE);
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+
+#ifdef DEBUG
+    SimObjectState *l = (SimObjectState *)sim_struct->pool[((pointer_t *)&sim_struct->sp)->struct_data.index];
+    CounterArray *obj = (CounterArray *)l->state;
+    int64_t sum = 0;
+    int i;
+
+    for (i = 0; i < SIM_BENCH_COUNTERS; i++)
+        sum += obj->counter[i];
+    fprintf(stderr, "DEBUG: Object state: %ld\n", (long)sum);
+    fprintf(stderr, "DEBUG: rounds: %d\n", l->rounds);
+    fprintf(stderr, "DEBUG: Average helping: %f\n", (float)l->counter / l->rounds);
+#endif
+
+    return 0;
+}
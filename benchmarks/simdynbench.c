@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include <sim.h>
+#include <barrier.h>
+#include <bench_args.h>
+#include <fam.h>
+#include <fastrand.h>
+#include <threadtools.h>
+
+/// @brief The maximum number of threads supported by the Sim instance. Only the registered threads are scanned by the combiners.
+#ifndef SIM_BENCH_MAX_THREADS
+#    define SIM_BENCH_MAX_THREADS 512
+#endif
+
+/// @brief The number of operations that each thread performs before it deregisters and registers again.
+#ifndef SIM_BENCH_REGISTER_PERIOD
+#    define SIM_BENCH_REGISTER_PERIOD 1000
+#endif
+
+SimStruct *sim_struct CACHE_ALIGN;
+int64_t d1 CACHE_ALIGN, d2;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+
+inline static void *Execute(void *Arg) {
+    SimThreadState th_state;
+    long i, rnum;
+    int id = synchGetThreadId();
+    int pid = -1;
+    volatile long j;
+
+    synchFastRandomSetSeed((unsigned long)id + 1);
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    for (i = 0; i < bench_args.runs; i++) {
+        if (i % SIM_BENCH_REGISTER_PERIOD == 0) {
+            if (pid >= 0)
+                SimDeregisterThread(sim_struct, &th_state, pid);
+            pid = SimRegisterThread(sim_struct, &th_state);
+        }
+        SimApplyOp(sim_struct, &th_state, fetchAndMultiply, (Object)(id + 1), pid);
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+    }
+    if (pid >= 0)
+        SimDeregisterThread(sim_struct, &th_state, pid);
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    synchParseArguments(&bench_args, argc, argv);
+    if (bench_args.nthreads > SIM_BENCH_MAX_THREADS) {
+        fprintf(stderr, "ERROR: this benchmark supports up to %d threads\n", SIM_BENCH_MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+    sim_struct = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimStruct));
+    synchSimStructInit(sim_struct, SIM_BENCH_MAX_THREADS, bench_args.backoff_high, sizeof(ObjectState), 0, NULL);
+    synchSimStructSetDynamicThreads(sim_struct);
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+
+#ifdef DEBUG
+    SimObjectState *l = (SimObjectState *)sim_struct->pool[((pointer_t *)&sim_struct->sp)->struct_data.index];
+    fprintf(stderr, "DEBUG: Object state: %d\n", l->counter);
+    fprintf(stderr, "DEBUG: rounds: %d\n", l->rounds);
+    fprintf(stderr, "DEBUG: active cells: %u\n", sim_struct->registry.active_cells);
+#endif
+
+    return 0;
+}
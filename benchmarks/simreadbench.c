@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include <sim.h>
+#include <barrier.h>
+#include <bench_args.h>
+#include <fastrand.h>
+#include <threadtools.h>
+
+/// @brief The percentage of read-only operations that each thread performs.
+#ifndef SIM_BENCH_READ_RATIO
+#    define SIM_BENCH_READ_RATIO 90
+#endif
+
+typedef struct Counter {
+    int64_t value;
+} Counter;
+
+SimStruct *sim_struct CACHE_ALIGN;
+int64_t d1 CACHE_ALIGN, d2;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+#ifdef DEBUG
+volatile int64_t total_reads CACHE_ALIGN = 0;
+volatile int64_t invalid_reads = 0;
+#endif
+
+inline static RetVal fetchAndIncrement(void *state, ArgVal arg, int pid) {
+    Counter *obj = (Counter *)state;
+
+    return obj->value++;
+}
+
+inline static RetVal readCounter(void *state, ArgVal arg, int pid) {
+    return ((Counter *)state)->value;
+}
+
+inline static void *Execute(void *Arg) {
+    SimThreadState th_state;
+    long i, rnum;
+    int id = synchGetThreadId();
+    RetVal last = 0, ret;
+#ifdef DEBUG
+    int64_t reads = 0, invalid = 0;
+#endif
+    volatile long j;
+
+    SimThreadStateInit(&th_state, bench_args.nthreads, id);
+    synchFastRandomSetSeed((unsigned long)id + 1);
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    for (i = 0; i < bench_args.runs; i++) {
+        if (synchFastRandomRange(0, 100) < SIM_BENCH_READ_RATIO) {
+            ret = SimApplyReadOp(sim_struct, &th_state, readCounter, 0, id);
+#ifdef DEBUG
+            reads++;
+            invalid += (ret < last);                                                    // the counter never decreases
+#endif
+            last = ret;
+        } else {
+            last = SimApplyOp(sim_struct, &th_state, fetchAndIncrement, 0, id) + 1;
+        }
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+    }
+#ifdef DEBUG
+    synchFAA64(&total_reads, reads);
+    synchFAA64(&invalid_reads, invalid);
+#endif
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    synchParseArguments(&bench_args, argc, argv);
+    sim_struct = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimStruct));
+    synchSimStructInit(sim_struct, bench_args.nthreads, bench_args.backoff_high, sizeof(Counter), 0, NULL);
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+
+#ifdef DEBUG
+    SimObjectState *l = (SimObjectState *)sim_struct->pool[((pointer_t *)&sim_struct->sp)->struct_data.index];
+    int64_t updates = ((Counter *)l->state)->value;
+    fprintf(stderr, "DEBUG: Object state: %ld\n", (long)(updates + total_reads - invalid_reads));
+    fprintf(stderr, "DEBUG: read-only operations: %ld\n", (long)total_reads);
+    fprintf(stderr, "DEBUG: rounds: %d\n", l->rounds);
+#endif
+
+    return 0;
+}
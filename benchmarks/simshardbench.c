@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include <simshard.h>
+#include <barrier.h>
+#include <bench_args.h>
+#include <fastrand.h>
+#include <threadtools.h>
+
+/// @brief The number of shards (i.e. counters) of the partitioned counter.
+#ifndef SIM_BENCH_SHARDS
+#    define SIM_BENCH_SHARDS 4096
+#endif
+
+SimShardStruct *shard_struct CACHE_ALIGN;
+int64_t d1 CACHE_ALIGN, d2;
+SynchBarrier bar CACHE_ALIGN;
+SynchBenchArgs bench_args CACHE_ALIGN;
+
+// A serial Fetch&Add on the counter of a shard
+inline static RetVal fetchAndAdd(void *state, ArgVal arg, int pid) {
+    int64_t *counter = (int64_t *)state;
+    RetVal old = *counter;
+
+    *counter += arg;
+
+    return old;
+}
+
+inline static void *Execute(void *Arg) {
+    SimShardThreadState th_state;
+    long i, rnum;
+    int id = synchGetThreadId();
+    volatile long j;
+
+    SimShardThreadStateInit(shard_struct, &th_state, id);
+    synchFastRandomSetSeed((unsigned long)id + 1);
+    synchBarrierWait(&bar);
+    if (id == 0) d1 = synchGetTimeMillis();
+
+    for (i = 0; i < bench_args.runs; i++) {
+        SimShardApplyOp(shard_struct, &th_state, fetchAndAdd, synchFastRandomRange32(0, SIM_BENCH_SHARDS - 1), 1, id);
+        rnum = synchFastRandomRange(1, bench_args.max_work);
+        for (j = 0; j < rnum; j++)
+            ;
+    }
+    synchBarrierWait(&bar);
+    if (id == 0) d2 = synchGetTimeMillis();
+
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    synchParseArguments(&bench_args, argc, argv);
+    shard_struct = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimShardStruct));
+    synchSimShardStructInit(shard_struct, bench_args.nthreads, bench_args.backoff_high, SIM_BENCH_SHARDS, sizeof(int64_t), NULL);
+    synchBarrierSet(&bar, bench_args.nthreads);
+    synchStartThreadsN(bench_args.nthreads, Execute, bench_args.fibers_per_thread);
+    synchJoinThreadsN(bench_args.nthreads);
+
+    printf("time: %d (ms)\tthroughput: %.2f (millions ops/sec)\t", (int)(d2 - d1), bench_args.runs * bench_args.nthreads / (1000.0 * (d2 - d1)));
+    synchPrintStats(bench_args.nthreads, bench_args.total_runs);
+
+#ifdef DEBUG
+    SimShardRecord *l = shard_struct->pool[((pointer_t *)&shard_struct->sp)->struct_data.index];
+    int64_t sum = 0;
+    uint32_t i;
+
+    // the sum of the counters of all shards should be equal to the number of the applied requests
+    for (i = 0; i < SIM_BENCH_SHARDS; i++)
+        sum += *(int64_t *)SimShardGetState(shard_struct, i);
+    fprintf(stderr, "DEBUG: Object state: %ld\n", sum);
+    fprintf(stderr, "DEBUG: Applied requests: %ld\n", l->counter);
+    fprintf(stderr, "DEBUG: rounds: %d\n", l->rounds);
+    fprintf(stderr, "DEBUG: Average helping: %f\n", (float)l->counter / l->rounds);
+    fprintf(stderr, "DEBUG: shards: %u\tdepth: %u\tblocks: %u\tblock size: %u\n", shard_struct->nshards, shard_struct->depth + 1, shard_struct->nblocks, shard_struct->block_size);
+#endif
+
+    return 0;
+}
@@ -66,6 +66,8 @@ int main(int argc, char *argv[]) {
         counter++;
     }
     fprintf(stderr, "DEBUG: %ld nodes were left in the stack\n", counter);
+    fprintf(stderr, "DEBUG: eliminated push/pop pairs: %ld (%.2f%% of the pushes)\n", (long)stack->pool[stack->sp.struct_data.index]->eliminated,
+            100.0 * stack->pool[stack->sp.struct_data.index]->eliminated / (bench_args.runs * bench_args.nthreads));
 #endif
 
     return 0;
@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <config.h>
+#include <primitives.h>
+#include <fastrand.h>
+#include <tvec.h>
+#include <bench_args.h>
+
+#if defined(__amd64__) || defined(__x86_64__)
+#    include <x86intrin.h>
+#else
+#    include <time.h>
+#endif
+
+// Vector sizes (in threads) that are benchmarked
+static const uint32_t sizes[] = {64, 256, 1024};
+
+SynchBenchArgs bench_args CACHE_ALIGN;
+volatile int64_t sink;
+
+// On x86_64 the time-stamp counter is used, on aarch64 the virtual counter (that usually ticks slower than the core)
+// and in any other case nanoseconds.
+inline static uint64_t ReadCycles(void) {
+#if defined(__amd64__) || defined(__x86_64__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t val;
+
+    asm volatile("mrs %0, cntvct_el0" : "=r"(val));
+    return val;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+// Measures the inlined scalar loops of tvec.h (i.e. the code used for vectors shorter than _TVEC_SIMD_CELLS_ cells).
+static void BenchInline(ToggleVector *a, ToggleVector *b, ToggleVector *c, double *res) {
+    uint64_t i, j, t;
+    int64_t count = 0;
+
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++) {
+        LOOP(a->cell[j] = a->cell[j] ^ b->cell[j], j, a->tvec_cells);
+        asm volatile("" ::: "memory");
+    }
+    res[0] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++) {
+        LOOP(a->cell[j] = a->cell[j] & b->cell[j], j, a->tvec_cells);
+        asm volatile("" ::: "memory");
+    }
+    res[1] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++) {
+        LOOP(a->cell[j] = a->cell[j] | b->cell[j], j, a->tvec_cells);
+        asm volatile("" ::: "memory");
+    }
+    res[2] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++) {
+        memcpy(c->cell, a->cell, a->tvec_cells * sizeof(bitword_t));
+        asm volatile("" ::: "memory");
+    }
+    res[3] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++) {
+        LOOP(count += synchNonZeroBits(a->cell[j]), j, a->tvec_cells);
+        asm volatile("" ::: "memory");
+    }
+    res[4] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    sink = count;
+}
+
+// Measures the currently selected set of kernels.
+static void BenchKernels(ToggleVector *a, ToggleVector *b, ToggleVector *c, double *res) {
+    uint64_t i, t;
+    int64_t count = 0;
+
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++)
+        synchTVecKernels.xor_cells(a->cell, a->cell, b->cell, a->tvec_cells);
+    res[0] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++)
+        synchTVecKernels.and_cells(a->cell, a->cell, b->cell, a->tvec_cells);
+    res[1] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++)
+        synchTVecKernels.or_cells(a->cell, a->cell, b->cell, a->tvec_cells);
+    res[2] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++)
+        synchTVecKernels.copy_cells(c->cell, a->cell, a->tvec_cells);
+    res[3] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    t = ReadCycles();
+    for (i = 0; i < bench_args.total_runs; i++)
+        count += synchTVecKernels.count_bits(a->cell, a->tvec_cells);
+    res[4] = (double)(ReadCycles() - t) / bench_args.total_runs;
+    sink = count;
+}
+
+static void PrintResults(uint32_t nthreads, uint32_t cells, const char *name, double *res) {
+    printf("threads: %5u\tcells: %3u\tkernels: %-8s\txor: %7.2f\tand: %7.2f\tor: %7.2f\tcopy: %7.2f\tcount: %7.2f (cycles/op)\n",
+           nthreads, cells, name, res[0], res[1], res[2], res[3], res[4]);
+}
+
+int main(int argc, char *argv[]) {
+    ToggleVector a, b, c;
+    double res[5];
+    int selected, kernels;
+    uint32_t s, i;
+
+    synchParseArguments(&bench_args, argc, argv);
+    synchFastRandomSetSeed(1);
+    selected = synchTVecGetKernels();
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        TVEC_INIT(&a, sizes[s]);
+        TVEC_INIT(&b, sizes[s]);
+        TVEC_INIT(&c, sizes[s]);
+        for (i = 0; i < a.tvec_cells; i++) {
+            a.cell[i] = ((bitword_t)synchFastRandom32() << 32) | synchFastRandom32();
+            b.cell[i] = ((bitword_t)synchFastRandom32() << 32) | synchFastRandom32();
+        }
+
+        BenchInline(&a, &b, &c, res);
+        PrintResults(sizes[s], a.tvec_cells, "inline", res);
+        for (kernels = TVEC_KERNELS_SCALAR; kernels <= TVEC_KERNELS_NEON; kernels++) {
+            if (!synchTVecSetKernels(kernels))
+                continue;
+            BenchKernels(&a, &b, &c, res);
+            PrintResults(sizes[s], a.tvec_cells, synchTVecKernelsName(kernels), res);
+        }
+        synchTVecSetKernels(selected);
+
+        TVEC_DESTROY(&a);
+        TVEC_DESTROY(&b);
+        TVEC_DESTROY(&c);
+    }
+    printf("selected kernels: %s\tSIMD threshold: %d cells\n", synchTVecKernelsName(selected), _TVEC_SIMD_CELLS_);
+
+    return 0;
+}
@@ -1,33 +1,35 @@
 #include <ccqueue.h>
-#include <pool.h>
 
 inline static RetVal serialEnqueue(void *state, ArgVal arg, int pid);
 inline static RetVal serialDequeue(void *state, ArgVal arg, int pid);
 
-static __thread SynchPoolStruct pool_node CACHE_ALIGN;
-
 void CCQueueStructInit(CCQueueStruct *queue_object_struct, uint32_t nthreads) {
+    uint32_t i;
+
     CCSynchStructInit(&queue_object_struct->enqueue_struct, nthreads);
     CCSynchStructInit(&queue_object_struct->dequeue_struct, nthreads);
+    queue_object_struct->node_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(SynchNodeReturnSlot));
+    for (i = 0; i < nthreads; i++) {
+        queue_object_struct->node_slots[i].returned = NULL;
+        queue_object_struct->node_slots[i].released = NULL;
+    }
     queue_object_struct->guard.val = GUARD_VALUE;
     queue_object_struct->guard.next = NULL;
     queue_object_struct->first = &queue_object_struct->guard;
     queue_object_struct->last = &queue_object_struct->guard;
+    synchEventCountInit(&queue_object_struct->nonempty);
 }
 
 void CCQueueThreadStateInit(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, int pid) {
     CCSynchThreadStateInit(&object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, (int)pid);
     CCSynchThreadStateInit(&object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, (int)pid);
-    synchInitPool(&pool_node, sizeof(Node));
+    synchInitPool(&lobject_struct->pool, sizeof(SynchOwnedNode));
 }
 
 inline static RetVal serialEnqueue(void *state, ArgVal arg, int pid) {
     CCQueueStruct *st = (CCQueueStruct *)state;
-    Node *node;
+    Node *node = (Node *)arg;   // the node has been allocated and filled by the enqueuer
 
-    node = synchAllocObj(&pool_node);
-    node->next = NULL;
-    node->val = arg;
     st->last->next = node;
     st->last = node;
     synchNonTSOFence();
@@ -45,7 +47,8 @@ inline static RetVal serialDequeue(void *state, ArgVal arg, int pid) {
         if (node->val == GUARD_VALUE)
             return serialDequeue(state, arg, pid);
         synchNonTSOFence();
-        synchRecycleObj(&pool_node, (Node *)prev);
+        if (prev != &st->guard)
+            st->node_slots[pid].released = (SynchOwnedNode *)prev;   // it is returned to its owner by the dequeuer
         return node->val;
     } else {
         return EMPTY_QUEUE;
@@ -53,9 +56,35 @@ inline static RetVal serialDequeue(void *state, ArgVal arg, int pid) {
 }
 
 void CCQueueApplyEnqueue(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, ArgVal arg, int pid) {
-    CCSynchApplyOp(&object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, serialEnqueue, object_struct, (ArgVal)arg, pid);
+    SynchOwnedNode *node = synchOwnedNodeAlloc(&lobject_struct->pool, &object_struct->node_slots[pid], arg, pid);
+
+    CCSynchApplyOp(&object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, serialEnqueue, object_struct, (ArgVal)node, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal CCQueueApplyDequeue(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, int pid) {
-    return CCSynchApplyOp(&object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, serialDequeue, object_struct, (ArgVal)pid, pid);
+    RetVal ret = CCSynchApplyOp(&object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, serialDequeue, object_struct, (ArgVal)pid, pid);
+
+    synchOwnedNodeReturn(&lobject_struct->pool, object_struct->node_slots, pid);
+
+    return ret;
+}
+
+static RetVal CCQueueDequeueWait(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, CCQueueApplyDequeue(object_struct, lobject_struct, pid), EMPTY_QUEUE, deadline);
+
+    return ret;
+}
+
+RetVal CCQueueApplyDequeueBlocking(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, int pid) {
+    return CCQueueDequeueWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal CCQueueApplyDequeueTimed(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return CCQueueDequeueWait(object_struct, lobject_struct, &deadline, pid);
 }
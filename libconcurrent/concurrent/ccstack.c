@@ -1,5 +1,6 @@
 #include <ccstack.h>
 #include <pool.h>
+#include <string.h>
 
 inline static RetVal serialPushPop(void *state, ArgVal arg, int pid);
 
@@ -9,7 +10,9 @@ static __thread SynchPoolStruct pool_node CACHE_ALIGN;
 void CCStackInit(CCStackStruct *stack_object_struct, uint32_t nthreads) {
     CCSynchStructInit(&stack_object_struct->object_struct, nthreads);
     stack_object_struct->top = NULL;
+    memset(&stack_object_struct->elim, 0, sizeof(SynchElimBuffer));
     synchStoreFence();
+    synchEventCountInit(&stack_object_struct->nonempty);
 }
 
 void CCStackThreadStateInit(CCStackStruct *object_struct, CCStackThreadState *lobject_struct, int pid) {
@@ -21,9 +24,12 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
     if (arg == POP_OP) {
         volatile CCStackStruct *st = (CCStackStruct *)state;
         volatile Node *node = st->top;
+        RetVal ret;
 
-        if (st->top != NULL) {
-            RetVal ret = node->val;
+        if (synchElimPop((SynchElimBuffer *)&st->elim, &ret)) {                    // eliminated by a previous push
+            return ret;
+        } else if (st->top != NULL) {
+            ret = node->val;
             st->top = st->top->next;
             synchNonTSOFence();
             synchRecycleObj(&pool_node, (void *)node);
@@ -33,12 +39,15 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
     } else {
         CCStackStruct *st = (CCStackStruct *)state;
         Node *node;
+        ArgVal evicted;
 
-        node = synchAllocObj(&pool_node);
-        node->next = st->top;
-        node->val = arg;
-        st->top = node;
-        synchNonTSOFence();
+        if (synchElimPush(&st->elim, arg, &evicted)) {                              // the buffer is full, move its oldest element to a node
+            node = synchAllocObj(&pool_node);
+            node->next = st->top;
+            node->val = evicted;
+            st->top = node;
+            synchNonTSOFence();
+        }
 
         return PUSH_SUCCESS;
     }
@@ -46,8 +55,32 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
 
 void CCStackPush(CCStackStruct *object_struct, CCStackThreadState *lobject_struct, ArgVal arg, int pid) {
     CCSynchApplyOp(&object_struct->object_struct, &lobject_struct->th_state, serialPushPop, object_struct, (ArgVal)arg, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal CCStackPop(CCStackStruct *object_struct, CCStackThreadState *lobject_struct, int pid) {
     return CCSynchApplyOp(&object_struct->object_struct, &lobject_struct->th_state, serialPushPop, object_struct, (ArgVal)POP_OP, pid);
 }
+
+static RetVal CCStackPopWait(CCStackStruct *object_struct, CCStackThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, CCStackPop(object_struct, lobject_struct, pid), EMPTY_STACK, deadline);
+
+    return ret;
+}
+
+RetVal CCStackPopBlocking(CCStackStruct *object_struct, CCStackThreadState *lobject_struct, int pid) {
+    return CCStackPopWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal CCStackPopTimed(CCStackStruct *object_struct, CCStackThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return CCStackPopWait(object_struct, lobject_struct, &deadline, pid);
+}
+
+void CCStackGetElimStats(CCStackStruct *object_struct, SynchElimStats *stats) {
+    synchElimGetStats(&object_struct->elim, stats);
+}
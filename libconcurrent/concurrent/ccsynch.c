@@ -3,14 +3,18 @@
 #include <primitives.h>
 #include <threadtools.h>
 
-static const int CCSYNCH_HELP_FACTOR = 10;
-
 RetVal CCSynchApplyOp(CCSynchStruct *l, CCSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
+    return CCSynchApplyOpInline(l, st_thread, sfunc, state, arg, pid);
+}
+
+RetVal CCSynchApplyBatchOp(CCSynchStruct *l, CCSynchThreadState *st_thread, void (*batch_sfunc)(void *, ArgVal *, RetVal *, uint32_t), void *state, ArgVal arg, int pid) {
     volatile CCSynchNode *p;
     volatile CCSynchNode *cur;
     CCSynchNode *next_node, *tmp_next;
-    int help_bound = CCSYNCH_HELP_FACTOR * l->nthreads;
-    int counter = 0;
+    uint32_t help_bound;
+    uint32_t i, n = 0;
+    int64_t start;
+    SynchParkWakeList wake_list;
 
     next_node = st_thread->next;
     next_node->next = NULL;
@@ -26,38 +30,89 @@ RetVal CCSynchApplyOp(CCSynchStruct *l, CCSynchThreadState *st_thread, RetVal (*
     st_thread->next = (CCSynchNode *)cur;
     synchNonTSOFence();
 
-    while (cur->locked) { // spinning
-        synchResched();
-    }
+    synchParkWait(&cur->locked); // spinning, then parking
     if (cur->completed) // I have been helped
         return cur->arg_ret;
-#ifdef DEBUG
-    l->rounds++;
-#endif
-    p = cur; // I am not been helped
-    while (p->next != NULL && counter < help_bound) {
+    help_bound = l->help.bound;
+    start = synchHelpBoundStart(&l->help);
+    // Collect the arguments of the requests that are served in this round
+    for (p = cur; p->next != NULL && n < help_bound; p = p->next) {
         synchStorePrefetch(p->next);
-        counter++;
+        l->batch_args[n++] = p->arg_ret;
+    }
 #ifdef DEBUG
-        l->counter++;
+    l->rounds++;
+    l->counter += n;
 #endif
+    batch_sfunc(state, l->batch_args, l->batch_rets, n);
+    synchParkWakeListInit(&wake_list);
+    p = cur;
+    for (i = 0; i < n; i++) {
         tmp_next = p->next;
-        p->arg_ret = sfunc(state, p->arg_ret, p->pid);
+        p->arg_ret = l->batch_rets[i];
         synchNonTSOFence();
         p->completed = true;
         synchNonTSOFence();
-        p->locked = false;
+        synchParkUnlockDeferred(&p->locked, &wake_list);
         p = tmp_next;
     }
+    synchHelpBoundEnd(&l->help, start, n);
     synchNonTSOFence();
-    p->locked = false; // Unlock the next one
+    synchParkUnlock(&p->locked); // Unlock the next one
     synchStoreFence();
+    synchParkWakeAll(&wake_list);
 
     return cur->arg_ret;
 }
 
+// Polls the ticket of a request of CCSynchSubmitOp (see synchTicketPoll)
+static bool CCSynchPollTicket(SynchTicket *ticket) {
+    volatile CCSynchNode *cur = ticket->node;
+
+    if (cur->locked != false)
+        return false;
+    if (!cur->completed) // I am the combiner
+        CCSynchCombineInline(ticket->object, cur, ticket->sfunc, ticket->state);
+    ticket->ret = cur->arg_ret;
+
+    return true;
+}
+
+void CCSynchSubmitOp(CCSynchStruct *l, CCSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid, SynchTicket *ticket) {
+    volatile CCSynchNode *cur;
+    CCSynchNode *next_node;
+
+    next_node = st_thread->next;
+    next_node->next = NULL;
+    next_node->locked = true;
+    synchNonTSOFence();
+    next_node->completed = false;
+
+    cur = (CCSynchNode *)synchSWAP(&l->Tail, next_node);
+    cur->arg_ret = arg;
+    cur->pid = pid;
+    synchNonTSOFence();
+    cur->next = (CCSynchNode *)next_node;
+    st_thread->next = (CCSynchNode *)cur;
+    synchNonTSOFence();
+
+    ticket->object = l;
+    ticket->node = cur;
+    ticket->locked = &cur->locked;
+    ticket->sfunc = sfunc;
+    ticket->state = state;
+    ticket->pid = pid;
+    ticket->poll = CCSynchPollTicket;
+    ticket->done = false;
+    synchTicketPoll(ticket, NULL); // in case that I am the combiner, the round is executed at once
+}
+
 void CCSynchStructInit(CCSynchStruct *l, uint32_t nthreads) {
     l->nthreads = nthreads;
+    synchHelpBoundInit(&l->help, CCSYNCH_HELP_FACTOR * nthreads);
+    l->batch_capacity = l->help.max_bound;
+    l->batch_args = synchGetMemory(l->batch_capacity * sizeof(ArgVal));                // unlike synchGetAlignedMemory, it pairs with synchFreeMemory
+    l->batch_rets = synchGetMemory(l->batch_capacity * sizeof(RetVal));
 
     if (synchGetMachineModel() == INTEL_X86_MACHINE) {
         l->nodes = NULL;
@@ -78,6 +133,22 @@ void CCSynchStructInit(CCSynchStruct *l, uint32_t nthreads) {
     synchStoreFence();
 }
 
+void CCSynchStructSetHelpPolicy(CCSynchStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound) {
+    synchHelpBoundSetPolicy(&l->help, target_ns, min_bound, max_bound);
+    if (l->help.max_bound > l->batch_capacity) { // the batches of CCSynchApplyBatchOp may become larger
+        synchFreeMemory(l->batch_args, l->batch_capacity * sizeof(ArgVal));
+        synchFreeMemory(l->batch_rets, l->batch_capacity * sizeof(RetVal));
+        l->batch_capacity = l->help.max_bound;
+        l->batch_args = synchGetMemory(l->batch_capacity * sizeof(ArgVal));
+        l->batch_rets = synchGetMemory(l->batch_capacity * sizeof(RetVal));
+    }
+    synchFullFence();
+}
+
+void CCSynchGetHelpStats(CCSynchStruct *l, SynchHelpBound *stats) {
+    *stats = l->help;
+}
+
 void CCSynchThreadStateInit(CCSynchStruct *l, CCSynchThreadState *st_thread, int pid) {
     if (synchGetMachineModel() == INTEL_X86_MACHINE) {
         st_thread->next = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(CCSynchStruct));
@@ -1,5 +1,6 @@
 #include <dsmstack.h>
 #include <pool.h>
+#include <string.h>
 
 inline static RetVal serialPushPop(void *state, ArgVal arg, int pid);
 
@@ -9,7 +10,9 @@ static __thread SynchPoolStruct pool_node CACHE_ALIGN;
 void DSMSStackInit(DSMStackStruct *stack_object_struct, uint32_t nthreads) {
     DSMSynchStructInit(&stack_object_struct->object_struct, nthreads);
     stack_object_struct->top = NULL;
+    memset(&stack_object_struct->elim, 0, sizeof(SynchElimBuffer));
     synchStoreFence();
+    synchEventCountInit(&stack_object_struct->nonempty);
 }
 
 void DSMStackThreadStateInit(DSMStackStruct *object_struct, DSMStackThreadState *lobject_struct, int pid) {
@@ -21,9 +24,12 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
     if (arg == POP_OP) {
         volatile DSMStackStruct *st = (DSMStackStruct *)state;
         volatile Node *node = st->top;
+        RetVal ret;
 
-        if (st->top != NULL) {
-            RetVal ret = node->val;
+        if (synchElimPop((SynchElimBuffer *)&st->elim, &ret)) {                    // eliminated by a previous push
+            return ret;
+        } else if (st->top != NULL) {
+            ret = node->val;
             st->top = st->top->next;
             synchNonTSOFence();
             synchRecycleObj(&pool_node, (void *)node);
@@ -33,12 +39,15 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
     } else {
         DSMStackStruct *st = (DSMStackStruct *)state;
         Node *node;
+        ArgVal evicted;
 
-        node = synchAllocObj(&pool_node);
-        node->next = st->top;
-        node->val = arg;
-        st->top = node;
-        synchNonTSOFence();
+        if (synchElimPush(&st->elim, arg, &evicted)) {                              // the buffer is full, move its oldest element to a node
+            node = synchAllocObj(&pool_node);
+            node->next = st->top;
+            node->val = evicted;
+            st->top = node;
+            synchNonTSOFence();
+        }
 
         return PUSH_SUCCESS;
     }
@@ -46,8 +55,32 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
 
 void DSMStackPush(DSMStackStruct *object_struct, DSMStackThreadState *lobject_struct, ArgVal arg, int pid) {
     DSMSynchApplyOp(&object_struct->object_struct, &lobject_struct->th_state, serialPushPop, object_struct, (ArgVal)arg, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal DSMStackPop(DSMStackStruct *object_struct, DSMStackThreadState *lobject_struct, int pid) {
     return DSMSynchApplyOp(&object_struct->object_struct, &lobject_struct->th_state, serialPushPop, object_struct, (ArgVal)POP_OP, pid);
 }
+
+static RetVal DSMStackPopWait(DSMStackStruct *object_struct, DSMStackThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, DSMStackPop(object_struct, lobject_struct, pid), EMPTY_STACK, deadline);
+
+    return ret;
+}
+
+RetVal DSMStackPopBlocking(DSMStackStruct *object_struct, DSMStackThreadState *lobject_struct, int pid) {
+    return DSMStackPopWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal DSMStackPopTimed(DSMStackStruct *object_struct, DSMStackThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return DSMStackPopWait(object_struct, lobject_struct, &deadline, pid);
+}
+
+void DSMStackGetElimStats(DSMStackStruct *object_struct, SynchElimStats *stats) {
+    synchElimGetStats(&object_struct->elim, stats);
+}
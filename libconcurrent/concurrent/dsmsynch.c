@@ -1,14 +1,18 @@
 #include <dsmsynch.h>
 #include <threadtools.h>
 
-static const int DSMSYNCH_HELP_FACTOR = 10;
-
 RetVal DSMSynchApplyOp(DSMSynchStruct *l, DSMSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
+    return DSMSynchApplyOpInline(l, st_thread, sfunc, state, arg, pid);
+}
+
+RetVal DSMSynchApplyBatchOp(DSMSynchStruct *l, DSMSynchThreadState *st_thread, void (*batch_sfunc)(void *, ArgVal *, RetVal *, uint32_t), void *state, ArgVal arg, int pid) {
     volatile DSMSynchNode *mynode;
     DSMSynchNode *mypred;
-    volatile DSMSynchNode *p;
-    register int counter;
-    int help_bound = DSMSYNCH_HELP_FACTOR * l->nthreads;
+    volatile DSMSynchNode *p, *last, *tmp_next;
+    uint32_t help_bound;
+    uint32_t i, n;
+    int64_t start;
+    SynchParkWakeList wake_list;
 
     st_thread->toggle = 1 - st_thread->toggle;
     mynode = st_thread->MyNodes[st_thread->toggle];
@@ -25,50 +29,65 @@ RetVal DSMSynchApplyOp(DSMSynchStruct *l, DSMSynchThreadState *st_thread, RetVal
         mypred->next = (DSMSynchNode *)mynode;
         synchFullFence();
 
-        while (mynode->locked) {
-            synchResched();
-        }
+        synchParkWait(&mynode->locked);
         synchNonTSOFence();
         if (mynode->completed) // operation has already applied
             return mynode->arg_ret;
     }
 
+    help_bound = l->help.bound;
+    start = synchHelpBoundStart(&l->help);
+    // Collect the arguments of the requests that are served in this round
+    n = 0;
+    last = mynode;
+    do { // I surely do it for myself
+        synchReadPrefetch(last->next);
+        l->batch_args[n++] = last->arg_ret;
+        if (last->next == NULL || last->next->next == NULL || n >= help_bound)
+            break;
+        last = last->next;
+    } while (true);
 #ifdef DEBUG
     l->rounds += 1;
+    l->counter += n;
 #endif
-    counter = 0;
+    batch_sfunc(state, l->batch_args, l->batch_rets, n);
+    synchParkWakeListInit(&wake_list);
     p = mynode;
-    do { // I surely do it for myself
-        synchReadPrefetch(p->next);
-        counter++;
-#ifdef DEBUG
-        l->counter += 1;
-#endif
-        p->arg_ret = sfunc(state, p->arg_ret, p->pid);
+    for (i = 0; i < n; i++) {
+        tmp_next = p->next;
+        p->arg_ret = l->batch_rets[i];
         synchNonTSOFence();
         p->completed = true;
         synchNonTSOFence();
-        p->locked = false;
-        if (p->next == NULL || p->next->next == NULL || counter >= help_bound)
-            break;
-        p = p->next;
-    } while (true);
+        synchParkUnlockDeferred(&p->locked, &wake_list);
+        p = tmp_next;
+    }
+    synchHelpBoundEnd(&l->help, start, n);
     // End critical section
-    if (p->next == NULL) {
-        if (l->Tail == p && synchCASPTR(&l->Tail, p, NULL) == true) return mynode->arg_ret;
-        while (p->next == NULL) {
+    if (last->next == NULL) {
+        if (l->Tail == last && synchCASPTR(&l->Tail, last, NULL) == true) {
+            synchParkWakeAll(&wake_list);
+            return mynode->arg_ret;
+        }
+        while (last->next == NULL) {
             synchResched();
         }
     }
     synchNonTSOFence();
-    p->next->locked = false;
+    synchParkUnlock(&last->next->locked);
     synchFullFence();
+    synchParkWakeAll(&wake_list);
 
     return mynode->arg_ret;
 }
 
 void DSMSynchStructInit(DSMSynchStruct *l, uint32_t nthreads) {
     l->nthreads = nthreads;
+    synchHelpBoundInit(&l->help, DSMSYNCH_HELP_FACTOR * nthreads);
+    l->batch_capacity = l->help.max_bound;
+    l->batch_args = synchGetMemory(l->batch_capacity * sizeof(ArgVal));                // unlike synchGetAlignedMemory, it pairs with synchFreeMemory
+    l->batch_rets = synchGetMemory(l->batch_capacity * sizeof(RetVal));
     l->Tail = NULL;
 
     if (synchGetMachineModel() == INTEL_X86_MACHINE) {
@@ -83,6 +102,69 @@ void DSMSynchStructInit(DSMSynchStruct *l, uint32_t nthreads) {
     synchFullFence();
 }
 
+void DSMSynchStructSetHelpPolicy(DSMSynchStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound) {
+    synchHelpBoundSetPolicy(&l->help, target_ns, min_bound, max_bound);
+    if (l->help.max_bound > l->batch_capacity) { // the batches of DSMSynchApplyBatchOp may become larger
+        synchFreeMemory(l->batch_args, l->batch_capacity * sizeof(ArgVal));
+        synchFreeMemory(l->batch_rets, l->batch_capacity * sizeof(RetVal));
+        l->batch_capacity = l->help.max_bound;
+        l->batch_args = synchGetMemory(l->batch_capacity * sizeof(ArgVal));
+        l->batch_rets = synchGetMemory(l->batch_capacity * sizeof(RetVal));
+    }
+    synchFullFence();
+}
+
+void DSMSynchGetHelpStats(DSMSynchStruct *l, SynchHelpBound *stats) {
+    *stats = l->help;
+}
+
+// Polls the ticket of a request of DSMSynchSubmitOp (see synchTicketPoll)
+static bool DSMSynchPollTicket(SynchTicket *ticket) {
+    volatile DSMSynchNode *mynode = ticket->node;
+
+    if (mynode->locked != false)
+        return false;
+    synchNonTSOFence();
+    if (!mynode->completed) // I am the combiner
+        DSMSynchCombineInline(ticket->object, mynode, ticket->sfunc, ticket->state);
+    ticket->ret = mynode->arg_ret;
+
+    return true;
+}
+
+void DSMSynchSubmitOp(DSMSynchStruct *l, DSMSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid, SynchTicket *ticket) {
+    volatile DSMSynchNode *mynode;
+    DSMSynchNode *mypred;
+
+    st_thread->toggle = 1 - st_thread->toggle;
+    mynode = st_thread->MyNodes[st_thread->toggle];
+
+    mynode->next = NULL;
+    mynode->arg_ret = arg;
+    mynode->pid = pid;
+    mynode->locked = true;
+    synchNonTSOFence();
+    mynode->completed = false;
+
+    mypred = (DSMSynchNode *)synchSWAP(&l->Tail, mynode);
+    if (mypred != NULL) {
+        mypred->next = (DSMSynchNode *)mynode;
+        synchFullFence();
+    } else {
+        mynode->locked = false; // there is no predecessor to unlock me, I am the combiner
+    }
+
+    ticket->object = l;
+    ticket->node = mynode;
+    ticket->locked = &mynode->locked;
+    ticket->sfunc = sfunc;
+    ticket->state = state;
+    ticket->pid = pid;
+    ticket->poll = DSMSynchPollTicket;
+    ticket->done = false;
+    synchTicketPoll(ticket, NULL); // in case that I am the combiner, the round is executed at once
+}
+
 void DSMSynchThreadStateInit(DSMSynchStruct *l, DSMSynchThreadState *st_thread, int pid) {
     if (synchGetMachineModel() == INTEL_X86_MACHINE) {
         DSMSynchNode *nodes = synchGetAlignedMemory(CACHE_LINE_SIZE, 2 * sizeof(DSMSynchNode));
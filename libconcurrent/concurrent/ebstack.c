@@ -0,0 +1,184 @@
+#include <stdbool.h>
+
+#include <ebstack.h>
+#include <fastrand.h>
+#include <threadtools.h>
+
+#ifdef SYNCH_NUMA_SUPPORT
+#    include <numa.h>
+#endif
+
+#define EBSTACK_PID_BITS 16
+#define EBSTACK_POP      0
+#define EBSTACK_PUSH     1
+
+#define EBStackOfferWord(seq, op, pid) (((seq) << (EBSTACK_PID_BITS + 1)) | ((uint64_t)(op) << EBSTACK_PID_BITS) | (uint64_t)((pid) + 1))
+#define EBStackOfferSeq(word)          ((word) >> (EBSTACK_PID_BITS + 1))
+#define EBStackOfferOp(word)           (((word) >> EBSTACK_PID_BITS) & 1)
+#define EBStackOfferPid(word)          ((int)((word) & ((1ULL << EBSTACK_PID_BITS) - 1)) - 1)
+
+#if defined(EBSTACK_DEBUG_CAS_FAILURES) && EBSTACK_DEBUG_CAS_FAILURES > 0
+#    define EBStackCASTop(s, old_top, new_top) (synchFastRandom32() % EBSTACK_DEBUG_CAS_FAILURES != 0 && synchCASPTR(&(s)->stack.top, old_top, new_top))
+#else
+#    define EBStackCASTop(s, old_top, new_top) synchCASPTR(&(s)->stack.top, old_top, new_top)
+#endif
+
+static bool EBStackEliminate(EBStackStruct *s, EBStackThreadState *th_state, int op, ArgVal *val);
+
+// The selected slot is occupied, so more threads than slots are trying to eliminate their operations.
+static inline void EBStackWiden(EBStackStruct *s, EBStackThreadState *th_state) {
+    th_state->width = (2 * th_state->width < s->max_width) ? 2 * th_state->width : s->max_width;
+}
+
+// A posted offer expired, so the threads are too sparse over the slots.
+static inline void EBStackShrink(EBStackThreadState *th_state) {
+    if (th_state->width > 1) th_state->width--;
+}
+
+static bool EBStackEliminate(EBStackStruct *s, EBStackThreadState *th_state, int op, ArgVal *val) {
+    EBStackSlot *slot = &th_state->slots[synchFastRandom32() % th_state->width];
+    uint64_t word = slot->word;
+
+    if (word == 0) {
+        EBStackOffer *mine = &s->offers[th_state->pid];
+        uint64_t seq = ++th_state->seq;
+        int i;
+
+        if (op == EBSTACK_PUSH) mine->val = *val;
+        word = EBStackOfferWord(seq, op, th_state->pid);
+        if (!synchCAS64(&slot->word, 0, word)) {
+            EBStackWiden(s, th_state);
+            return false;
+        }
+        for (i = 0; i < EBSTACK_ELIM_WAIT && mine->done != seq; i++)
+            synchResched();
+        if (mine->done != seq && synchCAS64(&slot->word, word, 0)) {
+            EBStackShrink(th_state);
+            return false;
+        }
+        // a partner has claimed the offer, so it is going to complete it
+        while (mine->done != seq)
+            synchResched();
+        synchNonTSOFence();
+        if (op == EBSTACK_POP) *val = mine->val;
+    } else if (EBStackOfferOp(word) != op && synchCAS64(&slot->word, word, 0)) {
+        EBStackOffer *partner = &s->offers[EBStackOfferPid(word)];
+
+        if (op == EBSTACK_PUSH) partner->val = *val;
+        else *val = partner->val;
+        synchNonTSOFence();
+        partner->done = EBStackOfferSeq(word);
+    } else {
+        EBStackWiden(s, th_state);
+        return false;
+    }
+    th_state->eliminated++;
+
+    return true;
+}
+
+void EBStackInit(EBStackStruct *s, uint32_t nthreads) {
+    uint32_t i, j;
+
+    LFStackInit(&s->stack, nthreads);
+#ifdef SYNCH_NUMA_SUPPORT
+    s->numa_nodes = numa_num_configured_nodes();
+    if (s->numa_nodes < 1) s->numa_nodes = 1;
+#else
+    s->numa_nodes = 1;
+#endif
+    s->max_width = (nthreads < EBSTACK_MAX_SLOTS) ? nthreads : EBSTACK_MAX_SLOTS;
+    if (s->max_width == 0) s->max_width = 1;
+    s->slots = synchGetAlignedMemory(CACHE_LINE_SIZE, s->numa_nodes * sizeof(EBStackSlot *));
+    for (i = 0; i < s->numa_nodes; i++) {
+        s->slots[i] = synchGetMemoryOnNumaNode(EBSTACK_MAX_SLOTS * sizeof(EBStackSlot), i);
+        for (j = 0; j < EBSTACK_MAX_SLOTS; j++)
+            s->slots[i][j].word = 0;
+    }
+    s->offers = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(EBStackOffer));
+    for (i = 0; i < nthreads; i++)
+        s->offers[i].done = 0;
+    synchFullFence();
+}
+
+void EBStackThreadStateInit(EBStackStruct *s, EBStackThreadState *th_state, int min_back, int max_back, int pid) {
+    int32_t node = synchGetPreferredNumaNode();
+
+    if (node < 0) node = 0;
+    LFStackThreadStateInit(&s->stack, &th_state->lf, min_back, max_back, pid);
+    th_state->slots = s->slots[node % s->numa_nodes];
+    th_state->width = 1;
+    th_state->pid = pid;
+    th_state->seq = 0;
+    th_state->eliminated = 0;
+}
+
+void EBStackPush(EBStackStruct *s, EBStackThreadState *th_state, ArgVal arg) {
+    LFStackStruct *l = &s->stack;
+    SynchOwnedNode *n;
+
+    n = synchEBRAlloc(&th_state->lf.ebr);
+    synchResetBackoff(&th_state->lf.backoff);
+    n->node.val = arg;
+    n->owner = th_state->lf.ebr.pid;
+    do {
+        Node *old_top = (Node *)l->top; // top is volatile
+        n->node.next = old_top;
+        if (EBStackCASTop(s, old_top, &n->node)) {
+            synchEventCountNotifyAfterRMW(&s->stack.nonempty);
+            return;
+        }
+        if (EBStackEliminate(s, th_state, EBSTACK_PUSH, &arg)) {
+            // n has never been accessible by other threads and the value has been passed to a pop, thus there is nothing to notify
+            synchRecycleObj(&th_state->lf.pool, n);
+            return;
+        }
+        synchBackoffDelay(&th_state->lf.backoff);
+    } while (true);
+}
+
+RetVal EBStackPop(EBStackStruct *s, EBStackThreadState *th_state) {
+    LFStackStruct *l = &s->stack;
+    ArgVal val;
+    RetVal ret;
+
+    synchResetBackoff(&th_state->lf.backoff);
+    do {
+        // as in LFStackPop, old_top could not be recycled before this thread exits
+        synchEBREnter(&l->ebr, &th_state->lf.ebr);
+        Node *old_top = (Node *)l->top;
+        if (old_top == NULL) {
+            synchEBRExit(&l->ebr, &th_state->lf.ebr);
+            return EMPTY_STACK;
+        }
+        if (EBStackCASTop(s, old_top, old_top->next)) {
+            ret = old_top->val;
+            synchEBRExit(&l->ebr, &th_state->lf.ebr);
+            synchEBRRetire(&l->ebr, &th_state->lf.ebr, old_top, ((SynchOwnedNode *)old_top)->owner);
+            return ret;
+        }
+        synchEBRExit(&l->ebr, &th_state->lf.ebr);
+        if (EBStackEliminate(s, th_state, EBSTACK_POP, &val))
+            return val;
+        synchBackoffDelay(&th_state->lf.backoff);
+    } while (true);
+}
+
+static RetVal EBStackPopWait(EBStackStruct *s, EBStackThreadState *th_state, const struct timespec *deadline) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&s->stack.nonempty, ret, EBStackPop(s, th_state), EMPTY_STACK, deadline);
+
+    return ret;
+}
+
+RetVal EBStackPopBlocking(EBStackStruct *s, EBStackThreadState *th_state) {
+    return EBStackPopWait(s, th_state, NULL);
+}
+
+RetVal EBStackPopTimed(EBStackStruct *s, EBStackThreadState *th_state, uint64_t timeout_ns) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return EBStackPopWait(s, th_state, &deadline);
+}
@@ -8,12 +8,15 @@
 #include "primitives.h"
 #include "threadtools.h"
 #include "fc.h"
+#include "park.h"
 
 #define FC_CLEANUP_FREQUENCY     100
 #define FC_CLEANUP_OLD_THRESHOLD 100
 #define FC_COMBINING_ROUNDS      3
 
 static void FCEnqueueRequest(FCStruct *lock, FCThreadState *st_thread);
+static void FCWait(FCStruct *lock, FCRequest *request);
+static void FCWakeParked(FCStruct *lock);
 
 void FCStructInit(FCStruct *l, uint32_t nthreads) {
     l->lock = 0;
@@ -22,6 +25,7 @@ void FCStructInit(FCStruct *l, uint32_t nthreads) {
     l->counter = 0;
     l->rounds = 0;
     l->nodes = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(FCRequest));
+    l->parked = 0;
     synchStoreFence();
 }
 
@@ -29,6 +33,7 @@ void FCThreadStateInit(FCStruct *l, FCThreadState *st_thread, int pid) {
     st_thread->node = &l->nodes[pid];
     st_thread->node->age = 0;
     st_thread->node->active = false;
+    st_thread->node->parked = SYNCH_PARK_UNLOCKED;
     synchNonTSOFence();
 }
 
@@ -47,6 +52,48 @@ static void FCEnqueueRequest(FCStruct *lock, FCThreadState *st_thread) {
     } while (!synchCASPTR(&lock->head, supposed, request));
 }
 
+// Waits until the lock is released or the request is either applied or removed from the list of requests
+static void FCWait(FCStruct *lock, FCRequest *request) {
+#ifndef SYNCH_PARKING_DISABLE
+    if (!synchIsFiberScheduled() && synchIsSystemOversubscribed()) {
+        int i;
+
+        for (i = 0; i < SYNCH_PARK_SPINS && lock->lock && request->pending && request->active; i++)
+            synchResched();
+        while (lock->lock && request->pending && request->active) {
+            request->parked = SYNCH_PARK_PARKED;
+            // the full fence of synchFAA32 orders the store above before checking the waiting condition
+            synchFAA32(&lock->parked, 1);
+            if (lock->lock && request->pending && request->active)
+                synchParkSleep(&request->parked);
+            request->parked = SYNCH_PARK_UNLOCKED;
+            synchFAA32(&lock->parked, -1);
+        }
+        return;
+    }
+#endif
+    while (lock->lock && request->pending && request->active) {
+        synchResched();
+    }
+}
+
+// Called by the combiner after it releases the lock; it wakes up the owners of the applied requests
+// and the owner of the first pending request, which competes for becoming the next combiner.
+static void FCWakeParked(FCStruct *lock) {
+    volatile FCRequest *cur;
+    bool woken_pending = false;
+
+    synchFullFence();
+    if (lock->parked == 0)
+        return;
+    for (cur = lock->head; cur != NULL; cur = cur->next) {
+        if (cur->parked == SYNCH_PARK_PARKED && (!cur->pending || !woken_pending)) {
+            woken_pending |= cur->pending;
+            synchParkUnlock(&cur->parked);
+        }
+    }
+}
+
 RetVal FCApplyOp(FCStruct *lock, FCThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
     struct FCRequest *request;
     int i;
@@ -61,9 +108,7 @@ RetVal FCApplyOp(FCStruct *lock, FCThreadState *st_thread, RetVal (*sfunc)(void
         if (lock->lock == 0 && synchCAS64(&lock->lock, 0, 1)) {
             break;
         } else {
-            while (lock->lock && request->pending && request->active) {
-                synchResched();
-            }
+            FCWait(lock, request);
             if (request->pending == false) {
                 return request->val;
             } else if (request->active == false) {
@@ -101,13 +146,17 @@ RetVal FCApplyOp(FCStruct *lock, FCThreadState *st_thread, RetVal (*sfunc)(void
                 prev->next = cur->next;
                 synchNonTSOFence();
                 cur->active = 0;
-                synchNonTSOFence();
+                synchFullFence();
+                synchParkUnlock(&cur->parked);
             } else
                 prev = cur;
         }
     }
     lock->lock = 0;
     synchStoreFence();
+#ifndef SYNCH_PARKING_DISABLE
+    FCWakeParked(lock);
+#endif
 
     return request->val;
 }
@@ -17,6 +17,7 @@ void FCQueueStructInit(FCQueueStruct *queue_object_struct, uint32_t nthreads) {
     queue_object_struct->guard.next = NULL;
     queue_object_struct->first = &queue_object_struct->guard;
     queue_object_struct->last = &queue_object_struct->guard;
+    synchEventCountInit(&queue_object_struct->nonempty);
 }
 
 void FCQueueThreadStateInit(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, int pid) {
@@ -51,8 +52,28 @@ inline static RetVal serialDequeue(void *state, ArgVal arg, int pid) {
 
 void FCQueueApplyEnqueue(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, ArgVal arg, int pid) {
     FCApplyOp(&object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, serialEnqueue, object_struct, (ArgVal) pid, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal FCQueueApplyDequeue(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, int pid) {
      return FCApplyOp(&object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, serialDequeue, object_struct, (ArgVal) pid, pid);
 }
+
+static RetVal FCQueueDequeueWait(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, FCQueueApplyDequeue(object_struct, lobject_struct, pid), EMPTY_QUEUE, deadline);
+
+    return ret;
+}
+
+RetVal FCQueueApplyDequeueBlocking(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, int pid) {
+    return FCQueueDequeueWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal FCQueueApplyDequeueTimed(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return FCQueueDequeueWait(object_struct, lobject_struct, &deadline, pid);
+}
@@ -2,6 +2,7 @@
 #include <config.h>
 #include <primitives.h>
 #include <pool.h>
+#include <string.h>
 #include <queue-stack.h>
 
 static const int POP_OP = INT_MIN;
@@ -10,7 +11,9 @@ static __thread SynchPoolStruct pool_node CACHE_ALIGN;
 void FCStackInit(FCStackStruct *stack_object_struct, uint32_t nthreads) {
     FCStructInit(&stack_object_struct->object_struct, nthreads);
     stack_object_struct->top = NULL;
+    memset(&stack_object_struct->elim, 0, sizeof(SynchElimBuffer));
     synchStoreFence();
+    synchEventCountInit(&stack_object_struct->nonempty);
 }
 
 void FCStackThreadStateInit(FCStackStruct *object_struct, FCStackThreadState *lobject_struct, int pid) {
@@ -23,6 +26,10 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
         volatile FCStackStruct *st = (FCStackStruct *)state;
         volatile Node *node = st->top;
 
+        RetVal ret;
+
+        if (synchElimPop((SynchElimBuffer *)&st->elim, &ret))                       // eliminated by a previous push
+            return ret;
         if (st->top != NULL) {
             st->top = st->top->next;
             return node->val;
@@ -30,11 +37,14 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
     } else {
         FCStackStruct *st = (FCStackStruct *)state;
         Node *node;
+        ArgVal evicted;
 
-        node = synchAllocObj(&pool_node);
-        node->next = st->top;
-        node->val = arg;
-        st->top = node;
+        if (synchElimPush(&st->elim, arg, &evicted)) {                              // the buffer is full, move its oldest element to a node
+            node = synchAllocObj(&pool_node);
+            node->next = st->top;
+            node->val = evicted;
+            st->top = node;
+        }
  
         return 0;
     }
@@ -42,8 +52,32 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
 
 void FCStackPush(FCStackStruct *object_struct, FCStackThreadState *lobject_struct, ArgVal arg, int pid) {
     FCApplyOp(&object_struct->object_struct, &lobject_struct->th_state, serialPushPop, object_struct, (ArgVal) arg, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal FCStackPop(FCStackStruct *object_struct, FCStackThreadState *lobject_struct, int pid) {
     return FCApplyOp(&object_struct->object_struct, &lobject_struct->th_state, serialPushPop, object_struct, (ArgVal) POP_OP, pid);
 }
+
+static RetVal FCStackPopWait(FCStackStruct *object_struct, FCStackThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, FCStackPop(object_struct, lobject_struct, pid), EMPTY_STACK, deadline);
+
+    return ret;
+}
+
+RetVal FCStackPopBlocking(FCStackStruct *object_struct, FCStackThreadState *lobject_struct, int pid) {
+    return FCStackPopWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal FCStackPopTimed(FCStackStruct *object_struct, FCStackThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return FCStackPopWait(object_struct, lobject_struct, &deadline, pid);
+}
+
+void FCStackGetElimStats(FCStackStruct *object_struct, SynchElimStats *stats) {
+    synchElimGetStats(&object_struct->elim, stats);
+}
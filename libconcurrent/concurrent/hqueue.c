@@ -1,35 +1,37 @@
 #include <hqueue.h>
-#include <pool.h>
 
 inline static RetVal serialEnqueue(void *state, ArgVal arg, int pid);
 inline static RetVal serialDequeue(void *state, ArgVal arg, int pid);
 
-static __thread SynchPoolStruct pool_node CACHE_ALIGN;
-
 void HQueueInit(HQueueStruct *queue_object_struct, uint32_t nthreads, uint32_t numa_nodes) {
+    uint32_t i;
+
     queue_object_struct->enqueue_struct = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(HSynchStruct));
     queue_object_struct->dequeue_struct = synchGetAlignedMemory(S_CACHE_LINE_SIZE, sizeof(HSynchStruct));
     HSynchStructInit(queue_object_struct->enqueue_struct, nthreads, numa_nodes);
     HSynchStructInit(queue_object_struct->dequeue_struct, nthreads, numa_nodes);
+    queue_object_struct->node_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(SynchNodeReturnSlot));
+    for (i = 0; i < nthreads; i++) {
+        queue_object_struct->node_slots[i].returned = NULL;
+        queue_object_struct->node_slots[i].released = NULL;
+    }
     queue_object_struct->guard.val = GUARD_VALUE;
     queue_object_struct->guard.next = NULL;
     queue_object_struct->first = &queue_object_struct->guard;
     queue_object_struct->last = &queue_object_struct->guard;
+    synchEventCountInit(&queue_object_struct->nonempty);
 }
 
 void HQueueThreadStateInit(HQueueStruct *object_struct, HQueueThreadState *lobject_struct, int pid) {
     HSynchThreadStateInit(object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, (int)pid);
     HSynchThreadStateInit(object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, (int)pid);
-    synchInitPool(&pool_node, sizeof(Node));
+    synchInitPool(&lobject_struct->pool, sizeof(SynchOwnedNode));
 }
 
 inline static RetVal serialEnqueue(void *state, ArgVal arg, int pid) {
     HQueueStruct *st = (HQueueStruct *)state;
-    Node *node;
+    Node *node = (Node *)arg;   // the node has been allocated and filled by the enqueuer
 
-    node = synchAllocObj(&pool_node);
-    node->next = NULL;
-    node->val = arg;
     st->last->next = node;
     st->last = node;
     synchNonTSOFence();
@@ -47,7 +49,8 @@ inline static RetVal serialDequeue(void *state, ArgVal arg, int pid) {
         if (node->val == GUARD_VALUE)
             return serialDequeue(state, arg, pid);
         synchNonTSOFence();
-        synchRecycleObj(&pool_node, (Node *)prev);
+        if (prev != &st->guard)
+            st->node_slots[pid].released = (SynchOwnedNode *)prev;   // it is returned to its owner by the dequeuer
         return node->val;
     } else {
         return EMPTY_QUEUE;
@@ -55,9 +58,35 @@ inline static RetVal serialDequeue(void *state, ArgVal arg, int pid) {
 }
 
 void HQueueApplyEnqueue(HQueueStruct *object_struct, HQueueThreadState *lobject_struct, ArgVal arg, int pid) {
-    HSynchApplyOp(object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, serialEnqueue, object_struct, (ArgVal)arg, pid);
+    SynchOwnedNode *node = synchOwnedNodeAlloc(&lobject_struct->pool, &object_struct->node_slots[pid], arg, pid);
+
+    HSynchApplyOp(object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, serialEnqueue, object_struct, (ArgVal)node, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal HQueueApplyDequeue(HQueueStruct *object_struct, HQueueThreadState *lobject_struct, int pid) {
-    return HSynchApplyOp(object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, serialDequeue, object_struct, (ArgVal)pid, pid);
+    RetVal ret = HSynchApplyOp(object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, serialDequeue, object_struct, (ArgVal)pid, pid);
+
+    synchOwnedNodeReturn(&lobject_struct->pool, object_struct->node_slots, pid);
+
+    return ret;
+}
+
+static RetVal HQueueDequeueWait(HQueueStruct *object_struct, HQueueThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, HQueueApplyDequeue(object_struct, lobject_struct, pid), EMPTY_QUEUE, deadline);
+
+    return ret;
+}
+
+RetVal HQueueApplyDequeueBlocking(HQueueStruct *object_struct, HQueueThreadState *lobject_struct, int pid) {
+    return HQueueDequeueWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal HQueueApplyDequeueTimed(HQueueStruct *object_struct, HQueueThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return HQueueDequeueWait(object_struct, lobject_struct, &deadline, pid);
 }
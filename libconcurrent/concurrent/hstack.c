@@ -1,5 +1,6 @@
 #include <hstack.h>
 #include <pool.h>
+#include <string.h>
 
 inline static RetVal serialPushPop(void *state, ArgVal arg, int pid);
 
@@ -9,6 +10,8 @@ static __thread SynchPoolStruct pool_node CACHE_ALIGN;
 void HStackInit(HStackStruct *stack_object_struct, uint32_t nthreads, uint32_t numa_nodes) {
     HSynchStructInit(&stack_object_struct->object_struct, nthreads, numa_nodes);
     stack_object_struct->top = NULL;
+    memset(&stack_object_struct->elim, 0, sizeof(SynchElimBuffer));
+    synchEventCountInit(&stack_object_struct->nonempty);
 }
 
 void HStackThreadStateInit(HStackStruct *object_struct, HStackThreadState *lobject_struct, int pid) {
@@ -20,33 +23,63 @@ inline RetVal serialPushPop(void *state, ArgVal arg, int pid) {
     if (arg == POP_OP) {
         volatile HStackStruct *st = (HStackStruct *)state;
         volatile Node *node = st->top;
+        RetVal ret;
 
-        if (st->top == NULL) {
-            return EMPTY_STACK;
-        } else {
-            RetVal ret = node->val;
+        if (synchElimPop((SynchElimBuffer *)&st->elim, &ret)) {                    // eliminated by a previous push
+            return ret;
+        } else if (st->top != NULL) {
+            ret = node->val;
             st->top = st->top->next;
             synchNonTSOFence();
             synchRecycleObj(&pool_node, (void *)node);
             return ret;
-        }
+        } else
+            return EMPTY_STACK;
     } else {
         HStackStruct *st = (HStackStruct *)state;
         Node *node;
+        ArgVal evicted;
+
+        if (synchElimPush(&st->elim, arg, &evicted)) {                              // the buffer is full, move its oldest element to a node
+            node = synchAllocObj(&pool_node);
+            node->next = st->top;
+            node->val = evicted;
+            st->top = node;
+            synchNonTSOFence();
+        }
 
-        node = synchAllocObj(&pool_node);
-        node->next = st->top;
-        node->val = arg;
-        st->top = node;
-        synchNonTSOFence();
         return PUSH_SUCCESS;
     }
 }
 
 void HStackPush(HStackStruct *object_struct, HStackThreadState *lobject_struct, ArgVal arg, int pid) {
     HSynchApplyOp(&object_struct->object_struct, &lobject_struct->th_state, serialPushPop, object_struct, (ArgVal)arg, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal HStackPop(HStackStruct *object_struct, HStackThreadState *lobject_struct, int pid) {
     return HSynchApplyOp(&object_struct->object_struct, &lobject_struct->th_state, serialPushPop, object_struct, (ArgVal)POP_OP, pid);
 }
+
+static RetVal HStackPopWait(HStackStruct *object_struct, HStackThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, HStackPop(object_struct, lobject_struct, pid), EMPTY_STACK, deadline);
+
+    return ret;
+}
+
+RetVal HStackPopBlocking(HStackStruct *object_struct, HStackThreadState *lobject_struct, int pid) {
+    return HStackPopWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal HStackPopTimed(HStackStruct *object_struct, HStackThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return HStackPopWait(object_struct, lobject_struct, &deadline, pid);
+}
+
+void HStackGetElimStats(HStackStruct *object_struct, SynchElimStats *stats) {
+    synchElimGetStats(&object_struct->elim, stats);
+}
@@ -7,70 +7,129 @@
 #    include <numa.h>
 #endif
 
-#define HSYNCH_HELP_FACTOR            10
 #define HSYNCH_DEFAULT_NUMA_NODE_SIZE 8
 
-static __thread int node_of_thread = 0;
-
 RetVal HSynchApplyOp(HSynchStruct *l, HSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
+    return HSynchApplyOpInline(l, st_thread, sfunc, state, arg, pid);
+}
+
+RetVal HSynchApplyBatchOp(HSynchStruct *l, HSynchThreadState *st_thread, void (*batch_sfunc)(void *, ArgVal *, RetVal *, uint32_t), void *state, ArgVal arg, int pid) {
     volatile HSynchNode *p;
     volatile HSynchNode *cur;
-    register HSynchNode *next_node, *tmp_next;
-    register int counter = 0;
-    int help_bound = HSYNCH_HELP_FACTOR * l->nthreads;
+    HSynchNode *next_node, *tmp_next;
+    uint32_t help_bound;
+    uint32_t i, n = 0;
+    int64_t start;
+    SynchParkWakeList wake_list;
 
     next_node = st_thread->next_node;
     next_node->next = NULL;
     next_node->locked = true;
     next_node->completed = false;
 
-    cur = (volatile HSynchNode *)synchSWAP(&l->Tail[node_of_thread].ptr, next_node);
+    cur = (volatile HSynchNode *)synchSWAP(&l->Tail[st_thread->node_of_thread].ptr, next_node);
     cur->arg_ret = arg;
     cur->pid = pid;
     cur->next = (HSynchNode *)next_node;
 
     st_thread->next_node = (HSynchNode *)cur;
 
-    while (cur->locked) // spinning
-        synchResched();
+    synchParkWait(&cur->locked); // spinning, then parking
 
-    p = cur;            // I am not been helped
     if (cur->completed) // I have been helped
         return cur->arg_ret;
+    // The combiners of the different NUMA nodes share batch_args and batch_rets, which are protected by the central lock
     CLHLock(l->central_lock, pid);
-#ifdef DEBUG
-    l->rounds++;
-#endif
-    while (counter < help_bound && p->next != NULL) {
+    help_bound = l->help.bound;
+    start = synchHelpBoundStart(&l->help);
+    for (p = cur; n < help_bound && p->next != NULL; p = p->next) {
         synchReadPrefetch(p->next);
-        counter++;
+        l->batch_args[n++] = p->arg_ret;
+    }
 #ifdef DEBUG
-        l->counter++;
+    l->rounds++;
+    l->counter += n;
 #endif
+    batch_sfunc(state, l->batch_args, l->batch_rets, n);
+    synchParkWakeListInit(&wake_list);
+    p = cur;
+    for (i = 0; i < n; i++) {
         tmp_next = p->next;
-        p->arg_ret = sfunc(state, p->arg_ret, p->pid);
+        p->arg_ret = l->batch_rets[i];
         synchNonTSOFence();
         p->completed = true;
         synchNonTSOFence();
-        p->locked = false;
+        synchParkUnlockDeferred(&p->locked, &wake_list);
         p = tmp_next;
-
-        // A full-memory barrier is inserted for performance optimization, with conditional behavior based on the processor type.
-        // This memory barrier is insert to enhance performance in a specific scenario. On non-Intel processors, applying this
-        // full-memory barrier can yield a slight performance improvement, when there are no remaining requests to be served.
-        // However, it's important to note that on Intel X86 machines, this barrier may actually degrade performance.
-        if (tmp_next->next == NULL && synchGetMachineModel() != INTEL_X86_MACHINE)
-            synchFullFence();
     }
-    p->locked = false; // Unlock the next one
+    synchHelpBoundEnd(&l->help, start, n);
+    synchParkUnlock(&p->locked); // Unlock the next one
     CLHUnlock(l->central_lock, pid);
+    synchParkWakeAll(&wake_list);
 
     return cur->arg_ret;
 }
 
+// Polls the ticket of a request of HSynchSubmitOp (see synchTicketPoll)
+static bool HSynchPollTicket(SynchTicket *ticket) {
+    volatile HSynchNode *cur = ticket->node;
+
+    if (cur->locked != false)
+        return false;
+    if (!cur->completed) // I am the combiner of my Numa node
+        HSynchCombineInline(ticket->object, cur, ticket->sfunc, ticket->state, ticket->pid);
+    ticket->ret = cur->arg_ret;
+
+    return true;
+}
+
+void HSynchSubmitOp(HSynchStruct *l, HSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid, SynchTicket *ticket) {
+    volatile HSynchNode *cur;
+    HSynchNode *next_node;
+
+    next_node = st_thread->next_node;
+    next_node->next = NULL;
+    next_node->locked = true;
+    next_node->completed = false;
+
+    cur = (volatile HSynchNode *)synchSWAP(&l->Tail[st_thread->node_of_thread].ptr, next_node);
+    cur->arg_ret = arg;
+    cur->pid = pid;
+    cur->next = (HSynchNode *)next_node;
+
+    st_thread->next_node = (HSynchNode *)cur;
+
+    ticket->object = l;
+    ticket->node = cur;
+    ticket->locked = &cur->locked;
+    ticket->sfunc = sfunc;
+    ticket->state = state;
+    ticket->pid = pid;
+    ticket->poll = HSynchPollTicket;
+    ticket->done = false;
+    synchTicketPoll(ticket, NULL); // in case that I am the combiner, the round is executed at once
+}
+
+void HSynchStructSetHelpPolicy(HSynchStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound) {
+    synchHelpBoundSetPolicy(&l->help, target_ns, min_bound, max_bound);
+    if (l->help.max_bound > l->batch_capacity) { // the batches of HSynchApplyBatchOp may become larger
+        synchFreeMemory(l->batch_args, l->batch_capacity * sizeof(ArgVal));
+        synchFreeMemory(l->batch_rets, l->batch_capacity * sizeof(RetVal));
+        l->batch_capacity = l->help.max_bound;
+        l->batch_args = synchGetMemory(l->batch_capacity * sizeof(ArgVal));
+        l->batch_rets = synchGetMemory(l->batch_capacity * sizeof(RetVal));
+    }
+    synchFullFence();
+}
+
+void HSynchGetHelpStats(HSynchStruct *l, SynchHelpBound *stats) {
+    *stats = l->help;
+}
+
 void HSynchThreadStateInit(HSynchStruct *l, HSynchThreadState *st_thread, int pid) {
     HSynchNode *last_node = NULL;
     uint32_t node_index = 0;
+    int node_of_thread = 0;
 
 #ifdef SYNCH_NUMA_SUPPORT
     if (l->numa_policy) {
@@ -113,6 +172,7 @@ void HSynchThreadStateInit(HSynchStruct *l, HSynchThreadState *st_thread, int pi
     synchCASPTR(&l->Tail[node_of_thread].ptr, NULL, last_node);
     node_index = synchFAA32(&l->node_indexes[node_of_thread], 1);
     st_thread->next_node = l->nodes[node_of_thread] + node_index;
+    st_thread->node_of_thread = node_of_thread;
 #ifdef DEBUG
     fprintf(stderr, "DEBUG: thread_id: %d -- running_core: %d -- running_node: %d -- hsynch_node: %d\n",
             pid, synchGetPreferredCore(), synchGetPreferredNumaNode(), node_of_thread);
@@ -125,6 +185,10 @@ void HSynchStructInit(HSynchStruct *l, uint32_t nthreads, uint32_t numa_regions)
     if (numa_regions > nthreads)
         numa_regions = nthreads;
     l->nthreads = nthreads;
+    synchHelpBoundInit(&l->help, HSYNCH_HELP_FACTOR * nthreads);
+    l->batch_capacity = l->help.max_bound;
+    l->batch_args = synchGetMemory(l->batch_capacity * sizeof(ArgVal));                // unlike synchGetAlignedMemory, it pairs with synchFreeMemory
+    l->batch_rets = synchGetMemory(l->batch_capacity * sizeof(RetVal));
     if (numa_regions == HSYNCH_DEFAULT_NUMA_POLICY) {
         // Whenever numa_regions is equal to HSYNCH_DEFAULT_NUMA_POLICY, the user uses
         // the default number of NUMA nodes, which is equal to the number of NUMA nodes
@@ -41,6 +41,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <primitives.h>
+#include <threadtools.h>
 #include <lcrq.h>
 
 inline static int is_empty(uint64_t v) __attribute__ ((pure));
@@ -51,7 +52,10 @@ inline static uint64_t tail_index(uint64_t t) __attribute__ ((pure));
 inline static int crq_is_closed(uint64_t t) __attribute__ ((pure));
 inline static void fix_state(RingQueue *rq);
 
-#ifdef DEBUG
+inline static void count_opened_crq(LCRQThreadState *thread_state) {
+    thread_state->myopens++;
+}
+
 inline static void count_closed_crq(LCRQThreadState *thread_state) {
     thread_state->mycloses++;
 }
@@ -59,17 +63,15 @@ inline static void count_closed_crq(LCRQThreadState *thread_state) {
 inline static void count_unsafe_node(LCRQThreadState *thread_state) {
     thread_state->myunsafes++;
 }
-#else
-inline static void count_closed_crq(LCRQThreadState *thread_state) {
-}
-inline static void count_unsafe_node(LCRQThreadState *thread_state) {
+
+inline static void count_recycled_crq(LCRQThreadState *thread_state) {
+    thread_state->myrecycles++;
 }
-#endif
 
-inline static void init_ring(RingQueue *r) {
-    int i;
+inline static void init_ring(LCRQStruct *queue, RingQueue *r) {
+    uint64_t i;
 
-    for (i = 0; i < RING_SIZE; i++) {
+    for (i = 0; i < queue->ring_size; i++) {
         r->array[i].val = -1;
         r->array[i].idx = i;
     }
@@ -124,17 +126,199 @@ inline static int close_crq(RingQueue *rq, const uint64_t t, const int tries) {
         return synchBitTAS64(&rq->tail, 63);
 }
 
-void LCRQInit(LCRQStruct *queue, uint32_t nthreads UNUSED_ARG) {
-    RingQueue *rq = synchGetMemory(sizeof(RingQueue));
-    init_ring(rq);
-    queue->head = queue->tail = rq;
+// Tries to store arg to the cell of rq that corresponds to index t; it fails in case that
+// the cell is occupied or a dequeuer has already marked it for index t.
+inline static int enqueue_cell(LCRQStruct *queue, RingQueue *rq, uint64_t t, ArgVal arg) {
+    RingNode *cell = &rq->array[t & (queue->ring_size - 1)];
+    synchStorePrefetch(cell);
+
+    uint64_t idx = cell->idx;
+    uint64_t val = cell->val;
+
+    if (synchLikely(is_empty(val))) {
+        if (synchLikely(node_index(idx) <= t)) {
+            if ((synchLikely(!node_unsafe(idx)) || rq->head < t) && synchCAS128((uint64_t *)cell, -1, idx, arg, t))
+                return true;
+        }
+    }
+    return false;
+}
+
+// Tries to remove the element with index h from the corresponding cell of rq and stores its value to ret.
+// In case that it fails, the cell is marked so that no enqueuer is able to store an element with index h to it.
+inline static int dequeue_cell(LCRQStruct *queue, LCRQThreadState *thread_state, RingQueue *rq, uint64_t h, uint64_t *ret) {
+    RingNode *cell = &rq->array[h & (queue->ring_size - 1)];
+    synchStorePrefetch(cell);
+
+    uint64_t tt = 0;
+    int r = 0;
+
+    while (true) {
+        uint64_t cell_idx = cell->idx;
+        uint64_t unsafe = node_unsafe(cell_idx);
+        uint64_t idx = node_index(cell_idx);
+        uint64_t val = cell->val;
+
+        if (synchUnlikely(idx > h)) return false;
+
+        if (synchLikely(!is_empty(val))) {
+            if (synchLikely(idx == h)) {
+                if (synchCAS128((uint64_t *)cell, val, cell_idx, -1, (unsafe | h) + queue->ring_size)) {
+                    *ret = val;
+                    return true;
+                }
+            } else {
+                if (synchCAS128((uint64_t *)cell, val, cell_idx, val, set_unsafe(idx))) {
+                    count_unsafe_node(thread_state);
+                    return false;
+                }
+            }
+        } else {
+            if ((r & ((1ull << 10) - 1)) == 0)
+                tt = rq->tail;
+
+            // Optimization: try to bail quickly if queue is closed.
+            int crq_closed = crq_is_closed(tt);
+            uint64_t t = tail_index(tt);
+
+            if (synchUnlikely(unsafe)) {  // Nothing to do, move along
+                if (synchCAS128((uint64_t *)cell, val, cell_idx, val, (unsafe | h) + queue->ring_size)) return false;
+            } else if (t < h + 1 || r > 200000 || crq_closed) {
+                if (synchCAS128((uint64_t *)cell, val, idx, val, h + queue->ring_size)) {
+                    if (r > 200000 && tt > queue->ring_size) {
+                        synchBitTAS64(&rq->tail, 63);
+                        count_closed_crq(thread_state);
+                    }
+                    return false;
+                }
+            } else {
+                ++r;
+            }
+        }
+    }
+}
+
+#ifdef HAVE_HPTRS
+static void free_list_push(LCRQStruct *queue, RingQueue *rq) {
+    while (true) {
+        uint64_t tag = queue->free_rings.tag;
+        RingQueue *top = queue->free_rings.top;
+
+        rq->next = top;
+        if (synchCAS128(&queue->free_rings, top, tag, rq, tag + 1)) return;
+        synchResched();
+    }
+}
+
+static RingQueue *free_list_pop(LCRQStruct *queue) {
+    while (true) {
+        uint64_t tag = queue->free_rings.tag;
+        RingQueue *top = queue->free_rings.top;
+
+        if (top == NULL) return NULL;
+        // top may have been popped and reused, in which case the tag has been increased and the CAS fails
+        if (synchCAS128(&queue->free_rings, top, tag, top->next, tag + 1)) return top;
+        synchResched();
+    }
+}
+
+static int is_hazardous(LCRQStruct *queue, RingQueue *rq) {
+    uint32_t i;
+
+    for (i = 0; i < queue->nthreads; i++) {
+        if (queue->hazardptrs[i].ptr == rq) return true;
+    }
+    return false;
+}
+
+// Only the dequeuer that moves queue->head past a ring retires it, thus each ring is retired once.
+// At most nthreads rings are protected at a time, so at most nthreads rings are kept in the retired list.
+static void retire_crq(LCRQStruct *queue, LCRQThreadState *thread_state, RingQueue *rq) {
+    uint32_t i, kept = 0;
+
+    thread_state->retired[thread_state->retired_size++] = rq;
+    synchFullFence();
+    for (i = 0; i < thread_state->retired_size; i++) {
+        RingQueue *r = thread_state->retired[i];
+
+        if (is_hazardous(queue, r)) {
+            thread_state->retired[kept++] = r;
+        } else {
+            free_list_push(queue, r);
+            count_recycled_crq(thread_state);
+        }
+    }
+    thread_state->retired_size = kept;
 }
+#endif
+
+// The ring is placed on the NUMA node of the calling thread, since this thread is going to initialize it
+// and to enqueue its first element; a recycled ring that lies on a different node is migrated.
+static RingQueue *alloc_crq(LCRQStruct *queue) {
+    int32_t node = synchGetPreferredNumaNode();
+    RingQueue *rq = NULL;
 
-void LCRQThreadStateInit(LCRQThreadState *thread_state, int pid UNUSED_ARG) {
+#ifdef HAVE_HPTRS
+    rq = free_list_pop(queue);
+#endif
+    if (rq == NULL) {
+        rq = synchGetMemoryOnNumaNode(queue->ring_bytes, node);
+        rq->numa_node = node;
+    } else if (rq->numa_node != node) {
+        synchMoveMemoryToNumaNode(rq, queue->ring_bytes, node);
+        rq->numa_node = node;
+    }
+    init_ring(queue, rq);
+
+    return rq;
+}
+
+void LCRQInit(LCRQStruct *queue, uint32_t nthreads, uint32_t ring_pow) {
+    if (ring_pow == 0) ring_pow = RING_POW;
+    if (ring_pow > RING_POW_MAX) ring_pow = RING_POW_MAX;
+    queue->ring_size = 1ULL << ring_pow;
+    queue->ring_bytes = sizeof(RingQueue) + queue->ring_size * sizeof(RingNode);
+#ifdef HAVE_HPTRS
+    uint32_t i;
+
+    queue->free_rings.top = NULL;
+    queue->free_rings.tag = 0;
+    queue->nthreads = nthreads;
+    queue->hazardptrs = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(LCRQHazardSlot));
+    for (i = 0; i < nthreads; i++)
+        queue->hazardptrs[i].ptr = NULL;
+#endif
+    queue->opens = 0;
+    queue->closes = 0;
+    queue->unsafes = 0;
+    queue->recycles = 0;
+    queue->head = queue->tail = alloc_crq(queue);
+    synchEventCountInit(&queue->nonempty);
+    synchFullFence();
+}
+
+void LCRQThreadStateInit(LCRQStruct *queue UNUSED_ARG, LCRQThreadState *thread_state, int pid UNUSED_ARG) {
     thread_state->nrq = NULL;
 #ifdef HAVE_HPTRS
-    thread_state->hazardptr = NULL;
+    thread_state->hazardptr = &queue->hazardptrs[pid];
+    thread_state->retired = synchGetMemory((queue->nthreads + 1) * sizeof(RingQueue *));
+    thread_state->retired_size = 0;
 #endif
+    thread_state->myopens = 0;
+    thread_state->mycloses = 0;
+    thread_state->myunsafes = 0;
+    thread_state->myrecycles = 0;
+}
+
+void LCRQCollectStats(LCRQStruct *queue, LCRQThreadState *thread_state) {
+    synchFAA64(&queue->opens, thread_state->myopens);
+    synchFAA64(&queue->closes, thread_state->mycloses);
+    synchFAA64(&queue->unsafes, thread_state->myunsafes);
+    synchFAA64(&queue->recycles, thread_state->myrecycles);
+    thread_state->myopens = 0;
+    thread_state->mycloses = 0;
+    thread_state->myunsafes = 0;
+    thread_state->myrecycles = 0;
 }
 
 void LCRQEnqueue(LCRQStruct *queue, LCRQThreadState *thread_state, ArgVal arg, int pid UNUSED_ARG) {
@@ -144,7 +328,7 @@ void LCRQEnqueue(LCRQStruct *queue, LCRQThreadState *thread_state, ArgVal arg, i
         RingQueue *rq = queue->tail;
 
 #ifdef HAVE_HPTRS
-        synchSWAP(&thread_state->hazardptr, rq);
+        synchSWAP(&thread_state->hazardptr->ptr, rq);
         if (synchUnlikely(queue->tail != rq)) continue;
 #endif
 
@@ -160,8 +344,7 @@ void LCRQEnqueue(LCRQStruct *queue, LCRQThreadState *thread_state, ArgVal arg, i
         if (crq_is_closed(t)) {
 alloc:
             if (thread_state->nrq == NULL) {
-                thread_state->nrq = synchGetMemory(sizeof(RingQueue));
-                init_ring(thread_state->nrq);
+                thread_state->nrq = alloc_crq(queue);
             }
 
             // Solo enqueue
@@ -170,28 +353,27 @@ alloc:
             if (synchCASPTR(&rq->next, NULL, thread_state->nrq)) {
                 synchCASPTR(&queue->tail, rq, thread_state->nrq);
                 thread_state->nrq = NULL;
+                count_opened_crq(thread_state);
+#ifdef HAVE_HPTRS
+                thread_state->hazardptr->ptr = NULL;
+#endif
+                synchEventCountNotifyAfterRMW(&queue->nonempty);
                 return;
             }
             continue;
         }
 
-        RingNode *cell = &rq->array[t & (RING_SIZE - 1)];
-        synchStorePrefetch(cell);
-
-        uint64_t idx = cell->idx;
-        uint64_t val = cell->val;
-
-        if (synchLikely(is_empty(val))) {
-            if (synchLikely(node_index(idx) <= t)) {
-                if ((synchLikely(!node_unsafe(idx)) || rq->head < t) && synchCAS128((uint64_t *)cell, -1, idx, arg, t)) {
-                    return;
-                }
-            }
+        if (enqueue_cell(queue, rq, t, arg)) {
+#ifdef HAVE_HPTRS
+            thread_state->hazardptr->ptr = NULL;
+#endif
+            synchEventCountNotifyAfterRMW(&queue->nonempty);
+            return;
         }
 
         uint64_t h = rq->head;
 
-        if (synchUnlikely((int64_t)(t - h) >= (int64_t)RING_SIZE) && close_crq(rq, t, ++try_close)) {
+        if (synchUnlikely((int64_t)(t - h) >= (int64_t)queue->ring_size) && close_crq(rq, t, ++try_close)) {
             count_closed_crq(thread_state);
             goto alloc;
         }
@@ -204,63 +386,154 @@ RetVal LCRQDequeue(LCRQStruct *queue, LCRQThreadState *thread_state, int pid UNU
         RingQueue *next;
 
 #ifdef HAVE_HPTRS
-        synchSWAP(&thread_state->hazardptr, rq);
-        if (synchUnlikely(head != rq)) continue;
+        synchSWAP(&thread_state->hazardptr->ptr, rq);
+        if (synchUnlikely(queue->head != rq)) continue;
 #endif
 
         uint64_t h = synchFAA64(&rq->head, 1);
 
-        RingNode *cell = &rq->array[h & (RING_SIZE - 1)];
-        synchStorePrefetch(cell);
+        uint64_t val;
 
-        uint64_t tt = 0;
-        int r = 0;
+        if (dequeue_cell(queue, thread_state, rq, h, &val)) {
+#ifdef HAVE_HPTRS
+            thread_state->hazardptr->ptr = NULL;
+#endif
+            return val;
+        }
 
-        while (true) {
-            uint64_t cell_idx = cell->idx;
-            uint64_t unsafe = node_unsafe(cell_idx);
-            uint64_t idx = node_index(cell_idx);
-            uint64_t val = cell->val;
+        if (tail_index(rq->tail) <= h + 1) {
+            fix_state(rq);
+            // try to return empty
+            next = rq->next;
+            if (next == NULL) {
+#ifdef HAVE_HPTRS
+                thread_state->hazardptr->ptr = NULL;
+#endif
+                return EMPTY_QUEUE;  // EMPTY
+            }
+            if (tail_index(rq->tail) <= h + 1) {
+#ifdef HAVE_HPTRS
+                // queue->tail should not point to a retired ring
+                if (queue->tail == rq) synchCASPTR(&queue->tail, rq, next);
+                if (synchCASPTR(&queue->head, rq, next)) retire_crq(queue, thread_state, rq);
+#else
+                synchCASPTR(&queue->head, rq, next);
+#endif
+            }
+        }
+    }
+}
 
-            if (synchUnlikely(idx > h)) break;
+void LCRQEnqueueBatch(LCRQStruct *queue, LCRQThreadState *thread_state, ArgVal *values, uint32_t n, int pid) {
+    uint32_t i = 0;
 
-            if (synchLikely(!is_empty(val))) {
-                if (synchLikely(idx == h)) {
-                    if (synchCAS128((uint64_t *)cell, val, cell_idx, -1, (unsafe | h) + RING_SIZE)) return val;
-                } else {
-                    if (synchCAS128((uint64_t *)cell, val, cell_idx, val, set_unsafe(idx))) {
-                        count_unsafe_node(thread_state);
-                        break;
-                    }
-                }
-            } else {
-                if ((r & ((1ull << 10) - 1)) == 0)
-                    tt = rq->tail;
-
-                // Optimization: try to bail quickly if queue is closed.
-                int crq_closed = crq_is_closed(tt);
-                uint64_t t = tail_index(tt);
-
-                if (synchUnlikely(unsafe)) {  // Nothing to do, move along
-                    if (synchCAS128((uint64_t *)cell, val, cell_idx, val, (unsafe | h) + RING_SIZE)) break;
-                } else if (t < h + 1 || r > 200000 || crq_closed) {
-                    if (synchCAS128((uint64_t *)cell, val, idx, val, h + RING_SIZE)) {
-                        if (r > 200000 && tt > RING_SIZE) synchBitTAS64(&rq->tail, 63);
-                        break;
-                    }
-                } else {
-                    ++r;
+    while (i < n) {
+        RingQueue *rq = queue->tail;
+
+#ifdef HAVE_HPTRS
+        synchSWAP(&thread_state->hazardptr->ptr, rq);
+        if (synchUnlikely(queue->tail != rq)) continue;
+#endif
+
+        RingQueue *next = rq->next;
+
+        if (synchUnlikely(next != NULL)) {
+            synchCASPTR(&queue->tail, rq, next);
+            continue;
+        }
+
+        uint64_t k = (n - i < queue->ring_size) ? n - i : queue->ring_size;
+        uint64_t t = synchFAA64(&rq->tail, k);
+        uint64_t j;
+        bool full = false;
+
+        // The ring is closed; the remaining elements are enqueued one by one, which appends a new ring.
+        if (crq_is_closed(t)) break;
+
+        // Each reserved cell is used, so no dequeuer waits for an index that is never filled. In case that a cell
+        // fails, values[i] is tried at the next reserved cell; FIFO order is preserved, since indices only grow.
+        for (j = 0; j < k; j++) {
+            if (enqueue_cell(queue, rq, t + j, values[i])) {
+                i++;
+            } else if ((int64_t)(t + j - rq->head) >= (int64_t)queue->ring_size) {
+                // The ring is full; it is closed, so the dequeuers of the rest of the reserved cells do not wait for
+                // them, and the remaining elements are enqueued one by one, which appends a new ring.
+                if (!crq_is_closed(rq->tail)) {
+                    synchBitTAS64(&rq->tail, 63);
+                    count_closed_crq(thread_state);
                 }
+                full = true;
+                break;
             }
         }
+        if (full) break;
+    }
+#ifdef HAVE_HPTRS
+    thread_state->hazardptr->ptr = NULL;
+#endif
+    for (; i < n; i++)
+        LCRQEnqueue(queue, thread_state, values[i], pid);
+    synchEventCountNotifyAfterRMW(&queue->nonempty);
+}
 
-        if (tail_index(rq->tail) <= h + 1) {
+uint32_t LCRQDequeueBatch(LCRQStruct *queue, LCRQThreadState *thread_state, RetVal *out, uint32_t max, int pid UNUSED_ARG) {
+    uint32_t count = 0;
+
+    while (count < max) {
+        RingQueue *rq = queue->head;
+        RingQueue *next;
+
+#ifdef HAVE_HPTRS
+        synchSWAP(&thread_state->hazardptr->ptr, rq);
+        if (synchUnlikely(queue->head != rq)) continue;
+#endif
+
+        uint64_t k = (max - count < queue->ring_size) ? max - count : queue->ring_size;
+        uint64_t h = synchFAA64(&rq->head, k);
+        uint64_t last = h + k - 1;
+        uint64_t val;
+
+        for (; h <= last; h++) {
+            if (dequeue_cell(queue, thread_state, rq, h, &val)) out[count++] = val;
+        }
+
+        if (tail_index(rq->tail) <= last + 1) {
             fix_state(rq);
-            // try to return empty
             next = rq->next;
-            if (next == NULL)
-                return EMPTY_QUEUE;  // EMPTY
-            if (tail_index(rq->tail) <= h + 1) synchCASPTR(&queue->head, rq, next);
+            if (next == NULL) break;  // EMPTY
+            if (tail_index(rq->tail) <= last + 1) {
+#ifdef HAVE_HPTRS
+                // queue->tail should not point to a retired ring
+                if (queue->tail == rq) synchCASPTR(&queue->tail, rq, next);
+                if (synchCASPTR(&queue->head, rq, next)) retire_crq(queue, thread_state, rq);
+#else
+                synchCASPTR(&queue->head, rq, next);
+#endif
+            }
         }
     }
+#ifdef HAVE_HPTRS
+    thread_state->hazardptr->ptr = NULL;
+#endif
+
+    return count;
+}
+
+static RetVal LCRQDequeueWait(LCRQStruct *queue, LCRQThreadState *thread_state, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&queue->nonempty, ret, LCRQDequeue(queue, thread_state, pid), EMPTY_QUEUE, deadline);
+
+    return ret;
+}
+
+RetVal LCRQDequeueBlocking(LCRQStruct *queue, LCRQThreadState *thread_state, int pid) {
+    return LCRQDequeueWait(queue, thread_state, NULL, pid);
+}
+
+RetVal LCRQDequeueTimed(LCRQStruct *queue, LCRQThreadState *thread_state, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return LCRQDequeueWait(queue, thread_state, &deadline, pid);
 }
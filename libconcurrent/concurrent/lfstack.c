@@ -1,40 +1,73 @@
 #include <lfstack.h>
 
-inline void LFStackInit(LFStackStruct *l) {
+inline void LFStackInit(LFStackStruct *l, uint32_t nthreads) {
     l->top = NULL;
+    synchEBRInit(&l->ebr, nthreads);
+    synchEventCountInit(&l->nonempty);
     synchFullFence();
 }
 
-inline void LFStackThreadStateInit(LFStackThreadState *th_state, int min_back, int max_back) {
+inline void LFStackThreadStateInit(LFStackStruct *l, LFStackThreadState *th_state, int min_back, int max_back, int pid) {
     synchInitBackoff(&th_state->backoff, min_back, max_back, 1);
-    synchInitPool(&th_state->pool, sizeof(Node));
+    synchInitPool(&th_state->pool, sizeof(SynchOwnedNode));
+    synchEBRThreadStateInit(&l->ebr, &th_state->ebr, &th_state->pool, pid);
 }
 
 inline void LFStackPush(LFStackStruct *l, LFStackThreadState *th_state, ArgVal arg) {
-    Node *n;
+    SynchOwnedNode *n;
 
-    n = synchAllocObj(&th_state->pool);
+    n = synchEBRAlloc(&th_state->ebr);
     synchResetBackoff(&th_state->backoff);
-    n->val = arg;
+    n->node.val = arg;
+    n->owner = th_state->ebr.pid;
     do {
         Node *old_top = (Node *)l->top; // top is volatile
-        n->next = old_top;
-        if (synchCASPTR(&l->top, old_top, n) == true)
+        n->node.next = old_top;
+        if (synchCASPTR(&l->top, old_top, &n->node) == true)
             break;
         else
             synchBackoffDelay(&th_state->backoff);
     } while (true);
+    synchEventCountNotifyAfterRMW(&l->nonempty);
 }
 
 inline RetVal LFStackPop(LFStackStruct *l, LFStackThreadState *th_state) {
+    RetVal ret;
+
     synchResetBackoff(&th_state->backoff);
+    // old_top could not be recycled (and pushed again) before this thread exits, thus the CAS does not suffer from ABA
+    synchEBREnter(&l->ebr, &th_state->ebr);
     do {
         Node *old_top = (Node *)l->top;
-        if (old_top == NULL)
+        if (old_top == NULL) {
+            synchEBRExit(&l->ebr, &th_state->ebr);
             return EMPTY_STACK;
-        if (synchCASPTR(&l->top, old_top, old_top->next))
-            return old_top->val;
-        else
+        }
+        if (synchCASPTR(&l->top, old_top, old_top->next)) {
+            ret = old_top->val;
+            synchEBRExit(&l->ebr, &th_state->ebr);
+            synchEBRRetire(&l->ebr, &th_state->ebr, old_top, ((SynchOwnedNode *)old_top)->owner);
+            return ret;
+        } else
             synchBackoffDelay(&th_state->backoff);
     } while (true);
 }
+
+static RetVal LFStackPopWait(LFStackStruct *l, LFStackThreadState *th_state, const struct timespec *deadline) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&l->nonempty, ret, LFStackPop(l, th_state), EMPTY_STACK, deadline);
+
+    return ret;
+}
+
+RetVal LFStackPopBlocking(LFStackStruct *l, LFStackThreadState *th_state) {
+    return LFStackPopWait(l, th_state, NULL);
+}
+
+RetVal LFStackPopTimed(LFStackStruct *l, LFStackThreadState *th_state, uint64_t timeout_ns) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return LFStackPopWait(l, th_state, &deadline);
+}
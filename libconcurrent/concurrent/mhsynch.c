@@ -0,0 +1,163 @@
+#include <stdio.h>
+
+#include <mhsynch.h>
+#include <threadtools.h>
+
+// Announces a node to the list of the thread at the given level and returns it
+static inline volatile MHSynchNode *MHSynchAnnounce(MHSynchThreadState *st_thread, uint32_t level, ArgVal arg, volatile MHSynchNode *batch,
+                                                    uint32_t batch_size, uint32_t requests, int pid) {
+    volatile MHSynchNode *cur;
+    MHSynchNode *next_node;
+
+    next_node = st_thread->next_node[level];
+    next_node->next = NULL;
+    next_node->locked = true;
+    next_node->completed = false;
+
+    cur = (volatile MHSynchNode *)synchSWAP(&st_thread->tail[level]->ptr, next_node);
+    cur->arg_ret = arg;
+    cur->batch = (MHSynchNode *)batch;
+    cur->batch_size = batch_size;
+    cur->requests = requests;
+    cur->pid = pid;
+    synchNonTSOFence();
+    cur->next = next_node;
+
+    st_thread->next_node[level] = (MHSynchNode *)cur;
+
+    return cur;
+}
+
+// Applies the requests of size nodes of the given level, starting from node p. The requests of the batch of each node
+// are applied before the node is unlocked, thus the owner of a node never reuses a node of its batch too early.
+// The parked owners are stored to wl and they are woken up after the round.
+static void MHSynchApplyBatch(volatile MHSynchNode *p, uint32_t size, uint32_t level, RetVal (*sfunc)(void *, ArgVal, int), void *state,
+                              SynchParkWakeList *wl) {
+    volatile MHSynchNode *tmp_next;
+    uint32_t i;
+
+    for (i = 0; i < size; i++) {
+        tmp_next = p->next;
+        if (level == 0) {
+            synchReadPrefetch(tmp_next);
+            p->arg_ret = sfunc(state, p->arg_ret, p->pid);
+        } else {
+            MHSynchApplyBatch(p->batch, p->batch_size, level - 1, sfunc, state, wl);
+        }
+        synchNonTSOFence();
+        p->completed = true;
+        synchNonTSOFence();
+        synchParkUnlockDeferred(&p->locked, wl);
+        p = tmp_next;
+    }
+}
+
+RetVal MHSynchApplyOp(MHSynchStruct *l, MHSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
+    volatile MHSynchNode *cur[MHSYNCH_MAX_LEVELS];  // the node of the thread at each level
+    volatile MHSynchNode *succ[MHSYNCH_MAX_LEVELS]; // the first node that is not combined at each level
+    volatile MHSynchNode *p, *batch = NULL;
+    uint32_t batch_size = 0, requests = 1, help_bound;
+    int level, j;
+    int64_t start;
+    SynchParkWakeList wake_list;
+
+    for (level = 0; level < st_thread->nlevels; level++) {
+        cur[level] = MHSynchAnnounce(st_thread, level, arg, batch, batch_size, requests, pid);
+        synchParkWait(&cur[level]->locked); // spinning, then parking
+        if (cur[level]->completed) {        // the batch has been applied by a combiner of an upper level
+            for (j = level - 1; j >= 0; j--)
+                synchParkUnlock(&succ[j]->locked);
+            return cur[0]->arg_ret;
+        }
+
+        // I am the combiner of this list; collect a batch and announce it to the next level
+        help_bound = l->help.bound;
+        batch_size = 0;
+        requests = 0;
+        for (p = cur[level]; p->next != NULL && (batch_size == 0 || requests + p->requests <= help_bound); p = p->next) {
+            synchReadPrefetch(p->next);
+            requests += p->requests;
+            batch_size++;
+        }
+        succ[level] = p;
+        batch = cur[level];
+    }
+
+    // I am the combiner of the top-level list
+    synchParkWakeListInit(&wake_list);
+    start = synchHelpBoundStart(&l->help);
+    MHSynchApplyBatch(batch, batch_size, st_thread->nlevels - 1, sfunc, state, &wake_list);
+    synchHelpBoundEnd(&l->help, start, requests);
+#ifdef DEBUG
+    l->rounds++;
+    l->counter += requests;
+#endif
+    for (j = st_thread->nlevels - 1; j >= 0; j--) // Unlock the next combiner of each level
+        synchParkUnlock(&succ[j]->locked);
+    synchParkWakeAll(&wake_list);
+
+    return cur[0]->arg_ret;
+}
+
+void MHSynchStructSetHelpPolicy(MHSynchStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound) {
+    synchHelpBoundSetPolicy(&l->help, target_ns, min_bound, max_bound);
+}
+
+void MHSynchGetHelpStats(MHSynchStruct *l, SynchHelpBound *stats) {
+    *stats = l->help;
+}
+
+void MHSynchThreadStateInit(MHSynchStruct *l, MHSynchThreadState *st_thread, int pid) {
+    MHSynchNode *nodes = synchGetAlignedMemory(CACHE_LINE_SIZE, l->nlevels * sizeof(MHSynchNode));
+    uint32_t level, cpu;
+
+    cpu = (l->topology.detected) ? synchGetPreferredCore() : pid;
+    cpu %= l->topology.ncpus;
+    for (level = 0; level < l->nlevels; level++) {
+        uint32_t domain = (level < l->topology.nlevels) ? synchTopologyDomainOf(&l->topology, level, cpu) : 0;
+
+        st_thread->next_node[level] = &nodes[level];
+        st_thread->tail[level] = &l->tails[l->offsets[level] + domain];
+    }
+    st_thread->nlevels = l->nlevels;
+#ifdef DEBUG
+    fprintf(stderr, "DEBUG: thread_id: %d -- running_core: %d -- mhsynch_cpu: %u -- mhsynch_domain:", pid, synchGetPreferredCore(), cpu);
+    for (level = 0; level < l->topology.nlevels; level++)
+        fprintf(stderr, " %u", synchTopologyDomainOf(&l->topology, level, cpu));
+    fprintf(stderr, "\n");
+#endif
+}
+
+void MHSynchStructInit(MHSynchStruct *l, uint32_t nthreads, const SynchTopology *topology) {
+    MHSynchNode *dummies;
+    uint32_t i, level, ntails = 1;
+
+    if (topology != NULL)
+        synchTopologyCopy(&l->topology, topology);
+    else
+        synchTopologyInit(&l->topology);
+    if (l->topology.ncpus == 0)
+        l->topology.ncpus = 1;
+    l->nlevels = l->topology.nlevels + 1;
+    for (level = 0; level < l->topology.nlevels; level++) {
+        l->offsets[level] = ntails - 1;
+        ntails += l->topology.ndomains[level];
+    }
+    l->offsets[l->topology.nlevels] = ntails - 1;
+    l->nthreads = nthreads;
+    synchHelpBoundInit(&l->help, MHSYNCH_HELP_FACTOR * nthreads);
+
+    l->tails = synchGetAlignedMemory(CACHE_LINE_SIZE, ntails * sizeof(MHSynchNodePtr));
+    dummies = synchGetAlignedMemory(CACHE_LINE_SIZE, ntails * sizeof(MHSynchNode));
+    for (i = 0; i < ntails; i++) {
+        dummies[i].next = NULL;
+        dummies[i].locked = false;
+        dummies[i].completed = false;
+        l->tails[i].ptr = &dummies[i];
+    }
+#ifdef DEBUG
+    l->rounds = l->counter = 0;
+    synchTopologyPrint(&l->topology);
+#endif
+    synchStoreFence();
+}
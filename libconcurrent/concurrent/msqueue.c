@@ -1,41 +1,49 @@
 #include <msqueue.h>
 
-void MSQueueInit(MSQueueStruct *l) {
-    Node *p = synchGetMemory(sizeof(Node));
+void MSQueueInit(MSQueueStruct *l, uint32_t nthreads) {
+    SynchOwnedNode *p = synchGetMemory(sizeof(SynchOwnedNode));
 
-    p->next = NULL;
-    l->head = p;
-    l->tail = p;
+    p->node.next = NULL;
+    p->owner = 0;                                                                       // the first dummy node is recycled to the pool of thread 0
+    l->head = &p->node;
+    l->tail = &p->node;
+    synchEBRInit(&l->ebr, nthreads);
+    synchEventCountInit(&l->nonempty);
     synchFullFence();
 }
 
-void MSQueueThreadStateInit(MSQueueThreadState *th_state, int min_back, int max_back) {
+void MSQueueThreadStateInit(MSQueueStruct *l, MSQueueThreadState *th_state, int min_back, int max_back, int pid) {
     synchInitBackoff(&th_state->backoff, min_back, max_back, 1);
-    synchInitPool(&th_state->pool, sizeof(Node));
+    synchInitPool(&th_state->pool, sizeof(SynchOwnedNode));
+    synchEBRThreadStateInit(&l->ebr, &th_state->ebr, &th_state->pool, pid);
 }
 
 void MSQueueEnqueue(MSQueueStruct *l, MSQueueThreadState *th_state, ArgVal arg) {
-    Node *p;
+    SynchOwnedNode *p;
     Node *next, *last;
 
-    p = synchAllocObj(&th_state->pool);
-    p->val = arg;
-    p->next = NULL;
+    p = synchEBRAlloc(&th_state->ebr);
+    p->node.val = arg;
+    p->node.next = NULL;
+    p->owner = th_state->ebr.pid;
     synchResetBackoff(&th_state->backoff);
+    synchEBREnter(&l->ebr, &th_state->ebr);
     while (true) {
         last = (Node *)l->tail;
         next = (Node *)last->next;
         if (last == l->tail) {
             if (next == NULL) {
                 synchResetBackoff(&th_state->backoff);
-                if (synchCASPTR(&last->next, next, p)) break;
+                if (synchCASPTR(&last->next, next, &p->node)) break;
             } else {
                 synchCASPTR(&l->tail, last, next);
                 synchBackoffDelay(&th_state->backoff);
             }
         }
     }
-    synchCASPTR(&l->tail, last, p);
+    synchCASPTR(&l->tail, last, &p->node);
+    synchEBRExit(&l->ebr, &th_state->ebr);
+    synchEventCountNotifyAfterRMW(&l->nonempty);
 }
 
 RetVal MSQueueDequeue(MSQueueStruct *l, MSQueueThreadState *th_state) {
@@ -43,14 +51,17 @@ RetVal MSQueueDequeue(MSQueueStruct *l, MSQueueThreadState *th_state) {
     Object value;
 
     synchResetBackoff(&th_state->backoff);
+    synchEBREnter(&l->ebr, &th_state->ebr);
     while (true) {
         first = (Node *)l->head;
         last = (Node *)l->tail;
         next = (Node *)first->next;
         if (first == l->head) {
             if (first == last) {
-                if (next == NULL)
+                if (next == NULL) {
+                    synchEBRExit(&l->ebr, &th_state->ebr);
                     return EMPTY_QUEUE;
+                }
                 synchCASPTR(&l->tail, last, next);
                 synchBackoffDelay(&th_state->backoff);
             } else {
@@ -60,5 +71,27 @@ RetVal MSQueueDequeue(MSQueueStruct *l, MSQueueThreadState *th_state) {
             }
         }
     }
+    synchEBRExit(&l->ebr, &th_state->ebr);
+    synchEBRRetire(&l->ebr, &th_state->ebr, first, ((SynchOwnedNode *)first)->owner);   // first is the previous dummy node
+
     return value;
 }
+
+static RetVal MSQueueDequeueWait(MSQueueStruct *l, MSQueueThreadState *th_state, const struct timespec *deadline) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&l->nonempty, ret, MSQueueDequeue(l, th_state), EMPTY_QUEUE, deadline);
+
+    return ret;
+}
+
+RetVal MSQueueDequeueBlocking(MSQueueStruct *l, MSQueueThreadState *th_state) {
+    return MSQueueDequeueWait(l, th_state, NULL);
+}
+
+RetVal MSQueueDequeueTimed(MSQueueStruct *l, MSQueueThreadState *th_state, uint64_t timeout_ns) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return MSQueueDequeueWait(l, th_state, &deadline);
+}
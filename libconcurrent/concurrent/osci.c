@@ -1,8 +1,6 @@
 #include <osci.h>
 #include <threadtools.h>
 
-static const int OSCI_HELP_FACTOR = 10;
-
 void OsciThreadStateInit(OsciThreadState *st_thread, OsciStruct *l, int pid) {
     int i, j;
 
@@ -23,103 +21,15 @@ void OsciThreadStateInit(OsciThreadState *st_thread, OsciStruct *l, int pid) {
 }
 
 RetVal OsciApplyOp(OsciStruct *l, OsciThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
-    volatile OsciNode *p, *pred, *cur, *mynode;
-    int counter = 0, i;
-    int help_bound = OSCI_HELP_FACTOR * l->nthreads;
-    int group = pid / l->fibers_per_thread;
-    int offset_id = pid % l->fibers_per_thread;
-
-    mynode = &st_thread->next_node[st_thread->toggle];
-osci_start:
-    do { // Try to acquire the combining point
-        if (l->current_node[group].ptr == NULL) synchCASPTR(&l->current_node[group].ptr, NULL, mynode);
-        cur = l->current_node[group].ptr;
-    } while (cur == NULL);
-
-    if (cur == mynode) { // In that case, I'm the combiner
-        st_thread->toggle = 1 - st_thread->toggle;
-        cur->rec[offset_id].arg_ret = arg;
-        cur->rec[offset_id].pid = pid;
-        cur->rec[offset_id].locked = true;
-        synchNonTSOFence();
-        cur->rec[offset_id].completed = false;
-        cur->next = NULL;
-        cur->door = _OSCI_DOOR_OPENED;
-        synchResched();                    // Scheduling point
-        l->current_node[group].ptr = NULL; // Release the combining point
-        while (!synchCAS32(&cur->door, _OSCI_DOOR_OPENED, _OSCI_DOOR_INIT))
-            synchResched();
-        pred = synchSWAP(&l->Tail, cur);
-
-        if (pred != NULL) {
-            pred->next = cur;
-            synchFullFence();
-            while (cur->rec[offset_id].locked)
-                synchResched();
-            if (cur->rec[offset_id].completed) // operation has already applied
-                return cur->rec[offset_id].arg_ret;
-        }
-    } else {
-        while (!synchCAS32(&cur->door, _OSCI_DOOR_OPENED, _OSCI_DOOR_LOCKED)) {
-            if (cur->door == _OSCI_DOOR_INIT)
-                goto osci_start;
-            synchResched();
-        }
-        cur->rec[offset_id].arg_ret = arg;
-        cur->rec[offset_id].pid = pid;
-        cur->rec[offset_id].locked = true;
-        synchNonTSOFence();
-        cur->rec[offset_id].completed = false;
-        cur->door = _OSCI_DOOR_OPENED;
-        synchNonTSOFence();
-        do {
-            synchResched();
-        } while (cur->rec[offset_id].locked);
-        if (cur->rec[offset_id].completed) // I have been helped
-            return cur->rec[offset_id].arg_ret;
-    }
+    return OsciApplyOpInline(l, st_thread, sfunc, state, arg, pid);
+}
 
-#ifdef DEBUG
-    l->rounds++;
-#endif
-    p = cur;
-    do {
-        synchStorePrefetch(p->next);
-        for (i = 0; i < l->fibers_per_thread; i++) {
-            if (p->rec[i].completed == false) {
-                p->rec[i].arg_ret = sfunc(state, p->rec[i].arg_ret, p->rec[i].pid);
-                p->rec[i].completed = true;
-                synchNonTSOFence();
-                p->rec[i].locked = false;
-#ifdef DEBUG
-                l->counter += 1;
-#endif
-            }
-        }
-        counter += i;
-        if (p->next == NULL || p->next->next == NULL || counter >= help_bound)
-            break;
-        p = p->next;
-    } while (true);
-    // End critical section
-    if (p->next == NULL) {
-        if (l->Tail == p && synchCASPTR(&l->Tail, p, NULL) == true) return cur->rec[offset_id].arg_ret;
-        while (p->next == NULL) {
-            synchResched();
-        }
-    }
-    synchNonTSOFence();
-    i = 0;
-    while (i < l->fibers_per_thread) {
-        if (p->next->rec[i].completed == false) {
-            p->next->rec[i].locked = false; // Unlock the next one
-            break;
-        }
-        i++;
-    }
-    synchFullFence();
+void OsciSetHelpPolicy(OsciStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound) {
+    synchHelpBoundSetPolicy(&l->help, target_ns, min_bound, max_bound);
+}
 
-    return cur->rec[offset_id].arg_ret;
+void OsciGetHelpStats(OsciStruct *l, SynchHelpBound *stats) {
+    *stats = l->help;
 }
 
 void OsciInit(OsciStruct *l, uint32_t nthreads, uint32_t fibers_per_thread) {
@@ -131,6 +41,7 @@ void OsciInit(OsciStruct *l, uint32_t nthreads, uint32_t fibers_per_thread) {
     else
         l->fibers_per_thread = 1;
     l->groups_of_fibers = (nthreads / fibers_per_thread) + (nthreads % fibers_per_thread != 0 ? 1 : 0);
+    synchHelpBoundInit(&l->help, OSCI_HELP_FACTOR * nthreads);
 #ifdef DEBUG
     l->rounds = l->counter = 0;
 #endif
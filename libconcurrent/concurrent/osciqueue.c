@@ -1,32 +1,35 @@
 #include <osciqueue.h>
-#include <threadtools.h>
 
 inline static RetVal serialEnqueue(void *state, ArgVal arg, int pid);
 inline static RetVal serialDequeue(void *state, ArgVal arg, int pid);
 
 void OsciQueueInit(OsciQueueStruct *queue_object_struct, uint32_t nthreads, uint32_t fibers_per_thread) {
+    uint32_t i;
+
     OsciInit(&(queue_object_struct->enqueue_struct), nthreads, fibers_per_thread);
     OsciInit(&queue_object_struct->dequeue_struct, nthreads, fibers_per_thread);
-    queue_object_struct->pool_node = synchGetAlignedMemory(CACHE_LINE_SIZE, queue_object_struct->enqueue_struct.groups_of_fibers * sizeof(SynchPoolStruct));
+    queue_object_struct->node_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(SynchNodeReturnSlot));
+    for (i = 0; i < nthreads; i++) {
+        queue_object_struct->node_slots[i].returned = NULL;
+        queue_object_struct->node_slots[i].released = NULL;
+    }
     queue_object_struct->guard.val = GUARD_VALUE;
     queue_object_struct->guard.next = NULL;
     queue_object_struct->first = &queue_object_struct->guard;
     queue_object_struct->last = &queue_object_struct->guard;
+    synchEventCountInit(&queue_object_struct->nonempty);
 }
 
 void OsciQueueThreadStateInit(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, int pid) {
     OsciThreadStateInit(&lobject_struct->enqueue_thread_state, &object_struct->enqueue_struct, (int)pid);
     OsciThreadStateInit(&lobject_struct->dequeue_thread_state, &object_struct->dequeue_struct, (int)pid);
-    synchInitPool(&(object_struct->pool_node[synchGetThreadId()]), sizeof(Node));
+    synchInitPool(&lobject_struct->pool, sizeof(SynchOwnedNode));
 }
 
 inline static RetVal serialEnqueue(void *state, ArgVal arg, int pid) {
     OsciQueueStruct *st = (OsciQueueStruct *)state;
-    Node *node;
+    Node *node = (Node *)arg;   // the node has been allocated and filled by the enqueuer
 
-    node = synchAllocObj(&(st->pool_node[synchGetThreadId()]));
-    node->next = NULL;
-    node->val = arg;
     st->last->next = node;
     st->last = node;
     return ENQUEUE_SUCCESS;
@@ -42,7 +45,8 @@ inline static RetVal serialDequeue(void *state, ArgVal arg, int pid) {
         node = st->first;
         if (node->val == GUARD_VALUE)
             return serialDequeue(state, arg, pid);
-        synchRecycleObj(&(st->pool_node[synchGetThreadId()]), (Node *)prev);
+        if (prev != &st->guard)
+            st->node_slots[pid].released = (SynchOwnedNode *)prev;   // it is returned to its owner by the dequeuer
         return node->val;
     } else {
         return EMPTY_QUEUE;
@@ -50,9 +54,35 @@ inline static RetVal serialDequeue(void *state, ArgVal arg, int pid) {
 }
 
 void OsciQueueApplyEnqueue(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, ArgVal arg, int pid) {
-    OsciApplyOp(&object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, serialEnqueue, object_struct, (ArgVal)arg, pid);
+    SynchOwnedNode *node = synchOwnedNodeAlloc(&lobject_struct->pool, &object_struct->node_slots[pid], arg, pid);
+
+    OsciApplyOp(&object_struct->enqueue_struct, &lobject_struct->enqueue_thread_state, serialEnqueue, object_struct, (ArgVal)node, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal OsciQueueApplyDequeue(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, int pid) {
-    return OsciApplyOp(&object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, serialDequeue, object_struct, (ArgVal)pid, pid);
+    RetVal ret = OsciApplyOp(&object_struct->dequeue_struct, &lobject_struct->dequeue_thread_state, serialDequeue, object_struct, (ArgVal)pid, pid);
+
+    synchOwnedNodeReturn(&lobject_struct->pool, object_struct->node_slots, pid);
+
+    return ret;
+}
+
+static RetVal OsciQueueDequeueWait(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, OsciQueueApplyDequeue(object_struct, lobject_struct, pid), EMPTY_QUEUE, deadline);
+
+    return ret;
+}
+
+RetVal OsciQueueApplyDequeueBlocking(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, int pid) {
+    return OsciQueueDequeueWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal OsciQueueApplyDequeueTimed(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return OsciQueueDequeueWait(object_struct, lobject_struct, &deadline, pid);
 }
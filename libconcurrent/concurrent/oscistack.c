@@ -1,5 +1,6 @@
 #include <oscistack.h>
 #include <threadtools.h>
+#include <string.h>
 
 inline static RetVal serialPushPop(void *state, ArgVal arg, int pid);
 
@@ -9,6 +10,8 @@ void OsciStackInit(OsciStackStruct *stack_object_struct, uint32_t nthreads, uint
     OsciInit(&(stack_object_struct->object_struct), nthreads, fibers_per_thread);
     stack_object_struct->pool_node = synchGetAlignedMemory(CACHE_LINE_SIZE, stack_object_struct->object_struct.groups_of_fibers * sizeof(SynchPoolStruct));
     stack_object_struct->top = NULL;
+    memset(&stack_object_struct->elim, 0, sizeof(SynchElimBuffer));
+    synchEventCountInit(&stack_object_struct->nonempty);
 }
 
 void OsciStackThreadStateInit(OsciStackStruct *object_struct, OsciStackThreadState *lobject_struct, int pid) {
@@ -21,8 +24,12 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
         volatile OsciStackStruct *st = (OsciStackStruct *)state;
         volatile Node *node = st->top;
 
+        RetVal ret;
+
+        if (synchElimPop((SynchElimBuffer *)&st->elim, &ret))                       // eliminated by a previous push
+            return ret;
         if (st->top != NULL) {
-            RetVal ret = node->val;
+            ret = node->val;
             st->top = st->top->next;
             synchRecycleObj(&(st->pool_node[synchGetThreadId()]), (void *)node);
             return ret;
@@ -32,11 +39,14 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
     } else {
         OsciStackStruct *st = (OsciStackStruct *)state;
         Node *node;
+        ArgVal evicted;
 
-        node = synchAllocObj(&(st->pool_node[synchGetThreadId()]));
-        node->next = st->top;
-        node->val = arg;
-        st->top = node;
+        if (synchElimPush(&st->elim, arg, &evicted)) {                              // the buffer is full, move its oldest element to a node
+            node = synchAllocObj(&(st->pool_node[synchGetThreadId()]));
+            node->next = st->top;
+            node->val = evicted;
+            st->top = node;
+        }
 
         return PUSH_SUCCESS;
     }
@@ -44,8 +54,32 @@ inline static RetVal serialPushPop(void *state, ArgVal arg, int pid) {
 
 void OsciStackApplyPush(OsciStackStruct *object_struct, OsciStackThreadState *lobject_struct, ArgVal arg, int pid) {
     OsciApplyOp(&(object_struct->object_struct), &(lobject_struct->th_state), serialPushPop, object_struct, (ArgVal)arg, pid);
+    synchEventCountNotify(&object_struct->nonempty);
 }
 
 RetVal OsciStackApplyPop(OsciStackStruct *object_struct, OsciStackThreadState *lobject_struct, int pid) {
     return OsciApplyOp(&(object_struct->object_struct), &(lobject_struct->th_state), serialPushPop, object_struct, POP_OP, pid);
 }
+
+static RetVal OsciStackPopWait(OsciStackStruct *object_struct, OsciStackThreadState *lobject_struct, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&object_struct->nonempty, ret, OsciStackApplyPop(object_struct, lobject_struct, pid), EMPTY_STACK, deadline);
+
+    return ret;
+}
+
+RetVal OsciStackApplyPopBlocking(OsciStackStruct *object_struct, OsciStackThreadState *lobject_struct, int pid) {
+    return OsciStackPopWait(object_struct, lobject_struct, NULL, pid);
+}
+
+RetVal OsciStackApplyPopTimed(OsciStackStruct *object_struct, OsciStackThreadState *lobject_struct, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return OsciStackPopWait(object_struct, lobject_struct, &deadline, pid);
+}
+
+void OsciStackGetElimStats(OsciStackStruct *object_struct, SynchElimStats *stats) {
+    synchElimGetStats(&object_struct->elim, stats);
+}
@@ -15,7 +15,7 @@ RetVal OyamaApplyOp(volatile OyamaStruct *l, OyamaThreadState *th_state, RetVal
     volatile OyamaAnnounceNode *mynode = &th_state->my_node;
     volatile OyamaAnnounceNode *p;
     register OyamaAnnounceNode *tmp_next;
-    int help_bound = OYAMA_HELP_FACTOR * l->nthreads;
+    SynchHelpBound *help = (SynchHelpBound *)&l->help;
 
     // Initializing node
     mynode->arg_ret = arg;
@@ -30,6 +30,8 @@ RetVal OyamaApplyOp(volatile OyamaStruct *l, OyamaThreadState *th_state, RetVal
     do {
         if (l->lock == UNLOCKED && synchCAS32(&l->lock, UNLOCKED, LOCKED)) {
             int counter = 0;
+            int help_bound = help->bound;
+            int64_t start = synchHelpBoundStart(help);
 #ifdef DEBUG
             l->rounds++;
 #endif
@@ -46,6 +48,7 @@ RetVal OyamaApplyOp(volatile OyamaStruct *l, OyamaThreadState *th_state, RetVal
                     p = (OyamaAnnounceNode *)tmp_next;
                 }
             }
+            synchHelpBoundEnd(help, start, counter);
             synchNonTSOFence();
             // Release the lock
             l->lock = UNLOCKED;
@@ -65,8 +68,17 @@ void OyamaThreadStateInit(OyamaThreadState *th_state) {
     ;
 }
 
+void OyamaSetHelpPolicy(OyamaStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound) {
+    synchHelpBoundSetPolicy(&l->help, target_ns, min_bound, max_bound);
+}
+
+void OyamaGetHelpStats(OyamaStruct *l, SynchHelpBound *stats) {
+    *stats = l->help;
+}
+
 void OyamaInit(OyamaStruct *l, uint32_t nthreads) {
     l->nthreads = nthreads;
+    synchHelpBoundInit(&l->help, OYAMA_HELP_FACTOR * nthreads);
     l->lock = UNLOCKED;
     l->tail = NULL;
 #ifdef DEBUG
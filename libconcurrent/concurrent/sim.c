@@ -2,41 +2,179 @@
 #include <fastrand.h>
 #include <threadtools.h>
 
-static inline void SimStateCopy(SimObjectState *dest, SimObjectState *src);
+void SimRegistryInit(SimRegistry *reg, uint32_t nthreads) {
+    uint32_t i;
 
-static inline void SimStateCopy(SimObjectState *dest, SimObjectState *src) {
-    // copy everything except 'applied' and 'ret' fields
-    memcpy(&dest->state, &src->state, SimObjectStateSize(dest->applied.nthreads) - CACHE_LINE_SIZE);
+    reg->nthreads = nthreads;
+    reg->registered = synchGetAlignedMemory(CACHE_LINE_SIZE, _TVEC_VECTOR_SIZE(nthreads));
+    for (i = 0; i < _TVEC_CELLS_(nthreads); i++)
+        reg->registered[i] = 0;
+    for (i = 0; i < nthreads; i++)
+        reg->registered[i >> _TVEC_DIVISION_SHIFT_BITS_] |= ((bitword_t)1) << (i & _TVEC_MODULO_BITS_);
+    reg->active_cells = _TVEC_CELLS_(nthreads);
+    reg->threads = nthreads;
 }
 
-void synchSimStructInit(SimStruct *sim_struct, uint32_t nthreads, int max_backoff) {
-    int i;
+void SimRegistrySetDynamic(SimRegistry *reg) {
+    uint32_t i;
+
+    for (i = 0; i < _TVEC_CELLS_(reg->nthreads); i++)
+        reg->registered[i] = 0;
+    reg->active_cells = 0;
+    reg->threads = 0;
+    synchFullFence();
+}
 
+int SimRegistryAcquire(SimRegistry *reg) {
+    uint32_t i, cells;
+
+    for (i = 0; i < _TVEC_CELLS_(reg->nthreads); i++) {
+        bitword_t old;
+
+        while ((old = reg->registered[i]) != ~((bitword_t)0)) {
+            int pid = i * _TVEC_BIWORD_SIZE_ + synchBitSearchFirst(~old);
+
+            if (pid >= reg->nthreads)
+                return -1;
+            if (synchCAS64(&reg->registered[i], old, old | (((bitword_t)1) << (pid & _TVEC_MODULO_BITS_)))) {
+                while ((cells = reg->active_cells) < i + 1)                             // extend the range of cells scanned by the combiners
+                    synchCAS32(&reg->active_cells, cells, i + 1);
+                synchFAA32(&reg->threads, 1);
+                return pid;
+            }
+        }
+    }
+
+    return -1;
+}
+
+void SimRegistryRelease(SimRegistry *reg, int pid) {
+    int i = pid >> _TVEC_DIVISION_SHIFT_BITS_;
+    bitword_t old;
+
+    synchFAA32(&reg->threads, -1);
+    do {
+        old = reg->registered[i];
+    } while (!synchCAS64(&reg->registered[i], old, old & ~(((bitword_t)1) << (pid & _TVEC_MODULO_BITS_))));
+}
+
+void synchSimStructInit(SimStruct *sim_struct, uint32_t nthreads, int max_backoff, uint32_t state_size, uint32_t state_align, void (*state_init)(void *)) {
+    synchSimStructInitBatch(sim_struct, nthreads, max_backoff, 1, state_size, state_align, state_init);
+}
+
+void synchSimStructInitBatch(SimStruct *sim_struct, uint32_t nthreads, int max_backoff, uint32_t max_batch, uint32_t state_size, uint32_t state_align, void (*state_init)(void *)) {
+    synchSimStructInitPool(sim_struct, nthreads, max_backoff, max_batch, _SIM_LOCAL_POOL_SIZE_, state_size, state_align, state_init);
+}
+
+void synchSimStructInitPool(SimStruct *sim_struct, uint32_t nthreads, int max_backoff, uint32_t max_batch, uint32_t pool_size, uint32_t state_size, uint32_t state_align, void (*state_init)(void *)) {
+    uint32_t ret_offset, version_offset, group_offset, dirty_offset, record_align, initial;
+    void *slice;
+    int i, k;
+
+    if (max_batch == 0)
+        max_batch = 1;
+    if (pool_size < 2)
+        pool_size = 2;
+    if (state_align < sizeof(uint64_t))
+        state_align = sizeof(uint64_t);
+    record_align = (state_align > CACHE_LINE_SIZE) ? state_align : CACHE_LINE_SIZE;
+
+    // Layout of each copy: [SimObjectState][object's state][applied toggles][list of return values][versions][group versions][dirty lines]
+    // A pointer to SimObjectState is stored just before object's state (see SimStateWriteBarrier).
     sim_struct->nthreads = nthreads;
+    sim_struct->pool_size = pool_size;
+    sim_struct->max_batch = max_batch;
+    sim_struct->copy_mode = SIM_COPY_FULL;
+    sim_struct->state_size = state_size;
+    sim_struct->state_lines = (state_size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE;
+    sim_struct->state_offset = SIM_ALIGN_UP(sizeof(SimObjectState) + sizeof(SimObjectState *), record_align);
+    sim_struct->tvec_offset = sim_struct->state_offset + sim_struct->state_lines * CACHE_LINE_SIZE;
+    sim_struct->copy_end = sim_struct->tvec_offset + _TVEC_VECTOR_SIZE(nthreads);
+    ret_offset = SIM_ALIGN_UP(sim_struct->copy_end, sizeof(uint64_t));
+    version_offset = SIM_ALIGN_UP(ret_offset + nthreads * max_batch * sizeof(SimRoundRet), CACHE_LINE_SIZE);
+    group_offset = version_offset + sim_struct->state_lines * sizeof(uint64_t);
+    dirty_offset = group_offset + _TVEC_CELLS_(sim_struct->state_lines) * sizeof(uint64_t);
+    sim_struct->record_size = SIM_ALIGN_UP(dirty_offset + _TVEC_VECTOR_SIZE(sim_struct->state_lines), record_align);
+
     TVEC_INIT_AT((ToggleVector *)&sim_struct->a_toggles, nthreads, synchGetAlignedMemory(CACHE_LINE_SIZE, _TVEC_VECTOR_SIZE(nthreads)));
-    sim_struct->announce = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(ArgVal));
-    sim_struct->pool = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimObjectState *) * (_SIM_LOCAL_POOL_SIZE_ * nthreads + 1));
-    for (i = 0; i < _SIM_LOCAL_POOL_SIZE_ * nthreads + 1; i++) {
-        sim_struct->pool[i] = synchGetAlignedMemory(CACHE_LINE_SIZE, SimObjectStateSize(nthreads));
-        TVEC_INIT_AT(&sim_struct->pool[i]->applied, nthreads, sim_struct->pool[i]->__flex);
-        sim_struct->pool[i]->ret = ((void *)sim_struct->pool[i]->__flex) + _TVEC_VECTOR_SIZE(nthreads);
+    sim_struct->announce = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * max_batch * sizeof(ArgVal));
+    sim_struct->announce_size = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(uint32_t));
+    sim_struct->announce_seq = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(uint64_t));
+    for (i = 0; i < nthreads; i++) {
+        sim_struct->announce_size[i] = 1;
+        sim_struct->announce_seq[i] = 0;
+    }
+    sim_struct->ret_stride = SIM_RET_SLOTS_PER_THREAD(max_batch);
+    sim_struct->ret_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sim_struct->ret_stride * sizeof(SimRetSlot));
+    memset(sim_struct->ret_slots, 0, nthreads * sim_struct->ret_stride * sizeof(SimRetSlot));
+    SimRegistryInit(&sim_struct->registry, nthreads);
+    sim_struct->saved_index = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int));
+    memset(sim_struct->saved_index, 0, nthreads * sizeof(int));
+    // The pool of each thread is a single memory area placed on the NUMA node of the thread,
+    // while the copy that holds the initial state of the object is stored at the end of sim_struct->pool.
+    initial = pool_size * nthreads;
+    sim_struct->pool_node = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int32_t));
+    sim_struct->pool = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimObjectState *) * (initial + 1));
+    for (i = 0; i < nthreads; i++) {
+        sim_struct->pool_node[i] = synchPreferredNumaNodeOfThread(i);
+        slice = synchGetMemoryOnNumaNode(pool_size * sim_struct->record_size, sim_struct->pool_node[i]);
+        for (k = 0; k < pool_size; k++)
+            sim_struct->pool[i * pool_size + k] = slice + k * sim_struct->record_size;
+    }
+    sim_struct->pool[initial] = synchGetAlignedMemory(record_align, sim_struct->record_size);
+    for (i = 0; i < initial + 1; i++) {
+        sim_struct->pool[i]->state = ((void *)sim_struct->pool[i]) + sim_struct->state_offset;
+        ((SimObjectState **)sim_struct->pool[i]->state)[-1] = sim_struct->pool[i];
+        TVEC_INIT_AT(&sim_struct->pool[i]->applied, nthreads, ((void *)sim_struct->pool[i]) + sim_struct->tvec_offset);
+        sim_struct->pool[i]->ret = ((void *)sim_struct->pool[i]) + ret_offset;
+        sim_struct->pool[i]->ret_size = 0;
+        sim_struct->pool[i]->version = ((void *)sim_struct->pool[i]) + version_offset;
+        sim_struct->pool[i]->group_version = ((void *)sim_struct->pool[i]) + group_offset;
+        sim_struct->pool[i]->dirty = NULL;
+        memset(((void *)sim_struct->pool[i]) + dirty_offset, 0, _TVEC_VECTOR_SIZE(sim_struct->state_lines));
+        SimStateInvalidate(sim_struct, sim_struct->pool[i]);
     }
 
-    sim_struct->sp.struct_data.index = _SIM_LOCAL_POOL_SIZE_ * nthreads;
+    sim_struct->sp.struct_data.index = initial;
     sim_struct->sp.struct_data.seq = 0;
 
     // OBJECT'S INITIAL VALUE
     // ----------------------
-    sim_struct->pool[_SIM_LOCAL_POOL_SIZE_ * nthreads]->state.state = 0;
-    TVEC_SET_ZERO((ToggleVector *)&sim_struct->pool[_SIM_LOCAL_POOL_SIZE_ * nthreads]->applied);
+    memset(sim_struct->pool[initial]->state, 0, state_size);
+    if (state_init != NULL)
+        state_init(sim_struct->pool[initial]->state);
+    for (i = 0; i < sim_struct->state_lines; i++)
+        sim_struct->pool[initial]->version[i] = sim_struct->sp.raw_data;
+    for (i = 0; i < _TVEC_CELLS_(sim_struct->state_lines); i++)
+        sim_struct->pool[initial]->group_version[i] = sim_struct->sp.raw_data;
+    TVEC_SET_ZERO((ToggleVector *)&sim_struct->pool[initial]->applied);
     sim_struct->MAX_BACK = max_backoff * 100;
 #ifdef DEBUG
-    sim_struct->pool[_SIM_LOCAL_POOL_SIZE_ * nthreads]->counter = 0;
-    sim_struct->pool[_SIM_LOCAL_POOL_SIZE_ * nthreads]->rounds = 0;
+    sim_struct->pool[initial]->counter = 0;
+    sim_struct->pool[initial]->rounds = 0;
 #endif
     synchFullFence();
 }
 
+void synchSimStructSetCopyMode(SimStruct *sim_struct, int copy_mode) {
+    int i;
+
+    sim_struct->copy_mode = copy_mode;
+    for (i = 0; i < sim_struct->pool_size * sim_struct->nthreads + 1; i++) {
+        SimObjectState *copy = sim_struct->pool[i];
+
+        if (copy_mode == SIM_COPY_DELTA)
+            copy->dirty = (bitword_t *)(copy->group_version + _TVEC_CELLS_(sim_struct->state_lines));
+        else
+            copy->dirty = NULL;
+    }
+    synchFullFence();
+}
+
+void synchSimStructSetDynamicThreads(SimStruct *sim_struct) {
+    SimRegistrySetDynamic(&sim_struct->registry);
+}
+
 void SimThreadStateInit(SimThreadState *th_state, uint32_t nthreads, int pid) {
     TVEC_INIT(&th_state->mask, nthreads);
     TVEC_INIT(&th_state->toggle, nthreads);
@@ -49,81 +187,74 @@ void SimThreadStateInit(SimThreadState *th_state, uint32_t nthreads, int pid) {
     TVEC_NEGATIVE(&th_state->toggle, &th_state->mask);
     th_state->local_index = 0;
     th_state->backoff = 1;
+    th_state->seq = 0;
+}
+
+int SimRegisterThread(SimStruct *sim_struct, SimThreadState *th_state) {
+    int pid = SimRegistryAcquire(&sim_struct->registry);
+    int32_t node;
+
+    if (pid < 0)
+        return -1;
+    SimThreadStateInit(th_state, sim_struct->nthreads, pid);
+    th_state->local_index = sim_struct->saved_index[pid];                              // continue from the state left by the previous owner of pid
+    th_state->seq = sim_struct->announce_seq[pid];
+    node = synchGetPreferredNumaNode();
+    if (node >= 0 && node != sim_struct->pool_node[pid]) {                               // move the pool of pid close to its new owner
+        synchMoveMemoryToNumaNode(sim_struct->pool[pid * sim_struct->pool_size], sim_struct->pool_size * sim_struct->record_size, node);
+        sim_struct->pool_node[pid] = node;
+    }
+    if (TVEC_IS_SET((ToggleVector *)&sim_struct->a_toggles, pid)) {
+        TVEC_REVERSE_BIT(&th_state->my_bit, pid);
+        TVEC_NEGATIVE_BANK(&th_state->toggle, &th_state->toggle, TVEC_GET_BANK_OF_BIT(pid, sim_struct->nthreads));
+    }
+
+    return pid;
+}
+
+void SimDeregisterThread(SimStruct *sim_struct, SimThreadState *th_state, int pid) {
+    sim_struct->saved_index[pid] = th_state->local_index;
+    TVEC_DESTROY(&th_state->mask);
+    TVEC_DESTROY(&th_state->toggle);
+    TVEC_DESTROY(&th_state->my_bit);
+    TVEC_DESTROY(&th_state->diffs);
+    TVEC_DESTROY(&th_state->l_toggles);
+    SimRegistryRelease(&sim_struct->registry, pid);                                    // CAS acts as a full write-barrier
 }
 
 Object SimApplyOp(SimStruct *sim_struct, SimThreadState *th_state, RetVal (*sfunc)(void *, ArgVal, int), Object arg, int pid) {
-    ToggleVector *diffs = &th_state->diffs, *l_toggles = &th_state->l_toggles;
-    pointer_t old_sp, new_sp;
-    HalfSimObjectState *sp_data, *lsp_data;
-    int i, j, prefix, mybank;
-
-    sim_struct->announce[pid] = arg;                                                    // sim_struct->announce the operation
-    synchNonTSOFence();
-    mybank = TVEC_GET_BANK_OF_BIT(pid, sim_struct->nthreads);
-    TVEC_REVERSE_BIT(&th_state->my_bit, pid);
-    TVEC_NEGATIVE_BANK(&th_state->toggle, &th_state->toggle, mybank);
-    lsp_data = (HalfSimObjectState *)sim_struct->pool[pid * _SIM_LOCAL_POOL_SIZE_ + th_state->local_index];
-    TVEC_ATOMIC_ADD_BANK(&sim_struct->a_toggles, &th_state->toggle, mybank);            // toggle pid's bit in sim_struct->a_toggles, Fetch&Add acts as a full write-barrier
-
-    if (!synchIsSystemOversubscribed()) {
-        volatile int k;
-        int backoff_limit;
-
-        if (synchFastRandomRange(1, sim_struct->nthreads) > 1) {
-            backoff_limit = th_state->backoff;
-            for (k = 0; k < backoff_limit; k++)
-                ;
-        }
-    } else if (synchFastRandomRange(1, sim_struct->nthreads) > 4)
-        synchResched();
+    return SimApplyOpInline(sim_struct, th_state, sfunc, arg, pid);
+}
 
-    for (j = 0; j < 2; j++) {
-        old_sp = sim_struct->sp;                                                        // read reference to struct ObjectState
+RetVal SimApplyReadOp(SimStruct *sim_struct, SimThreadState *th_state, RetVal (*rfunc)(void *, ArgVal, int), ArgVal arg, int pid) {
+    pointer_t old_sp;
+    RetVal ret;
+    int j;
+
+    for (j = 0; j < _SIM_READ_ATTEMPTS_; j++) {
+        old_sp = sim_struct->sp;                                                        // read reference to the most recent copy of object's state
         synchNonTSOFence();
-        sp_data = (HalfSimObjectState *)sim_struct->pool[old_sp.struct_data.index];     // read reference of struct ObjectState in a local variable lsim_struct->sp
-        TVEC_ATOMIC_COPY_BANKS(diffs, &sp_data->applied, mybank);
-        TVEC_XOR_BANKS(diffs, diffs, &th_state->my_bit, mybank);                        // determine the set of active processes
-        if (TVEC_IS_SET(diffs, pid))                                                    // if the operation has already been applied return
-            break;
-        SimStateCopy((SimObjectState *)lsp_data, (SimObjectState *)sp_data);
+        ret = rfunc(sim_struct->pool[old_sp.struct_data.index]->state, arg, pid);
         synchNonTSOFence();
-        TVEC_COPY(l_toggles, (ToggleVector *)&sim_struct->a_toggles);                   // This is an atomic read, since a_toogles is volatile
-        if (old_sp.raw_data != sim_struct->sp.raw_data)
-            continue;
-        TVEC_XOR(diffs, &lsp_data->applied, l_toggles);
-#ifdef DEBUG
-        lsp_data->rounds++;
-        lsp_data->counter++;
-#endif
-        lsp_data->ret[pid] = sfunc(&lsp_data->state, arg, pid);
-        TVEC_REVERSE_BIT(diffs, pid);
-        for (i = 0, prefix = 0; i < diffs->tvec_cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
-            synchReadPrefetch(&sim_struct->announce[prefix]);
-            synchReadPrefetch(&sim_struct->announce[prefix + 8]);
-            synchReadPrefetch(&sim_struct->announce[prefix + 16]);
-            synchReadPrefetch(&sim_struct->announce[prefix + 24]);
-
-            while (diffs->cell[i] != 0L) {
-                register int pos, proc_id;
-
-                pos = synchBitSearchFirst(diffs->cell[i]);
-                proc_id = prefix + pos;
-                diffs->cell[i] ^= ((bitword_t)1) << pos;
-                lsp_data->ret[proc_id] = sfunc(&lsp_data->state, sim_struct->announce[proc_id], proc_id);
-#ifdef DEBUG
-                lsp_data->counter++;
-#endif
-            }
-        }
-        TVEC_COPY(&lsp_data->applied, l_toggles);                                       // change applied to be equal to what was read in sim_struct->a_toggles
-        new_sp.struct_data.seq = old_sp.struct_data.seq + 1;                            // increase timestamp
-        new_sp.struct_data.index = _SIM_LOCAL_POOL_SIZE_ * pid + th_state->local_index; // store in mod_dw.index the index in sim_struct->pool where lsim_struct->sp will be stored
-        if (old_sp.raw_data == sim_struct->sp.raw_data && synchCAS64(&sim_struct->sp, old_sp.raw_data, new_sp.raw_data)) {  // try to change sim_struct->sp to the value mod_dw
-            th_state->local_index = (th_state->local_index + 1) % _SIM_LOCAL_POOL_SIZE_;                              // if this happens successfully,use next item in pid's sim_struct->pool next time
-            th_state->backoff = (th_state->backoff >> 1) | 1;
-            return lsp_data->ret[pid];
-        } else if (th_state->backoff < sim_struct->MAX_BACK)
-            th_state->backoff <<= 1;
+        if (old_sp.raw_data == sim_struct->sp.raw_data)                                 // the copy has not been replaced, thus it was not reused
+            return ret;
+    }
+
+    return SimApplyOp(sim_struct, th_state, rfunc, arg, pid);                           // too much contention, apply it as an ordinary request
+}
+
+void SimApplyBatch(SimStruct *sim_struct, SimThreadState *th_state, RetVal (*sfunc)(void *, ArgVal, int), ArgVal *args, RetVal *rets, uint32_t n, int pid) {
+    uint32_t max_batch = sim_struct->max_batch;
+    uint32_t size, k;
+
+    while (n > 0) {
+        size = (n < max_batch) ? n : max_batch;
+        for (k = 0; k < size; k++)                                                      // sim_struct->announce the whole batch of operations
+            sim_struct->announce[pid * max_batch + k] = args[k];
+        sim_struct->announce_size[pid] = size;
+        SimApplyRound(sim_struct, th_state, sfunc, rets, pid);
+        args += size;
+        rets += size;
+        n -= size;
     }
-    return sim_struct->pool[sim_struct->sp.struct_data.index]->ret[pid];                // return the value found in the record stored there
 }
@@ -0,0 +1,497 @@
+#include <simbqueue.h>
+#include <fastrand.h>
+#include <threadtools.h>
+
+static inline void SimBQueueRaise(volatile uint64_t *hint, uint64_t val);
+static inline void SimBQueueWrite(SimBQueueStruct *queue, SimBQueueSlot *list, uint32_t size);
+static inline uint64_t SimBQueueHelpEnqueuers(SimBQueueStruct *queue, SimBQueueThreadState *th_state);
+static inline uint64_t SimBQueueHelpDequeuers(SimBQueueStruct *queue);
+static inline void EnqStateCopy(SimBQueueStruct *queue, SimBQueueEnqState *dest, SimBQueueEnqState *src, uint32_t cells);
+static inline void DeqStateCopy(SimBQueueStruct *queue, SimBQueueDeqState *dest, SimBQueueDeqState *src, uint32_t cells);
+
+// Raises a hint (i.e. tail_hint or head_hint) to val, hints never decrease.
+static inline void SimBQueueRaise(volatile uint64_t *hint, uint64_t val) {
+    uint64_t old;
+
+    while ((old = *hint) < val) {
+        if (synchCAS64(hint, old, val))
+            break;
+    }
+}
+
+// Writes a list of enqueued elements to the ring. A slot is updated only in case that it stores an older element.
+static inline void SimBQueueWrite(SimBQueueStruct *queue, SimBQueueSlot *list, uint32_t size) {
+    uint32_t i;
+
+    for (i = 0; i < size; i++) {
+        SimBQueueSlot *slot = &queue->ring[(list[i].seq - 1) & (queue->capacity - 1)];
+        uint64_t old_seq;
+
+        while ((old_seq = slot->seq) < list[i].seq) {
+            if (synchCAS128(slot, old_seq, slot->val, list[i].seq, list[i].val))
+                break;
+        }
+    }
+}
+
+// Writes to the ring the elements of the most recent copy of SimBQueueEnqState (in case that their enqueuer has
+// not written them yet) and returns a position of the tail, such that all the elements before it are in the ring.
+static inline uint64_t SimBQueueHelpEnqueuers(SimBQueueStruct *queue, SimBQueueThreadState *th_state) {
+    SimBQueueEnqState *sp_data;
+    pointer_t old_sp;
+    uint64_t tail;
+    uint32_t size;
+
+    old_sp = queue->enq_sp;
+    synchNonTSOFence();
+    sp_data = queue->enq_pool[old_sp.struct_data.index];
+    tail = sp_data->tail;
+    size = sp_data->pending_size;
+    if (size > queue->nthreads)                                                         // a stale read
+        return queue->tail_hint;
+    memcpy(th_state->pending, sp_data->pending, size * sizeof(SimBQueueSlot));
+    synchNonTSOFence();
+    if (old_sp.raw_data != queue->enq_sp.raw_data)
+        return queue->tail_hint;
+    SimBQueueWrite(queue, th_state->pending, size);
+    SimBQueueRaise(&queue->tail_hint, tail);
+
+    return tail;
+}
+
+// Returns a position of the head that is read from the most recent copy of SimBQueueDeqState.
+static inline uint64_t SimBQueueHelpDequeuers(SimBQueueStruct *queue) {
+    pointer_t old_sp;
+    uint64_t head;
+
+    old_sp = queue->deq_sp;
+    synchNonTSOFence();
+    head = queue->deq_pool[old_sp.struct_data.index]->head;
+    synchNonTSOFence();
+    if (old_sp.raw_data == queue->deq_sp.raw_data)
+        SimBQueueRaise(&queue->head_hint, head);
+
+    return queue->head_hint;
+}
+
+static inline void EnqStateCopy(SimBQueueStruct *queue, SimBQueueEnqState *dest, SimBQueueEnqState *src, uint32_t cells) {
+    dest->tail = src->tail;
+#ifdef DEBUG
+    dest->counter = src->counter;
+#endif
+    TVEC_COPY_CELLS(&dest->applied, &src->applied, cells);
+    // copy only the elements and the return values of the attempt that produced src
+    dest->pending_size = src->pending_size;
+    if (dest->pending_size > queue->nthreads)                                           // a stale read, this attempt is going to fail
+        dest->pending_size = 0;
+    memcpy(dest->pending, src->pending, dest->pending_size * sizeof(SimBQueueSlot));
+    dest->ret_size = src->ret_size;
+    if (dest->ret_size > queue->nthreads)
+        dest->ret_size = 0;
+    memcpy(dest->ret, src->ret, dest->ret_size * sizeof(SimRoundRet));
+}
+
+static inline void DeqStateCopy(SimBQueueStruct *queue, SimBQueueDeqState *dest, SimBQueueDeqState *src, uint32_t cells) {
+    dest->head = src->head;
+#ifdef DEBUG
+    dest->counter = src->counter;
+#endif
+    TVEC_COPY_CELLS(&dest->applied, &src->applied, cells);
+    // copy only the return values of the attempt that produced src
+    dest->ret_size = src->ret_size;
+    if (dest->ret_size > queue->nthreads)                                               // a stale read, this attempt is going to fail
+        dest->ret_size = 0;
+    memcpy(dest->ret, src->ret, dest->ret_size * sizeof(SimRoundRet));
+}
+
+void SimBQueueStructInit(SimBQueueStruct *queue, uint32_t nthreads, int max_backoff, uint64_t capacity) {
+    SimBQueueStructInitPool(queue, nthreads, max_backoff, capacity, _SIM_LOCAL_POOL_SIZE_);
+}
+
+void SimBQueueStructInitPool(SimBQueueStruct *queue, uint32_t nthreads, int max_backoff, uint64_t capacity, uint32_t pool_size) {
+    uint32_t enq_tvec_offset, enq_pending_offset, enq_ret_offset;
+    uint32_t deq_tvec_offset, deq_ret_offset;
+    uint32_t initial;
+    void *enq_slice, *deq_slice;
+    pointer_t tmp_sp;
+    int i, k;
+
+    if (pool_size < 2)
+        pool_size = 2;
+    queue->capacity = 1;
+    while (queue->capacity < capacity)
+        queue->capacity <<= 1;
+    queue->nthreads = nthreads;
+    queue->pool_size = pool_size;
+    queue->ring = synchGetAlignedMemory(CACHE_LINE_SIZE, queue->capacity * sizeof(SimBQueueSlot));
+    memset(queue->ring, 0, queue->capacity * sizeof(SimBQueueSlot));
+    queue->tail_hint = 0;
+    queue->head_hint = 0;
+
+    // Layout of each copy of SimBQueueEnqState: [SimBQueueEnqState][applied toggles][enqueued elements][list of return values]
+    enq_tvec_offset = SIM_ALIGN_UP(sizeof(SimBQueueEnqState), sizeof(uint64_t));
+    enq_pending_offset = SIM_ALIGN_UP(enq_tvec_offset + _TVEC_VECTOR_SIZE(nthreads), sizeof(SimBQueueSlot));
+    enq_ret_offset = enq_pending_offset + nthreads * sizeof(SimBQueueSlot);
+    queue->enq_record_size = SIM_ALIGN_UP(enq_ret_offset + nthreads * sizeof(SimRoundRet), CACHE_LINE_SIZE);
+    // Layout of each copy of SimBQueueDeqState: [SimBQueueDeqState][applied toggles][list of return values]
+    deq_tvec_offset = SIM_ALIGN_UP(sizeof(SimBQueueDeqState), sizeof(uint64_t));
+    deq_ret_offset = SIM_ALIGN_UP(deq_tvec_offset + _TVEC_VECTOR_SIZE(nthreads), sizeof(uint64_t));
+    queue->deq_record_size = SIM_ALIGN_UP(deq_ret_offset + nthreads * sizeof(SimRoundRet), CACHE_LINE_SIZE);
+
+    queue->announce = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(ArgVal));
+    queue->enq_announce_seq = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(uint64_t));
+    queue->deq_announce_seq = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(uint64_t));
+    memset((void *)queue->enq_announce_seq, 0, nthreads * sizeof(uint64_t));
+    memset((void *)queue->deq_announce_seq, 0, nthreads * sizeof(uint64_t));
+    queue->ret_stride = SIM_RET_SLOTS_PER_THREAD(1);
+    queue->enq_ret_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * queue->ret_stride * sizeof(SimRetSlot));
+    queue->deq_ret_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * queue->ret_stride * sizeof(SimRetSlot));
+    memset(queue->enq_ret_slots, 0, nthreads * queue->ret_stride * sizeof(SimRetSlot));
+    memset(queue->deq_ret_slots, 0, nthreads * queue->ret_stride * sizeof(SimRetSlot));
+    SimRegistryInit(&queue->registry, nthreads);
+    queue->saved_enq_index = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int));
+    queue->saved_deq_index = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int));
+    memset(queue->saved_enq_index, 0, nthreads * sizeof(int));
+    memset(queue->saved_deq_index, 0, nthreads * sizeof(int));
+    TVEC_INIT_AT(&queue->enqueuers, nthreads, synchGetAlignedMemory(CACHE_LINE_SIZE, _TVEC_VECTOR_SIZE(nthreads)));
+    TVEC_INIT_AT(&queue->dequeuers, nthreads, synchGetAlignedMemory(CACHE_LINE_SIZE, _TVEC_VECTOR_SIZE(nthreads)));
+    TVEC_SET_ZERO((ToggleVector *)&queue->enqueuers);
+    TVEC_SET_ZERO((ToggleVector *)&queue->dequeuers);
+
+    initial = pool_size * nthreads;
+    queue->enq_pool = synchGetAlignedMemory(CACHE_LINE_SIZE, (initial + 1) * sizeof(SimBQueueEnqState *));
+    queue->deq_pool = synchGetAlignedMemory(CACHE_LINE_SIZE, (initial + 1) * sizeof(SimBQueueDeqState *));
+    queue->pool_node = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int32_t));
+    for (i = 0; i < nthreads; i++) {
+        queue->pool_node[i] = synchPreferredNumaNodeOfThread(i);
+        enq_slice = synchGetMemoryOnNumaNode(pool_size * queue->enq_record_size, queue->pool_node[i]);
+        deq_slice = synchGetMemoryOnNumaNode(pool_size * queue->deq_record_size, queue->pool_node[i]);
+        for (k = 0; k < pool_size; k++) {
+            queue->enq_pool[i * pool_size + k] = enq_slice + k * queue->enq_record_size;
+            queue->deq_pool[i * pool_size + k] = deq_slice + k * queue->deq_record_size;
+        }
+    }
+    queue->enq_pool[initial] = synchGetAlignedMemory(CACHE_LINE_SIZE, queue->enq_record_size);
+    queue->deq_pool[initial] = synchGetAlignedMemory(CACHE_LINE_SIZE, queue->deq_record_size);
+    for (i = 0; i < initial + 1; i++) {
+        TVEC_INIT_AT(&queue->enq_pool[i]->applied, nthreads, ((void *)queue->enq_pool[i]) + enq_tvec_offset);
+        queue->enq_pool[i]->pending = ((void *)queue->enq_pool[i]) + enq_pending_offset;
+        queue->enq_pool[i]->pending_size = 0;
+        queue->enq_pool[i]->ret = ((void *)queue->enq_pool[i]) + enq_ret_offset;
+        queue->enq_pool[i]->ret_size = 0;
+        TVEC_INIT_AT(&queue->deq_pool[i]->applied, nthreads, ((void *)queue->deq_pool[i]) + deq_tvec_offset);
+        queue->deq_pool[i]->ret = ((void *)queue->deq_pool[i]) + deq_ret_offset;
+        queue->deq_pool[i]->ret_size = 0;
+    }
+
+    // Initializing queue's state
+    // --------------------------
+    TVEC_SET_ZERO((ToggleVector *)&queue->enq_pool[initial]->applied);
+    TVEC_SET_ZERO((ToggleVector *)&queue->deq_pool[initial]->applied);
+    queue->enq_pool[initial]->tail = 0;
+    queue->deq_pool[initial]->head = 0;
+#ifdef DEBUG
+    queue->enq_pool[initial]->counter = 0;
+    queue->deq_pool[initial]->counter = 0;
+#endif
+    tmp_sp.struct_data.index = initial;
+    tmp_sp.struct_data.seq = 0L;
+    queue->enq_sp = tmp_sp;
+    queue->deq_sp = tmp_sp;
+    queue->MAX_BACK = max_backoff * 100;
+
+    synchEventCountInit(&queue->nonempty);
+    synchFullFence();
+}
+
+void SimBQueueThreadStateInit(SimBQueueStruct *queue, SimBQueueThreadState *th_state, int pid) {
+    TVEC_INIT(&th_state->mask, queue->nthreads);
+    TVEC_INIT(&th_state->deq_toggle, queue->nthreads);
+    TVEC_INIT(&th_state->my_deq_bit, queue->nthreads);
+    TVEC_INIT(&th_state->enq_toggle, queue->nthreads);
+    TVEC_INIT(&th_state->my_enq_bit, queue->nthreads);
+    TVEC_INIT(&th_state->diffs, queue->nthreads);
+    TVEC_INIT(&th_state->l_toggles, queue->nthreads);
+
+    TVEC_REVERSE_BIT(&th_state->my_enq_bit, pid);
+    TVEC_SET_BIT(&th_state->mask, pid);
+    TVEC_NEGATIVE(&th_state->enq_toggle, &th_state->mask);
+
+    TVEC_SET_ZERO(&th_state->mask);
+    TVEC_REVERSE_BIT(&th_state->my_deq_bit, pid);
+    TVEC_SET_BIT(&th_state->mask, pid);
+    TVEC_NEGATIVE(&th_state->deq_toggle, &th_state->mask);
+    th_state->pending = synchGetMemory(queue->nthreads * sizeof(SimBQueueSlot));
+    th_state->enq_local_index = 0;
+    th_state->deq_local_index = 0;
+    th_state->max_backoff = 1;
+    th_state->enq_seq = 0;
+    th_state->deq_seq = 0;
+}
+
+void SimBQueueStructSetDynamicThreads(SimBQueueStruct *queue) {
+    SimRegistrySetDynamic(&queue->registry);
+}
+
+int SimBQueueRegisterThread(SimBQueueStruct *queue, SimBQueueThreadState *th_state) {
+    int pid = SimRegistryAcquire(&queue->registry);
+    int32_t node;
+    int bank;
+
+    if (pid < 0)
+        return -1;
+    SimBQueueThreadStateInit(queue, th_state, pid);
+    bank = TVEC_GET_BANK_OF_BIT(pid, queue->nthreads);
+    th_state->enq_local_index = queue->saved_enq_index[pid];                          // continue from the state left by the previous owner of pid
+    th_state->deq_local_index = queue->saved_deq_index[pid];
+    th_state->enq_seq = queue->enq_announce_seq[pid];
+    th_state->deq_seq = queue->deq_announce_seq[pid];
+    node = synchGetPreferredNumaNode();
+    if (node >= 0 && node != queue->pool_node[pid]) {                                  // move the pools of pid close to its new owner
+        synchMoveMemoryToNumaNode(queue->enq_pool[pid * queue->pool_size], queue->pool_size * queue->enq_record_size, node);
+        synchMoveMemoryToNumaNode(queue->deq_pool[pid * queue->pool_size], queue->pool_size * queue->deq_record_size, node);
+        queue->pool_node[pid] = node;
+    }
+    if (TVEC_IS_SET(&queue->enqueuers, pid)) {
+        TVEC_REVERSE_BIT(&th_state->my_enq_bit, pid);
+        TVEC_NEGATIVE_BANK(&th_state->enq_toggle, &th_state->enq_toggle, bank);
+    }
+    if (TVEC_IS_SET(&queue->dequeuers, pid)) {
+        TVEC_REVERSE_BIT(&th_state->my_deq_bit, pid);
+        TVEC_NEGATIVE_BANK(&th_state->deq_toggle, &th_state->deq_toggle, bank);
+    }
+
+    return pid;
+}
+
+void SimBQueueDeregisterThread(SimBQueueStruct *queue, SimBQueueThreadState *th_state, int pid) {
+    queue->saved_enq_index[pid] = th_state->enq_local_index;
+    queue->saved_deq_index[pid] = th_state->deq_local_index;
+    TVEC_DESTROY(&th_state->mask);
+    TVEC_DESTROY(&th_state->deq_toggle);
+    TVEC_DESTROY(&th_state->my_deq_bit);
+    TVEC_DESTROY(&th_state->enq_toggle);
+    TVEC_DESTROY(&th_state->my_enq_bit);
+    TVEC_DESTROY(&th_state->diffs);
+    TVEC_DESTROY(&th_state->l_toggles);
+    synchFreeMemory(th_state->pending, queue->nthreads * sizeof(SimBQueueSlot));
+    SimRegistryRelease(&queue->registry, pid);                                        // CAS acts as a full write-barrier
+}
+
+static inline void SimBQueueBackoff(SimBQueueStruct *queue, SimBQueueThreadState *th_state) {
+    if (!synchIsSystemOversubscribed()) {
+        volatile int k;
+        int backoff_limit;
+
+        if (synchFastRandomRange(1, queue->registry.threads) > 1) {
+            backoff_limit = synchFastRandomRange(th_state->max_backoff >> 1, th_state->max_backoff);
+            for (k = 0; k < backoff_limit; k++)
+                ;
+        }
+    } else if (synchFastRandomRange(1, queue->registry.threads) > 4) {
+        synchResched();
+    }
+}
+
+static RetVal SimBQueueApplyEnqueue(SimBQueueStruct *queue, SimBQueueThreadState *th_state, ArgVal arg, int pid) {
+    ToggleVector *diffs = &th_state->diffs,
+                 *l_toggles = &th_state->l_toggles;
+    uint32_t cells;
+    SimBQueueEnqState *lsp_data, *sp_data;
+    pointer_t old_sp, new_sp;
+    uint64_t my_seq = ++th_state->enq_seq;
+    uint64_t head;
+    bool refreshed;
+    int i, j, prefix;
+    RetVal ret;
+
+    int mybank = TVEC_GET_BANK_OF_BIT(pid, queue->nthreads);
+    queue->announce[pid] = arg;                                                         // A Fetch&Add instruction follows soon, thus a barrier is needless
+    queue->enq_announce_seq[pid] = my_seq;
+    TVEC_REVERSE_BIT(&th_state->my_enq_bit, pid);
+    TVEC_NEGATIVE_BANK(&th_state->enq_toggle, &th_state->enq_toggle, mybank);
+    lsp_data = queue->enq_pool[pid * queue->pool_size + th_state->enq_local_index];
+    TVEC_ATOMIC_ADD_BANK(&queue->enqueuers, &th_state->enq_toggle, mybank);            // toggle pid's bit in enqueuers, Fetch&Add acts as a full write-barrier
+    SimBQueueBackoff(queue, th_state);
+
+    for (j = 0; j < 2; j++) {
+        old_sp = queue->enq_sp;
+        synchNonTSOFence();
+        sp_data = queue->enq_pool[old_sp.struct_data.index];
+        cells = queue->registry.active_cells;                                         // only these cells of the toggle vectors contain registered threads
+        TVEC_ATOMIC_COPY_BANKS(diffs, &sp_data->applied, mybank);
+        TVEC_XOR_BANKS(diffs, diffs, &th_state->my_enq_bit, mybank);                    // determine the set of active processes
+        if (TVEC_IS_SET(diffs, pid))                                                    // if the operation has already been applied return
+            break;
+        EnqStateCopy(queue, lsp_data, sp_data, cells);
+        synchNonTSOFence();
+        TVEC_COPY_CELLS(l_toggles, &queue->enqueuers, cells);                           // This is an atomic read, since enqueuers is volatile
+        if (old_sp.raw_data != queue->enq_sp.raw_data)
+            continue;
+        SimRetPublish(queue->enq_ret_slots, queue->ret_stride, lsp_data->ret, lsp_data->ret_size); // publish the return values of the previous attempt
+        lsp_data->ret_size = 0;
+        SimBQueueWrite(queue, lsp_data->pending, lsp_data->pending_size);               // write the elements of the previous attempt to the ring
+        lsp_data->pending_size = 0;
+        SimBQueueRaise(&queue->tail_hint, lsp_data->tail);
+        TVEC_XOR_CELLS(diffs, &lsp_data->applied, l_toggles, cells);
+        head = queue->head_hint;
+        refreshed = false;
+        for (i = 0, prefix = 0; i < cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
+            while (diffs->cell[i] != 0L) {
+                register int pos, proc_id;
+                SimRoundRet *entry;
+
+                pos = synchBitSearchFirst(diffs->cell[i]);
+                proc_id = prefix + pos;
+                diffs->cell[i] ^= ((bitword_t)1) << pos;
+                entry = &lsp_data->ret[lsp_data->ret_size++];
+                entry->pid = proc_id;
+                entry->index = 0;
+                entry->seq = queue->enq_announce_seq[proc_id];
+                if (lsp_data->tail - head >= queue->capacity && !refreshed) {         // the queue seems to be full, read the most recent head
+                    head = SimBQueueHelpDequeuers(queue);
+                    refreshed = true;
+                }
+                if (lsp_data->tail - head < queue->capacity) {
+                    lsp_data->pending[lsp_data->pending_size].seq = ++lsp_data->tail;   // slots are tagged with positions counting from 1
+                    lsp_data->pending[lsp_data->pending_size++].val = queue->announce[proc_id];
+                    entry->val = ENQUEUE_SUCCESS;
+                } else entry->val = ENQUEUE_FAIL;
+#ifdef DEBUG
+                lsp_data->counter += 1;
+#endif
+            }
+        }
+        TVEC_COPY_CELLS(&lsp_data->applied, l_toggles, cells);
+        new_sp.struct_data.seq = old_sp.struct_data.seq + 1;
+        new_sp.struct_data.index = pid * queue->pool_size + th_state->enq_local_index;
+        if (old_sp.raw_data == queue->enq_sp.raw_data && synchCAS64(&queue->enq_sp, old_sp.raw_data, new_sp.raw_data)) {
+            SimBQueueWrite(queue, lsp_data->pending, lsp_data->pending_size);           // make the new elements visible to the dequeuers
+            SimBQueueRaise(&queue->tail_hint, lsp_data->tail);
+            th_state->enq_local_index = (th_state->enq_local_index + 1) % queue->pool_size;
+            th_state->max_backoff = (th_state->max_backoff >> 1) | 1;
+            SimRetCollectFromList(lsp_data->ret, lsp_data->ret_size, pid, my_seq, &ret, 1);
+            return ret;
+        } else if (th_state->max_backoff < queue->MAX_BACK)
+            th_state->max_backoff <<= 1;
+    }
+    SimRetCollectFromCopy(&queue->enq_ret_slots[pid * queue->ret_stride], &queue->enq_sp, (void **)queue->enq_pool,
+                          offsetof(SimBQueueEnqState, ret), offsetof(SimBQueueEnqState, ret_size), queue->nthreads, pid, my_seq, &ret, 1);
+
+    return ret;
+}
+
+RetVal SimBQueueEnqueue(SimBQueueStruct *queue, SimBQueueThreadState *th_state, ArgVal arg, int pid) {
+    RetVal ret = SimBQueueApplyEnqueue(queue, th_state, arg, pid);
+
+    if (ret == ENQUEUE_SUCCESS)
+        synchEventCountNotifyAfterRMW(&queue->nonempty);
+    return ret;
+}
+
+RetVal SimBQueueDequeue(SimBQueueStruct *queue, SimBQueueThreadState *th_state, int pid) {
+    ToggleVector *diffs = &th_state->diffs,
+                 *l_toggles = &th_state->l_toggles;
+    uint32_t cells;
+    SimBQueueDeqState *lsp_data, *sp_data;
+    pointer_t old_sp, new_sp;
+    uint64_t my_seq = ++th_state->deq_seq;
+    uint64_t tail;
+    bool refreshed;
+    int i, j, prefix;
+    RetVal ret;
+
+    int mybank = TVEC_GET_BANK_OF_BIT(pid, queue->nthreads);
+    queue->deq_announce_seq[pid] = my_seq;                                              // A Fetch&Add instruction follows soon, thus a barrier is needless
+    TVEC_REVERSE_BIT(&th_state->my_deq_bit, pid);
+    TVEC_NEGATIVE_BANK(&th_state->deq_toggle, &th_state->deq_toggle, mybank);
+    lsp_data = queue->deq_pool[pid * queue->pool_size + th_state->deq_local_index];
+    TVEC_ATOMIC_ADD_BANK(&queue->dequeuers, &th_state->deq_toggle, mybank);            // toggle pid's bit in dequeuers, Fetch&Add acts as a full write-barrier
+    SimBQueueBackoff(queue, th_state);
+
+    for (j = 0; j < 2; j++) {
+        old_sp = queue->deq_sp;
+        synchNonTSOFence();
+        sp_data = queue->deq_pool[old_sp.struct_data.index];
+        cells = queue->registry.active_cells;                                         // only these cells of the toggle vectors contain registered threads
+        TVEC_ATOMIC_COPY_BANKS(diffs, &sp_data->applied, mybank);
+        TVEC_XOR_BANKS(diffs, diffs, &th_state->my_deq_bit, mybank);                    // determine the set of active processes
+        if (TVEC_IS_SET(diffs, pid))                                                    // if the operation has already been applied return
+            break;
+        DeqStateCopy(queue, lsp_data, sp_data, cells);
+        synchNonTSOFence();
+        TVEC_COPY_CELLS(l_toggles, &queue->dequeuers, cells);                           // This is an atomic read, since dequeuers is volatile
+        if (old_sp.raw_data != queue->deq_sp.raw_data)
+            continue;
+        SimRetPublish(queue->deq_ret_slots, queue->ret_stride, lsp_data->ret, lsp_data->ret_size); // publish the return values of the previous attempt
+        lsp_data->ret_size = 0;
+        TVEC_XOR_CELLS(diffs, &lsp_data->applied, l_toggles, cells);
+        tail = queue->tail_hint;
+        refreshed = false;
+        for (i = 0, prefix = 0; i < cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
+            while (diffs->cell[i] != 0L) {
+                register int pos, proc_id;
+                SimRoundRet *entry;
+
+                pos = synchBitSearchFirst(diffs->cell[i]);
+                proc_id = prefix + pos;
+                diffs->cell[i] ^= ((bitword_t)1) << pos;
+                entry = &lsp_data->ret[lsp_data->ret_size++];
+                entry->pid = proc_id;
+                entry->index = 0;
+                entry->seq = queue->deq_announce_seq[proc_id];
+                entry->val = EMPTY_QUEUE;
+                if (lsp_data->head >= tail && !refreshed) {                            // the queue seems to be empty, help the most recent enqueuers
+                    tail = SimBQueueHelpEnqueuers(queue, th_state);
+                    refreshed = true;
+                }
+                if (lsp_data->head < tail) {
+                    SimBQueueSlot *slot = &queue->ring[lsp_data->head & (queue->capacity - 1)];
+
+                    if (slot->seq == lsp_data->head + 1) {                              // otherwise, it is a stale read and this attempt is going to fail
+                        synchNonTSOFence();
+                        entry->val = slot->val;
+                        lsp_data->head++;
+                    }
+                }
+#ifdef DEBUG
+                lsp_data->counter += 1;
+#endif
+            }
+        }
+        TVEC_COPY_CELLS(&lsp_data->applied, l_toggles, cells);
+        new_sp.struct_data.seq = old_sp.struct_data.seq + 1;
+        new_sp.struct_data.index = pid * queue->pool_size + th_state->deq_local_index;
+        if (old_sp.raw_data == queue->deq_sp.raw_data && synchCAS64(&queue->deq_sp, old_sp.raw_data, new_sp.raw_data)) {
+            SimBQueueRaise(&queue->head_hint, lsp_data->head);                          // the slots before the new head could be reused by the enqueuers
+            th_state->deq_local_index = (th_state->deq_local_index + 1) % queue->pool_size;
+            th_state->max_backoff = (th_state->max_backoff >> 1) | 1;
+            SimRetCollectFromList(lsp_data->ret, lsp_data->ret_size, pid, my_seq, &ret, 1);
+            return ret;
+        } else if (th_state->max_backoff < queue->MAX_BACK)
+            th_state->max_backoff <<= 1;
+    }
+    SimRetCollectFromCopy(&queue->deq_ret_slots[pid * queue->ret_stride], &queue->deq_sp, (void **)queue->deq_pool,
+                          offsetof(SimBQueueDeqState, ret), offsetof(SimBQueueDeqState, ret_size), queue->nthreads, pid, my_seq, &ret, 1);
+
+    return ret;
+}
+
+static RetVal SimBQueueDequeueWait(SimBQueueStruct *queue, SimBQueueThreadState *th_state, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&queue->nonempty, ret, SimBQueueDequeue(queue, th_state, pid), EMPTY_QUEUE, deadline);
+
+    return ret;
+}
+
+RetVal SimBQueueDequeueBlocking(SimBQueueStruct *queue, SimBQueueThreadState *th_state, int pid) {
+    return SimBQueueDequeueWait(queue, th_state, NULL, pid);
+}
+
+RetVal SimBQueueDequeueTimed(SimBQueueStruct *queue, SimBQueueThreadState *th_state, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return SimBQueueDequeueWait(queue, th_state, &deadline, pid);
+}
@@ -2,10 +2,8 @@
 #include <fastrand.h>
 #include <threadtools.h>
 
-static const int LOCAL_POOL_SIZE = _SIM_LOCAL_POOL_SIZE_;
-
-static inline void EnqStateCopy(EnqState *dest, EnqState *src);
-static inline void DeqStateCopy(DeqState *dest, DeqState *src);
+static inline void EnqStateCopy(EnqState *dest, EnqState *src, uint32_t cells);
+static inline void DeqStateCopy(DeqState *dest, DeqState *src, uint32_t cells, uint32_t max_ret);
 static inline void EnqLinkQueue(SimQueueStruct *queue, EnqState *pst);
 static inline void DeqLinkQueue(SimQueueStruct *queue, DeqState *pst);
 
@@ -30,16 +28,21 @@ inline static void DeqLinkQueue(SimQueueStruct *queue, DeqState *pst) {
     }
 }
 
-static inline void EnqStateCopy(EnqState *dest, EnqState *src) {
-    // copy everything except 'applied'
+static inline void EnqStateCopy(EnqState *dest, EnqState *src, uint32_t cells) {
+    // copy everything except 'applied', and only the active cells of the applied toggles
     memcpy(&dest->copy_point, &src->copy_point,
-           EnqStateSize(src->applied.nthreads) - sizeof(ToggleVector));
+           offsetof(EnqState, __flex) - offsetof(EnqState, copy_point) + cells * sizeof(bitword_t));
 }
 
-static inline void DeqStateCopy(DeqState *dest, DeqState *src) {
-    // copy everything except 'applied' and 'ret' fields
+static inline void DeqStateCopy(DeqState *dest, DeqState *src, uint32_t cells, uint32_t max_ret) {
+    // copy everything except 'applied', 'ret' and 'ret_size' fields, and only the active cells of the applied toggles
     memcpy(&dest->copy_point, &src->copy_point,
-           DeqStateSize(src->applied.nthreads)- sizeof(ToggleVector) - sizeof(RetVal *));
+           offsetof(DeqState, __flex) - offsetof(DeqState, copy_point) + cells * sizeof(bitword_t));
+    // copy only the return values of the attempt that produced src
+    dest->ret_size = src->ret_size;
+    if (dest->ret_size > max_ret)                                                     // a stale read, this attempt is going to fail
+        dest->ret_size = 0;
+    memcpy(dest->ret, src->ret, dest->ret_size * sizeof(SimRoundRet));
 }
 
 void SimQueueThreadStateInit(SimQueueStruct *queue, SimQueueThreadState *th_state, int pid) {
@@ -63,18 +66,103 @@ void SimQueueThreadStateInit(SimQueueStruct *queue, SimQueueThreadState *th_stat
     th_state->deq_local_index = 0;
     th_state->enq_local_index = 0;
     th_state->max_backoff = 1;
+    th_state->deq_seq = 0;
+}
+
+void SimQueueStructSetDynamicThreads(SimQueueStruct *queue) {
+    SimRegistrySetDynamic(&queue->registry);
+}
+
+int SimQueueRegisterThread(SimQueueStruct *queue, SimQueueThreadState *th_state) {
+    int pid = SimRegistryAcquire(&queue->registry);
+    int32_t node;
+    int bank;
+
+    if (pid < 0)
+        return -1;
+    SimQueueThreadStateInit(queue, th_state, pid);
+    bank = TVEC_GET_BANK_OF_BIT(pid, queue->nthreads);
+    th_state->enq_local_index = queue->saved_enq_index[pid];                          // continue from the state left by the previous owner of pid
+    th_state->deq_local_index = queue->saved_deq_index[pid];
+    th_state->deq_seq = queue->deq_announce_seq[pid];
+    node = synchGetPreferredNumaNode();
+    if (node >= 0 && node != queue->pool_node[pid]) {                                  // move the pools of pid close to its new owner
+        synchMoveMemoryToNumaNode(queue->enq_pool[pid * queue->pool_size], queue->pool_size * queue->enq_record_size, node);
+        synchMoveMemoryToNumaNode(queue->deq_pool[pid * queue->pool_size], queue->pool_size * queue->deq_record_size, node);
+        queue->pool_node[pid] = node;
+    }
+    if (TVEC_IS_SET(&queue->enqueuers, pid)) {
+        TVEC_REVERSE_BIT(&th_state->my_enq_bit, pid);
+        TVEC_NEGATIVE_BANK(&th_state->enq_toggle, &th_state->enq_toggle, bank);
+    }
+    if (TVEC_IS_SET(&queue->dequeuers, pid)) {
+        TVEC_REVERSE_BIT(&th_state->my_deq_bit, pid);
+        TVEC_NEGATIVE_BANK(&th_state->deq_toggle, &th_state->deq_toggle, bank);
+    }
+
+    return pid;
+}
+
+void SimQueueDeregisterThread(SimQueueStruct *queue, SimQueueThreadState *th_state, int pid) {
+    queue->saved_enq_index[pid] = th_state->enq_local_index;
+    queue->saved_deq_index[pid] = th_state->deq_local_index;
+    TVEC_DESTROY(&th_state->mask);
+    TVEC_DESTROY(&th_state->deq_toggle);
+    TVEC_DESTROY(&th_state->my_deq_bit);
+    TVEC_DESTROY(&th_state->enq_toggle);
+    TVEC_DESTROY(&th_state->my_enq_bit);
+    TVEC_DESTROY(&th_state->diffs);
+    TVEC_DESTROY(&th_state->l_toggles);
+    SimRegistryRelease(&queue->registry, pid);                                        // CAS acts as a full write-barrier
 }
 
 void SimQueueStructInit(SimQueueStruct *queue, uint32_t nthreads, int max_backoff) {
-    pointer_t tmp_sp;
-    int i;
+    SimQueueStructInitPool(queue, nthreads, max_backoff, _SIM_LOCAL_POOL_SIZE_);
+}
 
+void SimQueueStructInitPool(SimQueueStruct *queue, uint32_t nthreads, int max_backoff, uint32_t pool_size) {
+    SimQueueStructInitBatch(queue, nthreads, max_backoff, 1, pool_size);
+    synchEventCountInit(&queue->nonempty);
+}
+
+void SimQueueStructInitBatch(SimQueueStruct *queue, uint32_t nthreads, int max_backoff, uint32_t max_batch, uint32_t pool_size) {
+    pointer_t tmp_sp;
+    uint32_t initial;
+    void *enq_slice, *deq_slice;
+    int i, k;
+
+    if (max_batch == 0)
+        max_batch = 1;
+    if (pool_size < 2)
+        pool_size = 2;
     queue->nthreads = nthreads;
-    queue->announce = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(ArgVal));
+    queue->pool_size = pool_size;
+    queue->max_batch = max_batch;
+    queue->enq_record_size = SIM_ALIGN_UP(EnqStateSize(nthreads), CACHE_LINE_SIZE);
+    // the list of return values (at most max_batch per thread) is stored after the copied part of DeqState
+    queue->deq_record_size = SIM_ALIGN_UP(DeqStateSize(nthreads) + nthreads * max_batch * sizeof(SimRoundRet), CACHE_LINE_SIZE);
+    queue->announce = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * max_batch * sizeof(ArgVal));
+    queue->announce_size = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(uint32_t));
+    queue->deq_announce_seq = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(uint64_t));
+    queue->deq_announce_size = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(uint32_t));
+    memset((void *)queue->deq_announce_seq, 0, nthreads * sizeof(uint64_t));
+    for (i = 0; i < nthreads; i++) {
+        queue->announce_size[i] = 1;
+        queue->deq_announce_size[i] = 1;
+    }
+    queue->ret_stride = SIM_RET_SLOTS_PER_THREAD(max_batch);
+    queue->ret_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * queue->ret_stride * sizeof(SimRetSlot));
+    memset(queue->ret_slots, 0, nthreads * queue->ret_stride * sizeof(SimRetSlot));
+    SimRegistryInit(&queue->registry, nthreads);
+    queue->saved_enq_index = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int));
+    queue->saved_deq_index = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int));
+    memset(queue->saved_enq_index, 0, nthreads * sizeof(int));
+    memset(queue->saved_deq_index, 0, nthreads * sizeof(int));
     TVEC_INIT_AT(&queue->enqueuers, nthreads, synchGetAlignedMemory(CACHE_LINE_SIZE, _TVEC_VECTOR_SIZE(nthreads)));
     TVEC_INIT_AT(&queue->dequeuers, nthreads, synchGetAlignedMemory(CACHE_LINE_SIZE, _TVEC_VECTOR_SIZE(nthreads)));
 
-    tmp_sp.struct_data.index = LOCAL_POOL_SIZE * nthreads;
+    initial = pool_size * nthreads;
+    tmp_sp.struct_data.index = initial;
     tmp_sp.struct_data.seq = 0L;
     queue->enq_sp = tmp_sp;
     queue->deq_sp = tmp_sp;
@@ -82,63 +170,77 @@ void SimQueueStructInit(SimQueueStruct *queue, uint32_t nthreads, int max_backof
     TVEC_SET_ZERO((ToggleVector *)&queue->enqueuers);
     TVEC_SET_ZERO((ToggleVector *)&queue->dequeuers);
 
-    queue->enq_pool = synchGetAlignedMemory(CACHE_LINE_SIZE, (LOCAL_POOL_SIZE * nthreads + 1) * sizeof(EnqState *));
-    queue->deq_pool = synchGetAlignedMemory(CACHE_LINE_SIZE, (LOCAL_POOL_SIZE * nthreads + 1) * sizeof(DeqState *));
-
-    for (i = 0; i < LOCAL_POOL_SIZE * nthreads + 1; i++) {
-        queue->enq_pool[i] = synchGetAlignedMemory(CACHE_LINE_SIZE, EnqStateSize(nthreads));
-        queue->deq_pool[i] = synchGetAlignedMemory(CACHE_LINE_SIZE, DeqStateSize(nthreads));
+    queue->pool_node = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int32_t));
+    queue->enq_pool = synchGetAlignedMemory(CACHE_LINE_SIZE, (initial + 1) * sizeof(EnqState *));
+    queue->deq_pool = synchGetAlignedMemory(CACHE_LINE_SIZE, (initial + 1) * sizeof(DeqState *));
+
+    for (i = 0; i < nthreads; i++) {
+        queue->pool_node[i] = synchPreferredNumaNodeOfThread(i);
+        enq_slice = synchGetMemoryOnNumaNode(pool_size * queue->enq_record_size, queue->pool_node[i]);
+        deq_slice = synchGetMemoryOnNumaNode(pool_size * queue->deq_record_size, queue->pool_node[i]);
+        for (k = 0; k < pool_size; k++) {
+            queue->enq_pool[i * pool_size + k] = enq_slice + k * queue->enq_record_size;
+            queue->deq_pool[i * pool_size + k] = deq_slice + k * queue->deq_record_size;
+        }
+    }
+    queue->enq_pool[initial] = synchGetAlignedMemory(CACHE_LINE_SIZE, queue->enq_record_size);
+    queue->deq_pool[initial] = synchGetAlignedMemory(CACHE_LINE_SIZE, queue->deq_record_size);
 
+    for (i = 0; i < initial + 1; i++) {
         TVEC_INIT_AT(&queue->enq_pool[i]->applied, nthreads, queue->enq_pool[i]->__flex);
         TVEC_INIT_AT(&queue->deq_pool[i]->applied, nthreads, queue->deq_pool[i]->__flex);
 
-        queue->deq_pool[i]->ret = ((void *)queue->deq_pool[i]->__flex) + _TVEC_VECTOR_SIZE(nthreads);
+        queue->deq_pool[i]->ret = ((void *)queue->deq_pool[i]) + DeqStateSize(nthreads);
+        queue->deq_pool[i]->ret_size = 0;
     }
 
     // Initializing queue's state
     // --------------------------
     queue->guard.val = GUARD_VALUE;
     queue->guard.next = NULL;
-    TVEC_SET_ZERO((ToggleVector *)&queue->enq_pool[LOCAL_POOL_SIZE * nthreads]->applied);
-    queue->enq_pool[LOCAL_POOL_SIZE * nthreads]->tail = &queue->guard;
-    queue->enq_pool[LOCAL_POOL_SIZE * nthreads]->first = NULL;
-    queue->enq_pool[LOCAL_POOL_SIZE * nthreads]->last = NULL;
-    TVEC_SET_ZERO((ToggleVector *)&queue->deq_pool[LOCAL_POOL_SIZE * nthreads]->applied);
-    queue->deq_pool[LOCAL_POOL_SIZE * nthreads]->head = &queue->guard;
+    TVEC_SET_ZERO((ToggleVector *)&queue->enq_pool[initial]->applied);
+    queue->enq_pool[initial]->tail = &queue->guard;
+    queue->enq_pool[initial]->first = NULL;
+    queue->enq_pool[initial]->last = NULL;
+    TVEC_SET_ZERO((ToggleVector *)&queue->deq_pool[initial]->applied);
+    queue->deq_pool[initial]->head = &queue->guard;
 #ifdef DEBUG
-    queue->enq_pool[LOCAL_POOL_SIZE * nthreads]->counter = 0L;
-    queue->deq_pool[LOCAL_POOL_SIZE * nthreads]->counter = 0L;
+    queue->enq_pool[initial]->counter = 0L;
+    queue->deq_pool[initial]->counter = 0L;
 #endif
     queue->MAX_BACK = max_backoff * 100;
 
     synchFullFence();
 }
 
-void SimQueueEnqueue(SimQueueStruct *queue, SimQueueThreadState *th_state, ArgVal arg, int pid) {
+// Applies an enqueue request of n elements, whose nodes are already linked from chain to chain_last (all of them are
+// allocated from pid's pool of nodes). It returns true in case that the chain is spliced to the queue, otherwise
+// (i.e. the request is applied by another thread) the nodes of the chain are not used.
+static inline bool SimQueueEnqueueRound(SimQueueStruct *queue, SimQueueThreadState *th_state, Node *chain, Node *chain_last, uint32_t n, int pid) {
     ToggleVector *diffs = &th_state->diffs,
                  *l_toggles = &th_state->l_toggles;
     pointer_t old_sp, new_sp;
     int i, j, enq_counter, prefix;
+    uint32_t cells, max_batch = queue->max_batch;
     EnqState *lsp_data, *sp_data;
-    Node *node, *llist;
+    Node *node;
 
     int mybank = TVEC_GET_BANK_OF_BIT(pid, queue->nthreads);
-    queue->announce[pid] = arg; // A Fetch&Add instruction follows soon, thus a barrier is needless
     TVEC_REVERSE_BIT(&th_state->my_enq_bit, pid);
     TVEC_NEGATIVE_BANK(&th_state->enq_toggle, &th_state->enq_toggle, mybank);
-    lsp_data = queue->enq_pool[pid * LOCAL_POOL_SIZE + th_state->enq_local_index];
+    lsp_data = queue->enq_pool[pid * queue->pool_size + th_state->enq_local_index];
     TVEC_ATOMIC_ADD_BANK(&queue->enqueuers, &th_state->enq_toggle, mybank); // toggle pid's bit in a_toggles, Fetch&Add acts as a full write-barrier
 
     if (!synchIsSystemOversubscribed()) {
         volatile int k;
         int backoff_limit;
 
-        if (synchFastRandomRange(1, queue->nthreads) > 1) {
+        if (synchFastRandomRange(1, queue->registry.threads) > 1) {
             backoff_limit = synchFastRandomRange(th_state->max_backoff >> 1, th_state->max_backoff);
             for (k = 0; k < backoff_limit; k++)
                 ;
         }
-    } else if (synchFastRandomRange(1, queue->nthreads) > 4) {
+    } else if (synchFastRandomRange(1, queue->registry.threads) > 4) {
         synchResched();
     }
 
@@ -146,55 +248,60 @@ void SimQueueEnqueue(SimQueueStruct *queue, SimQueueThreadState *th_state, ArgVa
         old_sp = queue->enq_sp;
         synchNonTSOFence();
         sp_data = queue->enq_pool[old_sp.struct_data.index];
+        cells = queue->registry.active_cells;                                         // only these cells of the toggle vectors contain registered threads
         TVEC_ATOMIC_COPY_BANKS(diffs, &sp_data->applied, mybank);
         TVEC_XOR_BANKS(diffs, diffs, &th_state->my_enq_bit, mybank); // determine the set of active processes
         if (TVEC_IS_SET(diffs, pid))                             // if the operation has already been applied return
             break;
-        EnqStateCopy(lsp_data, sp_data);
-        TVEC_COPY(l_toggles, &queue->enqueuers); // This is an atomic read, since sp is volatile
+        EnqStateCopy(lsp_data, sp_data, cells);
+        TVEC_COPY_CELLS(l_toggles, &queue->enqueuers, cells); // This is an atomic read, since sp is volatile
         if (old_sp.raw_data != queue->enq_sp.raw_data)
             continue;
-        TVEC_XOR(diffs, &lsp_data->applied, l_toggles);
+        TVEC_XOR_CELLS(diffs, &lsp_data->applied, l_toggles, cells);
 
         EnqLinkQueue(queue, lsp_data);
-        enq_counter = 1;
-        node = synchAllocObj(&th_state->pool_node);
+        enq_counter = 0;                                                              // the number of nodes allocated by this attempt
+        node = chain_last;                                                            // pid's chain is private, until this attempt succeeds
         node->next = NULL;
-        node->val = arg;
-        llist = node;
         TVEC_REVERSE_BIT(diffs, pid);
 #ifdef DEBUG
-        lsp_data->counter += 1;
+        lsp_data->counter += n;
 #endif
-        for (i = 0, prefix = 0; i < diffs->tvec_cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
+        for (i = 0, prefix = 0; i < cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
             while (diffs->cell[i] != 0L) {
                 register int pos, proc_id;
+                uint32_t size, m;
 
                 pos = synchBitSearchFirst(diffs->cell[i]);
                 proc_id = prefix + pos;
-                enq_counter++;
+                size = queue->announce_size[proc_id];
+                if (size > max_batch)                                                 // a stale read, this attempt is going to fail
+                    size = max_batch;
+                enq_counter += size;
 #ifdef DEBUG
-                lsp_data->counter += 1;
+                lsp_data->counter += size;
 #endif
-                node->next = synchAllocObj(&th_state->pool_node);
-                node = (Node *)node->next;
-                node->next = NULL;
-                node->val = queue->announce[proc_id];
+                for (m = 0; m < size; m++) {
+                    node->next = synchAllocObj(&th_state->pool_node);
+                    node = (Node *)node->next;
+                    node->next = NULL;
+                    node->val = queue->announce[proc_id * max_batch + m];
+                }
                 diffs->cell[i] ^= ((bitword_t)1) << pos;
             }
         }
 
         lsp_data->first = lsp_data->tail;
-        lsp_data->last = llist;
+        lsp_data->last = chain;
         lsp_data->tail = node;
-        TVEC_COPY(&lsp_data->applied, l_toggles);
+        TVEC_COPY_CELLS(&lsp_data->applied, l_toggles, cells);
         new_sp.struct_data.seq = old_sp.struct_data.seq + 1;
-        new_sp.struct_data.index = pid * LOCAL_POOL_SIZE + th_state->enq_local_index;
+        new_sp.struct_data.index = pid * queue->pool_size + th_state->enq_local_index;
         if (old_sp.raw_data == queue->enq_sp.raw_data && synchCAS64(&queue->enq_sp, old_sp.raw_data, new_sp.raw_data)) {
             EnqLinkQueue(queue, lsp_data);
-            th_state->enq_local_index = (th_state->enq_local_index + 1) % LOCAL_POOL_SIZE;
+            th_state->enq_local_index = (th_state->enq_local_index + 1) % queue->pool_size;
             th_state->max_backoff = (th_state->max_backoff >> 1) | 1;
-            return;
+            return true;
         } else {
             if (th_state->max_backoff < queue->MAX_BACK)
                 th_state->max_backoff <<= 1;
@@ -202,33 +309,74 @@ void SimQueueEnqueue(SimQueueStruct *queue, SimQueueThreadState *th_state, ArgVa
         }
     }
 
-    return;
+    return false;
 }
 
-RetVal SimQueueDequeue(SimQueueStruct *queue, SimQueueThreadState *th_state, int pid) {
+void SimQueueEnqueue(SimQueueStruct *queue, SimQueueThreadState *th_state, ArgVal arg, int pid) {
+    Node *node = synchAllocObj(&th_state->pool_node);
+
+    node->val = arg;
+    queue->announce[pid * queue->max_batch] = arg;                                    // A Fetch&Add instruction follows soon, thus a barrier is needless
+    if (queue->max_batch > 1)
+        queue->announce_size[pid] = 1;
+    if (!SimQueueEnqueueRound(queue, th_state, node, node, 1, pid))
+        synchRollback(&th_state->pool_node, 1);
+    synchEventCountNotifyAfterRMW(&queue->nonempty);
+}
+
+void SimQueueEnqueueBatch(SimQueueStruct *queue, SimQueueThreadState *th_state, ArgVal *values, uint32_t n, int pid) {
+    uint32_t max_batch = queue->max_batch;
+    uint32_t size, k;
+    Node *chain, *node;
+
+    while (n > 0) {
+        size = (n < max_batch) ? n : max_batch;
+        chain = node = synchAllocObj(&th_state->pool_node);                           // link the nodes of the batch before announcing it
+        node->val = values[0];
+        queue->announce[pid * max_batch] = values[0];
+        for (k = 1; k < size; k++) {
+            node->next = synchAllocObj(&th_state->pool_node);
+            node = (Node *)node->next;
+            node->val = values[k];
+            queue->announce[pid * max_batch + k] = values[k];
+        }
+        queue->announce_size[pid] = size;
+        if (!SimQueueEnqueueRound(queue, th_state, chain, node, size, pid))
+            synchRollback(&th_state->pool_node, size);
+        values += size;
+        n -= size;
+    }
+    synchEventCountNotifyAfterRMW(&queue->nonempty);
+}
+
+// Applies a dequeue request of n elements and stores their values (or EMPTY_QUEUE) to rets.
+static inline void SimQueueDequeueRound(SimQueueStruct *queue, SimQueueThreadState *th_state, RetVal *rets, uint32_t n, int pid) {
     ToggleVector *diffs = &th_state->diffs,
                  *l_toggles = &th_state->l_toggles;
     DeqState *lsp_data, *sp_data;
     int i, j, prefix;
+    uint32_t cells, max_batch = queue->max_batch;
     pointer_t old_sp, new_sp;
     volatile Node *node;
+    uint64_t my_seq = ++th_state->deq_seq;
 
     int mybank = TVEC_GET_BANK_OF_BIT(pid, queue->nthreads);
+    queue->deq_announce_seq[pid] = my_seq;                                            // A Fetch&Add instruction follows soon, thus a barrier is needless
     TVEC_REVERSE_BIT(&th_state->my_deq_bit, pid);
     TVEC_NEGATIVE_BANK(&th_state->deq_toggle, &th_state->deq_toggle, mybank);
-    lsp_data = queue->deq_pool[pid * LOCAL_POOL_SIZE + th_state->deq_local_index];
+    lsp_data = queue->deq_pool[pid * queue->pool_size + th_state->deq_local_index];
     TVEC_ATOMIC_ADD_BANK(&queue->dequeuers, &th_state->deq_toggle, mybank); // toggle pid's bit in a_toggles, Fetch&Add acts as a full write-barrier
 
     if (!synchIsSystemOversubscribed()) {
         volatile int k;
         int backoff_limit;
 
-        if (synchFastRandomRange(1, queue->nthreads) > 1) {
+        if (synchFastRandomRange(1, queue->registry.threads) > 1) {
             backoff_limit = synchFastRandomRange(th_state->max_backoff >> 1, th_state->max_backoff);
             for (k = 0; k < backoff_limit; k++)
                 ;
         }
-    } else if (synchFastRandomRange(1, queue->nthreads) > 4) {
+    } else if (synchFastRandomRange(1, queue->registry.threads) > 4) {
         synchResched();
     }
 
@@ -236,47 +384,110 @@ RetVal SimQueueDequeue(SimQueueStruct *queue, SimQueueThreadState *th_state, int
         old_sp = queue->deq_sp;
         synchNonTSOFence();
         sp_data = queue->deq_pool[old_sp.struct_data.index];
+        cells = queue->registry.active_cells;                                         // only these cells of the toggle vectors contain registered threads
         TVEC_ATOMIC_COPY_BANKS(diffs, &sp_data->applied, mybank);
         TVEC_XOR_BANKS(diffs, diffs, &th_state->my_deq_bit, mybank);        // determine the set of active processes
         if (TVEC_IS_SET(diffs, pid))                                                  // if the operation has already been applied return
             break;
-        DeqStateCopy(lsp_data, sp_data);
-        TVEC_COPY(l_toggles, &queue->dequeuers);                                      // This is an atomic read, since sp is volatile
+        DeqStateCopy(lsp_data, sp_data, cells, queue->nthreads * max_batch);
+        TVEC_COPY_CELLS(l_toggles, &queue->dequeuers, cells);                         // This is an atomic read, since sp is volatile
 
         if (old_sp.raw_data != queue->deq_sp.raw_data)
             continue;
-        TVEC_XOR(diffs, &lsp_data->applied, l_toggles);
+        SimRetPublish(queue->ret_slots, queue->ret_stride, lsp_data->ret, lsp_data->ret_size); // publish the return values of the previous attempt
+        lsp_data->ret_size = 0;
+        TVEC_XOR_CELLS(diffs, &lsp_data->applied, l_toggles, cells);
         DeqLinkQueue(queue, lsp_data);
-        for (i = 0, prefix = 0; i < diffs->tvec_cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
+        for (i = 0, prefix = 0; i < cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
             while (diffs->cell[i] != 0L) {
                 register int pos, proc_id;
+                uint32_t size, m;
+                uint64_t seq;
 
                 pos = synchBitSearchFirst(diffs->cell[i]);
                 proc_id = prefix + pos;
+                size = queue->deq_announce_size[proc_id];
+                if (size > max_batch)                                                 // a stale read, this attempt is going to fail
+                    size = max_batch;
+                seq = queue->deq_announce_seq[proc_id];
 #ifdef DEBUG
-                lsp_data->counter += 1;
+                lsp_data->counter += size;
 #endif
-                node = lsp_data->head->next;
-                if (node == NULL) DeqLinkQueue(queue, lsp_data);
-                node = lsp_data->head->next;
-                if (node != NULL) {
-                    lsp_data->ret[proc_id] = node->val;
-                    lsp_data->head = (Node *)node;
-                } else lsp_data->ret[proc_id] = EMPTY_QUEUE;
+                for (m = 0; m < size; m++) {                                          // detach up to size nodes from the front of the queue
+                    SimRoundRet *entry = &lsp_data->ret[lsp_data->ret_size++];
+
+                    entry->pid = proc_id;
+                    entry->index = m;
+                    entry->seq = seq;
+                    node = lsp_data->head->next;
+                    if (node == NULL) DeqLinkQueue(queue, lsp_data);
+                    node = lsp_data->head->next;
+                    if (node != NULL) {
+                        entry->val = node->val;
+                        lsp_data->head = (Node *)node;
+                    } else entry->val = EMPTY_QUEUE;
+                }
 
                 diffs->cell[i] ^= ((bitword_t)1) << pos;
             }
         }
-        TVEC_COPY(&lsp_data->applied, l_toggles);
+        TVEC_COPY_CELLS(&lsp_data->applied, l_toggles, cells);
         new_sp.struct_data.seq = old_sp.struct_data.seq + 1;
-        new_sp.struct_data.index = pid * LOCAL_POOL_SIZE + th_state->deq_local_index;
+        new_sp.struct_data.index = pid * queue->pool_size + th_state->deq_local_index;
         if (old_sp.raw_data == queue->deq_sp.raw_data && synchCAS64(&queue->deq_sp, old_sp.raw_data, new_sp.raw_data)) {
-            th_state->deq_local_index = (th_state->deq_local_index + 1) % LOCAL_POOL_SIZE;
+            th_state->deq_local_index = (th_state->deq_local_index + 1) % queue->pool_size;
             th_state->max_backoff = (th_state->max_backoff >> 1) | 1;
-            return lsp_data->ret[pid];
+            SimRetCollectFromList(lsp_data->ret, lsp_data->ret_size, pid, my_seq, rets, n);
+            return;
         } else if (th_state->max_backoff < queue->MAX_BACK)
             th_state->max_backoff <<= 1;
     }
 
-    return queue->deq_pool[queue->deq_sp.struct_data.index]->ret[pid];
+    SimRetCollectFromCopy(&queue->ret_slots[pid * queue->ret_stride], &queue->deq_sp, (void **)queue->deq_pool, offsetof(DeqState, ret),
+                          offsetof(DeqState, ret_size), queue->nthreads * queue->max_batch, pid, my_seq, rets, n);
+}
+
+RetVal SimQueueDequeue(SimQueueStruct *queue, SimQueueThreadState *th_state, int pid) {
+    RetVal ret;
+
+    if (queue->max_batch > 1)
+        queue->deq_announce_size[pid] = 1;
+    SimQueueDequeueRound(queue, th_state, &ret, 1, pid);
+
+    return ret;
+}
+
+uint32_t SimQueueDequeueBatch(SimQueueStruct *queue, SimQueueThreadState *th_state, RetVal *out, uint32_t max, int pid) {
+    uint32_t size, k, count = 0;
+
+    while (count < max) {
+        size = (max - count < queue->max_batch) ? max - count : queue->max_batch;
+        queue->deq_announce_size[pid] = size;
+        SimQueueDequeueRound(queue, th_state, out + count, size, pid);
+        for (k = 0; k < size && out[count] != EMPTY_QUEUE; k++)                       // the removed elements precede the EMPTY_QUEUE values
+            count++;
+        if (k < size)
+            break;
+    }
+
+    return count;
+}
+
+static RetVal SimQueueDequeueWait(SimQueueStruct *queue, SimQueueThreadState *th_state, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&queue->nonempty, ret, SimQueueDequeue(queue, th_state, pid), EMPTY_QUEUE, deadline);
+
+    return ret;
+}
+
+RetVal SimQueueDequeueBlocking(SimQueueStruct *queue, SimQueueThreadState *th_state, int pid) {
+    return SimQueueDequeueWait(queue, th_state, NULL, pid);
+}
+
+RetVal SimQueueDequeueTimed(SimQueueStruct *queue, SimQueueThreadState *th_state, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return SimQueueDequeueWait(queue, th_state, &deadline, pid);
 }
@@ -0,0 +1,298 @@
+#include <simshard.h>
+#include <fastrand.h>
+#include <threadtools.h>
+
+#define SIM_SHARD_BLOCK(S, B) ((void *)((char *)(S)->blocks + (uint64_t)(B) * (S)->block_size))
+
+void synchSimShardStructInit(SimShardStruct *shard_struct, uint32_t nthreads, int max_backoff, uint32_t nshards, uint32_t shard_size, void (*shard_init)(void *, uint32_t)) {
+    uint32_t ret_offset, tvec_offset, initial, level_first, level_size, tree_blocks, next, i, k;
+    void *slice;
+
+    if (nshards == 0)
+        nshards = 1;
+    shard_struct->nthreads = nthreads;
+    shard_struct->pool_size = _SIM_LOCAL_POOL_SIZE_;
+    shard_struct->nshards = nshards;
+    shard_struct->shard_stride = SIM_ALIGN_UP(shard_size == 0 ? 1 : shard_size, sizeof(uint64_t));
+    shard_struct->block_size = SIM_ALIGN_UP(shard_struct->shard_stride, CACHE_LINE_SIZE);
+    shard_struct->shards_per_block = shard_struct->block_size / shard_struct->shard_stride;
+
+    // Shape of the radix tree: the leaves are followed by the inner nodes of each level (bottom-up) and the root is
+    // the last block of the tree. The tree has at least one level of inner nodes. Each attempt copies at most one
+    // block per level for each request, thus each thread owns min(nthreads, blocks of the level) blocks per level.
+    level_size = (nshards + shard_struct->shards_per_block - 1) / shard_struct->shards_per_block;
+    tree_blocks = level_size;
+    shard_struct->blocks_per_thread = (level_size < nthreads) ? level_size : nthreads;
+    shard_struct->depth = 0;
+    do {
+        level_size = (level_size + SIM_SHARD_FANOUT - 1) / SIM_SHARD_FANOUT;
+        tree_blocks += level_size;
+        shard_struct->blocks_per_thread += (level_size < nthreads) ? level_size : nthreads;
+        shard_struct->depth++;
+    } while (level_size > 1);
+    shard_struct->nblocks = tree_blocks + nthreads * shard_struct->blocks_per_thread;
+    shard_struct->blocks = synchGetAlignedMemory(CACHE_LINE_SIZE, (uint64_t)shard_struct->nblocks * shard_struct->block_size);
+    shard_struct->block_tag = synchGetAlignedMemory(CACHE_LINE_SIZE, shard_struct->nblocks * sizeof(uint64_t));
+    for (i = 0; i < shard_struct->nblocks; i++)
+        shard_struct->block_tag[i] = 0;
+
+    // Layout of each copy: [SimShardRecord][applied toggles][list of return values]
+    tvec_offset = SIM_ALIGN_UP(sizeof(SimShardRecord), sizeof(uint64_t));
+    ret_offset = SIM_ALIGN_UP(tvec_offset + _TVEC_VECTOR_SIZE(nthreads), sizeof(uint64_t));
+    shard_struct->record_size = SIM_ALIGN_UP(ret_offset + nthreads * sizeof(SimRoundRet), CACHE_LINE_SIZE);
+
+    TVEC_INIT_AT((ToggleVector *)&shard_struct->a_toggles, nthreads, synchGetAlignedMemory(CACHE_LINE_SIZE, _TVEC_VECTOR_SIZE(nthreads)));
+    shard_struct->announce = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(SimShardAnnounce));
+    for (i = 0; i < nthreads; i++) {
+        shard_struct->announce[i].seq = 0;
+        shard_struct->announce[i].arg = 0;
+        shard_struct->announce[i].shard = 0;
+    }
+    shard_struct->ret_stride = SIM_RET_SLOTS_PER_THREAD(1);
+    shard_struct->ret_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * shard_struct->ret_stride * sizeof(SimRetSlot));
+    memset(shard_struct->ret_slots, 0, nthreads * shard_struct->ret_stride * sizeof(SimRetSlot));
+
+    initial = shard_struct->pool_size * nthreads;
+    shard_struct->pool = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimShardRecord *) * (initial + 1));
+    for (i = 0; i < nthreads; i++) {
+        slice = synchGetMemoryOnNumaNode(shard_struct->pool_size * shard_struct->record_size, synchPreferredNumaNodeOfThread(i));
+        for (k = 0; k < shard_struct->pool_size; k++)
+            shard_struct->pool[i * shard_struct->pool_size + k] = slice + k * shard_struct->record_size;
+    }
+    shard_struct->pool[initial] = synchGetAlignedMemory(CACHE_LINE_SIZE, shard_struct->record_size);
+    for (i = 0; i < initial + 1; i++) {
+        TVEC_INIT_AT(&shard_struct->pool[i]->applied, nthreads, ((void *)shard_struct->pool[i]) + tvec_offset);
+        shard_struct->pool[i]->ret = ((void *)shard_struct->pool[i]) + ret_offset;
+        shard_struct->pool[i]->ret_size = 0;
+    }
+
+    // OBJECT'S INITIAL VALUE
+    // ----------------------
+    level_size = (nshards + shard_struct->shards_per_block - 1) / shard_struct->shards_per_block;
+    memset(shard_struct->blocks, 0, (uint64_t)tree_blocks * shard_struct->block_size);
+    if (shard_init != NULL) {
+        for (i = 0; i < nshards; i++)
+            shard_init(SIM_SHARD_BLOCK(shard_struct, i / shard_struct->shards_per_block) + (i % shard_struct->shards_per_block) * shard_struct->shard_stride, i);
+    }
+    for (level_first = 0, next = level_size, k = 0; k < shard_struct->depth; k++) {
+        for (i = 0; i < level_size; i++)
+            ((uint32_t *)SIM_SHARD_BLOCK(shard_struct, next + i / SIM_SHARD_FANOUT))[i % SIM_SHARD_FANOUT] = level_first + i;
+        level_first = next;
+        level_size = (level_size + SIM_SHARD_FANOUT - 1) / SIM_SHARD_FANOUT;
+        next += level_size;
+    }
+    shard_struct->pool[initial]->root = level_first;
+    TVEC_SET_ZERO((ToggleVector *)&shard_struct->pool[initial]->applied);
+#ifdef DEBUG
+    shard_struct->pool[initial]->counter = 0;
+    shard_struct->pool[initial]->rounds = 0;
+#endif
+    shard_struct->sp.struct_data.index = initial;
+    shard_struct->sp.struct_data.seq = 0;
+    shard_struct->MAX_BACK = max_backoff * 100;
+    synchFullFence();
+}
+
+void SimShardThreadStateInit(SimShardStruct *shard_struct, SimShardThreadState *th_state, int pid) {
+    uint32_t nthreads = shard_struct->nthreads;
+    uint32_t first = shard_struct->nblocks - (nthreads - pid) * shard_struct->blocks_per_thread;
+    uint32_t i;
+
+    TVEC_INIT(&th_state->mask, nthreads);
+    TVEC_INIT(&th_state->toggle, nthreads);
+    TVEC_INIT(&th_state->my_bit, nthreads);
+    TVEC_INIT(&th_state->diffs, nthreads);
+    TVEC_INIT(&th_state->l_toggles, nthreads);
+
+    TVEC_REVERSE_BIT(&th_state->my_bit, pid);
+    TVEC_SET_BIT(&th_state->mask, pid);
+    TVEC_NEGATIVE(&th_state->toggle, &th_state->mask);
+    th_state->local_index = 0;
+    th_state->backoff = 1;
+    th_state->seq = 0;
+    th_state->tag = pid;
+    th_state->copied = 0;
+    th_state->fresh = synchGetAlignedMemory(CACHE_LINE_SIZE, shard_struct->blocks_per_thread * sizeof(uint32_t));
+    th_state->replaced = synchGetAlignedMemory(CACHE_LINE_SIZE, shard_struct->blocks_per_thread * sizeof(uint32_t));
+    th_state->requests = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(SimShardRequest));
+    // the blocks of pid form its initial list of free blocks; the next pointers are stored in the free blocks
+    th_state->free_head = first;
+    for (i = 0; i < shard_struct->blocks_per_thread; i++)
+        *(uint32_t *)SIM_SHARD_BLOCK(shard_struct, first + i) = (i + 1 < shard_struct->blocks_per_thread) ? first + i + 1 : SIM_SHARD_NULL_BLOCK;
+}
+
+static inline void SimShardFreeBlock(SimShardStruct *shard_struct, SimShardThreadState *th_state, uint32_t block) {
+    *(uint32_t *)SIM_SHARD_BLOCK(shard_struct, block) = th_state->free_head;
+    th_state->free_head = block;
+}
+
+// Copies the blocks on the path from the root (stored in *slot) to the leaf of shard that have not been copied yet
+// by the current attempt and returns the address of the state of shard in the copied leaf. In case of a stale read
+// (i.e. the attempt is going to fail), NULL is returned.
+static inline void *SimShardCopyPath(SimShardStruct *shard_struct, SimShardThreadState *th_state, uint32_t *slot, uint32_t shard) {
+    uint32_t leaf = shard / shard_struct->shards_per_block;
+    uint32_t block, copy, level;
+    void *addr;
+
+    for (level = shard_struct->depth + 1; level > 0; level--) {
+        block = *slot;
+        if (block >= shard_struct->nblocks)                                             // a stale read
+            return NULL;
+        if (shard_struct->block_tag[block] != th_state->tag) {                          // the block has not been copied by this attempt
+            copy = th_state->free_head;
+            if (copy == SIM_SHARD_NULL_BLOCK)                                           // it happens only after stale reads
+                return NULL;
+            th_state->free_head = *(uint32_t *)SIM_SHARD_BLOCK(shard_struct, copy);
+            memcpy(SIM_SHARD_BLOCK(shard_struct, copy), SIM_SHARD_BLOCK(shard_struct, block), shard_struct->block_size);
+            shard_struct->block_tag[copy] = th_state->tag;
+            th_state->fresh[th_state->copied] = copy;
+            th_state->replaced[th_state->copied++] = block;
+            *slot = copy;
+            block = copy;
+        }
+        addr = SIM_SHARD_BLOCK(shard_struct, block);
+        if (level > 1)
+            slot = &((uint32_t *)addr)[(leaf >> ((level - 2) * SIM_SHARD_FANOUT_BITS)) & (SIM_SHARD_FANOUT - 1)];
+    }
+
+    return addr + (shard % shard_struct->shards_per_block) * shard_struct->shard_stride;
+}
+
+RetVal SimShardApplyOp(SimShardStruct *shard_struct, SimShardThreadState *th_state, RetVal (*sfunc)(void *, ArgVal, int), uint32_t shard, ArgVal arg, int pid) {
+    ToggleVector *diffs = &th_state->diffs, *l_toggles = &th_state->l_toggles;
+    SimShardRequest *requests = th_state->requests;
+    SimShardRecord *sp_data, *lsp_data;
+    pointer_t old_sp, new_sp;
+    uint64_t my_seq = ++th_state->seq;
+    uint32_t cells = _TVEC_CELLS_(shard_struct->nthreads);
+    uint32_t nrequests, m;
+    int i, j, prefix, mybank;
+    bool stale;
+    RetVal ret;
+
+    shard_struct->announce[pid].shard = shard;                                          // announce the request
+    shard_struct->announce[pid].arg = arg;
+    shard_struct->announce[pid].seq = my_seq;
+    synchNonTSOFence();
+    mybank = TVEC_GET_BANK_OF_BIT(pid, shard_struct->nthreads);
+    TVEC_REVERSE_BIT(&th_state->my_bit, pid);
+    TVEC_NEGATIVE_BANK(&th_state->toggle, &th_state->toggle, mybank);
+    lsp_data = shard_struct->pool[pid * shard_struct->pool_size + th_state->local_index];
+    TVEC_ATOMIC_ADD_BANK(&shard_struct->a_toggles, &th_state->toggle, mybank);          // toggle pid's bit in a_toggles, Fetch&Add acts as a full write-barrier
+
+    if (!synchIsSystemOversubscribed()) {
+        volatile int k;
+        int backoff_limit;
+
+        if (synchFastRandomRange(1, shard_struct->nthreads) > 1) {
+            backoff_limit = th_state->backoff;
+            for (k = 0; k < backoff_limit; k++)
+                ;
+        }
+    } else if (synchFastRandomRange(1, shard_struct->nthreads) > 4)
+        synchResched();
+
+    for (j = 0; j < 2; j++) {
+        old_sp = shard_struct->sp;
+        synchNonTSOFence();
+        sp_data = shard_struct->pool[old_sp.struct_data.index];
+        TVEC_ATOMIC_COPY_BANKS(diffs, &sp_data->applied, mybank);
+        TVEC_XOR_BANKS(diffs, diffs, &th_state->my_bit, mybank);                        // determine the set of active processes
+        if (TVEC_IS_SET(diffs, pid))                                                    // if the operation has already been applied return
+            break;
+        // copy the metadata of the current copy; the blocks of the touched shards are copied below
+        lsp_data->root = sp_data->root;
+        TVEC_COPY_CELLS(&lsp_data->applied, &sp_data->applied, cells);
+        lsp_data->ret_size = sp_data->ret_size;
+        if (lsp_data->ret_size > shard_struct->nthreads)                                // a stale read, this attempt is going to fail
+            lsp_data->ret_size = 0;
+        memcpy(lsp_data->ret, sp_data->ret, lsp_data->ret_size * sizeof(SimRoundRet));
+#ifdef DEBUG
+        lsp_data->counter = sp_data->counter;
+        lsp_data->rounds = sp_data->rounds;
+#endif
+        synchNonTSOFence();
+        TVEC_COPY_CELLS(l_toggles, (ToggleVector *)&shard_struct->a_toggles, cells);   // This is an atomic read, since a_toogles is volatile
+        TVEC_XOR_CELLS(diffs, &lsp_data->applied, l_toggles, cells);
+
+        // collect the announced requests (pid's request first) and copy the paths to the shards they touch
+        th_state->tag += shard_struct->nthreads;
+        th_state->copied = 0;
+        requests[0].pid = pid;
+        requests[0].seq = my_seq;
+        requests[0].arg = arg;
+        requests[0].state = SimShardCopyPath(shard_struct, th_state, &lsp_data->root, shard);
+        stale = (requests[0].state == NULL);
+        nrequests = 1;
+        TVEC_REVERSE_BIT(diffs, pid);
+        for (i = 0, prefix = 0; i < cells && !stale; i++, prefix += _TVEC_BIWORD_SIZE_) {
+            while (diffs->cell[i] != 0L) {
+                register int pos, proc_id;
+                uint32_t proc_shard;
+
+                pos = synchBitSearchFirst(diffs->cell[i]);
+                proc_id = prefix + pos;
+                diffs->cell[i] ^= ((bitword_t)1) << pos;
+                proc_shard = shard_struct->announce[proc_id].shard;
+                requests[nrequests].pid = proc_id;
+                requests[nrequests].seq = shard_struct->announce[proc_id].seq;
+                requests[nrequests].arg = shard_struct->announce[proc_id].arg;
+                requests[nrequests].state = (proc_shard < shard_struct->nshards) ? SimShardCopyPath(shard_struct, th_state, &lsp_data->root, proc_shard) : NULL;
+                if (requests[nrequests++].state == NULL) {                              // a stale read, this attempt is going to fail
+                    stale = true;
+                    break;
+                }
+            }
+        }
+        synchNonTSOFence();
+        if (stale || old_sp.raw_data != shard_struct->sp.raw_data) {
+            for (m = 0; m < th_state->copied; m++)
+                SimShardFreeBlock(shard_struct, th_state, th_state->fresh[m]);
+            continue;
+        }
+        SimRetPublish(shard_struct->ret_slots, shard_struct->ret_stride, lsp_data->ret, lsp_data->ret_size); // publish the return values of the previous attempt
+        lsp_data->ret_size = 0;
+        for (m = 0; m < nrequests; m++) {
+            SimRoundRet *entry = &lsp_data->ret[lsp_data->ret_size++];
+
+            entry->pid = requests[m].pid;
+            entry->index = 0;
+            entry->seq = requests[m].seq;
+            entry->val = sfunc(requests[m].state, requests[m].arg, requests[m].pid);
+        }
+#ifdef DEBUG
+        lsp_data->rounds++;
+        lsp_data->counter += nrequests;
+#endif
+        TVEC_COPY_CELLS(&lsp_data->applied, l_toggles, cells);                          // change applied to be equal to what was read in a_toggles
+        new_sp.struct_data.seq = old_sp.struct_data.seq + 1;                            // increase timestamp
+        new_sp.struct_data.index = shard_struct->pool_size * pid + th_state->local_index;
+        if (old_sp.raw_data == shard_struct->sp.raw_data && synchCAS64(&shard_struct->sp, old_sp.raw_data, new_sp.raw_data)) {
+            th_state->local_index = (th_state->local_index + 1) % shard_struct->pool_size;
+            th_state->backoff = (th_state->backoff >> 1) | 1;
+            for (m = 0; m < th_state->copied; m++)                                      // the replaced blocks are no longer reachable from sp
+                SimShardFreeBlock(shard_struct, th_state, th_state->replaced[m]);
+            return lsp_data->ret[0].val;
+        }
+        for (m = 0; m < th_state->copied; m++)
+            SimShardFreeBlock(shard_struct, th_state, th_state->fresh[m]);
+        if (th_state->backoff < shard_struct->MAX_BACK)
+            th_state->backoff <<= 1;
+    }
+    // return the value found either in the current copy or in pid's result slots
+    SimRetCollectFromCopy(&shard_struct->ret_slots[pid * shard_struct->ret_stride], &shard_struct->sp, (void **)shard_struct->pool,
+                          offsetof(SimShardRecord, ret), offsetof(SimShardRecord, ret_size), shard_struct->nthreads, pid, my_seq, &ret, 1);
+
+    return ret;
+}
+
+void *SimShardGetState(SimShardStruct *shard_struct, uint32_t shard) {
+    uint32_t leaf = shard / shard_struct->shards_per_block;
+    uint32_t block = shard_struct->pool[shard_struct->sp.struct_data.index]->root;
+    int level;
+
+    for (level = shard_struct->depth; level > 0; level--)
+        block = ((uint32_t *)SIM_SHARD_BLOCK(shard_struct, block))[(leaf >> ((level - 1) * SIM_SHARD_FANOUT_BITS)) & (SIM_SHARD_FANOUT - 1)];
+
+    return SIM_SHARD_BLOCK(shard_struct, block) + (shard % shard_struct->shards_per_block) * shard_struct->shard_stride;
+}
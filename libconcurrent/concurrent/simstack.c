@@ -14,37 +14,75 @@
 static const uint64_t POP = LLONG_MIN;
 
 inline static void serialPush(HalfSimStackState *st, SimStackThreadState *th_state, ArgVal arg);
-inline static bool serialPop(HalfSimStackState *st, int pid);
+inline static bool serialPop(HalfSimStackState *st, int pid, uint64_t seq);
+inline static void serialPopEliminated(HalfSimStackState *st, int pid, uint64_t seq, ArgVal val);
 inline static RetVal SimStackApplyOp(SimStackStruct *stack, SimStackThreadState *th_state, ArgVal arg, int pid);
-static inline void SimStackStateCopy(SimStackState *dest, SimStackState *src);
+static inline void SimStackStateCopy(SimStackState *dest, SimStackState *src, uint32_t cells);
 inline static void recycleList(SynchPoolStruct *pool, Node *head, uint32_t items);
 
-static inline void SimStackStateCopy(SimStackState *dest, SimStackState *src) {
-    // copy everything except 'applied' and 'ret' fields
-    memcpy(&dest->head, &src->head, SimStackStateSize(dest->applied.nthreads) - sizeof(ToggleVector) - sizeof(Object *));
+static inline void SimStackStateCopy(SimStackState *dest, SimStackState *src, uint32_t cells) {
+    uint32_t nthreads = dest->applied.nthreads;
+
+    // copy everything except the 'applied', 'ret' and 'ret_size' fields, and only the active cells of the applied toggles
+    memcpy(&dest->head, &src->head, offsetof(SimStackState, __flex) - offsetof(SimStackState, head) + cells * sizeof(bitword_t));
+    // copy only the return values of the attempt that produced src
+    dest->ret_size = src->ret_size;
+    if (dest->ret_size > nthreads)                                                      // a stale read, this attempt is going to fail
+        dest->ret_size = 0;
+    memcpy(dest->ret, src->ret, dest->ret_size * sizeof(SimRoundRet));
 }
 
 void SimStackStructInit(SimStackStruct *stack, uint32_t nthreads, int max_backoff) {
-    int i;
+    SimStackStructInitPool(stack, nthreads, max_backoff, _SIM_LOCAL_POOL_SIZE_);
+    synchEventCountInit(&stack->nonempty);
+}
 
+void SimStackStructInitPool(SimStackStruct *stack, uint32_t nthreads, int max_backoff, uint32_t pool_size) {
+    uint32_t initial;
+    void *slice;
+    int i, k;
+
+    if (pool_size < 2)
+        pool_size = 2;
     stack->nthreads = nthreads;
+    stack->pool_size = pool_size;
+    // the list of return values (at most one per thread) is stored after the copied part of SimStackState
+    stack->record_size = SIM_ALIGN_UP(SimStackStateSize(nthreads) + nthreads * sizeof(SimRoundRet), CACHE_LINE_SIZE);
     stack->a_toggles.cell = synchGetAlignedMemory(CACHE_LINE_SIZE, _TVEC_VECTOR_SIZE(nthreads));
     stack->announce = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(ArgVal));
-    stack->pool = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimStackState *) * (_SIM_LOCAL_POOL_SIZE_ * nthreads + 1));
-    for (i = 0; i < _SIM_LOCAL_POOL_SIZE_ * nthreads + 1; i++) {
-        stack->pool[i] = synchGetAlignedMemory(CACHE_LINE_SIZE, SimStackStateSize(nthreads));
+    stack->announce_seq = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(uint64_t));
+    memset((void *)stack->announce_seq, 0, nthreads * sizeof(uint64_t));
+    stack->ret_stride = SIM_RET_SLOTS_PER_THREAD(1);
+    stack->ret_slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * stack->ret_stride * sizeof(SimRetSlot));
+    memset(stack->ret_slots, 0, nthreads * stack->ret_stride * sizeof(SimRetSlot));
+    SimRegistryInit(&stack->registry, nthreads);
+    stack->saved_index = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int));
+    memset(stack->saved_index, 0, nthreads * sizeof(int));
+    initial = pool_size * nthreads;
+    stack->pool_node = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(int32_t));
+    stack->pool = synchGetAlignedMemory(CACHE_LINE_SIZE, sizeof(SimStackState *) * (initial + 1));
+    for (i = 0; i < nthreads; i++) {
+        stack->pool_node[i] = synchPreferredNumaNodeOfThread(i);
+        slice = synchGetMemoryOnNumaNode(pool_size * stack->record_size, stack->pool_node[i]);
+        for (k = 0; k < pool_size; k++)
+            stack->pool[i * pool_size + k] = slice + k * stack->record_size;
+    }
+    stack->pool[initial] = synchGetAlignedMemory(CACHE_LINE_SIZE, stack->record_size);
+    for (i = 0; i < initial + 1; i++) {
         TVEC_INIT_AT(&stack->pool[i]->applied, nthreads, stack->pool[i]->__flex);
-        stack->pool[i]->ret = ((void *)stack->pool[i]->__flex) + _TVEC_VECTOR_SIZE(nthreads);
+        stack->pool[i]->ret = ((void *)stack->pool[i]) + SimStackStateSize(nthreads);
+        stack->pool[i]->ret_size = 0;
     }
-    stack->sp.struct_data.index = _SIM_LOCAL_POOL_SIZE_ * nthreads;
+    stack->sp.struct_data.index = initial;
     stack->sp.struct_data.seq = 0;
     TVEC_INIT((ToggleVector *)&stack->a_toggles, nthreads);
-    stack->pool[_SIM_LOCAL_POOL_SIZE_ * nthreads]->head = NULL;
+    stack->pool[initial]->head = NULL;
+    stack->pool[initial]->eliminated = 0;
 
-    TVEC_SET_ZERO((ToggleVector *)&stack->pool[_SIM_LOCAL_POOL_SIZE_ * nthreads]->applied);
+    TVEC_SET_ZERO((ToggleVector *)&stack->pool[initial]->applied);
     stack->MAX_BACK = max_backoff * 100;
 #ifdef DEBUG
-    stack->pool[_SIM_LOCAL_POOL_SIZE_ * nthreads]->counter = 0;
+    stack->pool[initial]->counter = 0;
 #endif
     synchFullFence();
 }
@@ -56,15 +94,55 @@ void SimStackThreadStateInit(SimStackThreadState *th_state, uint32_t nthreads, i
     TVEC_INIT(&th_state->my_bit, nthreads);
     TVEC_INIT(&th_state->toggle, nthreads);
     TVEC_INIT(&th_state->pops, nthreads);
+    th_state->pushes = synchGetMemory(nthreads * sizeof(ArgVal));
 
     TVEC_REVERSE_BIT(&th_state->my_bit, pid);
     TVEC_SET_BIT(&th_state->mask, pid);
     TVEC_NEGATIVE(&th_state->toggle, &th_state->mask);
     th_state->local_index = 0;
     th_state->backoff = 1;
+    th_state->seq = 0;
     synchInitPool(&th_state->pool, sizeof(Node));
 }
 
+void SimStackStructSetDynamicThreads(SimStackStruct *stack) {
+    SimRegistrySetDynamic(&stack->registry);
+}
+
+int SimStackRegisterThread(SimStackStruct *stack, SimStackThreadState *th_state) {
+    int pid = SimRegistryAcquire(&stack->registry);
+    int32_t node;
+
+    if (pid < 0)
+        return -1;
+    SimStackThreadStateInit(th_state, stack->nthreads, pid);
+    th_state->local_index = stack->saved_index[pid];                                    // continue from the state left by the previous owner of pid
+    th_state->seq = stack->announce_seq[pid];
+    node = synchGetPreferredNumaNode();
+    if (node >= 0 && node != stack->pool_node[pid]) {                                    // move the pool of pid close to its new owner
+        synchMoveMemoryToNumaNode(stack->pool[pid * stack->pool_size], stack->pool_size * stack->record_size, node);
+        stack->pool_node[pid] = node;
+    }
+    if (TVEC_IS_SET((ToggleVector *)&stack->a_toggles, pid)) {
+        TVEC_REVERSE_BIT(&th_state->my_bit, pid);
+        TVEC_NEGATIVE_BANK(&th_state->toggle, &th_state->toggle, TVEC_GET_BANK_OF_BIT(pid, stack->nthreads));
+    }
+
+    return pid;
+}
+
+void SimStackDeregisterThread(SimStackStruct *stack, SimStackThreadState *th_state, int pid) {
+    stack->saved_index[pid] = th_state->local_index;
+    TVEC_DESTROY(&th_state->diffs);
+    TVEC_DESTROY(&th_state->l_toggles);
+    TVEC_DESTROY(&th_state->mask);
+    TVEC_DESTROY(&th_state->my_bit);
+    TVEC_DESTROY(&th_state->toggle);
+    TVEC_DESTROY(&th_state->pops);
+    synchFreeMemory(th_state->pushes, stack->nthreads * sizeof(ArgVal));
+    SimRegistryRelease(&stack->registry, pid);                                          // CAS acts as a full write-barrier
+}
+
 inline static void recycleList(SynchPoolStruct *pool, Node *head, uint32_t items) {
     while (items > 0) {
         Node *node = head;
@@ -85,38 +163,60 @@ inline static void serialPush(HalfSimStackState *st, SimStackThreadState *th_sta
     st->head = n;
 }
 
-inline static bool serialPop(HalfSimStackState *st, int pid) {
+inline static bool serialPop(HalfSimStackState *st, int pid, uint64_t seq) {
+    SimRoundRet *entry = &st->ret[st->ret_size++];
+
 #ifdef DEBUG
     st->counter += 1;
 #endif
+    entry->pid = pid;
+    entry->index = 0;
+    entry->seq = seq;
     if (st->head != NULL) {
-        st->ret[pid] = (RetVal)st->head->val;
+        entry->val = (RetVal)st->head->val;
         st->head = (Node *)st->head->next;
         return true;
     } else {
-        st->ret[pid] = EMPTY_STACK;
+        entry->val = EMPTY_STACK;
         return false;
     }
 }
 
+inline static void serialPopEliminated(HalfSimStackState *st, int pid, uint64_t seq, ArgVal val) {
+    SimRoundRet *entry = &st->ret[st->ret_size++];
+
+#ifdef DEBUG
+    st->counter += 2;                                                                   // both the push and the pop are applied
+#endif
+    entry->pid = pid;
+    entry->index = 0;
+    entry->seq = seq;
+    entry->val = (RetVal)val;
+    st->eliminated++;
+}
+
 inline static RetVal SimStackApplyOp(SimStackStruct *stack, SimStackThreadState *th_state, ArgVal arg, int pid) {
     ToggleVector *diffs = &th_state->diffs, *l_toggles = &th_state->l_toggles, *pops = &th_state->pops;
     pointer_t new_sp, old_sp;
     HalfSimStackState *lsp_data, *sp_data;
-    int i, j, prefix, mybank;
+    uint64_t my_seq = ++th_state->seq;
+    uint32_t cells;
+    RetVal ret;
+    int i, j, k, prefix, mybank;
 
     mybank = TVEC_GET_BANK_OF_BIT(pid, stack->nthreads);
     TVEC_REVERSE_BIT(&th_state->my_bit, pid);
     TVEC_NEGATIVE_BANK(&th_state->toggle, &th_state->toggle, mybank);
-    lsp_data = (HalfSimStackState *)stack->pool[pid * _SIM_LOCAL_POOL_SIZE_ + th_state->local_index];
+    lsp_data = (HalfSimStackState *)stack->pool[pid * stack->pool_size + th_state->local_index];
     stack->announce[pid] = arg;                                                         // stack->announce the operation
+    stack->announce_seq[pid] = my_seq;
     TVEC_ATOMIC_ADD_BANK(&stack->a_toggles, &th_state->toggle, mybank);                 // toggle pid's bit in stack->a_toggles, Fetch&Add acts as a full write-barrier
 
     if (!synchIsSystemOversubscribed()) {
         volatile int k;
         int backoff_limit;
 
-        if (synchFastRandomRange(1, stack->nthreads) > 1) {
+        if (synchFastRandomRange(1, stack->registry.threads) > 1) {
             backoff_limit = synchFastRandomRange(th_state->backoff >> 1, th_state->backoff);
             for (k = 0; k < backoff_limit; k++)
                 ;
@@ -128,19 +228,22 @@ inline static RetVal SimStackApplyOp(SimStackStruct *stack, SimStackThreadState
         old_sp = stack->sp;                                                             // read reference to struct SimStackState
         synchNonTSOFence();
         sp_data = (HalfSimStackState *)stack->pool[old_sp.struct_data.index];           // read reference of struct SimStackState in a local variable lsp_data
+        cells = stack->registry.active_cells;                                           // only these cells of the toggle vectors contain registered threads
         TVEC_ATOMIC_COPY_BANKS(diffs, &sp_data->applied, mybank);
         TVEC_XOR_BANKS(diffs, diffs, &th_state->my_bit, mybank);                        // determine the set of active processes
         if (TVEC_IS_SET(diffs, pid))                                                    // if the operation has already been applied return
             break;
-        SimStackStateCopy((SimStackState *)lsp_data, (SimStackState *)sp_data);
-        TVEC_COPY(l_toggles, (ToggleVector *)&stack->a_toggles);                        // This is an atomic read, since a_toogles is volatile
+        SimStackStateCopy((SimStackState *)lsp_data, (SimStackState *)sp_data, cells);
+        TVEC_COPY_CELLS(l_toggles, (ToggleVector *)&stack->a_toggles, cells);           // This is an atomic read, since a_toogles is volatile
         if (old_sp.raw_data != stack->sp.raw_data)
             continue;
-        TVEC_XOR(diffs, &lsp_data->applied, l_toggles);
+        SimRetPublish(stack->ret_slots, stack->ret_stride, lsp_data->ret, lsp_data->ret_size); // publish the return values of the previous attempt
+        lsp_data->ret_size = 0;
+        TVEC_XOR_CELLS(diffs, &lsp_data->applied, l_toggles, cells);
 
         TVEC_SET_ZERO(pops);
-        int push_counter = 0;
-        for (i = 0, prefix = 0; i < diffs->tvec_cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
+        int push_counter = 0, pushes = 0;
+        for (i = 0, prefix = 0; i < cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
             synchReadPrefetch(&stack->announce[prefix]);
             synchReadPrefetch(&stack->announce[prefix + 8]);
             synchReadPrefetch(&stack->announce[prefix + 16]);
@@ -148,44 +251,62 @@ inline static RetVal SimStackApplyOp(SimStackStruct *stack, SimStackThreadState
 
             while (diffs->cell[i] != 0L) {
                 register int pos, proc_id;
+                ArgVal val;
 
                 pos = synchBitSearchFirst(diffs->cell[i]);
                 proc_id = prefix + pos;
                 diffs->cell[i] ^= ((bitword_t)1) << pos;
-                if (stack->announce[proc_id] == POP) {
+                val = stack->announce[proc_id];
+                if (val == POP) {
                     pops->cell[i] |= ((bitword_t)1) << pos;
                 } else {
-                    serialPush(lsp_data, th_state, stack->announce[proc_id]);
-                    push_counter++;
+                    th_state->pushes[pushes++] = val;
                 }
             }
         }
 
+        // The pushes of the round are linearized before its pops, thus each pop is served by the most recent
+        // push that is not yet matched (elimination) and only the remaining pops reach the nodes of the stack.
         Node *free_list = lsp_data->head;
         int pop_counter = 0;
-        for (i = 0, prefix = 0; i < pops->tvec_cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
+        for (i = 0, prefix = 0; i < cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
             while (pops->cell[i] != 0L) {
                 register int pos, proc_id;
 
                 pos = synchBitSearchFirst(pops->cell[i]);
                 proc_id = prefix + pos;
                 pops->cell[i] ^= ((bitword_t)1) << pos;
-                pop_counter += serialPop(lsp_data, proc_id);
+                if (pushes > 0) {
+                    serialPopEliminated(lsp_data, proc_id, stack->announce_seq[proc_id], th_state->pushes[--pushes]);
+                    continue;
+                }
+                pop_counter += serialPop(lsp_data, proc_id, stack->announce_seq[proc_id]);
                 synchNonTSOFence();
                 if (old_sp.raw_data != stack->sp.raw_data)
                     goto outer;
             }
         }
+        // Only the pushes that are not eliminated allocate nodes; in case that any pop reached the nodes of the
+        // stack, there are no such pushes.
+        for (k = 0; k < pushes; k++)
+            serialPush(lsp_data, th_state, th_state->pushes[k]);
+        push_counter = pushes;
+        if (push_counter > 0)
+            free_list = lsp_data->head;
  outer:
-        TVEC_COPY(&lsp_data->applied, l_toggles);                                       // change applied to be equal to what was read in stack->a_toggles
+        TVEC_COPY_CELLS(&lsp_data->applied, l_toggles, cells);                          // change applied to be equal to what was read in stack->a_toggles
         new_sp.struct_data.seq = old_sp.struct_data.seq + 1;                            // increase timestamp
-        new_sp.struct_data.index = _SIM_LOCAL_POOL_SIZE_ * pid + th_state->local_index; // store in mod_dw.index the index in stack->pool where lsp_data will be stored
+        new_sp.struct_data.index = stack->pool_size * pid + th_state->local_index; // store in mod_dw.index the index in stack->pool where lsp_data will be stored
         if (old_sp.raw_data == stack->sp.raw_data && synchCAS64(&stack->sp.raw_data, old_sp.raw_data, new_sp.raw_data)) {
-            th_state->local_index = (th_state->local_index + 1) % _SIM_LOCAL_POOL_SIZE_;
+            th_state->local_index = (th_state->local_index + 1) % stack->pool_size;
             th_state->backoff = (th_state->backoff >> 1) | 1;
             recycleList(&th_state->pool, free_list, pop_counter);
+            if (arg == POP)
+                SimRetCollectFromList(lsp_data->ret, lsp_data->ret_size, pid, my_seq, &ret, 1);
+            else
+                ret = 0;
 
-            return lsp_data->ret[pid];
+            return ret;
         } else {
             if (th_state->backoff < stack->MAX_BACK)
                 th_state->backoff <<= 1;
@@ -193,13 +314,39 @@ inline static RetVal SimStackApplyOp(SimStackStruct *stack, SimStackThreadState
         }
     }
 
-    return stack->pool[stack->sp.struct_data.index]->ret[pid];                          // return the value found in the record stored there
+    if (arg != POP)                                                                     // push operations do not return any value
+        return 0;
+    // return the value found either in the current record or in pid's result slot
+    SimRetCollectFromCopy(&stack->ret_slots[pid * stack->ret_stride], &stack->sp, (void **)stack->pool, offsetof(SimStackState, ret),
+                          offsetof(SimStackState, ret_size), stack->nthreads, pid, my_seq, &ret, 1);
+
+    return ret;
 }
 
 void SimStackPush(SimStackStruct *stack, SimStackThreadState *th_state, ArgVal arg, int pid) {
     SimStackApplyOp(stack, th_state, arg, pid);
+    synchEventCountNotifyAfterRMW(&stack->nonempty);
 }
 
 RetVal SimStackPop(SimStackStruct *stack, SimStackThreadState *th_state, int pid) {
     return SimStackApplyOp(stack, th_state, POP, pid);
 }
+
+static RetVal SimStackPopWait(SimStackStruct *stack, SimStackThreadState *th_state, const struct timespec *deadline, int pid) {
+    RetVal ret;
+
+    SYNCH_EVENTCOUNT_WAIT_FOR(&stack->nonempty, ret, SimStackPop(stack, th_state, pid), EMPTY_STACK, deadline);
+
+    return ret;
+}
+
+RetVal SimStackPopBlocking(SimStackStruct *stack, SimStackThreadState *th_state, int pid) {
+    return SimStackPopWait(stack, th_state, NULL, pid);
+}
+
+RetVal SimStackPopTimed(SimStackStruct *stack, SimStackThreadState *th_state, uint64_t timeout_ns, int pid) {
+    struct timespec deadline;
+
+    synchEventCountDeadline(&deadline, timeout_ns);
+    return SimStackPopWait(stack, th_state, &deadline, pid);
+}
@@ -71,6 +71,11 @@
 /// By default, this flag is disabled.
 //#define SYNCH_POOL_NODE_RECYCLING_DISABLE
 
+/// @brief This definition disables parking in the combining objects (i.e. CC-Synch, DSM-Synch, H-Synch and FC), i.e. the
+/// waiting threads keep yielding the CPU instead of sleeping on a futex after a bounded spin (see park.h).
+/// By default, this flag is disabled.
+//#define SYNCH_PARKING_DISABLE
+
 /// @brief By enabling this definition, the Performance Application Programming Interface (PAPI library) is used for
 /// getting performance counters during the execution of benchmarks. In this case, the PAPI library (i.e. libpapi)
 /// should be install and appropriately configured.
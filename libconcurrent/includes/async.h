@@ -0,0 +1,71 @@
+/// @file async.h
+/// @brief This file exposes the split-phase API of the combining objects (i.e. CC-Synch, DSM-Synch and H-Synch).
+/// A thread submits a request by the Submit function of an object (e.g. CCSynchSubmitOp), which announces the request
+/// and returns without waiting for it to be applied; the request is described by a ticket. The return value of the
+/// request is collected later by synchTicketPoll, synchTicketWait or synchTicketWaitAll. Thus, a thread may have
+/// several requests in flight on different objects and it overlaps the time that it waits for them.
+///
+/// Note that the combining role of an object is handed off to the owner of the next announced request. Therefore, a
+/// thread that has submitted a request may have to act as the combiner of the object; this happens in synchTicketPoll
+/// (or in the Submit function itself, in case that the thread becomes the combiner at once). A thread should not keep
+/// an uncompleted ticket without polling it for a long time, since the other threads of the object may wait for it.
+/// Moreover, a thread that has several tickets should collect them by synchTicketWaitAll (or by polling all of them),
+/// and not by calling synchTicketWait for each of them, since it may be the combiner of the object of another ticket.
+/// A thread should have at most one uncompleted ticket per object.
+#ifndef _ASYNC_H_
+#define _ASYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <config.h>
+#include <primitives.h>
+
+/// @brief SynchTicket describes a submitted request. It is initialized by the Submit function of a combining object
+/// (e.g. CCSynchSubmitOp) and it should not be modified by the user.
+typedef struct SynchTicket {
+    /// @brief The instance of the combining object that the request has been submitted to.
+    void *object;
+    /// @brief The node that announces the request.
+    volatile void *node;
+    /// @brief The locked field of the node, i.e. the field that the owner of the request waits on (see park.h).
+    volatile void *locked;
+    /// @brief The serial function of the request.
+    RetVal (*sfunc)(void *, ArgVal, int);
+    /// @brief A pointer to the state of the simulated object.
+    void *state;
+    /// @brief The pid of the thread that submitted the request.
+    int pid;
+    /// @brief The function of the combining object that polls the ticket; it returns true in case that the request
+    /// has been applied and it executes a combining round in case that the calling thread has become the combiner.
+    bool (*poll)(struct SynchTicket *ticket);
+    /// @brief The return value of the request, which is valid after the request is completed.
+    RetVal ret;
+    /// @brief It is true in case that the request is completed.
+    bool done;
+} SynchTicket;
+
+/// @brief This function checks whether a submitted request has been applied. In case that the calling thread has become
+/// the combiner of the object, this function executes a combining round (which applies the request) before it returns.
+///
+/// @param ticket A pointer to the ticket of the request.
+/// @param ret In case that the request is completed, its return value is stored here (it may be NULL).
+/// @return true in case that the request is completed; otherwise false.
+bool synchTicketPoll(SynchTicket *ticket, RetVal *ret);
+
+/// @brief This function waits until a submitted request is applied; the calling thread spins and then it parks (see park.h).
+/// It should be used only in case that this is the only uncompleted ticket of the calling thread (see async.h).
+///
+/// @param ticket A pointer to the ticket of the request.
+/// @return The return value of the request.
+RetVal synchTicketWait(SynchTicket *ticket);
+
+/// @brief This function waits until all the given requests are applied. The tickets are polled in turn; whenever a
+/// single ticket remains uncompleted, the calling thread waits for it by synchTicketWait.
+///
+/// @param tickets An array of n tickets.
+/// @param n The number of tickets.
+/// @param rets The return value of the request of tickets[i] is stored to rets[i].
+void synchTicketWaitAll(SynchTicket *tickets, uint32_t n, RetVal *rets);
+
+#endif
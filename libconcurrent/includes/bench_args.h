@@ -5,6 +5,11 @@
 #define _BENCH_ARGS_H_
 
 #include <stdint.h>
+#include <stdbool.h>
+
+/// @brief In case that report_memory is set, the benchmarks report the resident memory each time that the thread with
+/// id 0 has executed this number of operations.
+#define SYNCH_MEMORY_REPORT_PERIOD (1L << 22)
 
 /// @brief BenchArgs stores the values of the command-line arguments used by the benchmarks provided by the Synch framework.
 /// BenchArgs should be initialized using the parseArguments function. For the default values, see the config.h file.
@@ -32,6 +37,16 @@ typedef struct SynchBenchArgs {
     uint16_t backoff_low;
     /// @brief The upper backoff bound used in the experiment.
     uint16_t backoff_high;
+    /// @brief If true, the benchmarks that support it report the resident memory of the process during the experiment
+    /// (see SYNCH_MEMORY_REPORT_PERIOD). The default value is false.
+    bool report_memory;
+    /// @brief In case that it is not 0, the benchmarks that support it use this number of threads as producers, i.e. threads
+    /// that only insert elements, while the rest of the threads are consumers, i.e. threads that only remove elements.
+    /// It should be lower than nthreads. The default value is 0, i.e. each thread executes pairs of operations.
+    uint32_t producers;
+    /// @brief The target length (in nanoseconds) of a combining round for the combining objects that support an adaptive
+    /// help bound (see helpbound.h). The default value is 0, i.e. the help bound is fixed.
+    uint64_t combining_latency;
 } SynchBenchArgs;
 
 /// @brief This function parses the command-line arguments and stores them in an BenchArgs structure.
@@ -12,6 +12,7 @@
 
 #include <config.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 #include <ccsynch.h>
 
 /// @brief CCQueueStruct stores the state of an instance of the CC-Queue concurrent queue implementation.
@@ -27,6 +28,10 @@ typedef struct CCQueueStruct {
     volatile Node *first CACHE_ALIGN;
     /// @brief A guard node that it is used only at the initialization of the queue.
     Node guard CACHE_ALIGN;
+    /// @brief An array of return slots (one per thread), which are used for returning the dequeued nodes to the pools of their owners.
+    SynchNodeReturnSlot *node_slots CACHE_ALIGN;
+    /// @brief An eventcount, on which the blocking and timed dequeue operations wait while the queue is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } CCQueueStruct;
 
 /// @brief CCQueueThreadState stores each thread's local state for a single instance of CC-Queue.
@@ -36,6 +41,8 @@ typedef struct CCQueueThreadState {
     CCSynchThreadState enqueue_thread_state;
     /// @brief A CCSynchThreadState struct for the instance of CC-Synch that serves the dequeue operations.
     CCSynchThreadState dequeue_thread_state;
+    /// @brief A pool of nodes, from which the thread allocates the nodes of its enqueue operations.
+    SynchPoolStruct pool;
 } CCQueueThreadState;
 
 /// @brief This function initializes an instance of the CC-Queue concurrent queue implementation.
@@ -70,4 +77,23 @@ void CCQueueApplyEnqueue(CCQueueStruct *object_struct, CCQueueThreadState *lobje
 /// @return The value of the removed element.
 RetVal CCQueueApplyDequeue(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, int pid);
 
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits until an element is enqueued (see eventcount.h).
+///
+/// @param object_struct A pointer to an instance of the CC-Queue concurrent queue implementation.
+/// @param lobject_struct A pointer to thread's local state of CC-Queue.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal CCQueueApplyDequeueBlocking(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is enqueued.
+///
+/// @param object_struct A pointer to an instance of the CC-Queue concurrent queue implementation.
+/// @param lobject_struct A pointer to thread's local state of CC-Queue.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue remains empty for timeout_ns nanoseconds.
+RetVal CCQueueApplyDequeueTimed(CCQueueStruct *object_struct, CCQueueThreadState *lobject_struct, uint64_t timeout_ns, int pid);
+
 #endif
@@ -12,6 +12,14 @@
 
 #include <config.h>
 #include <primitives.h>
+#include <threadtools.h>
+#include <helpbound.h>
+#include <park.h>
+#include <async.h>
+
+/// @brief By default, a combiner applies at most CCSYNCH_HELP_FACTOR * nthreads requests in a single combining round
+/// (see CCSynchStructSetHelpPolicy).
+#define CCSYNCH_HELP_FACTOR 10
 
 /// @brief HalfCCSynchNode should not be directly used by the user.
 /// It is internally used for proper alignment of the CCSynchNode struct.
@@ -57,6 +65,14 @@ typedef struct CCSynchStruct {
     CCSynchNode *nodes CACHE_ALIGN;
     /// @brief The number of threads that will use the CC-Synch combining object.
     uint32_t nthreads;
+    /// @brief The arguments of the requests that are served by the current combiner of CCSynchApplyBatchOp.
+    ArgVal *batch_args;
+    /// @brief The return values of the requests that are served by the current combiner of CCSynchApplyBatchOp.
+    RetVal *batch_rets;
+    /// @brief The number of requests that batch_args and batch_rets have room for.
+    uint32_t batch_capacity;
+    /// @brief The help bound of the instance (see CCSynchStructSetHelpPolicy).
+    SynchHelpBound help CACHE_ALIGN;
 #ifdef DEBUG
     volatile uint64_t counter CACHE_ALIGN;
     volatile int rounds;
@@ -79,6 +95,23 @@ void CCSynchStructInit(CCSynchStruct *l, uint32_t nthreads);
 /// @param pid The pid of the calling thread.
 void CCSynchThreadStateInit(CCSynchStruct *l, CCSynchThreadState *st_thread, int pid);
 
+/// @brief This function enables (or disables) the adaptive help bound for an instance of the CC-Synch combining object.
+/// The help bound is adapted so as the length of a combining round stays below target_ns (see helpbound.h).
+/// This function should be called after the instance is initialized and before any thread applies any request to it.
+///
+/// @param l A pointer to an instance of the CC-Synch combining object.
+/// @param target_ns The target length of a combining round in nanoseconds; 0 restores the fixed help bound.
+/// @param min_bound The minimum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+/// @param max_bound The maximum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+void CCSynchStructSetHelpPolicy(CCSynchStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound);
+
+/// @brief This function returns the current help bound of an instance of the CC-Synch combining object and the statistics of its
+/// combining rounds. The statistics are collected only while the adaptive help bound is enabled.
+///
+/// @param l A pointer to an instance of the CC-Synch combining object.
+/// @param stats A snapshot of the help bound of the instance is stored here.
+void CCSynchGetHelpStats(CCSynchStruct *l, SynchHelpBound *stats);
+
 /// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
 ///
 /// @param l A pointer to an instance of the CC-Synch combining object.
@@ -90,4 +123,112 @@ void CCSynchThreadStateInit(CCSynchStruct *l, CCSynchThreadState *st_thread, int
 /// @return RetVal The return value of the applied request.
 RetVal CCSynchApplyOp(CCSynchStruct *l, CCSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid);
 
+/// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
+/// In contrast to CCSynchApplyOp, the combiner collects the arguments of the requests that it serves in a combining round
+/// into an array and it applies all of them by calling batch_sfunc once. Thus, the simulated object is able to merge
+/// the requests of a round (e.g. k Fetch&Multiply requests could be applied as a single multiplication).
+/// The requests of an instance should be applied either by CCSynchApplyOp or by CCSynchApplyBatchOp, but not by both.
+///
+/// @param l A pointer to an instance of the CC-Synch combining object.
+/// @param st_thread A pointer to thread's local state for a specific instance of CC-Synch.
+/// @param batch_sfunc A serial function that applies n requests; args[i] is the argument of the i-th request and the
+/// return value of the i-th request should be stored to rets[i]. The requests are given in the order they are served.
+/// @param state A pointer to the state of the simulated object.
+/// @param arg The argument of the request that the thread wants to apply.
+/// @param pid The pid of the calling thread.
+/// @return RetVal The return value of the applied request.
+RetVal CCSynchApplyBatchOp(CCSynchStruct *l, CCSynchThreadState *st_thread, void (*batch_sfunc)(void *, ArgVal *, RetVal *, uint32_t), void *state, ArgVal arg, int pid);
+
+/// @brief This function submits a request to the simulated concurrent object without waiting for it to be applied
+/// (see async.h). The return value of the request is collected later by synchTicketPoll, synchTicketWait or
+/// synchTicketWaitAll. In case that the calling thread becomes the combiner at once, the combining round is executed
+/// before this function returns. The calling thread should not submit (or apply) another request to the same instance
+/// before the ticket is completed.
+///
+/// @param l A pointer to an instance of the CC-Synch combining object.
+/// @param st_thread A pointer to thread's local state for a specific instance of CC-Synch.
+/// @param sfunc A serial function that the CC-Synch instance should execute, while applying requests announced by active threads.
+/// @param state A pointer to the state of the simulated object.
+/// @param arg The argument of the request that the thread wants to apply.
+/// @param pid The pid of the calling thread.
+/// @param ticket The ticket of the request is stored here.
+void CCSynchSubmitOp(CCSynchStruct *l, CCSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid, SynchTicket *ticket);
+
+/// @brief This function executes a combining round, starting from the request of cur. It is called by the combiner
+/// and it should not be directly used by the user.
+static inline ALWAYS_INLINE void CCSynchCombineInline(CCSynchStruct *l, volatile CCSynchNode *cur, RetVal (*sfunc)(void *, ArgVal, int), void *state) {
+    volatile CCSynchNode *p;
+    CCSynchNode *tmp_next;
+    int help_bound;
+    int counter = 0;
+    int64_t start;
+    SynchParkWakeList wake_list;
+
+#ifdef DEBUG
+    l->rounds++;
+#endif
+    synchParkWakeListInit(&wake_list);
+    help_bound = l->help.bound;
+    start = synchHelpBoundStart(&l->help);
+    p = cur; // I am not been helped
+    while (p->next != NULL && counter < help_bound) {
+        synchStorePrefetch(p->next);
+        counter++;
+#ifdef DEBUG
+        l->counter++;
+#endif
+        tmp_next = p->next;
+        p->arg_ret = sfunc(state, p->arg_ret, p->pid);
+        synchNonTSOFence();
+        p->completed = true;
+        synchNonTSOFence();
+        synchParkUnlockDeferred(&p->locked, &wake_list);
+        p = tmp_next;
+    }
+    synchHelpBoundEnd(&l->help, start, counter);
+    synchNonTSOFence();
+    synchParkUnlock(&p->locked); // Unlock the next one
+    synchStoreFence();
+    synchParkWakeAll(&wake_list);
+}
+
+/// @brief This function is the inlinable version of CCSynchApplyOp. In case that sfunc is a constant whose definition is
+/// visible (i.e. a static inline function), the compiler is able to inline it in the combining loop.
+/// Usually, it is used through CCSYNCH_DEFINE_APPLY_OP and not directly.
+static inline ALWAYS_INLINE RetVal CCSynchApplyOpInline(CCSynchStruct *l, CCSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
+    volatile CCSynchNode *cur;
+    CCSynchNode *next_node;
+
+    next_node = st_thread->next;
+    next_node->next = NULL;
+    next_node->locked = true;
+    synchNonTSOFence();
+    next_node->completed = false;
+
+    cur = (CCSynchNode *)synchSWAP(&l->Tail, next_node);
+    cur->arg_ret = arg;
+    cur->pid = pid;
+    synchNonTSOFence();
+    cur->next = (CCSynchNode *)next_node;
+    st_thread->next = (CCSynchNode *)cur;
+    synchNonTSOFence();
+
+    synchParkWait(&cur->locked); // spinning, then parking
+    if (cur->completed) // I have been helped
+        return cur->arg_ret;
+    CCSynchCombineInline(l, cur, sfunc, state);
+
+    return cur->arg_ret;
+}
+
+/// @brief This macro defines a function named NAME that is equivalent to CCSynchApplyOp, but it is specialized for the
+/// serial function SFUNC, i.e. SFUNC is inlined in the combining loop instead of being called through a pointer.
+/// The defined function has the following signature:
+/// `static inline RetVal NAME(CCSynchStruct *l, CCSynchThreadState *st_thread, void *state, ArgVal arg, int pid)`.
+/// An example of use is provided in benchmarks/ccsynchbench.c file.
+#define CCSYNCH_DEFINE_APPLY_OP(NAME, SFUNC)                                                                           \
+    static inline RetVal NAME(CCSynchStruct *l, CCSynchThreadState *st_thread, void *state, ArgVal arg, int pid) {    \
+        return CCSynchApplyOpInline(l, st_thread, SFUNC, state, arg, pid);                                             \
+    }
+
 #endif
@@ -12,6 +12,7 @@
 
 #include <config.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 #include <dsmsynch.h>
 #include <primitives.h>
 
@@ -28,6 +29,10 @@ typedef struct DSMQueueStruct {
     volatile Node *first CACHE_ALIGN;
     /// @brief A guard node that it is used only at the initialization of the queue.
     Node guard CACHE_ALIGN;
+    /// @brief An array of return slots (one per thread), which are used for returning the dequeued nodes to the pools of their owners.
+    SynchNodeReturnSlot *node_slots CACHE_ALIGN;
+    /// @brief An eventcount, on which the blocking and timed dequeue operations wait while the queue is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } DSMQueueStruct;
 
 /// @brief DSMQueueThreadState stores each thread's local state for a single instance of DSM-Queue.
@@ -37,6 +42,8 @@ typedef struct DSMQueueThreadState {
     DSMSynchThreadState enqueue_thread_state;
     /// @brief A DSMSynchThreadState struct for the instance of DSM-Synch that serves the dequeue operations.
     DSMSynchThreadState dequeue_thread_state;
+    /// @brief A pool of nodes, from which the thread allocates the nodes of its enqueue operations.
+    SynchPoolStruct pool;
 } DSMQueueThreadState;
 
 /// @brief This function initializes an instance of the DSM-Queue concurrent queue implementation.
@@ -72,4 +79,23 @@ void DSMQueueApplyEnqueue(DSMQueueStruct *object_struct, DSMQueueThreadState *lo
 /// @return The value of the removed element.
 RetVal DSMQueueApplyDequeue(DSMQueueStruct *object_struct, DSMQueueThreadState *lobject_struct, int pid);
 
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits until an element is enqueued (see eventcount.h).
+///
+/// @param object_struct A pointer to an instance of the DSM-Queue concurrent queue implementation.
+/// @param lobject_struct A pointer to thread's local state of DSM-Queue.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal DSMQueueApplyDequeueBlocking(DSMQueueStruct *object_struct, DSMQueueThreadState *lobject_struct, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is enqueued.
+///
+/// @param object_struct A pointer to an instance of the DSM-Queue concurrent queue implementation.
+/// @param lobject_struct A pointer to thread's local state of DSM-Queue.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue remains empty for timeout_ns nanoseconds.
+RetVal DSMQueueApplyDequeueTimed(DSMQueueStruct *object_struct, DSMQueueThreadState *lobject_struct, uint64_t timeout_ns, int pid);
+
 #endif
@@ -12,6 +12,14 @@
 
 #include <config.h>
 #include <primitives.h>
+#include <threadtools.h>
+#include <helpbound.h>
+#include <park.h>
+#include <async.h>
+
+/// @brief By default, a combiner applies at most DSMSYNCH_HELP_FACTOR * nthreads requests in a single combining round
+/// (see DSMSynchStructSetHelpPolicy).
+#define DSMSYNCH_HELP_FACTOR 10
 
 /// @brief HalfDSMSynchNode should not be directly used by the user.
 /// It is internally used for proper alignment of the DSMSynchNode struct.
@@ -58,6 +66,14 @@ typedef struct DSMSynchStruct {
     DSMSynchNode *nodes CACHE_ALIGN;
     /// @brief The number of threads that will use the DSMSynch combining object.
     uint32_t nthreads;
+    /// @brief The arguments of the requests that are served by the current combiner of DSMSynchApplyBatchOp.
+    ArgVal *batch_args;
+    /// @brief The return values of the requests that are served by the current combiner of DSMSynchApplyBatchOp.
+    RetVal *batch_rets;
+    /// @brief The number of requests that batch_args and batch_rets have room for.
+    uint32_t batch_capacity;
+    /// @brief The help bound of the instance (see DSMSynchStructSetHelpPolicy).
+    SynchHelpBound help CACHE_ALIGN;
 #ifdef DEBUG
     volatile uint64_t counter CACHE_ALIGN;
     volatile int rounds;
@@ -80,6 +96,23 @@ void DSMSynchStructInit(DSMSynchStruct *l, uint32_t nthreads);
 /// @param pid The pid of the calling thread.
 void DSMSynchThreadStateInit(DSMSynchStruct *l, DSMSynchThreadState *st_thread, int pid);
 
+/// @brief This function enables (or disables) the adaptive help bound for an instance of the DSMSynch combining object.
+/// The help bound is adapted so as the length of a combining round stays below target_ns (see helpbound.h).
+/// This function should be called after the instance is initialized and before any thread applies any request to it.
+///
+/// @param l A pointer to an instance of the DSMSynch combining object.
+/// @param target_ns The target length of a combining round in nanoseconds; 0 restores the fixed help bound.
+/// @param min_bound The minimum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+/// @param max_bound The maximum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+void DSMSynchStructSetHelpPolicy(DSMSynchStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound);
+
+/// @brief This function returns the current help bound of an instance of the DSMSynch combining object and the statistics of its
+/// combining rounds. The statistics are collected only while the adaptive help bound is enabled.
+///
+/// @param l A pointer to an instance of the DSMSynch combining object.
+/// @param stats A snapshot of the help bound of the instance is stored here.
+void DSMSynchGetHelpStats(DSMSynchStruct *l, SynchHelpBound *stats);
+
 /// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
 ///
 /// @param l A pointer to an instance of the DSMSynch combining object.
@@ -91,4 +124,126 @@ void DSMSynchThreadStateInit(DSMSynchStruct *l, DSMSynchThreadState *st_thread,
 /// @return RetVal The return value of the applied request.
 RetVal DSMSynchApplyOp(DSMSynchStruct *l, DSMSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid);
 
+/// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
+/// In contrast to DSMSynchApplyOp, the combiner collects the arguments of the requests that it serves in a combining round
+/// into an array and it applies all of them by calling batch_sfunc once. Thus, the simulated object is able to merge
+/// the requests of a round (e.g. k Fetch&Multiply requests could be applied as a single multiplication).
+/// The requests of an instance should be applied either by DSMSynchApplyOp or by DSMSynchApplyBatchOp, but not by both.
+///
+/// @param l A pointer to an instance of the DSMSynch combining object.
+/// @param st_thread A pointer to thread's local state for a specific instance of DSMSynch.
+/// @param batch_sfunc A serial function that applies n requests; args[i] is the argument of the i-th request and the
+/// return value of the i-th request should be stored to rets[i]. The requests are given in the order they are served.
+/// @param state A pointer to the state of the simulated object.
+/// @param arg The argument of the request that the thread wants to apply.
+/// @param pid The pid of the calling thread.
+/// @return RetVal The return value of the applied request.
+RetVal DSMSynchApplyBatchOp(DSMSynchStruct *l, DSMSynchThreadState *st_thread, void (*batch_sfunc)(void *, ArgVal *, RetVal *, uint32_t), void *state, ArgVal arg, int pid);
+
+/// @brief This function submits a request to the simulated concurrent object without waiting for it to be applied
+/// (see async.h). The return value of the request is collected later by synchTicketPoll, synchTicketWait or
+/// synchTicketWaitAll. In case that the calling thread becomes the combiner at once, the combining round is executed
+/// before this function returns. The calling thread should not submit (or apply) another request to the same instance
+/// before the ticket is completed.
+///
+/// @param l A pointer to an instance of the DSMSynch combining object.
+/// @param st_thread A pointer to thread's local state for a specific instance of DSMSynch.
+/// @param sfunc A serial function that the DSMSynch instance should execute, while applying requests announced by active threads.
+/// @param state A pointer to the state of the simulated object.
+/// @param arg The argument of the request that the thread wants to apply.
+/// @param pid The pid of the calling thread.
+/// @param ticket The ticket of the request is stored here.
+void DSMSynchSubmitOp(DSMSynchStruct *l, DSMSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid, SynchTicket *ticket);
+
+/// @brief This function executes a combining round, starting from the request of mynode. It is called by the combiner
+/// and it should not be directly used by the user.
+static inline ALWAYS_INLINE void DSMSynchCombineInline(DSMSynchStruct *l, volatile DSMSynchNode *mynode, RetVal (*sfunc)(void *, ArgVal, int), void *state) {
+    volatile DSMSynchNode *p;
+    register int counter;
+    int help_bound;
+    int64_t start;
+    SynchParkWakeList wake_list;
+
+#ifdef DEBUG
+    l->rounds += 1;
+#endif
+    synchParkWakeListInit(&wake_list);
+    help_bound = l->help.bound;
+    start = synchHelpBoundStart(&l->help);
+    counter = 0;
+    p = mynode;
+    do { // I surely do it for myself
+        synchReadPrefetch(p->next);
+        counter++;
+#ifdef DEBUG
+        l->counter += 1;
+#endif
+        p->arg_ret = sfunc(state, p->arg_ret, p->pid);
+        synchNonTSOFence();
+        p->completed = true;
+        synchNonTSOFence();
+        synchParkUnlockDeferred(&p->locked, &wake_list);
+        if (p->next == NULL || p->next->next == NULL || counter >= help_bound)
+            break;
+        p = p->next;
+    } while (true);
+    synchHelpBoundEnd(&l->help, start, counter);
+    // End critical section
+    if (p->next == NULL) {
+        if (l->Tail == p && synchCASPTR(&l->Tail, p, NULL) == true) {
+            synchParkWakeAll(&wake_list);
+            return;
+        }
+        while (p->next == NULL) {
+            synchResched();
+        }
+    }
+    synchNonTSOFence();
+    synchParkUnlock(&p->next->locked);
+    synchFullFence();
+    synchParkWakeAll(&wake_list);
+}
+
+/// @brief This function is the inlinable version of DSMSynchApplyOp. In case that sfunc is a constant whose definition is
+/// visible (i.e. a static inline function), the compiler is able to inline it in the combining loop.
+/// Usually, it is used through DSMSYNCH_DEFINE_APPLY_OP and not directly.
+static inline ALWAYS_INLINE RetVal DSMSynchApplyOpInline(DSMSynchStruct *l, DSMSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
+    volatile DSMSynchNode *mynode;
+    DSMSynchNode *mypred;
+
+    st_thread->toggle = 1 - st_thread->toggle;
+    mynode = st_thread->MyNodes[st_thread->toggle];
+
+    mynode->next = NULL;
+    mynode->arg_ret = arg;
+    mynode->pid = pid;
+    mynode->locked = true;
+    synchNonTSOFence();
+    mynode->completed = false;
+
+    mypred = (DSMSynchNode *)synchSWAP(&l->Tail, mynode);
+    if (mypred != NULL) {
+        mypred->next = (DSMSynchNode *)mynode;
+        synchFullFence();
+
+        synchParkWait(&mynode->locked);
+        synchNonTSOFence();
+        if (mynode->completed) // operation has already applied
+            return mynode->arg_ret;
+    }
+    DSMSynchCombineInline(l, mynode, sfunc, state);
+
+    return mynode->arg_ret;
+}
+
+/// @brief This macro defines a function named NAME that is equivalent to DSMSynchApplyOp, but it is specialized for the
+/// serial function SFUNC, i.e. SFUNC is inlined in the combining loop instead of being called through a pointer.
+/// The defined function has the following signature:
+/// `static inline RetVal NAME(DSMSynchStruct *l, DSMSynchThreadState *st_thread, void *state, ArgVal arg, int pid)`.
+/// An example of use is provided in benchmarks/dsmsynchbench.c file.
+#define DSMSYNCH_DEFINE_APPLY_OP(NAME, SFUNC)                                                                           \
+    static inline RetVal NAME(DSMSynchStruct *l, DSMSynchThreadState *st_thread, void *state, ArgVal arg, int pid) {    \
+        return DSMSynchApplyOpInline(l, st_thread, SFUNC, state, arg, pid);                                             \
+    }
+
 #endif
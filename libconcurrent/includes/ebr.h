@@ -0,0 +1,162 @@
+/// @file ebr.h
+/// @brief This file exposes the API of an epoch-based memory reclamation scheme (EBR) for lock-free data-structures.
+/// This scheme is based on the epoch-based reclamation proposed by Keir Fraser in "Practical lock-freedom",
+/// PhD thesis, University of Cambridge, 2004.
+/// Each thread accesses the shared nodes of a data-structure only between synchEBREnter and synchEBRExit.
+/// Each node is allocated by using synchEBRAlloc and a node that is removed from the data-structure is retired by using
+/// synchEBRRetire. After the global epoch has been advanced twice, i.e. after every thread that could have a reference to
+/// the node has exited, the node is recycled to the pool of the thread that allocated it (see pool.h), thus the memory is
+/// reused even when some threads only insert nodes and the rest of the threads only remove them. Examples of usage could be found in the lock-free stack and queue
+/// implementations (i.e. libconcurrent/concurrent/lfstack.c and libconcurrent/concurrent/msqueue.c respectively).
+#ifndef _EBR_H_
+#define _EBR_H_
+
+#include <config.h>
+#include <stdint.h>
+#include <primitives.h>
+#include <pool.h>
+
+/// @brief A thread tries to advance the global epoch each time that it has retired this number of nodes.
+#ifndef SYNCH_EBR_RETIRE_THRESHOLD
+#    define SYNCH_EBR_RETIRE_THRESHOLD 128
+#endif
+
+/// @brief The number of epochs that a thread keeps a list of retired nodes for.
+#define SYNCH_EBR_EPOCHS 3
+
+/// @brief The value of the announced epoch of a thread that is not accessing the data-structure.
+#define SYNCH_EBR_INACTIVE 0
+
+/// @brief SynchEBRSlot stores the epoch announced by a thread; each slot fills a whole cache line.
+typedef struct SynchEBRSlot {
+    /// @brief The announced epoch of the thread shifted left by one with the lowest bit set, or SYNCH_EBR_INACTIVE.
+    volatile uint64_t epoch;
+    /// @brief Padding space.
+    char pad[PAD_CACHE(sizeof(uint64_t))];
+} SynchEBRSlot;
+
+/// @brief SynchEBRReturnSlot stores the reclaimed nodes that have been allocated by a thread, but retired by other
+/// threads; each slot fills a whole cache line.
+typedef struct SynchEBRReturnSlot {
+    /// @brief A stack of reclaimed nodes, which are linked through their first word. Any thread could push a node to it,
+    /// but only the owner removes nodes from it and it always removes all of them at once (see synchEBRAlloc).
+    void *volatile returned;
+    /// @brief Padding space.
+    char pad[PAD_CACHE(sizeof(void *))];
+} SynchEBRReturnSlot;
+
+/// @brief SynchEBRLimbo stores the nodes that are retired by a thread during a single epoch.
+typedef struct SynchEBRLimbo {
+    /// @brief An array of retired nodes.
+    void **objs;
+    /// @brief The pids of the threads that allocated the nodes stored in objs.
+    int32_t *owners;
+    /// @brief The number of retired nodes stored in objs.
+    uint32_t size;
+    /// @brief The number of nodes that objs could store.
+    uint32_t capacity;
+    /// @brief The epoch during which the nodes of this list have been retired.
+    uint64_t epoch;
+} SynchEBRLimbo;
+
+/// @brief SynchEBRStruct stores the state of an instance of the epoch-based reclamation scheme.
+/// A discrete instance should be used for each data-structure.
+/// SynchEBRStruct should be initialized using the synchEBRInit function.
+typedef struct SynchEBRStruct {
+    /// @brief The global epoch; it starts from 1.
+    volatile uint64_t epoch CACHE_ALIGN;
+    /// @brief An array of slots, one per thread.
+    SynchEBRSlot *slots CACHE_ALIGN;
+    /// @brief An array of return slots, one per thread.
+    SynchEBRReturnSlot *returns;
+    /// @brief The number of threads that use this instance.
+    uint32_t nthreads;
+} SynchEBRStruct;
+
+/// @brief SynchEBRThreadState stores each thread's local state for a single instance of the epoch-based reclamation scheme.
+typedef struct SynchEBRThreadState {
+    /// @brief A pointer to the slot of the thread.
+    SynchEBRSlot *slot;
+    /// @brief A pointer to the return slot of the thread.
+    SynchEBRReturnSlot *returned;
+    /// @brief The pool of the thread, where the nodes that it allocates are recycled.
+    SynchPoolStruct *pool;
+    /// @brief The pid of the thread.
+    int32_t pid;
+    /// @brief The lists of the nodes retired by the thread during the last SYNCH_EBR_EPOCHS epochs.
+    SynchEBRLimbo limbo[SYNCH_EBR_EPOCHS];
+    /// @brief The number of nodes retired since the last try to advance the global epoch.
+    uint32_t retired;
+    /// @brief The total number of nodes retired by the thread that are recycled, either to pool or to the pools of their owners.
+    uint64_t reclaimed;
+} SynchEBRThreadState;
+
+/// @brief This function initializes an instance of the epoch-based reclamation scheme.
+///
+/// @param ebr A pointer to an instance of the epoch-based reclamation scheme.
+/// @param nthreads The number of threads that will use this instance.
+void synchEBRInit(SynchEBRStruct *ebr, uint32_t nthreads);
+
+/// @brief This function should be called once by each thread before it accesses the data-structure.
+///
+/// @param ebr A pointer to an instance of the epoch-based reclamation scheme.
+/// @param th_state A pointer to thread's local state of the epoch-based reclamation scheme.
+/// @param pool The pool of the thread, where the nodes that it allocates are recycled.
+/// @param pid The pid of the calling thread; it should be lower than the number of threads given to synchEBRInit.
+void synchEBRThreadStateInit(SynchEBRStruct *ebr, SynchEBRThreadState *th_state, SynchPoolStruct *pool, int pid);
+
+/// @brief This function allocates a node from the pool of the thread. The nodes of the thread that have been reclaimed
+/// by other threads are first moved to the pool.
+///
+/// @param th_state A pointer to thread's local state of the epoch-based reclamation scheme.
+/// @return A pointer to the new node; its owner (see synchEBRRetire) is the calling thread.
+static inline void *synchEBRAlloc(SynchEBRThreadState *th_state) {
+    if (th_state->returned->returned != NULL) {
+        void *obj = synchSWAP(&th_state->returned->returned, NULL);
+
+        while (obj != NULL) {
+            void *next = *(void **)obj;
+
+            synchRecycleObj(th_state->pool, obj);
+            obj = next;
+        }
+    }
+
+    return synchAllocObj(th_state->pool);
+}
+
+/// @brief This function marks the start of an access of the thread to the shared nodes of the data-structure.
+/// It acts as a full memory barrier.
+///
+/// @param ebr A pointer to an instance of the epoch-based reclamation scheme.
+/// @param th_state A pointer to thread's local state of the epoch-based reclamation scheme.
+static inline void synchEBREnter(SynchEBRStruct *ebr, SynchEBRThreadState *th_state) {
+    uint64_t epoch;
+
+    do {
+        epoch = ebr->epoch;
+        th_state->slot->epoch = (epoch << 1) | 1;
+        synchFullFence();
+    } while (epoch != ebr->epoch);                                                      // the epoch should not be advanced without taking this thread into account
+}
+
+/// @brief This function marks the end of an access of the thread to the shared nodes of the data-structure.
+/// After this call, the thread should not use any reference to a shared node that it has read.
+///
+/// @param ebr A pointer to an instance of the epoch-based reclamation scheme.
+/// @param th_state A pointer to thread's local state of the epoch-based reclamation scheme.
+static inline void synchEBRExit(SynchEBRStruct *ebr, SynchEBRThreadState *th_state) {
+    synchNonTSOFence();
+    th_state->slot->epoch = SYNCH_EBR_INACTIVE;
+}
+
+/// @brief This function retires a node that has been removed from the data-structure; this node is recycled to
+/// the pool of its owner, when no thread is able to access it.
+///
+/// @param ebr A pointer to an instance of the epoch-based reclamation scheme.
+/// @param th_state A pointer to thread's local state of the epoch-based reclamation scheme.
+/// @param obj A pointer to the retired node; it should be allocated from a pool with the same object size.
+/// @param owner The pid of the thread that allocated the node by synchEBRAlloc.
+void synchEBRRetire(SynchEBRStruct *ebr, SynchEBRThreadState *th_state, void *obj, int32_t owner);
+
+#endif
@@ -0,0 +1,140 @@
+/// @file ebstack.h
+/// @brief This file exposes the API of EB-Stack, an elimination-backoff version of the lock-free LF-Stack concurrent stack.
+/// An example of use of this API is provided in benchmarks/ebstackbench.c file.
+///
+/// Whenever the Compare&Swap of a push or a pop on the top of the underlying LF-Stack fails, the thread tries to meet
+/// a complementary operation in an elimination array before backing off. Each NUMA node has its own elimination array,
+/// thus the threads eliminate their operations with threads of the same NUMA node. A thread either posts an offer to
+/// a random slot of the array and waits for a partner for a while, or claims the offer of a complementary operation
+/// that it finds in the slot. Each thread adapts the range of slots that it uses: the range is doubled whenever the
+/// selected slot is occupied by another thread and it is reduced by one whenever a posted offer expires.
+///
+/// For a more detailed description see the original publication:
+/// Danny Hendler, Nir Shavit, and Lena Yerushalmi. "A scalable lock-free stack algorithm".
+/// Proceedings of the sixteenth annual ACM symposium on Parallelism in algorithms and architectures (SPAA), 2004.
+#ifndef _EBSTACK_H_
+#define _EBSTACK_H_
+
+#include <config.h>
+#include <queue-stack.h>
+#include <primitives.h>
+#include <lfstack.h>
+
+/// @brief The number of slots of the elimination array of each NUMA node.
+#ifndef EBSTACK_MAX_SLOTS
+#    define EBSTACK_MAX_SLOTS 32
+#endif
+
+/// @brief The number of times that a thread yields the processor (see synchResched) while it waits for a partner.
+#ifndef EBSTACK_ELIM_WAIT
+#    define EBSTACK_ELIM_WAIT 64
+#endif
+
+/// @brief In DEBUG builds, one out of EBSTACK_DEBUG_CAS_FAILURES Compare&Swap instructions on the top of the stack is
+/// skipped as if it had failed, thus the elimination protocol is exercised by validate.sh even without contention.
+/// It should be 0 (i.e. disabled) for performance measurements.
+#if defined(DEBUG) && !defined(EBSTACK_DEBUG_CAS_FAILURES)
+#    define EBSTACK_DEBUG_CAS_FAILURES 2
+#endif
+
+/// @brief A slot of an elimination array. A non-zero slot stores an offer that consists of the pid of the thread that
+/// posted it, the type of its operation and a sequence number, which makes each offer unique.
+typedef struct EBStackSlot {
+    volatile uint64_t word;
+    /// @brief Padding space.
+    char pad[PAD_CACHE(sizeof(uint64_t))];
+} EBStackSlot;
+
+/// @brief EBStackOffer stores the data of the offers posted by a thread.
+typedef struct EBStackOffer {
+    /// @brief The value that is pushed by the thread or the value that a partner passes to a pop of the thread.
+    volatile ArgVal val;
+    /// @brief The sequence number of the last offer of the thread that has been eliminated.
+    volatile uint64_t done;
+    /// @brief Padding space.
+    char pad[PAD_CACHE(sizeof(ArgVal) + sizeof(uint64_t))];
+} EBStackOffer;
+
+/// @brief EBStackStruct stores the state of an instance of the EB-Stack concurrent stack implementation.
+/// EBStackStruct should be initialized using the EBStackInit function.
+typedef struct EBStackStruct {
+    /// @brief The underlying lock-free stack.
+    LFStackStruct stack;
+    /// @brief An array of pointers to elimination arrays, one per NUMA node.
+    EBStackSlot **slots;
+    /// @brief An array of offers, one per thread.
+    EBStackOffer *offers;
+    /// @brief The number of NUMA nodes, i.e. the number of elimination arrays.
+    uint32_t numa_nodes;
+    /// @brief The maximum number of slots of an elimination array that a thread uses.
+    uint32_t max_width;
+} EBStackStruct;
+
+/// @brief EBStackThreadState stores each thread's local state for a single instance of EB-Stack.
+/// For each instance of EB-Stack, a discrete instance of EBStackThreadState should be used.
+typedef struct EBStackThreadState {
+    /// @brief The local state of the thread for the underlying lock-free stack.
+    LFStackThreadState lf;
+    /// @brief The elimination array of the NUMA node of the thread.
+    EBStackSlot *slots;
+    /// @brief The number of slots of the elimination array that the thread currently uses.
+    uint32_t width;
+    /// @brief The pid of the thread.
+    int pid;
+    /// @brief The sequence number of the last offer posted by the thread.
+    uint64_t seq;
+    /// @brief The number of operations of the thread that have been eliminated.
+    uint64_t eliminated;
+} EBStackThreadState;
+
+/// @brief This function initializes an instance of the EB-Stack concurrent stack implementation.
+///
+/// This function should be called once (by a single thread) before any other thread tries to
+/// apply any push or pop operation.
+///
+/// @param s A pointer to an instance of the EB-Stack concurrent stack implementation.
+/// @param nthreads The number of threads that will use the EB-Stack concurrent stack implementation.
+void EBStackInit(EBStackStruct *s, uint32_t nthreads);
+
+/// @brief This function should be called once before the thread applies any operation to the EB-Stack concurrent stack implementation.
+///
+/// @param s A pointer to an instance of the EB-Stack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of EB-Stack.
+/// @param min_back The minimum value for backoff (in most cases 0 is a good start).
+/// @param max_back The maximum value for backoff (usually this is much lower than 100).
+/// @param pid The pid of the calling thread.
+void EBStackThreadStateInit(EBStackStruct *s, EBStackThreadState *th_state, int min_back, int max_back, int pid);
+
+/// @brief This function adds (i.e. pushes) a new element to the top of the stack.
+/// This element has a value equal with arg.
+///
+/// @param s A pointer to an instance of the EB-Stack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of EB-Stack.
+/// @param arg The push operation will insert a new element to the stack with value equal to arg.
+void EBStackPush(EBStackStruct *s, EBStackThreadState *th_state, ArgVal arg);
+
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+///
+/// @param s A pointer to an instance of the EB-Stack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of EB-Stack.
+/// @return The value of the removed element, or EMPTY_STACK in case that the stack is empty.
+RetVal EBStackPop(EBStackStruct *s, EBStackThreadState *th_state);
+
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+/// In case that the stack is empty, the calling thread waits until an element is pushed (see eventcount.h).
+///
+/// @param s A pointer to an instance of the EB-Stack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of EB-Stack.
+/// @return The value of the removed element.
+RetVal EBStackPopBlocking(EBStackStruct *s, EBStackThreadState *th_state);
+
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+/// In case that the stack is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is pushed.
+///
+/// @param s A pointer to an instance of the EB-Stack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of EB-Stack.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @return The value of the removed element, or EMPTY_STACK in case that the stack remains empty for timeout_ns nanoseconds.
+RetVal EBStackPopTimed(EBStackStruct *s, EBStackThreadState *th_state, uint64_t timeout_ns);
+
+#endif
@@ -0,0 +1,131 @@
+/// @file eventcount.h
+/// @brief This file exposes the API of an eventcount, which is used by the blocking and timed dequeue/pop operations
+/// of the provided queues and stacks for parking the threads that find the data-structure empty.
+/// A thread that wants to wait for an element reads the current key of the eventcount with synchEventCountPrepare,
+/// checks again whether the data-structure is empty and, only in that case, it waits with synchEventCountWait until
+/// the key changes (SYNCH_EVENTCOUNT_WAIT_FOR implements this loop). Each enqueue or push calls synchEventCountNotify (or
+/// synchEventCountNotifyAfterRMW) after it inserts its element; the notifier
+/// changes the key and wakes up the waiting threads only in case that some thread is waiting, thus the enqueue and
+/// push operations pay for an additional system call only when there are waiting threads.
+/// The waiting threads first spin for a while and then they sleep on a futex, thus idle threads do not consume CPU.
+/// Fibers never sleep on the futex (see synchIsFiberScheduled); they yield the CPU instead (see synchResched).
+#ifndef _EVENTCOUNT_H_
+#define _EVENTCOUNT_H_
+
+#include <config.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <primitives.h>
+
+/// @brief The number of times that a waiting thread checks the key of the eventcount before it sleeps.
+#ifndef SYNCH_EVENTCOUNT_SPINS
+#    define SYNCH_EVENTCOUNT_SPINS 512
+#endif
+
+/// @brief SynchEventCount stores the state of an eventcount; it fills a whole cache line.
+/// SynchEventCount should be initialized using the synchEventCountInit function.
+typedef struct SynchEventCount {
+    /// @brief The key of the eventcount; it is increased by each notification that finds waiting threads.
+    volatile uint32_t key;
+    /// @brief The number of threads that have called synchEventCountPrepare and they have not finished waiting yet.
+    volatile int32_t waiters;
+    /// @brief Padding space.
+    char pad[PAD_CACHE(sizeof(uint32_t) + sizeof(int32_t))];
+} SynchEventCount;
+
+/// @brief This function initializes an eventcount.
+///
+/// @param ec A pointer to the eventcount.
+void synchEventCountInit(SynchEventCount *ec);
+
+/// @brief This function registers the calling thread as a waiter of the eventcount and returns the current key.
+/// After calling it, the thread should check again its waiting condition (e.g. whether the queue is still empty)
+/// and then call either synchEventCountWait or synchEventCountCancel.
+///
+/// @param ec A pointer to the eventcount.
+/// @return The current key of the eventcount.
+static inline uint32_t synchEventCountPrepare(SynchEventCount *ec) {
+    synchFAA32(&ec->waiters, 1);   // it is a full barrier, i.e. the key and the waiting condition are read afterwards
+
+    return ec->key;
+}
+
+/// @brief This function unregisters the calling thread that has called synchEventCountPrepare and it does not need to wait.
+///
+/// @param ec A pointer to the eventcount.
+static inline void synchEventCountCancel(SynchEventCount *ec) {
+    synchFAA32(&ec->waiters, -1);
+}
+
+/// @brief This function waits until the key of the eventcount is different than key or until the deadline expires.
+/// In any case, the calling thread is unregistered, i.e. it should call synchEventCountPrepare before waiting again.
+///
+/// @param ec A pointer to the eventcount.
+/// @param key The key returned by synchEventCountPrepare.
+/// @param deadline An absolute time of the CLOCK_MONOTONIC clock (see synchEventCountDeadline), or NULL for waiting without a deadline.
+/// @return false in case that the deadline has expired; otherwise true.
+bool synchEventCountWait(SynchEventCount *ec, uint32_t key, const struct timespec *deadline);
+
+/// @brief This function changes the key of the eventcount and wakes up all the threads that are waiting on it.
+/// It is called by synchEventCountNotify in case that there are waiting threads.
+///
+/// @param ec A pointer to the eventcount.
+void synchEventCountWake(SynchEventCount *ec);
+
+/// @brief This function should be called after the waiting condition of the threads that wait on the eventcount
+/// has changed (e.g. after an element is inserted to a queue). It wakes up the waiting threads (if any).
+///
+/// @param ec A pointer to the eventcount.
+static inline void synchEventCountNotify(SynchEventCount *ec) {
+    synchFullFence();   // the inserted element should be visible before reading the number of waiters
+    if (ec->waiters != 0)
+        synchEventCountWake(ec);
+}
+
+/// @brief This function is a variant of synchEventCountNotify for the operations that insert their element by an atomic
+/// read-modify-write instruction (e.g. the Compare&Swap of LF-Stack), or that observe that another thread has inserted
+/// it by such an instruction (e.g. the Compare&Swap of a Sim-based object that applies the request of the thread).
+/// The atomic instruction already orders the insertion before the read of the number of waiters, thus the full fence
+/// of synchEventCountNotify is needless on TSO machines.
+///
+/// @param ec A pointer to the eventcount.
+static inline void synchEventCountNotifyAfterRMW(SynchEventCount *ec) {
+    synchNonTSOFence();
+    if (ec->waiters != 0)
+        synchEventCountWake(ec);
+}
+
+/// @brief This macro implements the blocking and timed dequeue/pop operations on top of their non-blocking versions.
+/// It evaluates op (e.g. a dequeue) and stores its result to ret until the result is different than empty; whenever
+/// op returns empty, the calling thread waits on the eventcount until an element is inserted or the deadline expires.
+/// In the latter case, ret is equal to empty. Since op is evaluated once more after synchEventCountPrepare, an element
+/// that is inserted after that point changes the key, thus its notification could not be missed.
+///
+/// @param ec A pointer to the eventcount.
+/// @param ret An lvalue of type RetVal where the result of op is stored.
+/// @param op An expression that tries to remove an element and evaluates to empty in case that there is none.
+/// @param empty The value of op that indicates that the data-structure is empty (e.g. EMPTY_QUEUE).
+/// @param deadline An absolute time of the CLOCK_MONOTONIC clock (see synchEventCountDeadline), or NULL for waiting without a deadline.
+#define SYNCH_EVENTCOUNT_WAIT_FOR(ec, ret, op, empty, deadline)                                                        \
+    do {                                                                                                               \
+        uint32_t __ec_key;                                                                                             \
+                                                                                                                       \
+        while (((ret) = (op)) == (empty)) {                                                                            \
+            __ec_key = synchEventCountPrepare(ec);                                                                     \
+            if (((ret) = (op)) != (empty)) {                                                                           \
+                synchEventCountCancel(ec);                                                                             \
+                break;                                                                                                 \
+            }                                                                                                          \
+            if (!synchEventCountWait((ec), __ec_key, (deadline)))                                                      \
+                break;                                                                                                 \
+        }                                                                                                              \
+    } while (0)
+
+/// @brief This function computes the absolute time (of the CLOCK_MONOTONIC clock) that is timeout_ns nanoseconds after now.
+///
+/// @param deadline The computed absolute time is stored here.
+/// @param timeout_ns The timeout in nanoseconds.
+void synchEventCountDeadline(struct timespec *deadline, uint64_t timeout_ns);
+
+#endif
@@ -33,4 +33,25 @@ inline static RetVal fetchAndMultiply(void *state, ArgVal arg, int pid) {
     return (RetVal)res.state;
 }
 
+/// @brief This is the batch version of fetchAndMultiply, which is used by the batch entries of the combining objects
+/// (e.g. CCSynchApplyBatchOp). It applies n Fetch&Multiply operations in a single pass: the return value of each
+/// operation is the product of the previous one, while the state of the object is read and written only once.
+///
+/// @param state Pointer to the stored data.
+/// @param args The arguments of the n operations.
+/// @param rets The return values of the n operations are stored here.
+/// @param n The number of operations.
+inline static void fetchAndMultiplyBatch(void *state, ArgVal *args, RetVal *rets, uint32_t n) {
+    ObjectState *obj = (ObjectState *)state;
+    ObjectState res;
+    uint32_t i;
+
+    res.state_f = obj->state_f;
+    for (i = 0; i < n; i++) {
+        rets[i] = (RetVal)res.state;
+        res.state_f *= 1.000001;
+    }
+    obj->state_f = res.state_f;
+}
+
 #endif
@@ -27,6 +27,7 @@ typedef struct HalfFCRequest {
     volatile int age;
     volatile bool active;
     volatile bool pending;
+    volatile uint32_t parked;
 } HalfFCRequest;
 
 typedef struct FCRequest {
@@ -40,6 +41,8 @@ typedef struct FCRequest {
     volatile bool active;
     /// @brief If the request is pending or not.
     volatile bool pending;
+    /// @brief It is equal to SYNCH_PARK_PARKED while the owner of the request is parked (see park.h).
+    volatile uint32_t parked;
     /// @brief Padding space.
     char pad[CACHE_LINE_SIZE - sizeof(HalfFCRequest)];
 } FCRequest;
@@ -58,6 +61,9 @@ typedef struct FCStruct {
     volatile uint64_t counter;
     /// @brief The total number of executed combining rounds.
     volatile uint64_t rounds;
+    /// @brief The number of threads that are parked (or they are just about to park) on their requests.
+    /// The combiner wakes them up only in case that this field is not equal to 0.
+    volatile int32_t parked CACHE_ALIGN;
 } FCStruct;
 
 /// @brief FCThreadState stores each thread's local state for a single instance of FC.
@@ -17,6 +17,7 @@
 #include <primitives.h>
 #include <pool.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 
 /// @brief FCQueueStruct stores the state of an instance of the FC-Queue concurrent queue implementation.
 /// FCQueueStruct should be initialized using the FCQueueStructInit function.
@@ -31,6 +32,8 @@ typedef struct FCQueueStruct {
     volatile Node *first CACHE_ALIGN;
     /// @brief A guard node that it is used only at the initialization of the queue.
     Node guard CACHE_ALIGN;
+    /// @brief An eventcount, on which the blocking and timed dequeue operations wait while the queue is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } FCQueueStruct;
 
 /// @brief FCQueueThreadState stores each thread's local state for a single instance of FC-Queue.
@@ -74,4 +77,23 @@ void FCQueueApplyEnqueue(FCQueueStruct *object_struct, FCQueueThreadState *lobje
 /// @return The value of the removed element.
 RetVal FCQueueApplyDequeue(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, int pid);
 
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits until an element is enqueued (see eventcount.h).
+///
+/// @param object_struct A pointer to an instance of the FC-Queue concurrent queue implementation.
+/// @param lobject_struct A pointer to thread's local state of FC-Queue.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal FCQueueApplyDequeueBlocking(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is enqueued.
+///
+/// @param object_struct A pointer to an instance of the FC-Queue concurrent queue implementation.
+/// @param lobject_struct A pointer to thread's local state of FC-Queue.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue remains empty for timeout_ns nanoseconds.
+RetVal FCQueueApplyDequeueTimed(FCQueueStruct *object_struct, FCQueueThreadState *lobject_struct, uint64_t timeout_ns, int pid);
+
 #endif
@@ -0,0 +1,101 @@
+/// @file helpbound.h
+/// @brief This file exposes the API of the help bound that is used by the combining objects (i.e. CC-Synch, DSM-Synch,
+/// H-Synch, Osci and the combining object of Oyama et al.); a combiner applies at most as many requests as the help bound
+/// in a single combining round. By default, the help bound is fixed (e.g. CCSYNCH_HELP_FACTOR * nthreads).
+/// In case that a target length for the combining rounds is set (see synchHelpBoundSetPolicy), the help bound of the
+/// instance is adapted at runtime: each combiner measures the length of its round and the help bound is decreased by
+/// a quarter whenever a round exceeds the target, while it is increased by an eighth whenever a round is cut short by
+/// the help bound and it lasts less than the half of the target. Thus, the target bounds the latency of the combiner
+/// itself, while the combining degree stays as high as the target allows.
+/// The help bound of an instance is accessed only by the combiner of the instance, thus no atomic instructions are used.
+#ifndef _HELPBOUND_H_
+#define _HELPBOUND_H_
+
+#include <config.h>
+#include <stdint.h>
+#include <primitives.h>
+
+/// @brief The value of the min_bound and max_bound arguments of synchHelpBoundSetPolicy that selects their default values.
+#define SYNCH_HELP_BOUND_DEFAULT 0
+
+/// @brief In case that the adaptive policy is used, the default maximum help bound is equal to
+/// SYNCH_HELP_BOUND_MAX_FACTOR times the fixed help bound of the instance.
+#ifndef SYNCH_HELP_BOUND_MAX_FACTOR
+#    define SYNCH_HELP_BOUND_MAX_FACTOR 4
+#endif
+
+/// @brief SynchHelpBound stores the help bound of a combining object and the statistics of its combining rounds.
+/// SynchHelpBound should be initialized using the synchHelpBoundInit function.
+typedef struct SynchHelpBound {
+    /// @brief The current help bound, i.e. the maximum number of requests that a combiner applies in a single round.
+    volatile uint32_t bound;
+    /// @brief The minimum value of the help bound.
+    uint32_t min_bound;
+    /// @brief The maximum value of the help bound.
+    uint32_t max_bound;
+    /// @brief The help bound that is used in case that the adaptive policy is disabled.
+    uint32_t fixed_bound;
+    /// @brief The target length of a combining round in nanoseconds; it is equal to 0 in case that the help bound is fixed.
+    uint64_t target_ns;
+    /// @brief The number of the combining rounds that have been measured.
+    uint64_t rounds;
+    /// @brief The number of requests that have been applied by the measured rounds.
+    uint64_t requests;
+    /// @brief The number of the measured rounds that have exceeded the target.
+    uint64_t over_target;
+    /// @brief The total length of the measured rounds in nanoseconds.
+    uint64_t total_ns;
+    /// @brief The length of the longest measured round in nanoseconds.
+    uint64_t max_round_ns;
+} SynchHelpBound;
+
+/// @brief This function initializes a fixed help bound.
+///
+/// @param hb A pointer to the help bound.
+/// @param bound The fixed value of the help bound.
+void synchHelpBoundInit(SynchHelpBound *hb, uint32_t bound);
+
+/// @brief This function enables the adaptive policy for a help bound. It should be called after synchHelpBoundInit
+/// and before any combining round starts.
+///
+/// @param hb A pointer to the help bound.
+/// @param target_ns The target length of a combining round in nanoseconds; 0 restores the fixed help bound.
+/// @param min_bound The minimum value of the help bound, or SYNCH_HELP_BOUND_DEFAULT for 1.
+/// @param max_bound The maximum value of the help bound, or SYNCH_HELP_BOUND_DEFAULT for SYNCH_HELP_BOUND_MAX_FACTOR
+/// times the fixed help bound.
+void synchHelpBoundSetPolicy(SynchHelpBound *hb, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound);
+
+/// @brief This function prints the current help bound and the statistics of the combining rounds (see the GetHelpStats
+/// functions of the combining objects, e.g. CCSynchGetHelpStats) to the standard error.
+///
+/// @param stats A snapshot of a help bound.
+void synchPrintHelpStats(SynchHelpBound *stats);
+
+/// @brief This function adapts the help bound according to the length of a combining round. It is called by
+/// synchHelpBoundEnd and it should not be directly used by the user.
+///
+/// @param hb A pointer to the help bound.
+/// @param round_ns The length of the round in nanoseconds.
+/// @param served The number of requests applied by the round.
+void synchHelpBoundAdapt(SynchHelpBound *hb, uint64_t round_ns, uint32_t served);
+
+/// @brief This function should be called by a combiner before it starts its combining round.
+///
+/// @param hb A pointer to the help bound.
+/// @return The start time of the round, which should be passed to synchHelpBoundEnd (0 in case that the help bound is fixed).
+static inline int64_t synchHelpBoundStart(SynchHelpBound *hb) {
+    return (hb->target_ns != 0) ? synchGetTimeNanos() : 0;
+}
+
+/// @brief This function should be called by a combiner after it applies the last request of its combining round and
+/// before it hands off the combining role to another thread.
+///
+/// @param hb A pointer to the help bound.
+/// @param start The value returned by synchHelpBoundStart.
+/// @param served The number of requests applied by the round.
+static inline void synchHelpBoundEnd(SynchHelpBound *hb, int64_t start, uint32_t served) {
+    if (hb->target_ns != 0)
+        synchHelpBoundAdapt(hb, synchGetTimeNanos() - start, served);
+}
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <config.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 #include <hsynch.h>
 #include <primitives.h>
 
@@ -22,6 +23,10 @@ typedef struct HStackStruct {
     HSynchStruct object_struct CACHE_ALIGN;
     /// @brief A pointer to the top element of the stack.
     volatile Node *top CACHE_ALIGN;
+    /// @brief The topmost elements of the stack, which are stored above top (see SynchElimBuffer).
+    SynchElimBuffer elim;
+    /// @brief An eventcount, on which the blocking and timed pop operations wait while the stack is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } HStackStruct;
 
 /// @brief HStackThreadState stores each thread's local state for a single instance of H-Stack.
@@ -67,4 +72,30 @@ void HStackPush(HStackStruct *object_struct, HStackThreadState *lobject_struct,
 /// @return The value of the removed element.
 RetVal HStackPop(HStackStruct *object_struct, HStackThreadState *lobject_struct, int pid);
 
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+/// In case that the stack is empty, the calling thread waits until an element is pushed (see eventcount.h).
+///
+/// @param object_struct A pointer to an instance of the H-Stack concurrent stack implementation.
+/// @param lobject_struct A pointer to thread's local state of H-Stack.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal HStackPopBlocking(HStackStruct *object_struct, HStackThreadState *lobject_struct, int pid);
+
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+/// In case that the stack is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is pushed.
+///
+/// @param object_struct A pointer to an instance of the H-Stack concurrent stack implementation.
+/// @param lobject_struct A pointer to thread's local state of H-Stack.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_STACK in case that the stack remains empty for timeout_ns nanoseconds.
+RetVal HStackPopTimed(HStackStruct *object_struct, HStackThreadState *lobject_struct, uint64_t timeout_ns, int pid);
+
+/// @brief This function takes a snapshot of the statistics of the elimination buffer of the stack (see SynchElimBuffer).
+/// It should be called while no operation is applied to the stack, e.g. after the threads have been joined.
+///
+/// @param object_struct A pointer to an instance of the H-Stack concurrent stack implementation.
+/// @param stats The snapshot of the statistics is stored here.
+void HStackGetElimStats(HStackStruct *object_struct, SynchElimStats *stats);
+
 #endif
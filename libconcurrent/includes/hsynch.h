@@ -12,6 +12,14 @@
 
 #include <config.h>
 #include <primitives.h>
+#include <threadtools.h>
+#include <helpbound.h>
+#include <park.h>
+#include <async.h>
+
+/// @brief By default, a combiner applies at most HSYNCH_HELP_FACTOR * nthreads requests in a single combining round
+/// (see HSynchStructSetHelpPolicy).
+#define HSYNCH_HELP_FACTOR 10
 #include <clh.h>
 
 /// @brief Whenever numa_regions is equal to HSYNCH_DEFAULT_NUMA_POLICY, the user uses the default number of NUMA nodes,
@@ -62,6 +70,8 @@ typedef union HSynchNodePtr {
 typedef struct HSynchThreadState {
     /// @brief pointer to an empty request that would be used for announcing future requests.
     HSynchNode *next_node;
+    /// @brief The Numa node (as it is considered by HSynch) of the thread.
+    int node_of_thread;
 } HSynchThreadState;
 
 ///  @brief HSynchStruct stores the state of an instance of the a HSynch combining object.
@@ -71,6 +81,8 @@ typedef struct HSynchStruct {
     CLHLockStruct *central_lock CACHE_ALIGN;
     /// @brief A tail to the list of announced requests.
     HSynchNodePtr *Tail CACHE_ALIGN;
+    /// @brief The help bound of the instance (see HSynchStructSetHelpPolicy).
+    SynchHelpBound help CACHE_ALIGN;
 #ifdef DEBUG
     volatile uint64_t counter CACHE_ALIGN;
     volatile int rounds;
@@ -82,6 +94,12 @@ typedef struct HSynchStruct {
     int32_t *node_indexes;
     /// @brief The number of threads that will use the HSynch combining object.
     uint32_t nthreads;
+    /// @brief The arguments of the requests that are served by the current combiner of HSynchApplyBatchOp.
+    ArgVal *batch_args;
+    /// @brief The return values of the requests that are served by the current combiner of HSynchApplyBatchOp.
+    RetVal *batch_rets;
+    /// @brief The number of requests that batch_args and batch_rets have room for.
+    uint32_t batch_capacity;
     /// @brief The size in terms of processing elements that each Numa node has.
     uint32_t numa_node_size;
     /// @brief The number of Numa nodes.
@@ -109,6 +127,23 @@ void HSynchStructInit(HSynchStruct *l, uint32_t nthreads, uint32_t numa_regions)
 /// @param pid The pid of the calling thread.
 void HSynchThreadStateInit(HSynchStruct *l, HSynchThreadState *st_thread, int pid);
 
+/// @brief This function enables (or disables) the adaptive help bound for an instance of the HSynch combining object.
+/// The help bound is adapted so as the length of a combining round stays below target_ns (see helpbound.h).
+/// This function should be called after the instance is initialized and before any thread applies any request to it.
+///
+/// @param l A pointer to an instance of the HSynch combining object.
+/// @param target_ns The target length of a combining round in nanoseconds; 0 restores the fixed help bound.
+/// @param min_bound The minimum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+/// @param max_bound The maximum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+void HSynchStructSetHelpPolicy(HSynchStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound);
+
+/// @brief This function returns the current help bound of an instance of the HSynch combining object and the statistics of its
+/// combining rounds. The statistics are collected only while the adaptive help bound is enabled.
+///
+/// @param l A pointer to an instance of the HSynch combining object.
+/// @param stats A snapshot of the help bound of the instance is stored here.
+void HSynchGetHelpStats(HSynchStruct *l, SynchHelpBound *stats);
+
 /// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
 ///
 /// @param l A pointer to an instance of the HSynch combining object.
@@ -119,4 +154,118 @@ void HSynchThreadStateInit(HSynchStruct *l, HSynchThreadState *st_thread, int pi
 /// @param pid The pid of the calling thread.
 /// @return RetVal The return value of the applied request.
 RetVal HSynchApplyOp(HSynchStruct *l, HSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid);
+
+/// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
+/// In contrast to HSynchApplyOp, the combiner collects the arguments of the requests that it serves in a combining round
+/// into an array and it applies all of them by calling batch_sfunc once. Thus, the simulated object is able to merge
+/// the requests of a round (e.g. k Fetch&Multiply requests could be applied as a single multiplication).
+/// The requests of an instance should be applied either by HSynchApplyOp or by HSynchApplyBatchOp, but not by both.
+///
+/// @param l A pointer to an instance of the HSynch combining object.
+/// @param st_thread A pointer to thread's local state for a specific instance of HSynch.
+/// @param batch_sfunc A serial function that applies n requests; args[i] is the argument of the i-th request and the
+/// return value of the i-th request should be stored to rets[i]. The requests are given in the order they are served.
+/// @param state A pointer to the state of the simulated object.
+/// @param arg The argument of the request that the thread wants to apply.
+/// @param pid The pid of the calling thread.
+/// @return RetVal The return value of the applied request.
+RetVal HSynchApplyBatchOp(HSynchStruct *l, HSynchThreadState *st_thread, void (*batch_sfunc)(void *, ArgVal *, RetVal *, uint32_t), void *state, ArgVal arg, int pid);
+
+/// @brief This function submits a request to the simulated concurrent object without waiting for it to be applied
+/// (see async.h). The return value of the request is collected later by synchTicketPoll, synchTicketWait or
+/// synchTicketWaitAll. In case that the calling thread becomes the combiner at once, the combining round is executed
+/// before this function returns. The calling thread should not submit (or apply) another request to the same instance
+/// before the ticket is completed.
+///
+/// @param l A pointer to an instance of the HSynch combining object.
+/// @param st_thread A pointer to thread's local state for a specific instance of HSynch.
+/// @param sfunc A serial function that the HSynch instance should execute, while applying requests announced by active threads.
+/// @param state A pointer to the state of the simulated object.
+/// @param arg The argument of the request that the thread wants to apply.
+/// @param pid The pid of the calling thread.
+/// @param ticket The ticket of the request is stored here.
+void HSynchSubmitOp(HSynchStruct *l, HSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid, SynchTicket *ticket);
+
+/// @brief This function acquires the central lock and executes a combining round, starting from the request of cur.
+/// It is called by the combiner of a Numa node and it should not be directly used by the user.
+static inline ALWAYS_INLINE void HSynchCombineInline(HSynchStruct *l, volatile HSynchNode *cur, RetVal (*sfunc)(void *, ArgVal, int), void *state, int pid) {
+    volatile HSynchNode *p;
+    register HSynchNode *tmp_next;
+    register int counter = 0;
+    int help_bound;
+    int64_t start;
+    SynchParkWakeList wake_list;
+
+    synchParkWakeListInit(&wake_list);
+    p = cur;            // I am not been helped
+    CLHLock(l->central_lock, pid);
+#ifdef DEBUG
+    l->rounds++;
+#endif
+    help_bound = l->help.bound;
+    start = synchHelpBoundStart(&l->help);
+    while (counter < help_bound && p->next != NULL) {
+        synchReadPrefetch(p->next);
+        counter++;
+#ifdef DEBUG
+        l->counter++;
+#endif
+        tmp_next = p->next;
+        p->arg_ret = sfunc(state, p->arg_ret, p->pid);
+        synchNonTSOFence();
+        p->completed = true;
+        synchNonTSOFence();
+        synchParkUnlockDeferred(&p->locked, &wake_list);
+        p = tmp_next;
+
+        // A full-memory barrier is inserted for performance optimization, with conditional behavior based on the processor type.
+        // This memory barrier is insert to enhance performance in a specific scenario. On non-Intel processors, applying this
+        // full-memory barrier can yield a slight performance improvement, when there are no remaining requests to be served.
+        // However, it's important to note that on Intel X86 machines, this barrier may actually degrade performance.
+        if (tmp_next->next == NULL && synchGetMachineModel() != INTEL_X86_MACHINE)
+            synchFullFence();
+    }
+    synchHelpBoundEnd(&l->help, start, counter);
+    synchParkUnlock(&p->locked); // Unlock the next one
+    CLHUnlock(l->central_lock, pid);
+    synchParkWakeAll(&wake_list);
+}
+
+/// @brief This function is the inlinable version of HSynchApplyOp. In case that sfunc is a constant whose definition is
+/// visible (i.e. a static inline function), the compiler is able to inline it in the combining loop.
+/// Usually, it is used through HSYNCH_DEFINE_APPLY_OP and not directly.
+static inline ALWAYS_INLINE RetVal HSynchApplyOpInline(HSynchStruct *l, HSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
+    volatile HSynchNode *cur;
+    register HSynchNode *next_node;
+
+    next_node = st_thread->next_node;
+    next_node->next = NULL;
+    next_node->locked = true;
+    next_node->completed = false;
+
+    cur = (volatile HSynchNode *)synchSWAP(&l->Tail[st_thread->node_of_thread].ptr, next_node);
+    cur->arg_ret = arg;
+    cur->pid = pid;
+    cur->next = (HSynchNode *)next_node;
+
+    st_thread->next_node = (HSynchNode *)cur;
+
+    synchParkWait(&cur->locked); // spinning, then parking
+
+    if (cur->completed) // I have been helped
+        return cur->arg_ret;
+    HSynchCombineInline(l, cur, sfunc, state, pid);
+
+    return cur->arg_ret;
+}
+
+/// @brief This macro defines a function named NAME that is equivalent to HSynchApplyOp, but it is specialized for the
+/// serial function SFUNC, i.e. SFUNC is inlined in the combining loop instead of being called through a pointer.
+/// The defined function has the following signature:
+/// `static inline RetVal NAME(HSynchStruct *l, HSynchThreadState *st_thread, void *state, ArgVal arg, int pid)`.
+/// An example of use is provided in benchmarks/hsynchbench.c file.
+#define HSYNCH_DEFINE_APPLY_OP(NAME, SFUNC)                                                                           \
+    static inline RetVal NAME(HSynchStruct *l, HSynchThreadState *st_thread, void *state, ArgVal arg, int pid) {    \
+        return HSynchApplyOpInline(l, st_thread, SFUNC, state, arg, pid);                                             \
+    }
 #endif
@@ -47,22 +47,31 @@
 
 #include <config.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 
 // Definition: RING_POW
 // --------------------
-// The LCRQ's ring size will be 2^{RING_POW}.
+// The default order of the LCRQ's rings, i.e. in case that
+// LCRQInit is called with ring_pow equal to 0, the ring size
+// will be 2^{RING_POW}.
 #ifndef RING_POW
 #define RING_POW        (14)
 #endif
-#define RING_SIZE       (1ULL << RING_POW)
+
+// Definition: RING_POW_MAX
+// --------------------
+// The maximum order of the LCRQ's rings.
+#define RING_POW_MAX    (30)
 
 
 // Definition: HAVE_HPTRS
 // --------------------
 // Define to enable hazard pointer setting for safe memory
-// reclamation.  You'll need to integrate this with your
-// hazard pointers implementation.
-//#define HAVE_HPTRS
+// reclamation. A ring that is removed from the queue is retired
+// by the dequeuer that removed it and, as soon as no hazard
+// pointer protects it, it is moved to a free-list of rings that
+// enqueuers reuse instead of allocating new rings.
+#define HAVE_HPTRS
 
 typedef struct RingNode {
     volatile uint64_t val;
@@ -74,9 +83,32 @@ typedef struct RingQueue {
     volatile int64_t head S_CACHE_ALIGN;
     volatile int64_t tail S_CACHE_ALIGN;
     struct RingQueue *next S_CACHE_ALIGN;
-    RingNode array[RING_SIZE] S_CACHE_ALIGN;
+    /// @brief The NUMA node where the memory of the ring is allocated.
+    int32_t numa_node;
+    /// @brief The cells of the ring; their number is given by the ring_size field of LCRQStruct.
+    RingNode array[] S_CACHE_ALIGN;
 } RingQueue;
 
+#ifdef HAVE_HPTRS
+/// @brief LCRQHazardSlot stores the hazard pointer of a thread; each slot fills a whole cache line.
+typedef struct LCRQHazardSlot {
+    /// @brief The ring that the thread is currently accessing, or NULL.
+    RingQueue *volatile ptr;
+    /// @brief Padding space.
+    char pad[PAD_CACHE(sizeof(RingQueue *))];
+} LCRQHazardSlot;
+
+/// @brief LCRQFreeList is the top of a stack of rings that are no longer accessible by any thread.
+/// The rings are linked through their next field and the tag is increased by each update of the
+/// top, in order to avoid the ABA problem.
+typedef struct LCRQFreeList {
+    /// @brief The topmost free ring, or NULL.
+    RingQueue *volatile top;
+    /// @brief The number of times that top has been updated.
+    volatile uint64_t tag;
+} LCRQFreeList;
+#endif
+
 /// @brief LCRQStruct stores the state of an instance of the LCRQ concurrent queue implementation.
 /// LCRQStruct should be initialized using the LCRQStructInit function.
 typedef struct LCRQStruct {
@@ -84,10 +116,28 @@ typedef struct LCRQStruct {
     RingQueue *head;
     /// @brief A pointer to the tail Ring.
     RingQueue *tail;
-#ifdef DEBUG
+    /// @brief The number of cells of each ring; it is a power of two.
+    uint64_t ring_size;
+    /// @brief The number of bytes of each ring.
+    size_t ring_bytes;
+#ifdef HAVE_HPTRS
+    /// @brief The free-list of rings that could be reused by the enqueuers.
+    LCRQFreeList free_rings CACHE_ALIGN;
+    /// @brief An array of hazard pointers, one per thread.
+    LCRQHazardSlot *hazardptrs CACHE_ALIGN;
+    /// @brief The number of threads that use this instance.
+    uint32_t nthreads;
+#endif
+    /// @brief The number of rings that have been appended to the queue by the enqueuers (see LCRQCollectStats).
+    uint64_t opens;
+    /// @brief The number of rings that have been closed by the enqueuers (see LCRQCollectStats).
     uint64_t closes;
+    /// @brief The number of cells that have been marked as unsafe by the dequeuers (see LCRQCollectStats).
     uint64_t unsafes;
-#endif
+    /// @brief The number of retired rings that have been moved to the free-list (see LCRQCollectStats).
+    uint64_t recycles;
+    /// @brief An eventcount, on which the blocking and timed dequeue operations wait while the queue is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } LCRQStruct;
 
 /// @brief LCRQThreadState stores each thread's local state for a single instance of LCRQ.
@@ -95,12 +145,17 @@ typedef struct LCRQStruct {
 typedef struct LCRQThreadState {
     RingQueue *nrq;
 #ifdef HAVE_HPTRS
-    RingQueue *hazardptr;
+    /// @brief A pointer to the hazard pointer slot of the thread.
+    LCRQHazardSlot *hazardptr;
+    /// @brief The rings retired by the thread that were still protected by some hazard pointer during the last scan.
+    RingQueue **retired;
+    /// @brief The number of rings stored in retired.
+    uint32_t retired_size;
 #endif
-#ifdef DEBUG
+    uint64_t myopens;
     uint64_t mycloses;
     uint64_t myunsafes;
-#endif
+    uint64_t myrecycles;
 } LCRQThreadState;
 
 /// @brief This function initializes an instance of the LCRQ concurrent queue implementation.
@@ -109,13 +164,16 @@ typedef struct LCRQThreadState {
 ///
 /// @param queue A pointer to an instance of the LCRQ concurrent queue implementation.
 /// @param nthreads The number of threads that will use the LCRQ concurrent queue implementation.
-void LCRQInit(LCRQStruct *queue, uint32_t nthreads);
+/// @param ring_pow The order of the rings of the queue, i.e. each ring has 2^{ring_pow} cells; in case that ring_pow
+/// is equal to 0, RING_POW is used. Values greater than RING_POW_MAX are reduced to RING_POW_MAX.
+void LCRQInit(LCRQStruct *queue, uint32_t nthreads, uint32_t ring_pow);
 
 /// @brief This function should be called once before the thread applies any operation to the LCRQ concurrent queue implementation.
 ///
+/// @param queue A pointer to an instance of the LCRQ concurrent queue implementation.
 /// @param thread_state A pointer to thread's local state of LCRQ.
-/// @param pid The pid of the calling thread.
-void LCRQThreadStateInit(LCRQThreadState *thread_state, int pid);
+/// @param pid The pid of the calling thread; it should be lower than the number of threads given to LCRQInit.
+void LCRQThreadStateInit(LCRQStruct *queue, LCRQThreadState *thread_state, int pid);
 
 /// @brief This function adds (i.e. enqueues) a new element to the back of the queue.
 /// This element has a value equal with arg.
@@ -132,4 +190,58 @@ void LCRQEnqueue(LCRQStruct *queue, LCRQThreadState *thread_state, ArgVal arg, i
 /// @param thread_state A pointer to thread's local state of LCRQ.
 /// @param pid The pid of the calling thread.
 /// @return The value of the removed element.
-RetVal LCRQDequeue(LCRQStruct *queue, LCRQThreadState *thread_state, int pid);
\ No newline at end of file
+RetVal LCRQDequeue(LCRQStruct *queue, LCRQThreadState *thread_state, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits until an element is enqueued (see eventcount.h).
+///
+/// @param queue A pointer to an instance of the LCRQ concurrent queue implementation.
+/// @param thread_state A pointer to thread's local state of LCRQ.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal LCRQDequeueBlocking(LCRQStruct *queue, LCRQThreadState *thread_state, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is enqueued.
+///
+/// @param queue A pointer to an instance of the LCRQ concurrent queue implementation.
+/// @param thread_state A pointer to thread's local state of LCRQ.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue remains empty for timeout_ns nanoseconds.
+RetVal LCRQDequeueTimed(LCRQStruct *queue, LCRQThreadState *thread_state, uint64_t timeout_ns, int pid);
+
+/// @brief This function adds (i.e. enqueues) n new elements to the back of the queue, in the order they are given.
+/// The calling thread reserves consecutive cells of the tail ring for the whole batch using a single Fetch&Add on its
+/// tail and then stores the elements to these cells using 128-bit CAS. In case that a reserved cell could not be used
+/// (e.g. a dequeuer has already passed it), the element is stored to the next reserved cell, thus no reserved cell is
+/// left unused. In case that the ring is closed or becomes full during the batch, the ring is closed and the elements
+/// that are not stored yet are enqueued one by one (as in LCRQEnqueue).
+/// The batch is not applied atomically, i.e. elements of other threads may be interleaved with its elements.
+///
+/// @param queue A pointer to an instance of the LCRQ concurrent queue implementation.
+/// @param thread_state A pointer to thread's local state of LCRQ.
+/// @param values An array with the values of the n elements.
+/// @param n The number of elements.
+/// @param pid The pid of the calling thread.
+void LCRQEnqueueBatch(LCRQStruct *queue, LCRQThreadState *thread_state, ArgVal *values, uint32_t n, int pid);
+
+/// @brief This function removes (i.e. dequeues) up to max elements from the front of the queue and stores their values to out.
+/// The calling thread reserves consecutive cells of the head ring using a single Fetch&Add on its head and then drains
+/// these cells using 128-bit CAS. The values are stored to out in FIFO order.
+///
+/// @param queue A pointer to an instance of the LCRQ concurrent queue implementation.
+/// @param thread_state A pointer to thread's local state of LCRQ.
+/// @param out An array of at least max entries, where the values of the removed elements are stored.
+/// @param max The maximum number of elements to remove.
+/// @param pid The pid of the calling thread.
+/// @return The number of the removed elements; it is lower than max only in case that the queue became empty.
+uint32_t LCRQDequeueBatch(LCRQStruct *queue, LCRQThreadState *thread_state, RetVal *out, uint32_t max, int pid);
+
+/// @brief This function adds the counters of rings opened, rings closed, unsafe cells and recycled rings of
+/// the calling thread to the corresponding counters of the queue (i.e. opens, closes, unsafes and recycles)
+/// and resets them. It is usually called once by each thread after its last operation.
+///
+/// @param queue A pointer to an instance of the LCRQ concurrent queue implementation.
+/// @param thread_state A pointer to thread's local state of LCRQ.
+void LCRQCollectStats(LCRQStruct *queue, LCRQThreadState *thread_state);
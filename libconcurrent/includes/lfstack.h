@@ -9,15 +9,21 @@
 
 #include <config.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 #include <primitives.h>
 #include <backoff.h>
 #include <pool.h>
+#include <ebr.h>
 
 /// @brief LFStackStruct stores the state of an instance of the LF-Stack concurrent stack implementation.
 /// LFStackStruct should be initialized using the LFStackInit function.
 typedef struct LFStackStruct {
     /// @brief A pointer to the top element of the stack.
     volatile Node *top;
+    /// @brief The epoch-based reclamation scheme that recycles the removed nodes.
+    SynchEBRStruct ebr;
+    /// @brief An eventcount, on which the blocking and timed pop operations wait while the stack is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } LFStackStruct;
 
 /// @brief LFStackThreadState stores each thread's local state for a single instance of LF-Stack.
@@ -27,6 +33,8 @@ typedef struct LFStackThreadState {
     SynchPoolStruct pool;
     /// @brief A backoff object per thread is used for reducing the contention while accessing the queue.
     SynchBackoffStruct backoff;
+    /// @brief The local state of the thread for the epoch-based reclamation scheme.
+    SynchEBRThreadState ebr;
 } LFStackThreadState;
 
 /// @brief This function initializes an instance of the LF-Stack concurrent stack implementation.
@@ -35,14 +43,17 @@ typedef struct LFStackThreadState {
 /// apply any push or pop operation.
 ///
 /// @param l A pointer to an instance of the LF-Stack concurrent stack implementation.
-void LFStackInit(LFStackStruct *l);
+/// @param nthreads The number of threads that will use the LF-Stack concurrent stack implementation.
+void LFStackInit(LFStackStruct *l, uint32_t nthreads);
 
 /// @brief This function should be called once before the thread applies any operation to the LF-Stack concurrent stack implementation.
 ///
+/// @param l A pointer to an instance of the LF-Stack concurrent stack implementation.
 /// @param th_state A pointer to thread's local state of LF-Stack.
 /// @param min_back The minimum value for backoff (in most cases 0 is a good start).
 /// @param max_back The maximum value for backoff (usually this is much lower than 100).
-void LFStackThreadStateInit(LFStackThreadState *th_state, int min_back, int max_back);
+/// @param pid The pid of the calling thread.
+void LFStackThreadStateInit(LFStackStruct *l, LFStackThreadState *th_state, int min_back, int max_back, int pid);
 
 /// @brief This function adds (i.e. pushes) a new element to the top of the stack.
 /// This element has a value equal with arg.
@@ -59,4 +70,21 @@ void LFStackPush(LFStackStruct *l, LFStackThreadState *th_state, ArgVal arg);
 /// @return The value of the removed element.
 RetVal LFStackPop(LFStackStruct *l, LFStackThreadState *th_state);
 
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+/// In case that the stack is empty, the calling thread waits until an element is pushed (see eventcount.h).
+///
+/// @param l A pointer to an instance of the LF-Stack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of LF-Stack.
+/// @return The value of the removed element.
+RetVal LFStackPopBlocking(LFStackStruct *l, LFStackThreadState *th_state);
+
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+/// In case that the stack is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is pushed.
+///
+/// @param l A pointer to an instance of the LF-Stack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of LF-Stack.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @return The value of the removed element, or EMPTY_STACK in case that the stack remains empty for timeout_ns nanoseconds.
+RetVal LFStackPopTimed(LFStackStruct *l, LFStackThreadState *th_state, uint64_t timeout_ns);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+/// @file mhsynch.h
+/// @brief This file exposes the API of the MH-Synch combining object, i.e. a multi-level variant of H-Synch.
+/// An example of use of this API is provided in benchmarks/mhsynchbench.c file.
+///
+/// H-Synch combines the requests of the threads of each NUMA node and then it uses a lock for serializing the
+/// combiners of the different NUMA nodes. MH-Synch generalizes this to an arbitrary-depth hierarchy, which is built
+/// from the detected cache and NUMA topology of the machine (e.g. SMT cores, L3 caches, dies and sockets, see topology.h).
+/// Each domain of each level has a list of announced requests (in the same way as CC-Synch). A thread announces its
+/// request to the list of its domain at the finest level. The combiner of a list collects a batch of the requests of
+/// the list and then it announces this batch to the list of its domain at the next level, where it is combined with
+/// the batches of the other domains. The combiner of the top-level list applies all the requests of the collected
+/// batches and then it hands off the combining role at every level that it has combined. Thus, the threads that share
+/// a cache combine their requests before they move up, and only a single batch per domain moves across the levels.
+#ifndef _MHSYNCH_H_
+#define _MHSYNCH_H_
+
+#include <config.h>
+#include <primitives.h>
+#include <threadtools.h>
+#include <helpbound.h>
+#include <park.h>
+#include <topology.h>
+
+/// @brief By default, a combiner applies at most MHSYNCH_HELP_FACTOR * nthreads requests in a single combining round
+/// (see MHSynchStructSetHelpPolicy).
+#define MHSYNCH_HELP_FACTOR 10
+
+/// @brief The maximum number of lists that a request may pass, i.e. the levels of the topology plus the top-level list.
+#define MHSYNCH_MAX_LEVELS (SYNCH_TOPOLOGY_MAX_LEVELS + 1)
+
+/// @brief HalfMHSynchNode should not be directly used by the user.
+/// It is internally used for proper alignment of the MHSynchNode struct.
+typedef struct HalfMHSynchNode {
+    struct HalfMHSynchNode *next;
+    ArgVal arg_ret;
+    struct HalfMHSynchNode *batch;
+    uint32_t batch_size;
+    uint32_t requests;
+    uint32_t pid;
+    uint32_t locked;
+    uint32_t completed;
+} HalfMHSynchNode;
+
+/// @brief MHSynchNode stores the data of an announced request or of an announced batch of requests.
+typedef struct MHSynchNode {
+    /// @brief Pointer to the next node that has been announced to the same list.
+    struct MHSynchNode *next;
+    /// @brief This variable stores the argument of the request and the return value after the request is applied
+    /// (only for the nodes of the finest level).
+    ArgVal arg_ret;
+    /// @brief The first node of the announced batch, which belongs to the list of the previous level (only for the
+    /// nodes of the upper levels).
+    struct MHSynchNode *batch;
+    /// @brief The number of the nodes of the previous level that the batch consists of.
+    uint32_t batch_size;
+    /// @brief The number of the requests that the node represents; it is equal to 1 for the nodes of the finest level.
+    uint32_t requests;
+    /// @brief The pid of the thread that announced this node.
+    uint32_t pid;
+    /// @brief Whenever it is equal to false, the thread is the combiner of the list; otherwise the thread waits until
+    /// a combiner applies its request (see park.h).
+    uint32_t locked;
+    /// @brief If true, the requests of the node have been applied.
+    uint32_t completed;
+    /// @brief Padding space.
+    char align[PAD_CACHE(sizeof(HalfMHSynchNode))];
+} MHSynchNode;
+
+/// @brief MHSynchNodePtr is a struct for padding pointers to nodes.
+typedef union MHSynchNodePtr {
+    volatile MHSynchNode *ptr;
+    char pad[CACHE_LINE_SIZE];
+} MHSynchNodePtr;
+
+/// @brief MHSynchThreadState stores each thread's local state for a single instance of MH-Synch.
+/// For each instance of MH-Synch, a discrete instance of MHSynchThreadState should be used.
+typedef struct MHSynchThreadState {
+    /// @brief For each level, a pointer to an empty node that would be used for announcing future requests.
+    MHSynchNode *next_node[MHSYNCH_MAX_LEVELS];
+    /// @brief For each level, the tail of the list of the domain of the thread.
+    MHSynchNodePtr *tail[MHSYNCH_MAX_LEVELS];
+    /// @brief The number of lists that a request of the thread may pass.
+    uint32_t nlevels;
+} MHSynchThreadState;
+
+/// @brief MHSynchStruct stores the state of an instance of the MH-Synch combining object.
+/// MHSynchStruct should be initialized using the MHSynchStructInit function.
+typedef struct MHSynchStruct {
+    /// @brief The tails of the lists; one list per domain of each level of the topology and the top-level list.
+    MHSynchNodePtr *tails CACHE_ALIGN;
+    /// @brief The help bound of the instance (see MHSynchStructSetHelpPolicy).
+    SynchHelpBound help CACHE_ALIGN;
+#ifdef DEBUG
+    volatile uint64_t counter CACHE_ALIGN;
+    volatile int rounds;
+#endif
+    /// @brief The topology that the hierarchy of lists is built from.
+    SynchTopology topology CACHE_ALIGN;
+    /// @brief The index of the tail of the first domain of each level in tails.
+    uint32_t offsets[MHSYNCH_MAX_LEVELS];
+    /// @brief The number of levels of lists, i.e. the number of levels of the topology plus 1.
+    uint32_t nlevels;
+    /// @brief The number of threads that will use the MH-Synch combining object.
+    uint32_t nthreads;
+} MHSynchStruct;
+
+/// @brief This function initializes an instance of the MH-Synch combining object.
+///
+/// This function should be called once (by a single thread) before any other thread tries to
+/// apply any request by using the MHSynchApplyOp function.
+///
+/// @param l A pointer to an instance of the MH-Synch combining object.
+/// @param nthreads The number of threads that will use the MH-Synch combining object.
+/// @param topology The topology that the hierarchy is built from, or NULL for the topology of the machine
+/// (see synchTopologyInit). The instance keeps its own copy of the topology. In case that the topology has been
+/// detected, each thread is placed according to the core that it runs on (see synchGetPreferredCore); otherwise,
+/// the thread with id pid is placed at the processing element pid % topology->ncpus.
+void MHSynchStructInit(MHSynchStruct *l, uint32_t nthreads, const SynchTopology *topology);
+
+/// @brief This function should be called once before the thread applies any operation to the MH-Synch combining object.
+///
+/// @param l A pointer to an instance of the MH-Synch combining object.
+/// @param st_thread A pointer to thread's local state of MH-Synch.
+/// @param pid The pid of the calling thread.
+void MHSynchThreadStateInit(MHSynchStruct *l, MHSynchThreadState *st_thread, int pid);
+
+/// @brief This function enables (or disables) the adaptive help bound for an instance of the MH-Synch combining object.
+/// The help bound limits the number of requests of a batch at every level, while the length of the rounds of the
+/// top-level combiners is used for adapting it (see helpbound.h).
+/// This function should be called after the instance is initialized and before any thread applies any request to it.
+///
+/// @param l A pointer to an instance of the MH-Synch combining object.
+/// @param target_ns The target length of a combining round in nanoseconds; 0 restores the fixed help bound.
+/// @param min_bound The minimum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+/// @param max_bound The maximum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+void MHSynchStructSetHelpPolicy(MHSynchStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound);
+
+/// @brief This function returns the current help bound of an instance of the MH-Synch combining object and the
+/// statistics of its combining rounds. The statistics are collected only while the adaptive help bound is enabled.
+///
+/// @param l A pointer to an instance of the MH-Synch combining object.
+/// @param stats A snapshot of the help bound of the instance is stored here.
+void MHSynchGetHelpStats(MHSynchStruct *l, SynchHelpBound *stats);
+
+/// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
+///
+/// @param l A pointer to an instance of the MH-Synch combining object.
+/// @param st_thread A pointer to thread's local state for a specific instance of MH-Synch.
+/// @param sfunc A serial function that the MH-Synch instance should execute, while applying requests announced by active threads.
+/// @param state A pointer to the state of the simulated object.
+/// @param arg The argument of the request that the thread wants to apply.
+/// @param pid The pid of the calling thread.
+/// @return RetVal The return value of the applied request.
+RetVal MHSynchApplyOp(MHSynchStruct *l, MHSynchThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid);
+
+#endif
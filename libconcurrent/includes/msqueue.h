@@ -12,7 +12,9 @@
 #include <primitives.h>
 #include <backoff.h>
 #include <pool.h>
+#include <ebr.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 
 /// @brief MSQueueStruct stores the state of an instance of the MS-Queue concurrent queue implementation.
 /// MSQueueStruct should be initialized using the MSQueueStructInit function.
@@ -21,6 +23,10 @@ typedef struct MSQueueStruct {
     volatile Node *head CACHE_ALIGN;
     /// @brief A pointer to the tail element of the queue.
     volatile Node *tail CACHE_ALIGN;
+    /// @brief The epoch-based reclamation scheme that recycles the removed nodes.
+    SynchEBRStruct ebr;
+    /// @brief An eventcount, on which the blocking and timed dequeue operations wait while the queue is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } MSQueueStruct;
 
 /// @brief MSQueueThreadState stores each thread's local state for a single instance of MS-Queue.
@@ -30,6 +36,8 @@ typedef struct MSQueueThreadState {
     SynchPoolStruct pool;
     /// @brief A backoff object per thread is used for reducing the contention while accessing the queue.
     SynchBackoffStruct backoff;
+    /// @brief The local state of the thread for the epoch-based reclamation scheme.
+    SynchEBRThreadState ebr;
 } MSQueueThreadState;
 
 /// @brief This function initializes an instance of the MS-Queue concurrent queue implementation.
@@ -38,14 +46,17 @@ typedef struct MSQueueThreadState {
 /// apply any enqueue or dequeue operation.
 ///
 /// @param l A pointer to an instance of the MS-Queue concurrent queue implementation.
-void MSQueueInit(MSQueueStruct *l);
+/// @param nthreads The number of threads that will use the MS-Queue concurrent queue implementation.
+void MSQueueInit(MSQueueStruct *l, uint32_t nthreads);
 
 /// @brief This function should be called once before the thread applies any operation to the MS-Queue concurrent queue implementation.
 ///
+/// @param l A pointer to an instance of the MS-Queue concurrent queue implementation.
 /// @param th_state A pointer to thread's local state of MS-Queue.
 /// @param min_back The minimum value for backoff (in most cases 0 is a good start).
 /// @param max_back The maximum value for backoff (usually this is much lower than 100).
-void MSQueueThreadStateInit(MSQueueThreadState *th_state, int min_back, int max_back);
+/// @param pid The pid of the calling thread.
+void MSQueueThreadStateInit(MSQueueStruct *l, MSQueueThreadState *th_state, int min_back, int max_back, int pid);
 
 /// @brief This function adds (i.e. enqueues) a new element to the back of the queue.
 /// This element has a value equal with arg.
@@ -62,4 +73,21 @@ void MSQueueEnqueue(MSQueueStruct *l, MSQueueThreadState *th_state, ArgVal arg);
 /// @return The value of the removed element.
 RetVal MSQueueDequeue(MSQueueStruct *l, MSQueueThreadState *th_state);
 
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits until an element is enqueued (see eventcount.h).
+///
+/// @param l A pointer to an instance of the MS-Queue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of MS-Queue.
+/// @return The value of the removed element.
+RetVal MSQueueDequeueBlocking(MSQueueStruct *l, MSQueueThreadState *th_state);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is enqueued.
+///
+/// @param l A pointer to an instance of the MS-Queue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of MS-Queue.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue remains empty for timeout_ns nanoseconds.
+RetVal MSQueueDequeueTimed(MSQueueStruct *l, MSQueueThreadState *th_state, uint64_t timeout_ns);
+
 #endif
\ No newline at end of file
@@ -12,6 +12,12 @@
 
 #include <config.h>
 #include <primitives.h>
+#include <threadtools.h>
+#include <helpbound.h>
+
+/// @brief By default, a combiner applies at most OSCI_HELP_FACTOR * nthreads requests in a single combining round
+/// (see OsciSetHelpPolicy).
+#define OSCI_HELP_FACTOR 10
 #include <types.h>
 
 enum { _OSCI_DOOR_INIT, _OSCI_DOOR_OPENED, _OSCI_DOOR_LOCKED };
@@ -62,6 +68,8 @@ typedef struct OsciStruct {
     uint32_t groups_of_fibers;
     /// @brief Combining points for the current instance of Osci.
     ptr_aligned_t *current_node;
+    /// @brief The help bound of the instance (see OsciSetHelpPolicy).
+    SynchHelpBound help CACHE_ALIGN;
 #ifdef DEBUG
     volatile uint64_t counter;
     volatile int rounds CACHE_ALIGN;
@@ -85,6 +93,23 @@ void OsciInit(OsciStruct *l, uint32_t nthreads, uint32_t fibers_per_thread);
 /// @param pid The pid of the calling thread.
 void OsciThreadStateInit(OsciThreadState *st_thread, OsciStruct *l, int pid);
 
+/// @brief This function enables (or disables) the adaptive help bound for an instance of the Osci combining object.
+/// The help bound is adapted so as the length of a combining round stays below target_ns (see helpbound.h).
+/// This function should be called after the instance is initialized and before any thread applies any request to it.
+///
+/// @param l A pointer to an instance of the Osci combining object.
+/// @param target_ns The target length of a combining round in nanoseconds; 0 restores the fixed help bound.
+/// @param min_bound The minimum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+/// @param max_bound The maximum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+void OsciSetHelpPolicy(OsciStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound);
+
+/// @brief This function returns the current help bound of an instance of the Osci combining object and the statistics of its
+/// combining rounds. The statistics are collected only while the adaptive help bound is enabled.
+///
+/// @param l A pointer to an instance of the Osci combining object.
+/// @param stats A snapshot of the help bound of the instance is stored here.
+void OsciGetHelpStats(OsciStruct *l, SynchHelpBound *stats);
+
 /// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
 ///
 /// @param l A pointer to an instance of the Osci combining object.
@@ -96,4 +121,121 @@ void OsciThreadStateInit(OsciThreadState *st_thread, OsciStruct *l, int pid);
 /// @return RetVal The return value of the applied request.
 RetVal OsciApplyOp(OsciStruct *l, OsciThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid);
 
+/// @brief This function is the inlinable version of OsciApplyOp. In case that sfunc is a constant whose definition is
+/// visible (i.e. a static inline function), the compiler is able to inline it in the combining loop.
+/// Usually, it is used through OSCI_DEFINE_APPLY_OP and not directly.
+static inline ALWAYS_INLINE RetVal OsciApplyOpInline(OsciStruct *l, OsciThreadState *st_thread, RetVal (*sfunc)(void *, ArgVal, int), void *state, ArgVal arg, int pid) {
+    volatile OsciNode *p, *pred, *cur, *mynode;
+    int counter = 0, i;
+    int help_bound;
+    int64_t start;
+    int group = pid / l->fibers_per_thread;
+    int offset_id = pid % l->fibers_per_thread;
+
+    mynode = &st_thread->next_node[st_thread->toggle];
+osci_start:
+    do { // Try to acquire the combining point
+        if (l->current_node[group].ptr == NULL) synchCASPTR(&l->current_node[group].ptr, NULL, mynode);
+        cur = l->current_node[group].ptr;
+    } while (cur == NULL);
+
+    if (cur == mynode) { // In that case, I'm the combiner
+        st_thread->toggle = 1 - st_thread->toggle;
+        cur->rec[offset_id].arg_ret = arg;
+        cur->rec[offset_id].pid = pid;
+        cur->rec[offset_id].locked = true;
+        synchNonTSOFence();
+        cur->rec[offset_id].completed = false;
+        cur->next = NULL;
+        cur->door = _OSCI_DOOR_OPENED;
+        synchResched();                    // Scheduling point
+        l->current_node[group].ptr = NULL; // Release the combining point
+        while (!synchCAS32(&cur->door, _OSCI_DOOR_OPENED, _OSCI_DOOR_INIT))
+            synchResched();
+        pred = synchSWAP(&l->Tail, cur);
+
+        if (pred != NULL) {
+            pred->next = cur;
+            synchFullFence();
+            while (cur->rec[offset_id].locked)
+                synchResched();
+            if (cur->rec[offset_id].completed) // operation has already applied
+                return cur->rec[offset_id].arg_ret;
+        }
+    } else {
+        while (!synchCAS32(&cur->door, _OSCI_DOOR_OPENED, _OSCI_DOOR_LOCKED)) {
+            if (cur->door == _OSCI_DOOR_INIT)
+                goto osci_start;
+            synchResched();
+        }
+        cur->rec[offset_id].arg_ret = arg;
+        cur->rec[offset_id].pid = pid;
+        cur->rec[offset_id].locked = true;
+        synchNonTSOFence();
+        cur->rec[offset_id].completed = false;
+        cur->door = _OSCI_DOOR_OPENED;
+        synchNonTSOFence();
+        do {
+            synchResched();
+        } while (cur->rec[offset_id].locked);
+        if (cur->rec[offset_id].completed) // I have been helped
+            return cur->rec[offset_id].arg_ret;
+    }
+
+#ifdef DEBUG
+    l->rounds++;
+#endif
+    help_bound = l->help.bound;
+    start = synchHelpBoundStart(&l->help);
+    p = cur;
+    do {
+        synchStorePrefetch(p->next);
+        for (i = 0; i < l->fibers_per_thread; i++) {
+            if (p->rec[i].completed == false) {
+                p->rec[i].arg_ret = sfunc(state, p->rec[i].arg_ret, p->rec[i].pid);
+                p->rec[i].completed = true;
+                synchNonTSOFence();
+                p->rec[i].locked = false;
+#ifdef DEBUG
+                l->counter += 1;
+#endif
+            }
+        }
+        counter += i;
+        if (p->next == NULL || p->next->next == NULL || counter >= help_bound)
+            break;
+        p = p->next;
+    } while (true);
+    synchHelpBoundEnd(&l->help, start, counter);
+    // End critical section
+    if (p->next == NULL) {
+        if (l->Tail == p && synchCASPTR(&l->Tail, p, NULL) == true) return cur->rec[offset_id].arg_ret;
+        while (p->next == NULL) {
+            synchResched();
+        }
+    }
+    synchNonTSOFence();
+    i = 0;
+    while (i < l->fibers_per_thread) {
+        if (p->next->rec[i].completed == false) {
+            p->next->rec[i].locked = false; // Unlock the next one
+            break;
+        }
+        i++;
+    }
+    synchFullFence();
+
+    return cur->rec[offset_id].arg_ret;
+}
+
+/// @brief This macro defines a function named NAME that is equivalent to OsciApplyOp, but it is specialized for the
+/// serial function SFUNC, i.e. SFUNC is inlined in the combining loop instead of being called through a pointer.
+/// The defined function has the following signature:
+/// `static inline RetVal NAME(OsciStruct *l, OsciThreadState *st_thread, void *state, ArgVal arg, int pid)`.
+/// An example of use is provided in benchmarks/oscibench.c file.
+#define OSCI_DEFINE_APPLY_OP(NAME, SFUNC)                                                                           \
+    static inline RetVal NAME(OsciStruct *l, OsciThreadState *st_thread, void *state, ArgVal arg, int pid) {    \
+        return OsciApplyOpInline(l, st_thread, SFUNC, state, arg, pid);                                             \
+    }
+
 #endif
@@ -15,6 +15,7 @@
 #include <osci.h>
 #include <pool.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 
 /// @brief OsciQueueStruct stores the state of an instance of the OsciQueue concurrent queue implementation.
 /// OsciQueueStruct should be initialized using the OsciQueueStructInit function.
@@ -29,8 +30,10 @@ typedef struct OsciQueueStruct {
     volatile Node *first CACHE_ALIGN;
     /// @brief A guard node that it is used only at the initialization of the queue.
     Node guard CACHE_ALIGN;
-    /// @brief Pointer to an array of pools of nodes (a single pool per fiber). It is used for fast node allocation on enqueue operations.
-    SynchPoolStruct *pool_node CACHE_ALIGN;
+    /// @brief An array of return slots (one per fiber), which are used for returning the dequeued nodes to the pools of their owners.
+    SynchNodeReturnSlot *node_slots CACHE_ALIGN;
+    /// @brief An eventcount, on which the blocking and timed dequeue operations wait while the queue is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } OsciQueueStruct;
 
 /// @brief OsciQueueThreadState stores each thread's local state for a single instance of OsciQueue.
@@ -40,6 +43,8 @@ typedef struct OsciQueueThreadState {
     OsciThreadState enqueue_thread_state;
     /// @brief An OsciThreadState struct for the instance of Osci that serves the dequeue operations.
     OsciThreadState dequeue_thread_state;
+    /// @brief A pool of nodes, from which the fiber allocates the nodes of its enqueue operations.
+    SynchPoolStruct pool;
 } OsciQueueThreadState;
 
 /// @brief This function initializes an instance of the OsciQueue concurrent queue implementation.
@@ -76,4 +81,23 @@ void OsciQueueApplyEnqueue(OsciQueueStruct *object_struct, OsciQueueThreadState
 /// @return The value of the removed element.
 RetVal OsciQueueApplyDequeue(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, int pid);
 
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits until an element is enqueued (see eventcount.h).
+///
+/// @param object_struct A pointer to an instance of the OsciQueue concurrent queue implementation.
+/// @param lobject_struct A pointer to thread's local state of OsciQueue.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal OsciQueueApplyDequeueBlocking(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is enqueued.
+///
+/// @param object_struct A pointer to an instance of the OsciQueue concurrent queue implementation.
+/// @param lobject_struct A pointer to thread's local state of OsciQueue.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue remains empty for timeout_ns nanoseconds.
+RetVal OsciQueueApplyDequeueTimed(OsciQueueStruct *object_struct, OsciQueueThreadState *lobject_struct, uint64_t timeout_ns, int pid);
+
 #endif
@@ -10,6 +10,7 @@
 
 #include <config.h>
 #include <primitives.h>
+#include <helpbound.h>
 
 /// @brief HalfOyamaAnnounceNode should not be directly used by the user.
 /// It is internally used for proper alignment of the OyamaAnnounceNode struct.
@@ -42,6 +43,8 @@ typedef struct OyamaStruct {
     volatile OyamaAnnounceNode *tail CACHE_ALIGN;
     /// @brief The number of threads that will use the Oyama combining object.
     uint32_t nthreads CACHE_ALIGN;
+    /// @brief The help bound of the instance (see OyamaSetHelpPolicy).
+    SynchHelpBound help CACHE_ALIGN;
 #ifdef DEBUG
     volatile int rounds CACHE_ALIGN;
     volatile int counter;
@@ -69,6 +72,23 @@ void OyamaInit(OyamaStruct *l, uint32_t nthreads);
 /// @param th_state A pointer to thread's local state of the Oyama combining object.
 void OyamaThreadStateInit(OyamaThreadState *th_state);
 
+/// @brief This function enables (or disables) the adaptive help bound for an instance of the Oyama combining object.
+/// The help bound is adapted so as the length of a combining round stays below target_ns (see helpbound.h).
+/// This function should be called after the instance is initialized and before any thread applies any request to it.
+///
+/// @param l A pointer to an instance of the Oyama combining object.
+/// @param target_ns The target length of a combining round in nanoseconds; 0 restores the fixed help bound.
+/// @param min_bound The minimum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+/// @param max_bound The maximum help bound, or SYNCH_HELP_BOUND_DEFAULT.
+void OyamaSetHelpPolicy(OyamaStruct *l, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound);
+
+/// @brief This function returns the current help bound of an instance of the Oyama combining object and the statistics of its
+/// combining rounds. The statistics are collected only while the adaptive help bound is enabled.
+///
+/// @param l A pointer to an instance of the Oyama combining object.
+/// @param stats A snapshot of the help bound of the instance is stored here.
+void OyamaGetHelpStats(OyamaStruct *l, SynchHelpBound *stats);
+
 /// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
 ///
 /// @param l A pointer to an instance of the Oyama combining object.
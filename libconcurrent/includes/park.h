@@ -0,0 +1,121 @@
+/// @file park.h
+/// @brief This file exposes the API that is used by the waiters of the combining objects (i.e. CC-Synch, DSM-Synch,
+/// H-Synch and MH-Synch) for waiting on the locked field of their nodes. In case that the threads outnumber the cores
+/// (see synchIsSystemOversubscribed), a waiter yields the CPU for a bounded number of times (see SYNCH_PARK_SPINS) and
+/// then it parks, i.e. it marks the locked field as SYNCH_PARK_PARKED and it sleeps on a futex until the field becomes
+/// SYNCH_PARK_UNLOCKED; thus, the waiting threads do not consume the CPU time that the combiner needs. Otherwise, each
+/// thread has a core of its own and the waiter spins, since a combining round is usually much shorter than the wake-up
+/// of a parked thread. The combiner issues a wake-up system call only for the nodes that have been marked as parked and
+/// it defers these system calls until the end of its combining round (see SynchParkWakeList), thus they do not make the
+/// round longer.
+/// The waiters of FC spin or park in the same way on the parked field of their requests; the combiner of FC wakes up
+/// the owners of the requests that it has applied and a single owner of a pending request whenever it releases the
+/// lock, since the latter should become the next combiner.
+/// Fibers never park (see synchIsFiberScheduled); they yield the CPU instead (see synchResched).
+/// In case that the SYNCH_PARKING_DISABLE option of config.h is enabled, the waiters keep yielding the CPU.
+#ifndef _PARK_H_
+#define _PARK_H_
+
+#include <config.h>
+#include <stdint.h>
+#include <primitives.h>
+
+/// @brief The number of times that a waiter of an oversubscribed system yields the CPU (see synchResched) before it parks.
+#ifndef SYNCH_PARK_SPINS
+#    define SYNCH_PARK_SPINS 16
+#endif
+
+/// @brief The number of parked waiters that a SynchParkWakeList holds; whenever it is full, its waiters are woken up
+/// at once, thus a combiner defers at most this number of wake-up system calls.
+#ifndef SYNCH_PARK_WAKE_BATCH
+#    define SYNCH_PARK_WAKE_BATCH 64
+#endif
+
+/// @brief The value of the locked field that allows its waiter to proceed.
+#define SYNCH_PARK_UNLOCKED 0
+/// @brief The value of the locked field while its waiter should wait (i.e. the value of true).
+#define SYNCH_PARK_LOCKED   1
+/// @brief The value of the locked field while its waiter is parked (or it is just about to park).
+#define SYNCH_PARK_PARKED   2
+
+/// @brief This function waits until the locked field is equal to SYNCH_PARK_UNLOCKED. It is called by
+/// synchParkWait and it should not be directly used by the user.
+///
+/// @param locked A pointer to the locked field.
+void synchParkWaitSlow(volatile uint32_t *locked);
+
+/// @brief This function puts the calling thread to sleep while the value of the word is equal to SYNCH_PARK_PARKED.
+/// The thread may wake up spuriously, thus the caller should check its waiting condition again.
+///
+/// @param word A pointer to the word.
+void synchParkSleep(volatile uint32_t *word);
+
+/// @brief This function wakes up the thread that is parked on the locked field. It is called by synchParkUnlock
+/// and it should not be directly used by the user.
+///
+/// @param locked A pointer to the locked field.
+void synchParkWake(volatile uint32_t *locked);
+
+/// @brief SynchParkWakeList stores the locked fields of the parked waiters that a combiner has unlocked during its
+/// combining round and that it has not woken up yet. It is a local variable of the combiner.
+typedef struct SynchParkWakeList {
+    /// @brief The locked fields of the parked waiters.
+    volatile uint32_t *words[SYNCH_PARK_WAKE_BATCH];
+    /// @brief The number of the stored locked fields.
+    uint32_t size;
+} SynchParkWakeList;
+
+/// @brief This function wakes up the waiters of a SynchParkWakeList and it empties the list.
+///
+/// @param wl A pointer to the list.
+void synchParkWakeAll(SynchParkWakeList *wl);
+
+/// @brief This function waits until the locked field is equal to SYNCH_PARK_UNLOCKED, i.e. until it is unlocked by
+/// synchParkUnlock. Only a single thread (i.e. the owner of the node) should wait on a locked field.
+///
+/// @param locked A pointer to the locked field; it should be equal to either SYNCH_PARK_LOCKED or SYNCH_PARK_UNLOCKED.
+static inline void synchParkWait(volatile void *locked) {
+    if (*(volatile uint32_t *)locked != SYNCH_PARK_UNLOCKED)
+        synchParkWaitSlow((volatile uint32_t *)locked);
+}
+
+/// @brief This function unlocks a locked field and wakes up its waiter, in case that the waiter has parked.
+///
+/// @param locked A pointer to the locked field.
+static inline void synchParkUnlock(volatile void *locked) {
+#ifndef SYNCH_PARKING_DISABLE
+    // the field is read and unlocked by a single atomic step, thus a waiter could not park between them
+    if (synchSWAP32(locked, SYNCH_PARK_UNLOCKED) == SYNCH_PARK_PARKED)
+        synchParkWake((volatile uint32_t *)locked);
+#else
+    *(volatile uint32_t *)locked = SYNCH_PARK_UNLOCKED;
+#endif
+}
+
+/// @brief This function initializes an empty SynchParkWakeList.
+///
+/// @param wl A pointer to the list.
+static inline void synchParkWakeListInit(SynchParkWakeList *wl) {
+    wl->size = 0;
+}
+
+/// @brief This function unlocks a locked field like synchParkUnlock, but in case that the waiter has parked, it stores
+/// the field to wl instead of waking up the waiter. The combiner should call synchParkWakeAll after its combining round.
+/// A waiter that is unlocked in this way may reuse its node before synchParkWakeAll is called; then, it is woken up
+/// spuriously, which is harmless, since a parked waiter checks its waiting condition again (see synchParkSleep).
+///
+/// @param locked A pointer to the locked field.
+/// @param wl A pointer to the list of the parked waiters of the current combining round.
+static inline void synchParkUnlockDeferred(volatile void *locked, SynchParkWakeList *wl) {
+#ifndef SYNCH_PARKING_DISABLE
+    if (synchSWAP32(locked, SYNCH_PARK_UNLOCKED) == SYNCH_PARK_PARKED) {
+        if (wl->size == SYNCH_PARK_WAKE_BATCH)
+            synchParkWakeAll(wl);
+        wl->words[wl->size++] = (volatile uint32_t *)locked;
+    }
+#else
+    *(volatile uint32_t *)locked = SYNCH_PARK_UNLOCKED;
+#endif
+}
+
+#endif
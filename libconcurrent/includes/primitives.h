@@ -33,6 +33,7 @@
 #    define __CAS64(A, B, C)            __sync_bool_compare_and_swap(A, B, C)
 #    define __CAS32(A, B, C)            __sync_bool_compare_and_swap(A, B, C)
 #    define __SWAP(A, B)                __sync_lock_test_and_set((long *)A, (long)B)
+#    define __SWAP32(A, B)              __sync_lock_test_and_set(A, B)
 #    define __FAA64(A, B)               __sync_fetch_and_add(A, B)
 #    define __FAA32(A, B)               __sync_fetch_and_add(A, B)
 #    define __BitTAS64(A, B)            __sync_fetch_and_or(A, (1ULL << (B)))
@@ -43,6 +44,7 @@
 #    define synchLikely(A)              __builtin_expect(!!(A), 1)
 #    define synchUnlikely(A)            __builtin_expect(!!(A), 0)
 #    define UNUSED_ARG                  __attribute__((unused))
+#    define ALWAYS_INLINE               __attribute__((always_inline))
 #    if defined(__amd64__) || defined(__x86_64__)
 #        define synchLoadFence()  asm volatile("lfence" ::: "memory")
 #        define synchStoreFence() asm volatile("sfence" ::: "memory")
@@ -66,6 +68,7 @@
 #    define synchLikely(A)   (A)
 #    define synchUnlikely(A) (A)
 #    define UNUSED_ARG       __attribute__((unused))
+#    define ALWAYS_INLINE    __attribute__((always_inline))
 //   in this case where gcc is too old, implement atomic primitives in primitives.c
 #    define __OLD_GCC_X86__
 inline int synchBitSearchFirst(uint64_t B);
@@ -115,6 +118,23 @@ inline void *synchGetMemory(size_t size);
 /// @return In case of error, NULL is returned. In case of success a pointer to the allocated memory area is returned.
 inline void *synchGetAlignedMemory(size_t align, size_t size);
 
+/// @brief This function allocates a memory area of size bytes on a specific NUMA node. The returned address is aligned to the page size.
+/// In case that SYNCH_NUMA_SUPPORT is not defined in libconcurrent/config.h, the numa_node argument is ignored.
+///
+/// @param size The size of the memory area.
+/// @param numa_node The NUMA node where the memory area should be allocated.
+/// @return In case of error, NULL is returned. In case of success a pointer to the allocated memory area is returned.
+inline void *synchGetMemoryOnNumaNode(size_t size, int32_t numa_node);
+
+/// @brief This function migrates the pages of a memory area (allocated by synchGetMemoryOnNumaNode) to a specific NUMA node.
+/// Pages that are touched for the first time after this call are also allocated on this node. This is only a hint, it has no effect
+/// in case of failure or in case that SYNCH_NUMA_SUPPORT is not defined in libconcurrent/config.h.
+///
+/// @param ptr A pointer to the memory area. It should be aligned to the page size.
+/// @param size The size of the memory area.
+/// @param numa_node The NUMA node where the memory area should be moved.
+inline void synchMoveMemoryToNumaNode(void *ptr, size_t size, int32_t numa_node);
+
 /// @brief This function frees memory allocated with either getMemory() or synchGetAlignedMemory() functions.
 ///
 /// @param ptr A pointer to the memory area to be freed.
@@ -126,6 +146,16 @@ inline void synchFreeMemory(void *ptr, size_t size);
 /// @return System's time in milliseconds.
 inline int64_t synchGetTimeMillis(void);
 
+/// @brief This function returns the current system's time in nanoseconds.
+///
+/// @return System's time in nanoseconds.
+inline int64_t synchGetTimeNanos(void);
+
+/// @brief This function returns the resident set size (i.e. the amount of physical memory used) of the calling process.
+///
+/// @return The resident set size in bytes, or -1 in case that it is not available.
+int64_t synchGetResidentMemory(void);
+
 /// @brief This function returns the vendor of the processor that it runs on.
 /// The current version of the Synch framework returns any of the following codes:
 /// - AMD_X86_MACHINE
@@ -200,6 +230,16 @@ inline bool _CAS32(uint32_t *A, uint32_t B, uint32_t C);
 /// @return It returns the old value of the memory location pointed by A just before the operation. 
 inline void *_SWAP(void *A, void *B);
 
+/// A wrapper for the _SWAP32 function. See more on _SWAP32().
+#define synchSWAP32(A, B) _SWAP32((volatile uint32_t *)(A), (uint32_t)(B))
+/// @brief This function is executed atomically. It performs an atomic exchange operation on the 32-bit value pointed by A,
+/// setting B as the new value. It returns the old value of the memory location pointed by A just before the operation.
+///
+/// @param A A pointer to memory location that stores a 32-bit value.
+/// @param B The new 32-bit value to be stored in the memory location pointed by A.
+/// @return It returns the old 32-bit value of the memory location pointed by A just before the operation.
+inline uint32_t _SWAP32(volatile uint32_t *A, uint32_t B);
+
 /// A wrapper for the _FAA32 function. See more on _FAA32().
 #define synchFAA32(A, B) _FAA32((volatile int32_t *)(A), (int32_t)(B))
 /// @brief This function is executed atomically. It performs an atomic addition of value B to the value pointed by A.
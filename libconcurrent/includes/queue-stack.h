@@ -5,10 +5,17 @@
 /// Moreover, this file provides error-codes definitions for operations on stacks and queues
 /// (i.e., error codes for failing to dequeue an element from a queue, error code for failing
 /// to pop an element from a stack, etc.).
+/// It provides the elimination buffer (see SynchElimBuffer) that is used by the combining stacks.
+/// Finally, it provides the owned nodes (see SynchOwnedNode) that the enqueuers of the combining queues
+/// allocate from their own pools and that are returned to these pools after they are dequeued.
 #ifndef _QUEUE_STACK_H_
 #define _QUEUE_STACK_H_
 
 #include <limits.h>
+#include <stdbool.h>
+#include <config.h>
+#include <primitives.h>
+#include <pool.h>
 
 typedef struct Node {
     Object val;
@@ -23,4 +30,161 @@ typedef struct Node {
 #define PUSH_SUCCESS    0
 #define PUSH_FAIL       -1
 
-#endif
\ No newline at end of file
+/// @brief The number of elements that are stored in the elimination buffer of a combining stack (see SynchElimBuffer).
+#ifndef SYNCH_ELIM_SLOTS
+#    define SYNCH_ELIM_SLOTS 32
+#endif
+
+/// @brief SynchElimBuffer stores the topmost elements of a combining stack (i.e. CC-Stack, DSM-Stack, H-Stack,
+/// Osci-Stack and FC-Stack) in a ring of values, above the elements that are stored in the linked-list of nodes.
+/// Since a combiner applies the announced requests one after the other, a pop that follows a push is eliminated,
+/// i.e. it returns the value of the push without touching the top pointer and without allocating and recycling a node.
+/// A node is allocated only for the oldest element of the buffer, when a push finds it full.
+/// A SynchElimBuffer should be accessed only by the combiner; it is initialized by zeroing it.
+typedef struct SynchElimBuffer {
+    /// @brief The values of the elements stored in the buffer.
+    ArgVal val[SYNCH_ELIM_SLOTS];
+    /// @brief The position of the oldest (i.e. the bottommost) element of the buffer.
+    uint32_t first;
+    /// @brief The number of elements stored in the buffer.
+    uint32_t size;
+    /// @brief The number of pop operations that are served by the buffer. The matching push may have been applied by any
+    /// earlier combining round, thus this is not the number of push/pop pairs that are eliminated within a round.
+    uint64_t hits;
+    /// @brief The number of pop operations that are applied to the stack, including the pops that find it empty.
+    uint64_t pops;
+} SynchElimBuffer;
+
+/// @brief SynchElimStats is a snapshot of the statistics of an elimination buffer (see the GetElimStats functions of
+/// the combining stacks, e.g. CCStackGetElimStats). These statistics are maintained in all builds, thus the fraction
+/// of the pops that are served by the buffer (i.e. hits / pops) is also available in non-DEBUG builds.
+typedef struct SynchElimStats {
+    /// @brief The number of pop operations that are served by the elimination buffer.
+    uint64_t hits;
+    /// @brief The number of pop operations that are applied to the stack.
+    uint64_t pops;
+} SynchElimStats;
+
+/// @brief This function stores the value of a push operation to the top of an elimination buffer.
+///
+/// @param buf A pointer to the elimination buffer.
+/// @param arg The value of the push operation.
+/// @param evicted In case that the buffer is full, the value of its oldest element is stored here.
+/// @return true in case that an element is evicted; the caller should then push it to the linked-list of nodes.
+static inline bool synchElimPush(SynchElimBuffer *buf, ArgVal arg, ArgVal *evicted) {
+    bool full = (buf->size == SYNCH_ELIM_SLOTS);
+
+    if (full) {
+        *evicted = buf->val[buf->first];
+        buf->first = (buf->first + 1) % SYNCH_ELIM_SLOTS;
+        buf->size--;
+    }
+    buf->val[(buf->first + buf->size) % SYNCH_ELIM_SLOTS] = arg;
+    buf->size++;
+
+    return full;
+}
+
+/// @brief This function removes the topmost element of an elimination buffer.
+///
+/// @param buf A pointer to the elimination buffer.
+/// @param ret The value of the removed element is stored here.
+/// @return false in case that the buffer is empty; the caller should then pop from the linked-list of nodes.
+static inline bool synchElimPop(SynchElimBuffer *buf, RetVal *ret) {
+    buf->pops++;
+    if (buf->size == 0)
+        return false;
+    buf->size--;
+    *ret = buf->val[(buf->first + buf->size) % SYNCH_ELIM_SLOTS];
+    buf->hits++;
+
+    return true;
+}
+
+/// @brief This function takes a snapshot of the statistics of an elimination buffer. Since the buffer is updated
+/// only by the combiner, the snapshot is consistent only in case that no operation is applied concurrently.
+///
+/// @param buf A pointer to the elimination buffer.
+/// @param stats The snapshot of the statistics is stored here.
+static inline void synchElimGetStats(SynchElimBuffer *buf, SynchElimStats *stats) {
+    stats->hits = buf->hits;
+    stats->pops = buf->pops;
+}
+
+/// @brief SynchOwnedNode is a node of a combining queue (i.e. CC-Queue, DSM-Queue, H-Queue and Osci-Queue) that is
+/// allocated and filled by the enqueuer before it announces its request, so the combiner only links it to the queue.
+/// Since node is the first field, a pointer to a SynchOwnedNode could be used as a pointer to a Node.
+typedef struct SynchOwnedNode {
+    /// @brief The node that is linked to the queue.
+    Node node;
+    /// @brief The pid of the thread that allocated the node from its pool.
+    int32_t owner;
+} SynchOwnedNode;
+
+/// @brief SynchNodeReturnSlot stores the per-thread data that is used for returning the nodes of a combining queue
+/// to the pools of their owners. Each slot fills a whole cache line.
+typedef struct SynchNodeReturnSlot {
+    /// @brief A stack of nodes owned by the thread that have been removed from the queue. Any thread could push a node
+    /// to it, but only the owner removes nodes from it and it always removes all of them at once.
+    SynchOwnedNode *volatile returned;
+    /// @brief The node that has been removed from the queue by the last dequeue of the thread, or NULL.
+    /// It is written by the combiner that serves the dequeue and read by the thread after its dequeue completes.
+    SynchOwnedNode *released;
+    /// @brief Padding space.
+    char pad[PAD_CACHE(2 * sizeof(SynchOwnedNode *))];
+} SynchNodeReturnSlot;
+
+/// @brief This function allocates a node for an enqueue operation of a combining queue from the pool of the calling
+/// thread. In case that some nodes of the thread have been returned to it, they are first moved to the pool.
+///
+/// @param pool The pool of nodes of the calling thread; it should be initialized with objects of size sizeof(SynchOwnedNode).
+/// @param slot The return slot of the calling thread.
+/// @param arg The value of the new element.
+/// @param pid The pid of the calling thread.
+/// @return A pointer to the new node; its next field is NULL.
+static inline SynchOwnedNode *synchOwnedNodeAlloc(SynchPoolStruct *pool, SynchNodeReturnSlot *slot, ArgVal arg, int pid) {
+    SynchOwnedNode *node;
+
+    if (slot->returned != NULL) {
+        node = synchSWAP(&slot->returned, NULL);
+        while (node != NULL) {
+            SynchOwnedNode *next = (SynchOwnedNode *)node->node.next;
+
+            synchRecycleObj(pool, node);
+            node = next;
+        }
+    }
+    node = synchAllocObj(pool);
+    node->node.val = arg;
+    node->node.next = NULL;
+    node->owner = pid;
+
+    return node;
+}
+
+/// @brief This function returns the node that has been released by the last dequeue of the calling thread (if any)
+/// to the pool of its owner. The node is directly recycled in case that the calling thread is its owner, otherwise it
+/// is pushed to the return slot of the owner. It should be called after the dequeue operation has been completed.
+///
+/// @param pool The pool of nodes of the calling thread.
+/// @param slots The array of return slots of the queue, one per thread.
+/// @param pid The pid of the calling thread.
+static inline void synchOwnedNodeReturn(SynchPoolStruct *pool, SynchNodeReturnSlot *slots, int pid) {
+    SynchOwnedNode *node = slots[pid].released, *top;
+    SynchNodeReturnSlot *owner;
+
+    if (node == NULL)
+        return;
+    slots[pid].released = NULL;
+    if (node->owner == pid) {
+        synchRecycleObj(pool, node);
+        return;
+    }
+    owner = &slots[node->owner];
+    do {
+        top = owner->returned;
+        node->node.next = (Node *)top;
+    } while (!synchCASPTR(&owner->returned, top, node));
+}
+
+#endif
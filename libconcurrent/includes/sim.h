@@ -12,50 +12,104 @@
 
 #include <config.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <primitives.h>
+#include <fastrand.h>
+#include <threadtools.h>
 #include <tvec.h>
-#include <fam.h>
 
-/// @brief This constant controls the size of pool of SimObjectState structs that each thread maintains.
+/// @brief This constant controls the default size of pool of SimObjectState structs that each thread maintains.
 /// This should be a small integer (i.e, 2 or 4) in order to avoid excess memory consumption.
+/// A different size could be set at runtime by using synchSimStructInitPool.
 #define _SIM_LOCAL_POOL_SIZE_ 4
 
 #if _SIM_LOCAL_POOL_SIZE_ < 2
 #    error SIM universal construction is improperly configured
 #endif
 
-/// @brief This should not used directely by user. 
-/// It is used for padding the SimObjectState struct appropriately.
-typedef struct HalfSimObjectState {
-    RetVal *ret;
-    ToggleVector applied;
-    ObjectState state CACHE_ALIGN;
-#ifdef DEBUG
-    int counter;
-    int rounds;
-#endif
-    uint64_t __flex[1];
-} HalfSimObjectState;
+/// @brief This constant controls the number of times that SimApplyReadOp tries to evaluate a read-only request
+/// directly on the most recent copy of the simulated object's state, before falling back to SimApplyOp.
+#define _SIM_READ_ATTEMPTS_ 2
+
+/// @brief In this copy mode, the whole simulated object's state is copied on each attempt of Sim (this is the default mode).
+#define SIM_COPY_FULL  0
+/// @brief In this copy mode, only the cache lines of the simulated object's state that have changed since the local copy
+/// was last valid are copied on each attempt of Sim. This mode requires the serial function to report every write to
+/// the simulated object's state by calling SimStateWriteBarrier.
+#define SIM_COPY_DELTA 1
+
+/// @brief SimRetSlot is a result slot, where the return value of a request is published to the thread that issued it.
+/// Each slot is tagged with the sequence number of the request, so a thread is able to recognize whether the value
+/// stored in its slot belongs to its most recent request. Slots are updated by a 128-bit CAS and their sequence
+/// numbers never decrease.
+typedef struct SimRetSlot {
+    /// @brief The sequence number of the request that produced the value.
+    volatile uint64_t seq;
+    /// @brief The return value of the request.
+    volatile RetVal val;
+} SimRetSlot;
 
-/// @brief This struct stores the data for a copy of the simulated object's state.
+/// @brief SimRoundRet stores the return value of a request that has been applied by a successful attempt of Sim.
+/// Each copy of the simulated object's state keeps only the return values of the requests applied by the attempt
+/// that produced it. These values are published to the per-thread result slots by the next attempt.
+typedef struct SimRoundRet {
+    /// @brief The pid of the thread that issued the request.
+    uint32_t pid;
+    /// @brief The position of the request in the batch of requests announced by the thread.
+    uint32_t index;
+    /// @brief The sequence number of the request.
+    uint64_t seq;
+    /// @brief The return value of the request.
+    RetVal val;
+} SimRoundRet;
+
+/// @brief Rounds N up to the closest multiple of A.
+#define SIM_ALIGN_UP(N, A) ((((N) + (A) - 1) / (A)) * (A))
+
+/// @brief The number of result slots that each thread owns, so as each thread's slots are padded to a cache line.
+#define SIM_RET_SLOTS_PER_THREAD(max_batch) ((((max_batch) * sizeof(SimRetSlot) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * (CACHE_LINE_SIZE / sizeof(SimRetSlot)))
+
+/// @brief SimRegistry keeps track of the pids that are handed out to the threads of an instance of Sim, SimStack or SimQueue.
+/// Pids are handed out lowest first, so the registered threads occupy the first cells of the toggle vectors and
+/// the combiners scan only these cells (see active_cells).
+typedef struct SimRegistry {
+    /// @brief A bitmap of the registered pids.
+    volatile bitword_t *registered;
+    /// @brief The number of cells of the toggle vectors that the combiners scan. It is the highest number of cells
+    /// that ever contained a registered pid, so it never decreases.
+    volatile uint32_t active_cells;
+    /// @brief The number of registered threads; it is used for tuning the backoff instead of nthreads.
+    volatile uint32_t threads;
+    /// @brief The maximum number of threads (i.e. pids) supported.
+    uint32_t nthreads;
+} SimRegistry;
+
+/// @brief This struct stores the metadata for a copy of the simulated object's state.
+/// The actual data of the simulated object's state, the applied vector of toggles and the list of return values
+/// are stored in the same memory area directly after this struct; their size and placement are computed at
+/// runtime by synchSimStructInit, based on the size and the alignment of the simulated object's state.
 typedef struct SimObjectState {
-    /// @brief A pointer to the array of return values.
-    RetVal *ret;
+    /// @brief A pointer to the list of return values of the requests applied by the attempt that produced this copy.
+    SimRoundRet *ret;
+    /// @brief The number of entries in the list of return values.
+    uint32_t ret_size;
     /// @brief The applied vector of toggles.
     ToggleVector applied;
-    /// @brief The actual data of the simulated object's state.
-    ObjectState state CACHE_ALIGN;
+    /// @brief A pointer to the actual data of the simulated object's state.
+    void *state;
+    /// @brief An array that stores for each cache line of the simulated object's state the attempt that last modified it.
+    uint64_t *version;
+    /// @brief An array that stores for each group of 64 cache lines of the simulated object's state the attempt that last modified it.
+    uint64_t *group_version;
+    /// @brief A bitmap of the cache lines of the simulated object's state that are modified by the current attempt.
+    /// It is NULL, whenever the SIM_COPY_DELTA mode is not enabled.
+    bitword_t *dirty;
 #ifdef DEBUG
     int counter;
     int rounds;
 #endif
-    uint64_t __flex[1];
-    char pad[PAD_CACHE(sizeof(HalfSimObjectState))];
 } SimObjectState;
 
-/// @brief A macro for calculating the size of the SimObjectState struct for a specific amount of threads.
-#define SimObjectStateSize(nthreads) (sizeof(SimObjectState) + _TVEC_VECTOR_SIZE(nthreads) + (nthreads) * sizeof(RetVal))
-
 /// @brief pointer_t should not used directely by user. This struct is used by Sim for pointing to the 
 /// most rescent and valid copy of the simulated object's state. It also contains a 40-bit sequence number
 /// for avoiding the ABA problem.
@@ -79,6 +133,8 @@ typedef struct SimThreadState {
     int local_index;
     /// @brief Current backoff value.
     int backoff;
+    /// @brief The sequence number of the last request (or batch of requests) announced by the thread.
+    uint64_t seq;
 } SimThreadState;
 
 /// @brief SimStruct stores the state of an instance of the a Sim combining object.
@@ -92,10 +148,46 @@ typedef struct SimStruct {
     /// @brief An array of pools (one pool per thread) of SimObjectState structs.
     SimObjectState **volatile pool;
     /// @brief Pointer to an array, where threads announce the requests that want to perform to the object.
+    /// Each thread owns max_batch consecutive entries of this array.
     ArgVal *volatile announce;
+    /// @brief Pointer to an array, where each thread announces the number of requests it has placed in its announce entries.
+    volatile uint32_t *announce_size;
+    /// @brief Pointer to an array, where each thread announces the sequence number of its current request.
+    volatile uint64_t *announce_seq;
+    /// @brief Pointer to an array of result slots, where the return values of the applied requests are published.
+    /// Each thread owns ret_stride consecutive (cache line padded) entries of this array.
+    SimRetSlot *ret_slots;
+    /// @brief The registry of the pids of the threads that use this instance of Sim.
+    SimRegistry registry;
+    /// @brief Pointer to an array, where a deregistered thread saves the next available free copy of its pool.
+    int *saved_index;
+    /// @brief Pointer to an array that stores the NUMA node where the pool of each thread is currently placed.
+    int32_t *pool_node;
 
-    /// @brief The number of threads that use this instance of Sim.
+    /// @brief The maximum number of threads that use this instance of Sim.
     uint32_t nthreads;
+    /// @brief The number of SimObjectState structs in the pool of each thread.
+    uint32_t pool_size;
+    /// @brief The maximum number of requests that a thread could announce in a single round (see SimApplyBatch).
+    uint32_t max_batch;
+    /// @brief The number of result slots that each thread owns.
+    uint32_t ret_stride;
+    /// @brief The size (in bytes) of the simulated object's state.
+    uint32_t state_size;
+    /// @brief The offset (in bytes) of the simulated object's state from the start of each SimObjectState.
+    uint32_t state_offset;
+    /// @brief The offset (in bytes) of the applied vector of toggles from the start of each SimObjectState.
+    uint32_t tvec_offset;
+    /// @brief The offset (in bytes) of the end of the area that is copied on each attempt from the start of each SimObjectState.
+    /// The list of return values is copied separately and only up to its actual size.
+    uint32_t copy_end;
+    /// @brief The number of cache lines that the simulated object's state spans.
+    uint32_t state_lines;
+    /// @brief The copy mode, i.e. either SIM_COPY_FULL or SIM_COPY_DELTA.
+    int copy_mode;
+    /// @brief The total size (in bytes) of each copy of the simulated object's state, including metadata,
+    /// the applied vector of toggles and the list of return values.
+    uint32_t record_size;
     /// @brief The maximum backoff value.
     int MAX_BACK;
 } SimStruct;
@@ -108,7 +200,216 @@ typedef struct SimStruct {
 /// @param sim_struct A pointer to an instance of the Sim universal construction.
 /// @param nthreads The number of threads that will use the Sim universal construction.
 /// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
-void synchSimStructInit(SimStruct *sim_struct, uint32_t nthreads, int max_backoff);
+/// @param state_size The size (in bytes) of the simulated object's state.
+/// @param state_align The alignment (in bytes) of the simulated object's state. A zero value stands for the default alignment.
+/// @param state_init A function that initializes the simulated object's state. In case that state_init is NULL,
+/// the initial state is filled with zeros.
+void synchSimStructInit(SimStruct *sim_struct, uint32_t nthreads, int max_backoff, uint32_t state_size, uint32_t state_align, void (*state_init)(void *));
+
+/// @brief This function initializes an instance of the Sim universal construction that supports batches of requests.
+/// Each thread is able to announce up to max_batch requests in a single round by using SimApplyBatch.
+/// Note that each thread owns max_batch result slots and each copy of the simulated object's state reserves space
+/// for nthreads * max_batch return values (although only the return values of a single attempt are copied),
+/// so max_batch should be kept small (i.e., 8, 16 or 32).
+///
+/// @param sim_struct A pointer to an instance of the Sim universal construction.
+/// @param nthreads The number of threads that will use the Sim universal construction.
+/// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
+/// @param max_batch The maximum number of requests that a thread announces in a single round.
+/// @param state_size The size (in bytes) of the simulated object's state.
+/// @param state_align The alignment (in bytes) of the simulated object's state. A zero value stands for the default alignment.
+/// @param state_init A function that initializes the simulated object's state. In case that state_init is NULL,
+/// the initial state is filled with zeros.
+void synchSimStructInitBatch(SimStruct *sim_struct, uint32_t nthreads, int max_backoff, uint32_t max_batch, uint32_t state_size, uint32_t state_align, void (*state_init)(void *));
+
+/// @brief This function initializes an instance of the Sim universal construction, exactly as synchSimStructInitBatch does,
+/// but it also sets the number of copies of the simulated object's state that each thread maintains in its pool.
+/// The pool of each thread is allocated as a single memory area on the NUMA node of the thread (see synchPreferredNumaNodeOfThread).
+/// In case that a thread registers to a pid by using SimRegisterThread, its pool is migrated to the NUMA node of the registering thread.
+///
+/// @param sim_struct A pointer to an instance of the Sim universal construction.
+/// @param nthreads The number of threads that will use the Sim universal construction.
+/// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
+/// @param max_batch The maximum number of requests that a thread announces in a single round.
+/// @param pool_size The number of copies of the simulated object's state in the pool of each thread. Values lower than 2 are set to 2.
+/// @param state_size The size (in bytes) of the simulated object's state.
+/// @param state_align The alignment (in bytes) of the simulated object's state. A zero value stands for the default alignment.
+/// @param state_init A function that initializes the simulated object's state. In case that state_init is NULL,
+/// the initial state is filled with zeros.
+void synchSimStructInitPool(SimStruct *sim_struct, uint32_t nthreads, int max_backoff, uint32_t max_batch, uint32_t pool_size, uint32_t state_size, uint32_t state_align, void (*state_init)(void *));
+
+/// @brief This function returns the size (in bytes) of each copy of the simulated object's state that
+/// an instance of Sim maintains, including metadata, the applied vector of toggles and the list of return values.
+///
+/// @param sim_struct A pointer to an initialized instance of the Sim universal construction.
+/// @return The size (in bytes) of a copy of the simulated object's state.
+static inline uint32_t SimObjectStateSize(SimStruct *sim_struct) {
+    return sim_struct->record_size;
+}
+
+/// @brief This function initializes a registry of pids. Initially, all the pids (i.e. 0 to nthreads - 1) are registered,
+/// so threads are able to use their pids directly. See also SimRegistrySetDynamic.
+///
+/// @param reg A pointer to a registry of pids.
+/// @param nthreads The maximum number of threads (i.e. pids) supported.
+void SimRegistryInit(SimRegistry *reg, uint32_t nthreads);
+
+/// @brief This function deregisters all the pids of a registry, so threads should get their pids by SimRegistryAcquire.
+/// It should be called after SimRegistryInit and before any thread applies any request.
+///
+/// @param reg A pointer to a registry of pids.
+void SimRegistrySetDynamic(SimRegistry *reg);
+
+/// @brief This function registers the lowest free pid of a registry and extends the active range of cells, if needed.
+///
+/// @param reg A pointer to a registry of pids.
+/// @return The registered pid, or -1 in case that all pids are in use.
+int SimRegistryAcquire(SimRegistry *reg);
+
+/// @brief This function deregisters a pid, so it could be handed out to another thread.
+///
+/// @param reg A pointer to a registry of pids.
+/// @param pid The pid to be deregistered.
+void SimRegistryRelease(SimRegistry *reg, int pid);
+
+/// @brief This function sets the copy mode (i.e. either SIM_COPY_FULL or SIM_COPY_DELTA) of an instance of Sim.
+/// It should be called after synchSimStructInit and before any thread applies any request to the Sim instance.
+/// The SIM_COPY_DELTA mode is beneficial for simulated objects with large states (i.e. a few kilobytes), where each
+/// request modifies only a small part of the state.
+///
+/// @param sim_struct A pointer to an instance of the Sim universal construction.
+/// @param copy_mode The copy mode, i.e. either SIM_COPY_FULL or SIM_COPY_DELTA.
+void synchSimStructSetCopyMode(SimStruct *sim_struct, int copy_mode);
+
+/// @brief This function enables the dynamic registration of threads for an instance of Sim.
+/// After this call, each thread should get its pid by calling SimRegisterThread and it should release it by calling
+/// SimDeregisterThread, when it does not use the Sim instance anymore. Released pids are handed out again to threads that
+/// register later. Pids are handed out lowest first and the combiners scan only the cells of the toggle vectors that ever
+/// contained a registered pid, so the cost of each round depends on the highest number of concurrently registered threads
+/// and not on the nthreads value of synchSimStructInit, which becomes the maximum number of threads.
+/// It should be called after synchSimStructInit and before any thread applies any request to the Sim instance.
+///
+/// @param sim_struct A pointer to an instance of the Sim universal construction.
+void synchSimStructSetDynamicThreads(SimStruct *sim_struct);
+
+/// @brief This function should be called by a serial function for every area of the simulated object's state that it
+/// modifies, whenever the SIM_COPY_DELTA mode is enabled. In any other case, it has no effect.
+///
+/// @param state A pointer to the simulated object's state, as passed to the serial function.
+/// @param addr A pointer to the modified area of the simulated object's state.
+/// @param size The size (in bytes) of the modified area.
+static inline void SimStateWriteBarrier(void *state, void *addr, size_t size) {
+    SimObjectState *copy = ((SimObjectState **)state)[-1];
+    size_t line, last;
+
+    if (copy->dirty == NULL || size == 0)
+        return;
+    line = ((char *)addr - (char *)state) / CACHE_LINE_SIZE;
+    last = ((char *)addr + size - 1 - (char *)state) / CACHE_LINE_SIZE;
+    for (; line <= last; line++)
+        copy->dirty[line >> _TVEC_DIVISION_SHIFT_BITS_] |= ((bitword_t)1) << (line & _TVEC_MODULO_BITS_);
+}
+
+/// @brief This function publishes a list of return values (copied from a valid copy of the simulated object's state)
+/// to the result slots of the threads that issued the corresponding requests. A result slot is updated only in case
+/// that it stores the return value of an older request, thus stale publications have no effect.
+///
+/// @param slots A pointer to the array of result slots.
+/// @param stride The number of result slots that each thread owns.
+/// @param list A pointer to the list of return values.
+/// @param size The number of entries in the list.
+static inline void SimRetPublish(SimRetSlot *slots, uint32_t stride, SimRoundRet *list, uint32_t size) {
+    uint32_t i;
+
+    for (i = 0; i < size; i++) {
+        SimRetSlot *slot = &slots[list[i].pid * stride + list[i].index];
+        uint64_t old_seq;
+
+        while ((old_seq = slot->seq) < list[i].seq) {
+            if (synchCAS128(slot, old_seq, slot->val, list[i].seq, list[i].val))
+                break;
+        }
+    }
+}
+
+/// @brief This function searches a list of return values for the return values of a request (or batch of requests)
+/// of a thread. The caller should validate that the copy of the simulated object's state that stores the list is still
+/// the current one after the search.
+///
+/// @param list A pointer to the list of return values.
+/// @param size The number of entries in the list.
+/// @param pid The pid of the thread that issued the requests.
+/// @param seq The sequence number of the requests.
+/// @param rets An array where the return values are stored.
+/// @param n The number of the requests.
+/// @return true in case that all n return values have been found, otherwise false.
+static inline bool SimRetCollectFromList(SimRoundRet *list, uint32_t size, int pid, uint64_t seq, RetVal *rets, uint32_t n) {
+    uint32_t i, found = 0;
+
+    for (i = 0; i < size && found < n; i++) {
+        if (list[i].pid == pid && list[i].seq == seq && list[i].index < n) {
+            rets[list[i].index] = list[i].val;
+            found++;
+        }
+    }
+    return found == n;
+}
+
+/// @brief This function reads the return values of a request (or batch of requests) from the result slots of a thread.
+///
+/// @param slots A pointer to the result slots of the thread.
+/// @param seq The sequence number of the requests.
+/// @param rets An array where the return values are stored.
+/// @param n The number of the requests.
+/// @return true in case that all n return values have been published, otherwise false.
+static inline bool SimRetCollectFromSlots(SimRetSlot *slots, uint64_t seq, RetVal *rets, uint32_t n) {
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        if (slots[i].seq != seq)
+            return false;
+        synchNonTSOFence();
+        rets[i] = slots[i].val;
+    }
+    return true;
+}
+
+/// @brief This function collects the return values of a request (or batch of requests) of a thread. The return values
+/// are either stored in the list of the most recent copy of the object's state or they have already been published to
+/// the result slots of the thread by the attempt that replaced this copy. It is used by all the Sim-based objects, thus
+/// the list of each copy is located by the given offsets.
+///
+/// @param slots A pointer to the result slots of the thread.
+/// @param sp A pointer to the reference to the most recent copy of the object's state (e.g. the sp field of SimStruct).
+/// @param pool The array of copies that sp refers to.
+/// @param ret_offset The offset of the pointer to the list of return values in each copy.
+/// @param size_offset The offset of the number of entries in the list in each copy.
+/// @param max_size The maximum number of entries in the list; a greater number is a stale read.
+/// @param pid The pid of the thread that issued the requests.
+/// @param seq The sequence number of the requests.
+/// @param rets An array where the return values are stored.
+/// @param n The number of the requests.
+static inline void SimRetCollectFromCopy(SimRetSlot *slots, volatile pointer_t *sp, void **pool, size_t ret_offset, size_t size_offset,
+                                         uint32_t max_size, int pid, uint64_t seq, RetVal *rets, uint32_t n) {
+    void *sp_data;
+    pointer_t old_sp;
+    uint32_t size;
+
+    // This loop is executed at most a few times.
+    while (!SimRetCollectFromSlots(slots, seq, rets, n)) {
+        old_sp.raw_data = sp->raw_data;
+        synchNonTSOFence();
+        sp_data = pool[old_sp.struct_data.index];
+        size = *(volatile uint32_t *)(sp_data + size_offset);
+        if (size > max_size)
+            continue;
+        if (SimRetCollectFromList(*(SimRoundRet **)(sp_data + ret_offset), size, pid, seq, rets, n)) {
+            synchNonTSOFence();
+            if (old_sp.raw_data == sp->raw_data)
+                return;
+        }
+    }
+}
 
 /// @brief This function should be called once before the thread applies any operation to the Sim universal construction.
 ///
@@ -117,6 +418,22 @@ void synchSimStructInit(SimStruct *sim_struct, uint32_t nthreads, int max_backof
 /// @param pid The pid of the calling thread.
 void SimThreadStateInit(SimThreadState *th_state, uint32_t nthreads, int pid);
 
+/// @brief This function registers the calling thread to an instance of Sim (see synchSimStructSetDynamicThreads) and
+/// initializes its local state. There is no need to call SimThreadStateInit.
+///
+/// @param sim_struct A pointer to an instance of the Sim universal construction.
+/// @param th_state A pointer to thread's local state for this instance of Sim.
+/// @return The pid that the thread should use for this instance of Sim, or -1 in case that all pids are in use.
+int SimRegisterThread(SimStruct *sim_struct, SimThreadState *th_state);
+
+/// @brief This function deregisters the calling thread from an instance of Sim and releases its local state.
+/// The thread should not have any pending request, i.e. it should not be in the middle of a SimApplyOp call.
+///
+/// @param sim_struct A pointer to an instance of the Sim universal construction.
+/// @param th_state A pointer to thread's local state for this instance of Sim.
+/// @param pid The pid returned by SimRegisterThread.
+void SimDeregisterThread(SimStruct *sim_struct, SimThreadState *th_state, int pid);
+
 /// @brief This function is called whenever a thread wants to apply an operation to the simulated concurrent object.
 ///
 /// @param sim_struct A pointer to an instance of the Sim universal construction.
@@ -127,4 +444,239 @@ void SimThreadStateInit(SimThreadState *th_state, uint32_t nthreads, int pid);
 /// @return RetVal The return value of the applied request.
 Object SimApplyOp(SimStruct *sim_struct, SimThreadState *th_state, RetVal (*sfunc)(void *, ArgVal, int), Object arg, int pid);
 
+/// @brief This function is called whenever a thread wants to apply a read-only operation to the simulated concurrent object.
+/// The read function is evaluated directly on the most recent copy of the simulated object's state, without toggling
+/// any bit, copying the state or updating the pointer to the most recent copy. The result is valid only in case that
+/// this copy is still the most recent one after the evaluation, otherwise the evaluation is repeated. After
+/// _SIM_READ_ATTEMPTS_ failed evaluations, the request is applied as an ordinary request by SimApplyOp, thus it
+/// remains wait-free. Since the copy may be concurrently reused by another thread, rfunc should not modify the
+/// simulated object's state and should tolerate reading an inconsistent state (i.e. it should not follow pointers stored
+/// in the state without checking them); in this case its return value is discarded.
+///
+/// @param sim_struct A pointer to an instance of the Sim universal construction.
+/// @param th_state A pointer to thread's local state for a specific instance of Sim.
+/// @param rfunc A serial function that reads (but never modifies) the simulated object's state.
+/// @param arg The argument of the read-only request.
+/// @param pid The pid of the calling thread.
+/// @return RetVal The return value of the read-only request.
+RetVal SimApplyReadOp(SimStruct *sim_struct, SimThreadState *th_state, RetVal (*rfunc)(void *, ArgVal, int), ArgVal arg, int pid);
+
+/// @brief This function is called whenever a thread wants to apply a batch of operations to the simulated concurrent object.
+/// All the requests of the batch are announced at once, and they are applied by a single round of Sim, i.e. by using a single
+/// Fetch&Add on the toggle bits and a single copy of the object's state. The requests of the batch are applied in order and
+/// without any other request interleaved between them. Batches larger than the max_batch value of sim_struct
+/// are split into multiple rounds.
+///
+/// @param sim_struct A pointer to an instance of the Sim universal construction.
+/// @param th_state A pointer to thread's local state for a specific instance of Sim.
+/// @param sfunc A serial function that the Sim instance should execute, while applying requests announced by active threads.
+/// @param args An array of n arguments, one for each request of the batch.
+/// @param rets An array of n entries, where the return values of the applied requests are stored.
+/// @param n The number of requests of the batch.
+/// @param pid The pid of the calling thread.
+void SimApplyBatch(SimStruct *sim_struct, SimThreadState *th_state, RetVal (*sfunc)(void *, ArgVal, int), ArgVal *args, RetVal *rets, uint32_t n, int pid);
+
+// Inlinable apply path
+// --------------------
+// The functions below implement a round of Sim. They are defined in this header (instead of sim.c), so as
+// a serial function that is known at compile time could be inlined in the combining loop (see SIM_DEFINE_APPLY_OP).
+
+#define SIM_INVALID_VERSION (~((uint64_t)0))
+
+static inline void SimStateCopy(SimStruct *sim_struct, SimObjectState *dest, SimObjectState *src, uint32_t cells) {
+    if (sim_struct->copy_mode == SIM_COPY_DELTA) {
+        uint32_t g, i, line, lines = sim_struct->state_lines;
+
+        // copy only the cache lines of object's state that are not up to date
+        for (g = 0, i = 0; i < lines; g++, i += _TVEC_BIWORD_SIZE_) {
+            uint32_t last = (lines - i < _TVEC_BIWORD_SIZE_) ? lines - i : _TVEC_BIWORD_SIZE_;
+            bitword_t stale = 0;
+
+            if (dest->group_version[g] == src->group_version[g])                       // none of the lines of this group has changed
+                continue;
+            for (line = 0; line < last; line++)                                         // branch-free comparison of versions
+                stale |= ((bitword_t)(dest->version[i + line] != src->version[i + line])) << line;
+            while (stale != 0L) {
+                line = i + synchBitSearchFirst(stale);
+                stale &= stale - 1;
+                memcpy(dest->state + line * CACHE_LINE_SIZE, src->state + line * CACHE_LINE_SIZE, CACHE_LINE_SIZE);
+                dest->version[line] = src->version[line];
+            }
+            dest->group_version[g] = src->group_version[g];
+        }
+        // copy the active cells of the applied toggles
+        TVEC_COPY_CELLS(&dest->applied, &src->applied, cells);
+    } else {
+        // copy everything except the metadata fields, i.e. object's state and the active cells of the applied toggles
+        memcpy(dest->state, src->state, sim_struct->tvec_offset - sim_struct->state_offset + cells * sizeof(bitword_t));
+    }
+    // copy only the return values of the attempt that produced src
+    dest->ret_size = src->ret_size;
+    if (dest->ret_size > sim_struct->nthreads * sim_struct->max_batch)                 // a stale read, this attempt is going to fail
+        dest->ret_size = 0;
+    memcpy(dest->ret, src->ret, dest->ret_size * sizeof(SimRoundRet));
+#ifdef DEBUG
+    dest->counter = src->counter;
+    dest->rounds = src->rounds;
+#endif
+}
+
+static inline void SimStateInvalidate(SimStruct *sim_struct, SimObjectState *copy) {
+    uint32_t line;
+
+    for (line = 0; line < sim_struct->state_lines; line++)
+        copy->version[line] = SIM_INVALID_VERSION;
+    for (line = 0; line < _TVEC_CELLS_(sim_struct->state_lines); line++)
+        copy->group_version[line] = SIM_INVALID_VERSION;
+}
+
+static inline void SimRetAppend(SimObjectState *copy, int pid, uint32_t index, uint64_t seq, RetVal val) {
+    SimRoundRet *entry = &copy->ret[copy->ret_size++];
+
+    entry->pid = pid;
+    entry->index = index;
+    entry->seq = seq;
+    entry->val = val;
+}
+
+static inline void SimStateCommitDirty(SimStruct *sim_struct, SimObjectState *copy, uint64_t version) {
+    uint32_t i;
+
+    for (i = 0; i < _TVEC_CELLS_(sim_struct->state_lines); i++) {
+        while (copy->dirty[i] != 0L) {
+            int pos = synchBitSearchFirst(copy->dirty[i]);
+
+            copy->dirty[i] ^= ((bitword_t)1) << pos;
+            copy->version[i * _TVEC_BIWORD_SIZE_ + pos] = version;
+            copy->group_version[i] = version;
+        }
+    }
+}
+
+static inline ALWAYS_INLINE void SimApplyRound(SimStruct *sim_struct, SimThreadState *th_state, RetVal (*sfunc)(void *, ArgVal, int), RetVal *rets, int pid) {
+    ToggleVector *diffs = &th_state->diffs, *l_toggles = &th_state->l_toggles;
+    pointer_t old_sp, new_sp;
+    SimObjectState *sp_data, *lsp_data;
+    uint32_t max_batch = sim_struct->max_batch;
+    uint32_t my_size = sim_struct->announce_size[pid];
+    uint64_t my_seq = ++th_state->seq;
+    uint32_t cells;
+    int i, j, m, prefix, mybank;
+
+    sim_struct->announce_seq[pid] = my_seq;
+    synchNonTSOFence();
+    mybank = TVEC_GET_BANK_OF_BIT(pid, sim_struct->nthreads);
+    TVEC_REVERSE_BIT(&th_state->my_bit, pid);
+    TVEC_NEGATIVE_BANK(&th_state->toggle, &th_state->toggle, mybank);
+    lsp_data = sim_struct->pool[pid * sim_struct->pool_size + th_state->local_index];
+    TVEC_ATOMIC_ADD_BANK(&sim_struct->a_toggles, &th_state->toggle, mybank);            // toggle pid's bit in sim_struct->a_toggles, Fetch&Add acts as a full write-barrier
+
+    if (!synchIsSystemOversubscribed()) {
+        volatile int k;
+        int backoff_limit;
+
+        if (synchFastRandomRange(1, sim_struct->registry.threads) > 1) {
+            backoff_limit = th_state->backoff;
+            for (k = 0; k < backoff_limit; k++)
+                ;
+        }
+    } else if (synchFastRandomRange(1, sim_struct->registry.threads) > 4)
+        synchResched();
+
+    for (j = 0; j < 2; j++) {
+        old_sp = sim_struct->sp;                                                        // read reference to struct ObjectState
+        synchNonTSOFence();
+        sp_data = sim_struct->pool[old_sp.struct_data.index];                          // read reference of struct ObjectState in a local variable lsim_struct->sp
+        cells = sim_struct->registry.active_cells;                                      // only these cells of the toggle vectors contain registered threads
+        TVEC_ATOMIC_COPY_BANKS(diffs, &sp_data->applied, mybank);
+        TVEC_XOR_BANKS(diffs, diffs, &th_state->my_bit, mybank);                        // determine the set of active processes
+        if (TVEC_IS_SET(diffs, pid))                                                    // if the operation has already been applied return
+            break;
+        SimStateCopy(sim_struct, lsp_data, sp_data, cells);
+        synchNonTSOFence();
+        TVEC_COPY_CELLS(l_toggles, (ToggleVector *)&sim_struct->a_toggles, cells);      // This is an atomic read, since a_toogles is volatile
+        if (old_sp.raw_data != sim_struct->sp.raw_data) {
+            if (sim_struct->copy_mode == SIM_COPY_DELTA)                                // the copy may be inconsistent
+                SimStateInvalidate(sim_struct, lsp_data);
+            continue;
+        }
+        SimRetPublish(sim_struct->ret_slots, sim_struct->ret_stride, lsp_data->ret, lsp_data->ret_size); // publish the return values of the previous attempt
+        lsp_data->ret_size = 0;
+        TVEC_XOR_CELLS(diffs, &lsp_data->applied, l_toggles, cells);
+#ifdef DEBUG
+        lsp_data->rounds++;
+        lsp_data->counter += my_size;
+#endif
+        for (m = 0; m < my_size; m++)
+            SimRetAppend(lsp_data, pid, m, my_seq, sfunc(lsp_data->state, sim_struct->announce[pid * max_batch + m], pid));
+        TVEC_REVERSE_BIT(diffs, pid);
+        for (i = 0, prefix = 0; i < cells; i++, prefix += _TVEC_BIWORD_SIZE_) {
+            synchReadPrefetch(&sim_struct->announce[prefix * max_batch]);
+            synchReadPrefetch(&sim_struct->announce[(prefix + 8) * max_batch]);
+            synchReadPrefetch(&sim_struct->announce[(prefix + 16) * max_batch]);
+            synchReadPrefetch(&sim_struct->announce[(prefix + 24) * max_batch]);
+
+            while (diffs->cell[i] != 0L) {
+                register int pos, proc_id;
+                uint32_t size;
+                uint64_t seq;
+
+                pos = synchBitSearchFirst(diffs->cell[i]);
+                proc_id = prefix + pos;
+                diffs->cell[i] ^= ((bitword_t)1) << pos;
+                size = sim_struct->announce_size[proc_id];
+                seq = sim_struct->announce_seq[proc_id];
+                if (size > max_batch)                                                   // a stale read, this attempt is going to fail
+                    size = max_batch;
+                for (m = 0; m < size; m++)
+                    SimRetAppend(lsp_data, proc_id, m, seq, sfunc(lsp_data->state, sim_struct->announce[proc_id * max_batch + m], proc_id));
+#ifdef DEBUG
+                lsp_data->counter += size;
+#endif
+            }
+        }
+        TVEC_COPY_CELLS(&lsp_data->applied, l_toggles, cells);                          // change applied to be equal to what was read in sim_struct->a_toggles
+        new_sp.struct_data.seq = old_sp.struct_data.seq + 1;                            // increase timestamp
+        new_sp.struct_data.index = sim_struct->pool_size * pid + th_state->local_index; // store in mod_dw.index the index in sim_struct->pool where lsim_struct->sp will be stored
+        if (sim_struct->copy_mode == SIM_COPY_DELTA)                                    // tag the modified cache lines with this attempt
+            SimStateCommitDirty(sim_struct, lsp_data, new_sp.raw_data);
+        if (old_sp.raw_data == sim_struct->sp.raw_data && synchCAS64(&sim_struct->sp, old_sp.raw_data, new_sp.raw_data)) {  // try to change sim_struct->sp to the value mod_dw
+            th_state->local_index = (th_state->local_index + 1) % sim_struct->pool_size;                              // if this happens successfully,use next item in pid's sim_struct->pool next time
+            th_state->backoff = (th_state->backoff >> 1) | 1;
+            for (m = 0; m < my_size; m++)                                               // pid's requests are the first ones applied
+                rets[m] = lsp_data->ret[m].val;
+            return;
+        } else if (th_state->backoff < sim_struct->MAX_BACK)
+            th_state->backoff <<= 1;
+    }
+    // return the values found either in the current record or in pid's result slots
+    SimRetCollectFromCopy(&sim_struct->ret_slots[pid * sim_struct->ret_stride], &sim_struct->sp, (void **)sim_struct->pool,
+                          offsetof(SimObjectState, ret), offsetof(SimObjectState, ret_size), sim_struct->nthreads * sim_struct->max_batch,
+                          pid, my_seq, rets, my_size);
+}
+
+/// @brief This function is the inlinable version of SimApplyOp. In case that sfunc is a constant whose definition is
+/// visible (i.e. a static inline function), the compiler is able to inline it in the loop that applies the announced requests.
+/// Usually, it is used through SIM_DEFINE_APPLY_OP and not directly.
+static inline ALWAYS_INLINE Object SimApplyOpInline(SimStruct *sim_struct, SimThreadState *th_state, RetVal (*sfunc)(void *, ArgVal, int), Object arg, int pid) {
+    RetVal ret;
+
+    sim_struct->announce[pid * sim_struct->max_batch] = arg;                            // sim_struct->announce the operation
+    if (sim_struct->max_batch > 1)
+        sim_struct->announce_size[pid] = 1;
+    SimApplyRound(sim_struct, th_state, sfunc, &ret, pid);
+
+    return ret;
+}
+
+/// @brief This macro defines a function named NAME that is equivalent to SimApplyOp, but it is specialized for the
+/// serial function SFUNC, i.e. SFUNC is inlined in the loop that applies the announced requests instead of being
+/// called through a pointer. The defined function has the following signature:
+/// `static inline Object NAME(SimStruct *sim_struct, SimThreadState *th_state, Object arg, int pid)`.
+/// An example of use is provided in benchmarks/simbench.c file.
+#define SIM_DEFINE_APPLY_OP(NAME, SFUNC)                                                                               \
+    static inline Object NAME(SimStruct *sim_struct, SimThreadState *th_state, Object arg, int pid) {                 \
+        return SimApplyOpInline(sim_struct, th_state, SFUNC, arg, pid);                                                \
+    }
+
 #endif
@@ -0,0 +1,242 @@
+/// @file simbqueue.h
+/// @author Nikolaos D. Kallimanis (nkallima@gmail.com)
+/// @brief This file exposes the API of SimBQueue, a bounded, array-based version of the SimQueue concurrent queue.
+/// An example of use of this API is provided in benchmarks/simbqueuebench.c file.
+///
+/// As in SimQueue, the enqueuers and the dequeuers use two discrete instances of the Sim toggle/announce machinery.
+/// However, the elements are stored in a preallocated ring of slots whose size is a power of two, so no node is
+/// allocated; the state of the enqueuers (SimBQueueEnqState) stores the index of the tail and the state of the
+/// dequeuers (SimBQueueDeqState) stores the index of the head of the queue. An enqueue returns ENQUEUE_FAIL in case
+/// that the ring is full and a dequeue returns EMPTY_QUEUE in case that the ring is empty.
+///
+/// Since more than one combiner may try to apply the same round, the combiners never write to the ring directly.
+/// Each copy of SimBQueueEnqState stores the elements that are enqueued by the attempt that produced it, and these
+/// elements are written to the ring by the next attempts (in the same way that return values are published in Sim,
+/// see SimRetPublish). Each slot of the ring is tagged with the position of the element that it stores, and it is
+/// updated only by a 128-bit CAS that increases its tag, thus stale writes have no effect.
+///
+/// For a more detailed description of Sim and SimQueue see the original publication:
+/// Panagiota Fatourou, and Nikolaos D. Kallimanis. "A highly-efficient wait-free universal construction".
+/// Proceedings of the twenty-third annual ACM symposium on Parallelism in algorithms and architectures (SPAA), 2011.
+/// @copyright Copyright (c) 2021
+#ifndef _SIMBQUEUE_H_
+#define _SIMBQUEUE_H_
+
+#include <config.h>
+#include <primitives.h>
+#include <queue-stack.h>
+#include <eventcount.h>
+#include <sim.h>
+
+/// @brief A slot of the ring of SimBQueue. The tag of a slot is equal to the position (counting from 1) of the
+/// element that it stores, or 0 in case that no element has ever been stored to it.
+typedef SimRetSlot SimBQueueSlot;
+
+/// @brief This struct stores the data about the state of the enqueuers of SimBQueue.
+/// The applied vector of toggles, the list of enqueued elements and the list of return values are stored in the
+/// same memory area directly after this struct.
+typedef struct SimBQueueEnqState {
+    /// @brief The applied vector of toggles.
+    ToggleVector applied;
+    /// @brief The elements enqueued by the attempt that produced this copy (each one tagged with its position).
+    SimBQueueSlot *pending;
+    /// @brief The number of entries in the list of enqueued elements.
+    uint32_t pending_size;
+    /// @brief The number of entries in the list of return values.
+    uint32_t ret_size;
+    /// @brief A pointer to the list of return values of the enqueue operations applied by the attempt that produced this copy.
+    SimRoundRet *ret;
+    /// @brief The position of the tail of the queue, i.e. the number of elements that have ever been enqueued.
+    uint64_t tail;
+#ifdef DEBUG
+    int64_t counter;
+#endif
+} SimBQueueEnqState;
+
+/// @brief This struct stores the data about the state of the dequeuers of SimBQueue.
+/// The applied vector of toggles and the list of return values are stored in the same memory area directly after this struct.
+typedef struct SimBQueueDeqState {
+    /// @brief The applied vector of toggles.
+    ToggleVector applied;
+    /// @brief A pointer to the list of return values of the dequeue operations applied by the attempt that produced this copy.
+    SimRoundRet *ret;
+    /// @brief The number of entries in the list of return values.
+    uint32_t ret_size;
+    /// @brief The position of the head of the queue, i.e. the number of elements that have ever been dequeued.
+    uint64_t head;
+#ifdef DEBUG
+    int64_t counter;
+#endif
+} SimBQueueDeqState;
+
+/// @brief SimBQueueThreadState stores each thread's local state for a single instance of SimBQueue.
+/// For each instance of SimBQueue, a discrete instance of SimBQueueThreadState should be used.
+typedef struct SimBQueueThreadState {
+    ToggleVector mask;
+    ToggleVector deq_toggle;
+    ToggleVector my_deq_bit;
+    ToggleVector enq_toggle;
+    ToggleVector my_enq_bit;
+    ToggleVector diffs;
+    ToggleVector l_toggles;
+    /// @brief A buffer for the elements of the most recent copy of SimBQueueEnqState, which a dequeuer writes to the ring.
+    SimBQueueSlot *pending;
+    /// @brief The next available free copy of SimBQueueEnqState.
+    int enq_local_index;
+    /// @brief The next available free copy of SimBQueueDeqState.
+    int deq_local_index;
+    /// @brief The maximum backoff value.
+    int max_backoff;
+    /// @brief The sequence number of the last enqueue operation announced by the thread.
+    uint64_t enq_seq;
+    /// @brief The sequence number of the last dequeue operation announced by the thread.
+    uint64_t deq_seq;
+} SimBQueueThreadState;
+
+/// @brief SimBQueueStruct stores the state of an instance of the SimBQueue.
+/// SimBQueueStruct should be initialized using the SimBQueueStructInit function.
+typedef struct SimBQueueStruct {
+    /// @brief Pointer to the most recent and valid copy of SimBQueueEnqState.
+    volatile pointer_t enq_sp CACHE_ALIGN;
+    /// @brief Pointer to the most recent and valid copy of SimBQueueDeqState.
+    volatile pointer_t deq_sp CACHE_ALIGN;
+    /// @brief A lower bound of the position of the tail, such that all the elements before it have been written to the ring.
+    volatile uint64_t tail_hint CACHE_ALIGN;
+    /// @brief A lower bound of the position of the head; the slots of the ring before it could be reused.
+    volatile uint64_t head_hint CACHE_ALIGN;
+    /// @brief Toggle bits for the enqueue operations.
+    ToggleVector enqueuers CACHE_ALIGN;
+    /// @brief Toggle bits for the dequeue operations.
+    ToggleVector dequeuers;
+    /// @brief The ring of slots that stores the elements of the queue.
+    SimBQueueSlot *ring;
+    /// @brief Pointer to an array, where threads announce the enqueue requests that want to perform to the object.
+    ArgVal *announce;
+    /// @brief Pointer to an array, where each thread announces the sequence number of its current enqueue operation.
+    volatile uint64_t *enq_announce_seq;
+    /// @brief Pointer to an array, where each thread announces the sequence number of its current dequeue operation.
+    volatile uint64_t *deq_announce_seq;
+    /// @brief Pointer to an array of result slots, where the return values of the applied enqueue operations are published.
+    SimRetSlot *enq_ret_slots;
+    /// @brief Pointer to an array of result slots, where the return values of the applied dequeue operations are published.
+    SimRetSlot *deq_ret_slots;
+    /// @brief The registry of the pids of the threads that use this instance of SimBQueue.
+    SimRegistry registry;
+    /// @brief Pointer to an array, where a deregistered thread saves the next available free copy of its pool of SimBQueueEnqState structs.
+    int *saved_enq_index;
+    /// @brief Pointer to an array, where a deregistered thread saves the next available free copy of its pool of SimBQueueDeqState structs.
+    int *saved_deq_index;
+    /// @brief An array of pools (one pool per thread) of SimBQueueEnqState structs, used by the enqueuers.
+    SimBQueueEnqState **enq_pool;
+    /// @brief An array of pools (one pool per thread) of SimBQueueDeqState structs, used by the dequeuers.
+    SimBQueueDeqState **deq_pool;
+    /// @brief Pointer to an array that stores the NUMA node where the pools of each thread are currently placed.
+    int32_t *pool_node;
+    /// @brief The number of slots of the ring; it is a power of two.
+    uint64_t capacity;
+    /// @brief The maximum number of threads that use this instance of SimBQueue.
+    uint32_t nthreads;
+    /// @brief The number of SimBQueueEnqState (and SimBQueueDeqState) structs in the pools of each thread.
+    uint32_t pool_size;
+    /// @brief The size (in bytes) of each SimBQueueEnqState struct, including the lists of elements and return values.
+    uint32_t enq_record_size;
+    /// @brief The size (in bytes) of each SimBQueueDeqState struct, including the list of return values.
+    uint32_t deq_record_size;
+    /// @brief The number of result slots that each thread owns.
+    uint32_t ret_stride;
+    /// @brief The maximum backoff value.
+    int MAX_BACK;
+    /// @brief An eventcount, on which the blocking and timed dequeue operations wait while the queue is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
+} SimBQueueStruct;
+
+/// @brief This function initializes an instance of the SimBQueue concurrent queue implementation.
+/// This function should be called once (by a single thread) before any other thread tries to
+/// apply any enqueue or dequeue operation.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param nthreads The number of threads that will use the SimBQueue concurrent queue implementation.
+/// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
+/// @param capacity The maximum number of elements that the queue stores; it is rounded up to the next power of two.
+void SimBQueueStructInit(SimBQueueStruct *queue, uint32_t nthreads, int max_backoff, uint64_t capacity);
+
+/// @brief This function initializes an instance of the SimBQueue concurrent queue implementation, exactly as SimBQueueStructInit does,
+/// but it also sets the number of copies of the enqueuers' and the dequeuers' state that each thread maintains in its pools.
+/// The pools of each thread are allocated on the NUMA node of the thread and they are migrated to the NUMA node of
+/// any thread that later registers to the same pid by using SimBQueueRegisterThread.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param nthreads The number of threads that will use the SimBQueue concurrent queue implementation.
+/// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
+/// @param capacity The maximum number of elements that the queue stores; it is rounded up to the next power of two.
+/// @param pool_size The number of copies in each pool of each thread. Values lower than 2 are set to 2.
+void SimBQueueStructInitPool(SimBQueueStruct *queue, uint32_t nthreads, int max_backoff, uint64_t capacity, uint32_t pool_size);
+
+/// @brief This function enables the dynamic registration of threads for an instance of SimBQueue.
+/// After this call, each thread should get its pid by calling SimBQueueRegisterThread and it should release it by calling
+/// SimBQueueDeregisterThread. The combiners scan only the cells of the toggle vectors that ever contained a registered pid.
+/// It should be called after SimBQueueStructInit and before any thread applies any operation.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+void SimBQueueStructSetDynamicThreads(SimBQueueStruct *queue);
+
+/// @brief This function registers the calling thread to an instance of SimBQueue (see SimBQueueStructSetDynamicThreads)
+/// and initializes its local state. There is no need to call SimBQueueThreadStateInit.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimBQueue.
+/// @return The pid that the thread should use for this instance of SimBQueue, or -1 in case that all pids are in use.
+int SimBQueueRegisterThread(SimBQueueStruct *queue, SimBQueueThreadState *th_state);
+
+/// @brief This function deregisters the calling thread from an instance of SimBQueue and releases its local state.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimBQueue.
+/// @param pid The pid returned by SimBQueueRegisterThread.
+void SimBQueueDeregisterThread(SimBQueueStruct *queue, SimBQueueThreadState *th_state, int pid);
+
+/// @brief This function should be called once before the thread applies any operation to the SimBQueue concurrent queue implementation.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimBQueue.
+/// @param pid The pid of the calling thread.
+void SimBQueueThreadStateInit(SimBQueueStruct *queue, SimBQueueThreadState *th_state, int pid);
+
+/// @brief This function adds (i.e. enqueues) a new element to the back of the queue.
+/// This element has a value equal with arg.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimBQueue.
+/// @param arg The enqueue operation will insert a new element to the queue with value equal to arg.
+/// @param pid The pid of the calling thread.
+/// @return ENQUEUE_SUCCESS in case that the element is enqueued, or ENQUEUE_FAIL in case that the queue is full.
+RetVal SimBQueueEnqueue(SimBQueueStruct *queue, SimBQueueThreadState *th_state, ArgVal arg, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimBQueue.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue is empty.
+RetVal SimBQueueDequeue(SimBQueueStruct *queue, SimBQueueThreadState *th_state, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits until an element is enqueued (see eventcount.h).
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimBQueue.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal SimBQueueDequeueBlocking(SimBQueueStruct *queue, SimBQueueThreadState *th_state, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is enqueued.
+///
+/// @param queue A pointer to an instance of the SimBQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimBQueue.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue remains empty for timeout_ns nanoseconds.
+RetVal SimBQueueDequeueTimed(SimBQueueStruct *queue, SimBQueueThreadState *th_state, uint64_t timeout_ns, int pid);
+
+#endif
@@ -13,6 +13,7 @@
 #include <config.h>
 #include <primitives.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 #include <sim.h>
 #include <pool.h>
 
@@ -41,12 +42,14 @@ typedef struct EnqState {
 typedef struct DeqState {
     /// @brief The applied vector of toggles.
     ToggleVector applied;
+    /// @brief A pointer to the list of return values of the dequeue operations applied by the attempt that produced this copy.
+    SimRoundRet *ret;
+    /// @brief The number of entries in the list of return values.
+    uint32_t ret_size;
     /// @brief In case you want to copy this struct, start from here.
     uint64_t copy_point;
     /// @brief A pointer to the head of the queue.
     Node *head;
-    /// @brief A pointer to the array of return values.
-    RetVal *ret;
 #ifdef DEBUG
     int32_t counter;
 #endif
@@ -54,7 +57,9 @@ typedef struct DeqState {
 } DeqState;
 
 /// @brief A macro for calculating the size of the DeqState struct for a specific amount of threads.
-#define DeqStateSize(N) (sizeof(DeqState) + _TVEC_VECTOR_SIZE(N) + (N) * sizeof(RetVal))
+/// This is the part of DeqState that is copied on each attempt; the list of return values (up to max_batch
+/// per thread) is stored after it and only its used entries are copied.
+#define DeqStateSize(N) (sizeof(DeqState) + _TVEC_VECTOR_SIZE(N))
 
 /// @brief SimQueueThreadState stores each thread's local state for a single instance of SimQueue.
 /// For each instance of SimQueue, a discrete instance of SimQueueThreadState should be used.
@@ -74,6 +79,8 @@ typedef struct SimQueueThreadState {
     int enq_local_index;
     /// @brief The maximum backoff value.
     int max_backoff;
+    /// @brief The sequence number of the last dequeue operation announced by the thread.
+    uint64_t deq_seq;
 } SimQueueThreadState;
 
 /// @brief SimQueueStruct stores the state of an instance of the SimQueue.
@@ -90,15 +97,46 @@ typedef struct SimQueueStruct {
     /// @brief Toggle bits for the dequeue operations.
     ToggleVector dequeuers;
     /// @brief Pointer to an array, where threads announce only the enqueue requests that want to perform to the object.
+    /// Each thread owns max_batch consecutive entries of this array.
     ArgVal *announce;
+    /// @brief Pointer to an array, where each thread announces the number of elements of its current enqueue operation.
+    volatile uint32_t *announce_size;
+    /// @brief Pointer to an array, where each thread announces the sequence number of its current dequeue operation.
+    volatile uint64_t *deq_announce_seq;
+    /// @brief Pointer to an array, where each thread announces the maximum number of elements of its current dequeue operation.
+    volatile uint32_t *deq_announce_size;
+    /// @brief Pointer to an array of result slots, where the return values of the applied dequeue operations are published.
+    /// Each thread owns ret_stride consecutive (cache line padded) entries of this array.
+    SimRetSlot *ret_slots;
+    /// @brief The number of result slots that each thread owns.
+    uint32_t ret_stride;
+    /// @brief The registry of the pids of the threads that use this instance of SimQueue.
+    SimRegistry registry;
+    /// @brief Pointer to an array, where a deregistered thread saves the next available free copy of its pool of EnqState structs.
+    int *saved_enq_index;
+    /// @brief Pointer to an array, where a deregistered thread saves the next available free copy of its pool of DeqState structs.
+    int *saved_deq_index;
     /// @brief An array of pools (one pool per thread) of EnqState structs, used by the enqueuers.
     EnqState **enq_pool;
     /// @brief An array of pools (one pool per thread) of DeqState structs, used by dequeuers.
     DeqState **deq_pool;
-    /// @brief The number of threads that use this instance of SimQueue.
+    /// @brief Pointer to an array that stores the NUMA node where the pools of each thread are currently placed.
+    int32_t *pool_node;
+    /// @brief The maximum number of threads that use this instance of SimQueue.
     uint32_t nthreads;
+    /// @brief The number of EnqState (and DeqState) structs in the pools of each thread.
+    uint32_t pool_size;
+    /// @brief The maximum number of elements that a thread enqueues or dequeues in a single round
+    /// (see SimQueueEnqueueBatch and SimQueueDequeueBatch).
+    uint32_t max_batch;
+    /// @brief The size (in bytes) of each EnqState struct.
+    uint32_t enq_record_size;
+    /// @brief The size (in bytes) of each DeqState struct, including the list of return values.
+    uint32_t deq_record_size;
     /// @brief The maximum backoff value.
     int MAX_BACK;
+    /// @brief An eventcount, on which the blocking and timed dequeue operations wait while the queue is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } SimQueueStruct;
 
 /// @brief This function initializes an instance of the SimQueue concurrent queue implementation.
@@ -110,6 +148,54 @@ typedef struct SimQueueStruct {
 /// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
 void SimQueueStructInit(SimQueueStruct *queue, uint32_t nthreads, int max_backoff);
 
+/// @brief This function initializes an instance of the SimQueue concurrent queue implementation, exactly as SimQueueStructInit does,
+/// but it also sets the number of copies of the enqueuers' and the dequeuers' state that each thread maintains in its pools.
+/// The pools of each thread are allocated on the NUMA node of the thread and they are migrated to the NUMA node of
+/// any thread that later registers to the same pid by using SimQueueRegisterThread.
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+/// @param nthreads The number of threads that will use the SimQueue concurrent queue implementation.
+/// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
+/// @param pool_size The number of copies in each pool of each thread. Values lower than 2 are set to 2.
+void SimQueueStructInitPool(SimQueueStruct *queue, uint32_t nthreads, int max_backoff, uint32_t pool_size);
+
+/// @brief This function initializes an instance of the SimQueue concurrent queue implementation that supports batches of
+/// elements, i.e. each thread is able to enqueue or dequeue up to max_batch elements in a single round by using
+/// SimQueueEnqueueBatch and SimQueueDequeueBatch. It also sets the number of copies in the pools of each thread
+/// (see SimQueueStructInitPool). Each copy of the dequeuers' state reserves space for nthreads * max_batch return
+/// values, so max_batch should be kept moderate (i.e., up to a few hundreds).
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+/// @param nthreads The number of threads that will use the SimQueue concurrent queue implementation.
+/// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
+/// @param max_batch The maximum number of elements that a thread enqueues or dequeues in a single round.
+/// @param pool_size The number of copies in each pool of each thread. Values lower than 2 are set to 2.
+void SimQueueStructInitBatch(SimQueueStruct *queue, uint32_t nthreads, int max_backoff, uint32_t max_batch, uint32_t pool_size);
+
+/// @brief This function enables the dynamic registration of threads for an instance of SimQueue.
+/// After this call, each thread should get its pid by calling SimQueueRegisterThread and it should release it by calling
+/// SimQueueDeregisterThread. The combiners scan only the cells of the toggle vectors that ever contained a registered pid.
+/// It should be called after SimQueueStructInit and before any thread applies any operation.
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+void SimQueueStructSetDynamicThreads(SimQueueStruct *queue);
+
+/// @brief This function registers the calling thread to an instance of SimQueue (see SimQueueStructSetDynamicThreads)
+/// and initializes its local state. There is no need to call SimQueueThreadStateInit.
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimQueue.
+/// @return The pid that the thread should use for this instance of SimQueue, or -1 in case that all pids are in use.
+int SimQueueRegisterThread(SimQueueStruct *queue, SimQueueThreadState *th_state);
+
+/// @brief This function deregisters the calling thread from an instance of SimQueue.
+/// The pool of nodes of the thread is not released, since its nodes may still be part of the queue.
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimQueue.
+/// @param pid The pid returned by SimQueueRegisterThread.
+void SimQueueDeregisterThread(SimQueueStruct *queue, SimQueueThreadState *th_state, int pid);
+
 /// @brief This function should be called once before the thread applies any operation to the SimQueue concurrent queue implementation.
 ///
 /// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
@@ -134,4 +220,48 @@ void SimQueueEnqueue(SimQueueStruct *queue, SimQueueThreadState *th_state, ArgVa
 /// @return The value of the removed element.
 RetVal SimQueueDequeue(SimQueueStruct *queue, SimQueueThreadState *th_state, int pid);
 
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits until an element is enqueued (see eventcount.h).
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimQueue.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal SimQueueDequeueBlocking(SimQueueStruct *queue, SimQueueThreadState *th_state, int pid);
+
+/// @brief This function removes (i.e. dequeues) an element from the front of the queue and returns its value.
+/// In case that the queue is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is enqueued.
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimQueue.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_QUEUE in case that the queue remains empty for timeout_ns nanoseconds.
+RetVal SimQueueDequeueTimed(SimQueueStruct *queue, SimQueueThreadState *th_state, uint64_t timeout_ns, int pid);
+
+/// @brief This function adds (i.e. enqueues) n new elements to the back of the queue, in the order they are given.
+/// The nodes of the elements are allocated and linked by the calling thread before it announces them; in case that the
+/// calling thread applies its own request, the combiner splices the whole chain to the queue in one step. Batches
+/// larger than max_batch (see SimQueueStructInitBatch) are split into rounds of at most max_batch elements, and the
+/// elements of each round are enqueued atomically.
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimQueue.
+/// @param values An array with the values of the n elements.
+/// @param n The number of elements.
+/// @param pid The pid of the calling thread.
+void SimQueueEnqueueBatch(SimQueueStruct *queue, SimQueueThreadState *th_state, ArgVal *values, uint32_t n, int pid);
+
+/// @brief This function removes (i.e. dequeues) up to max elements from the front of the queue and stores their values to out.
+/// Requests larger than max_batch (see SimQueueStructInitBatch) are split into rounds of at most max_batch elements;
+/// the elements of each round are detached from the queue atomically.
+///
+/// @param queue A pointer to an instance of the SimQueue concurrent queue implementation.
+/// @param th_state A pointer to thread's local state of SimQueue.
+/// @param out An array of at least max entries, where the values of the removed elements are stored.
+/// @param max The maximum number of elements to remove.
+/// @param pid The pid of the calling thread.
+/// @return The number of the removed elements; it is lower than max only in case that the queue became empty.
+uint32_t SimQueueDequeueBatch(SimQueueStruct *queue, SimQueueThreadState *th_state, RetVal *out, uint32_t max, int pid);
+
 #endif
@@ -0,0 +1,190 @@
+/// @file simshard.h
+/// @author Nikolaos D. Kallimanis (nkallima@gmail.com)
+/// @brief This file exposes the API of SimShard, a sharded version of the P-Sim (or Sim) universal construction.
+/// An example of use of this API is provided in benchmarks/simshardbench.c file.
+///
+/// SimShard simulates a large number of small and independent objects (shards), e.g. the counters of a partitioned
+/// counter or the buckets of a map, behind a single announce array. Each thread announces a pair (shard, argument)
+/// and the combiner copies and applies only the shards that are touched by the requests of its round.
+/// The states of the shards are stored in the leaves of a radix tree of fixed-size blocks; each copy of the object's
+/// state (see SimShardRecord) stores just the index of the root of a tree and each attempt copies only the blocks on
+/// the paths from the root to the touched leaves (path copying). Thus, the memory and the copying cost of SimShard
+/// grow with the number of shards plus the number of threads (and not with their product, as it would happen by
+/// using one instance of Sim per shard or a single instance of Sim with a large state).
+///
+/// The blocks that are replaced by a successful attempt are recycled by the thread that performed it; a combiner that
+/// reads a recycled block always fails to validate its copy, so it never applies a request on an inconsistent state.
+///
+/// For a more detailed description of Sim see the original publication:
+/// Panagiota Fatourou, and Nikolaos D. Kallimanis. "A highly-efficient wait-free universal construction".
+/// Proceedings of the twenty-third annual ACM symposium on Parallelism in algorithms and architectures (SPAA), 2011.
+/// @copyright Copyright (c) 2021
+#ifndef _SIMSHARD_H_
+#define _SIMSHARD_H_
+
+#include <config.h>
+#include <stdint.h>
+#include <primitives.h>
+#include <tvec.h>
+#include <sim.h>
+
+/// @brief The logarithm of the number of children of each inner node of the radix tree.
+#define SIM_SHARD_FANOUT_BITS  4
+
+/// @brief The number of children of each inner node of the radix tree; an inner node fills a single cache line.
+#define SIM_SHARD_FANOUT       (1 << SIM_SHARD_FANOUT_BITS)
+
+/// @brief An invalid index of a block, it is used for terminating the lists of free blocks.
+#define SIM_SHARD_NULL_BLOCK   (~((uint32_t)0))
+
+/// @brief This struct stores the metadata for a copy of the state of a SimShard object.
+/// The applied vector of toggles and the list of return values are stored in the same memory area directly after this struct.
+typedef struct SimShardRecord {
+    /// @brief The index of the block that is the root of the radix tree of this copy.
+    uint32_t root;
+    /// @brief The number of entries in the list of return values.
+    uint32_t ret_size;
+    /// @brief A pointer to the list of return values of the requests applied by the attempt that produced this copy.
+    SimRoundRet *ret;
+    /// @brief The applied vector of toggles.
+    ToggleVector applied;
+#ifdef DEBUG
+    int64_t counter;
+    int rounds;
+#endif
+} SimShardRecord;
+
+/// @brief SimShardAnnounce stores the request that a thread has announced.
+typedef struct SimShardAnnounce {
+    /// @brief The sequence number of the request.
+    volatile uint64_t seq;
+    /// @brief The argument of the request.
+    volatile ArgVal arg;
+    /// @brief The shard on which the request is applied.
+    volatile uint32_t shard;
+} SimShardAnnounce;
+
+/// @brief SimShardRequest stores a request that is collected by a combiner, together with the private copy of the
+/// state of the shard that the request is applied on.
+typedef struct SimShardRequest {
+    uint32_t pid;
+    uint64_t seq;
+    ArgVal arg;
+    void *state;
+} SimShardRequest;
+
+/// @brief SimShardThreadState stores each thread's local state for a single instance of SimShard.
+/// For each instance of SimShard, a discrete instance of SimShardThreadState should be used.
+typedef struct SimShardThreadState {
+    ToggleVector mask;
+    ToggleVector toggle;
+    ToggleVector my_bit;
+    ToggleVector diffs;
+    ToggleVector l_toggles;
+    /// @brief The next available free copy of object's state.
+    int local_index;
+    /// @brief Current backoff value.
+    int backoff;
+    /// @brief The sequence number of the last request announced by the thread.
+    uint64_t seq;
+    /// @brief A tag that is unique for each attempt of the thread; the blocks copied by an attempt are tagged with it.
+    uint64_t tag;
+    /// @brief The head of the list of free blocks owned by the thread.
+    uint32_t free_head;
+    /// @brief The number of blocks copied by the current attempt.
+    uint32_t copied;
+    /// @brief The blocks allocated by the current attempt.
+    uint32_t *fresh;
+    /// @brief The blocks that are replaced by the blocks of fresh, in case that the current attempt succeeds.
+    uint32_t *replaced;
+    /// @brief The requests collected by the current attempt.
+    SimShardRequest *requests;
+} SimShardThreadState;
+
+/// @brief SimShardStruct stores the state of an instance of the SimShard combining object.
+/// SimShardStruct should be initialized using the synchSimShardStructInit function.
+typedef struct SimShardStruct {
+    /// @brief Pointer to a SimShardRecord struct that contains the most recent and valid copy of the object's state.
+    volatile pointer_t sp;
+
+    /// @brief Toggle bits.
+    ToggleVector a_toggles CACHE_ALIGN;
+    /// @brief An array of pools (one pool per thread) of SimShardRecord structs.
+    SimShardRecord **volatile pool;
+    /// @brief Pointer to an array, where threads announce the requests that want to perform to the object.
+    SimShardAnnounce *announce;
+    /// @brief Pointer to an array of result slots, where the return values of the applied requests are published.
+    SimRetSlot *ret_slots;
+    /// @brief The memory area that stores the blocks of the radix trees.
+    void *blocks;
+    /// @brief An array that stores for each block the tag of the attempt that allocated it.
+    volatile uint64_t *block_tag;
+
+    /// @brief The maximum number of threads that use this instance of SimShard.
+    uint32_t nthreads;
+    /// @brief The number of SimShardRecord structs in the pool of each thread.
+    uint32_t pool_size;
+    /// @brief The number of result slots that each thread owns.
+    uint32_t ret_stride;
+    /// @brief The number of shards.
+    uint32_t nshards;
+    /// @brief The distance (in bytes) between the states of two consecutive shards in a leaf.
+    uint32_t shard_stride;
+    /// @brief The number of shards stored in each leaf of the radix tree.
+    uint32_t shards_per_block;
+    /// @brief The size (in bytes) of each block, i.e. either of a leaf or of an inner node of the radix tree.
+    uint32_t block_size;
+    /// @brief The total number of blocks.
+    uint32_t nblocks;
+    /// @brief The number of blocks that each thread owns for copying the paths touched by its attempts.
+    uint32_t blocks_per_thread;
+    /// @brief The number of levels of inner nodes of the radix tree.
+    uint32_t depth;
+    /// @brief The total size (in bytes) of each SimShardRecord, including the applied vector of toggles and the list of return values.
+    uint32_t record_size;
+    /// @brief The maximum backoff value.
+    int MAX_BACK;
+} SimShardStruct;
+
+/// @brief This function initializes an instance of SimShard.
+///
+/// This function should be called once (by a single thread) before any other thread tries to
+/// apply any request by using the SimShardApplyOp function.
+///
+/// @param shard_struct A pointer to an instance of SimShard.
+/// @param nthreads The number of threads that will use SimShard.
+/// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
+/// @param nshards The number of shards.
+/// @param shard_size The size (in bytes) of the state of each shard.
+/// @param shard_init A function that initializes the state of a shard; its second argument is the number of the shard.
+/// In case that shard_init is NULL, the initial states are filled with zeros.
+void synchSimShardStructInit(SimShardStruct *shard_struct, uint32_t nthreads, int max_backoff, uint32_t nshards, uint32_t shard_size, void (*shard_init)(void *, uint32_t));
+
+/// @brief This function should be called once (for each pid) before the thread applies any operation to SimShard.
+/// Each pid owns a discrete set of blocks, thus this function should not be called twice for the same pid.
+///
+/// @param shard_struct A pointer to an instance of SimShard.
+/// @param th_state A pointer to thread's local state of SimShard.
+/// @param pid The pid of the calling thread.
+void SimShardThreadStateInit(SimShardStruct *shard_struct, SimShardThreadState *th_state, int pid);
+
+/// @brief This function applies a request on a shard of the SimShard object.
+///
+/// @param shard_struct A pointer to an instance of SimShard.
+/// @param th_state A pointer to thread's local state of SimShard.
+/// @param sfunc A serial function that is applied on the state of the shard.
+/// @param shard The shard on which the request is applied; it should be lower than the number of shards.
+/// @param arg The argument of the request.
+/// @param pid The pid of the calling thread.
+/// @return The return value of the applied request.
+RetVal SimShardApplyOp(SimShardStruct *shard_struct, SimShardThreadState *th_state, RetVal (*sfunc)(void *, ArgVal, int), uint32_t shard, ArgVal arg, int pid);
+
+/// @brief This function returns a pointer to the state of a shard in the most recent copy of the object's state.
+/// It is intended for inspecting the object while no thread applies requests on it (e.g. after the threads have joined).
+///
+/// @param shard_struct A pointer to an instance of SimShard.
+/// @param shard The number of the shard.
+/// @return A pointer to the state of the shard.
+void *SimShardGetState(SimShardStruct *shard_struct, uint32_t shard);
+
+#endif
@@ -15,12 +15,15 @@
 #include <primitives.h>
 #include <pool.h>
 #include <queue-stack.h>
+#include <eventcount.h>
 
 /// @brief This struct is  used for padding the SimStackState struct appropriately.
 typedef struct HalfSimStackState {
     ToggleVector applied;
-    Object *ret;
+    SimRoundRet *ret;
+    uint32_t ret_size;
     Node *head;
+    uint64_t eliminated;
 #ifdef DEBUG
     int counter;
 #endif
@@ -31,10 +34,14 @@ typedef struct HalfSimStackState {
 typedef struct SimStackState {
     /// @brief The applied vector of toggles.
     ToggleVector applied;
-    /// @brief A pointer to the array of return values.
-    Object *ret;
+    /// @brief A pointer to the list of return values of the pop operations applied by the attempt that produced this copy.
+    SimRoundRet *ret;
+    /// @brief The number of entries in the list of return values.
+    uint32_t ret_size;
     /// @brief A pointer to the head node of the stack.
     Node *head;
+    /// @brief The number of push/pop pairs that are eliminated, i.e. that are applied without allocating any node.
+    uint64_t eliminated;
 #ifdef DEBUG
     int counter;
 #endif
@@ -44,7 +51,9 @@ typedef struct SimStackState {
 } SimStackState;
 
 /// @brief A macro for calculating the size of the SimStackState struct for a specific amount of threads.
-#define SimStackStateSize(nthreads) (sizeof(SimStackState) + _TVEC_VECTOR_SIZE(nthreads) + nthreads * sizeof(Object))
+/// This is the part of SimStackState that is copied on each attempt; the list of return values is stored
+/// after it and only its used entries are copied.
+#define SimStackStateSize(nthreads) (sizeof(SimStackState) + _TVEC_VECTOR_SIZE(nthreads))
 
 /// @brief SimStackThreadState stores each thread's local state for a single instance of SimStack.
 /// For each instance of SimStack, a discrete instance of SimStackThreadState should be used.
@@ -57,10 +66,14 @@ typedef struct SimStackThreadState {
     ToggleVector diffs;
     ToggleVector l_toggles;
     ToggleVector pops;
+    /// @brief The values of the push operations collected by the current attempt; the pops of the same attempt are served by them first.
+    ArgVal *pushes;
     /// @brief The next available free copy of SimStackState that could be used while applying push and/or pop operations.
     int local_index;
     /// @brief The maximum backoff value.
     int backoff;
+    /// @brief The sequence number of the last operation announced by the thread.
+    uint64_t seq;
 } SimStackThreadState;
 
 /// @brief SimStackStruct stores the state of an instance of the SimStack.
@@ -68,10 +81,27 @@ typedef struct SimStackThreadState {
 typedef struct SimStackStruct {
     /// @brief Pointer to an array, where threads announce only the requests that want to perform to the object.
     ArgVal *announce;
+    /// @brief Pointer to an array, where each thread announces the sequence number of its current operation.
+    volatile uint64_t *announce_seq;
+    /// @brief Pointer to an array of result slots, where the return values of the applied pop operations are published.
+    /// Each thread owns ret_stride consecutive (cache line padded) entries of this array.
+    SimRetSlot *ret_slots;
+    /// @brief The number of result slots that each thread owns.
+    uint32_t ret_stride;
+    /// @brief The registry of the pids of the threads that use this instance of SimStack.
+    SimRegistry registry;
+    /// @brief Pointer to an array, where a deregistered thread saves the next available free copy of its pool.
+    int *saved_index;
     /// @brief An array of pools (one pool per thread) of SimStackState structs.
     SimStackState **pool;
-    /// @brief The number of threads that use this instance of SimStack.
+    /// @brief Pointer to an array that stores the NUMA node where the pool of each thread is currently placed.
+    int32_t *pool_node;
+    /// @brief The maximum number of threads that use this instance of SimStack.
     uint32_t nthreads;
+    /// @brief The number of SimStackState structs in the pool of each thread.
+    uint32_t pool_size;
+    /// @brief The size (in bytes) of each SimStackState struct, including the list of return values.
+    uint32_t record_size;
     /// @brief The maximum backoff value.
     int MAX_BACK;
     /// @brief A pointer to the head node of the stack.
@@ -80,6 +110,8 @@ typedef struct SimStackStruct {
     volatile pointer_t sp CACHE_ALIGN;
     /// @brief A vector of toggle bits used to detect which announced operations are applied or not.
     volatile ToggleVector a_toggles CACHE_ALIGN;
+    /// @brief An eventcount, on which the blocking and timed pop operations wait while the stack is empty.
+    SynchEventCount nonempty CACHE_ALIGN;
 } SimStackStruct;
 
 /// @brief This function initializes an instance of the SimStack concurrent stack implementation.
@@ -92,6 +124,41 @@ typedef struct SimStackStruct {
 /// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
 void SimStackStructInit(SimStackStruct *stack, uint32_t nthreads, int max_backoff);
 
+/// @brief This function initializes an instance of the SimStack concurrent stack implementation, exactly as SimStackStructInit does,
+/// but it also sets the number of copies of the stack's state that each thread maintains in its pool.
+/// The pool of each thread is allocated on the NUMA node of the thread and it is migrated to the NUMA node of
+/// any thread that later registers to the same pid by using SimStackRegisterThread.
+///
+/// @param stack A pointer to an instance of the SimStack concurrent stack implementation.
+/// @param nthreads The number of threads that will use the SimStack concurrent stack implementation.
+/// @param max_backoff The maximum value for backoff (usually this is much lower than 100).
+/// @param pool_size The number of copies of the stack's state in the pool of each thread. Values lower than 2 are set to 2.
+void SimStackStructInitPool(SimStackStruct *stack, uint32_t nthreads, int max_backoff, uint32_t pool_size);
+
+/// @brief This function enables the dynamic registration of threads for an instance of SimStack.
+/// After this call, each thread should get its pid by calling SimStackRegisterThread and it should release it by calling
+/// SimStackDeregisterThread. The combiners scan only the cells of the toggle vectors that ever contained a registered pid.
+/// It should be called after SimStackStructInit and before any thread applies any operation.
+///
+/// @param stack A pointer to an instance of the SimStack concurrent stack implementation.
+void SimStackStructSetDynamicThreads(SimStackStruct *stack);
+
+/// @brief This function registers the calling thread to an instance of SimStack (see SimStackStructSetDynamicThreads)
+/// and initializes its local state. There is no need to call SimStackThreadStateInit.
+///
+/// @param stack A pointer to an instance of the SimStack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of SimStack.
+/// @return The pid that the thread should use for this instance of SimStack, or -1 in case that all pids are in use.
+int SimStackRegisterThread(SimStackStruct *stack, SimStackThreadState *th_state);
+
+/// @brief This function deregisters the calling thread from an instance of SimStack.
+/// The pool of nodes of the thread is not released, since its nodes may still be part of the stack.
+///
+/// @param stack A pointer to an instance of the SimStack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of SimStack.
+/// @param pid The pid returned by SimStackRegisterThread.
+void SimStackDeregisterThread(SimStackStruct *stack, SimStackThreadState *th_state, int pid);
+
 /// @brief This function should be called once before the thread applies any operation to the SimStack concurrent stack implementation.
 ///
 /// @param th_state A pointer to thread's local state of SimStack.
@@ -116,4 +183,23 @@ void SimStackPush(SimStackStruct *stack, SimStackThreadState *th_state, ArgVal a
 /// @return The value of the removed element.
 RetVal SimStackPop(SimStackStruct *stack, SimStackThreadState *th_state, int pid);
 
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+/// In case that the stack is empty, the calling thread waits until an element is pushed (see eventcount.h).
+///
+/// @param stack A pointer to an instance of the SimStack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of SimStack.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element.
+RetVal SimStackPopBlocking(SimStackStruct *stack, SimStackThreadState *th_state, int pid);
+
+/// @brief This function removes (i.e. pops) an element from the top of the stack and returns its value.
+/// In case that the stack is empty, the calling thread waits for at most timeout_ns nanoseconds until an element is pushed.
+///
+/// @param stack A pointer to an instance of the SimStack concurrent stack implementation.
+/// @param th_state A pointer to thread's local state of SimStack.
+/// @param timeout_ns The maximum time in nanoseconds that the calling thread waits for an element.
+/// @param pid The pid of the calling thread.
+/// @return The value of the removed element, or EMPTY_STACK in case that the stack remains empty for timeout_ns nanoseconds.
+RetVal SimStackPopTimed(SimStackStruct *stack, SimStackThreadState *th_state, uint64_t timeout_ns, int pid);
+
 #endif
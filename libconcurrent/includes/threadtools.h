@@ -130,4 +130,9 @@ inline void synchResched(void);
 /// system's available processing cores; otherwise, this function returns false.
 inline bool synchIsSystemOversubscribed(void);
 
+/// @brief This function returns true if the threads have been spawned as fibers (i.e. synchStartThreadsN has been
+/// called with more than one fiber per posix thread); otherwise, this function returns false. A fiber should never
+/// block its posix thread in the kernel, since the other fibers of the posix thread could not run meanwhile.
+inline bool synchIsFiberScheduled(void);
+
 #endif
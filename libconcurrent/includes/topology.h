@@ -0,0 +1,83 @@
+/// @file topology.h
+/// @brief This file exposes an API for detecting the cache and NUMA topology of the machine. The topology is described
+/// as a hierarchy of levels, from the finest level (e.g. the processing elements that share an SMT core) to the coarsest
+/// one (e.g. the processing elements of a socket); the whole machine is implied above the coarsest level. Each level
+/// partitions the processing elements of the machine into domains and the domains of each level are nested into the
+/// domains of the next (coarser) level. The topology is used by the hierarchical combining objects (see mhsynch.h).
+#ifndef _TOPOLOGY_H_
+#define _TOPOLOGY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <config.h>
+
+/// @brief The maximum number of levels of a topology.
+#define SYNCH_TOPOLOGY_MAX_LEVELS 8
+
+/// @brief SynchTopology describes the hierarchy of domains of the processing elements.
+/// SynchTopology should be initialized using either synchTopologyInit or synchTopologyInitUniform.
+typedef struct SynchTopology {
+    /// @brief The number of processing elements.
+    uint32_t ncpus;
+    /// @brief The number of levels (the whole machine is not considered as a level).
+    uint32_t nlevels;
+    /// @brief The number of domains of each level, from the finest to the coarsest level.
+    uint32_t ndomains[SYNCH_TOPOLOGY_MAX_LEVELS];
+    /// @brief The name of each level (e.g. "smt", "l3" or "numa").
+    const char *names[SYNCH_TOPOLOGY_MAX_LEVELS];
+    /// @brief The domain of each processing element for each level; the domain of the processing element cpu
+    /// at level i is stored in domains[i * ncpus + cpu].
+    uint32_t *domains;
+    /// @brief It is true in case that the topology has been detected from the machine (see synchTopologyInit).
+    bool detected;
+} SynchTopology;
+
+/// @brief This function detects the topology of the machine by reading the sysfs entries of the processing elements
+/// (i.e. SMT cores, L2 and L3 caches, dies and packages) and the NUMA nodes (in case that the SYNCH_NUMA_SUPPORT
+/// option of config.h is enabled). Levels that are not nested into coarser levels are refined, levels that are
+/// identical to a coarser level are omitted, and levels where each domain contains a single processing element or a
+/// single domain contains the whole machine are also omitted. In case that sysfs is not available, the topology has
+/// no levels.
+///
+/// @param topology A pointer to the topology.
+void synchTopologyInit(SynchTopology *topology);
+
+/// @brief This function initializes a uniform topology, which does not necessarily describe the machine.
+/// For example, synchTopologyInitUniform(t, 16, 2, (uint32_t[]){2, 8}) creates a topology of 16 processing elements,
+/// where the domains of the first level contain 2 processing elements and the domains of the second level contain 8.
+///
+/// @param topology A pointer to the topology.
+/// @param ncpus The number of processing elements.
+/// @param nlevels The number of levels; at most SYNCH_TOPOLOGY_MAX_LEVELS.
+/// @param sizes The number of processing elements of each domain of each level, from the finest to the coarsest level.
+/// The size of each level should be greater than the size of the previous one.
+void synchTopologyInitUniform(SynchTopology *topology, uint32_t ncpus, uint32_t nlevels, const uint32_t *sizes);
+
+/// @brief This function copies the topology src to dst; dst does not share any memory with src.
+///
+/// @param dst A pointer to the destination topology.
+/// @param src A pointer to the source topology.
+void synchTopologyCopy(SynchTopology *dst, const SynchTopology *src);
+
+/// @brief This function releases the memory allocated for a topology.
+///
+/// @param topology A pointer to the topology.
+void synchTopologyDestroy(SynchTopology *topology);
+
+/// @brief This function prints the levels of a topology to the standard error.
+///
+/// @param topology A pointer to the topology.
+void synchTopologyPrint(const SynchTopology *topology);
+
+/// @brief This function returns the domain of a processing element at a level of the topology.
+///
+/// @param topology A pointer to the topology.
+/// @param level The level; it should be less than topology->nlevels.
+/// @param cpu The processing element; it should be less than topology->ncpus.
+/// @return The domain of the processing element, i.e. an integer in {0, ..., topology->ndomains[level] - 1}.
+static inline uint32_t synchTopologyDomainOf(const SynchTopology *topology, uint32_t level, uint32_t cpu) {
+    return topology->domains[level * topology->ncpus + cpu];
+}
+
+#endif
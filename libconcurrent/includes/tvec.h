@@ -14,12 +14,57 @@
 #    define _TVEC_VECTOR_SIZE(N) (_TVEC_CELLS_(N) * sizeof(bitword_t))
 #    define LOOP(EXPR, I, TIMES) {for (I = 0; I < TIMES; I++) {EXPR;}}
 
+/// @brief Vectors of at least this number of cells are handled by the SIMD kernels of synchTVecKernels,
+/// while shorter vectors are handled by inlined scalar loops (the cost of an indirect call is not amortized).
+#    ifndef _TVEC_SIMD_CELLS_
+#        define _TVEC_SIMD_CELLS_ 8
+#    endif
+
+/// @brief Plain 64-bit scalar kernels.
+#    define TVEC_KERNELS_SCALAR 0
+/// @brief AVX2 kernels (x86_64).
+#    define TVEC_KERNELS_AVX2   1
+/// @brief AVX-512 kernels (x86_64), the population count needs the AVX512_VPOPCNTDQ extension.
+#    define TVEC_KERNELS_AVX512 2
+/// @brief NEON kernels (aarch64).
+#    define TVEC_KERNELS_NEON   3
+
 typedef struct ToggleVector {
     uint32_t nthreads;
     uint32_t tvec_cells;
     bitword_t *cell;
 } ToggleVector;
 
+/// @brief TVecKernels stores the set of kernels that perform the operations on whole (long) vectors of bits.
+/// At startup, the best set of kernels that is supported by the running processor is selected.
+typedef struct TVecKernels {
+    int kernels;
+    void (*xor_cells)(bitword_t *res, const bitword_t *tv1, const bitword_t *tv2, uint32_t cells);
+    void (*and_cells)(bitword_t *res, const bitword_t *tv1, const bitword_t *tv2, uint32_t cells);
+    void (*or_cells)(bitword_t *res, const bitword_t *tv1, const bitword_t *tv2, uint32_t cells);
+    void (*copy_cells)(bitword_t *dest, const bitword_t *src, uint32_t cells);
+    int (*count_bits)(const bitword_t *tv, uint32_t cells);
+} TVecKernels;
+
+extern TVecKernels synchTVecKernels;
+
+/// @brief This function returns true in case that the given set of kernels (i.e. TVEC_KERNELS_SCALAR, TVEC_KERNELS_AVX2,
+/// TVEC_KERNELS_AVX512 or TVEC_KERNELS_NEON) is supported by both the compiler and the running processor.
+bool synchTVecKernelsSupported(int kernels);
+
+/// @brief This function selects the set of kernels used by the operations on whole vectors of bits.
+/// It should be called before any thread uses a ToggleVector, since the selection is not atomic.
+///
+/// @param kernels One of TVEC_KERNELS_SCALAR, TVEC_KERNELS_AVX2, TVEC_KERNELS_AVX512 or TVEC_KERNELS_NEON.
+/// @return false in case that the given set of kernels is not supported; the current selection is kept.
+bool synchTVecSetKernels(int kernels);
+
+/// @brief This function returns the set of kernels that is currently used.
+int synchTVecGetKernels(void);
+
+/// @brief This function returns a printable name for a set of kernels.
+const char *synchTVecKernelsName(int kernels);
+
 // Operations that handle banks of bits and not the whole vectors
 // --------------------------------------------------------------
 
@@ -75,14 +120,26 @@ static inline void TVEC_INIT_AT(ToggleVector *tv1, uint32_t nthreads, void *ptr)
     LOOP(tv1->cell[i] = 0L, i, tv1->tvec_cells);
 }
 
+static inline void TVEC_DESTROY(ToggleVector *tv1) {
+    synchFreeMemory(tv1->cell, _TVEC_VECTOR_SIZE(tv1->nthreads));
+    tv1->cell = NULL;
+}
+
 static inline void TVEC_SET_ZERO(ToggleVector *tv1) {
     int i;
 
     LOOP(tv1->cell[i] = 0L, i, tv1->tvec_cells);
 }
 
+static inline void TVEC_COPY_CELLS(ToggleVector *dest, ToggleVector *src, uint32_t cells) {
+    if (cells >= _TVEC_SIMD_CELLS_)
+        synchTVecKernels.copy_cells(dest->cell, src->cell, cells);
+    else
+        memcpy(dest->cell, src->cell, cells * sizeof(bitword_t));
+}
+
 static inline void TVEC_COPY(ToggleVector *dest, ToggleVector *src) {
-    memcpy(dest->cell, src->cell, _TVEC_VECTOR_SIZE(dest->nthreads));
+    TVEC_COPY_CELLS(dest, src, dest->tvec_cells);
 }
 
 static inline void TVEC_NEGATIVE(ToggleVector *res, ToggleVector *tv) {
@@ -121,24 +178,39 @@ static inline bool TVEC_IS_SET(ToggleVector *tv1, int pid) {
 static inline void TVEC_OR(ToggleVector *res, ToggleVector *tv1, ToggleVector *tv2) {
     int i;
 
-    LOOP(res->cell[i] = tv1->cell[i] | tv2->cell[i], i, res->tvec_cells);
+    if (res->tvec_cells >= _TVEC_SIMD_CELLS_)
+        synchTVecKernels.or_cells(res->cell, tv1->cell, tv2->cell, res->tvec_cells);
+    else
+        LOOP(res->cell[i] = tv1->cell[i] | tv2->cell[i], i, res->tvec_cells);
 }
 
 static inline void TVEC_AND(ToggleVector *res, ToggleVector *tv1, ToggleVector *tv2) {
     int i;
 
-    LOOP(res->cell[i] = tv1->cell[i] & tv2->cell[i], i, res->tvec_cells);
+    if (res->tvec_cells >= _TVEC_SIMD_CELLS_)
+        synchTVecKernels.and_cells(res->cell, tv1->cell, tv2->cell, res->tvec_cells);
+    else
+        LOOP(res->cell[i] = tv1->cell[i] & tv2->cell[i], i, res->tvec_cells);
 }
 
-static inline void TVEC_XOR(ToggleVector *res, ToggleVector *tv1, ToggleVector *tv2) {
+static inline void TVEC_XOR_CELLS(ToggleVector *res, ToggleVector *tv1, ToggleVector *tv2, uint32_t cells) {
     int i;
 
-    LOOP(res->cell[i] = tv1->cell[i] ^ tv2->cell[i], i, res->tvec_cells);
+    if (cells >= _TVEC_SIMD_CELLS_)
+        synchTVecKernels.xor_cells(res->cell, tv1->cell, tv2->cell, cells);
+    else
+        LOOP(res->cell[i] = tv1->cell[i] ^ tv2->cell[i], i, cells);
+}
+
+static inline void TVEC_XOR(ToggleVector *res, ToggleVector *tv1, ToggleVector *tv2) {
+    TVEC_XOR_CELLS(res, tv1, tv2, res->tvec_cells);
 }
 
 static inline int TVEC_COUNT_BITS(ToggleVector *tv) {
     int i, count;
 
+    if (tv->tvec_cells >= _TVEC_SIMD_CELLS_)
+        return synchTVecKernels.count_bits(tv->cell, tv->tvec_cells);
     count = 0;
     LOOP(count += synchNonZeroBits(tv->cell[i]), i, tv->tvec_cells);
 
@@ -0,0 +1,41 @@
+#include <async.h>
+#include <park.h>
+#include <threadtools.h>
+
+bool synchTicketPoll(SynchTicket *ticket, RetVal *ret) {
+    if (!ticket->done && ticket->poll(ticket))
+        ticket->done = true;
+    if (ticket->done && ret != NULL)
+        *ret = ticket->ret;
+    return ticket->done;
+}
+
+RetVal synchTicketWait(SynchTicket *ticket) {
+    RetVal ret;
+
+    while (!synchTicketPoll(ticket, &ret))
+        synchParkWait(ticket->locked); // spinning, then parking
+
+    return ret;
+}
+
+void synchTicketWaitAll(SynchTicket *tickets, uint32_t n, RetVal *rets) {
+    uint32_t i, pending, last = 0;
+
+    do {
+        pending = 0;
+        for (i = 0; i < n; i++) {
+            if (!synchTicketPoll(&tickets[i], &rets[i])) {
+                pending++;
+                last = i;
+            }
+        }
+        if (pending == 1) {
+            // The calling thread could not be the combiner of another object, thus it is safe to park
+            rets[last] = synchTicketWait(&tickets[last]);
+            pending = 0;
+        } else if (pending > 1) {
+            synchResched();
+        }
+    } while (pending > 0);
+}
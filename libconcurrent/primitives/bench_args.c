@@ -20,6 +20,9 @@ static void printHelp(const char *exec_name) {
             "-w,  --max_work   \t set the amount of workload (i.e. dummy loop iterations among two consecutive operations of the benchmarked object), default is 64\n"
             "-b,  --backoff, --backoff_high \t set an upper backoff bound\n"
             "-l,  --backoff_low\t set a lower backoff bound\n"
+            "-m,  --memory     \t report the resident memory of the process during the experiment (only for some benchmarks)\n"
+            "-p,  --producers  \t set the number of threads that only insert elements, while the rest of the threads only remove them (only for some benchmarks)\n"
+            "-c,  --combining_latency \t set the target length (in ns) of a combining round; the help bound of the combining objects is adapted to it (only for some benchmarks)\n"
             "\n"
             "-h, --help        \t displays this help and exits\n",
             exec_name);
@@ -36,6 +39,9 @@ void synchParseArguments(SynchBenchArgs *bench_args, int argc, char *argv[]) {
              {"backoff_low", required_argument, 0, 'l'},
              {"backoff_high", required_argument, 0, 'b'},
              {"numa_nodes", required_argument, 0, 'n'},
+             {"memory", no_argument, 0, 'm'},
+             {"producers", required_argument, 0, 'p'},
+             {"combining_latency", required_argument, 0, 'c'},
              {"help", no_argument, 0, 'h'},
              {0, 0, 0, 0}};
 
@@ -47,8 +53,11 @@ void synchParseArguments(SynchBenchArgs *bench_args, int argc, char *argv[]) {
     bench_args->backoff_high = 0;
     bench_args->backoff_low = 0;
     bench_args->numa_nodes = HSYNCH_DEFAULT_NUMA_POLICY;
+    bench_args->report_memory = false;
+    bench_args->producers = 0;
+    bench_args->combining_latency = 0;
 
-    while ((opt = getopt_long(argc, argv, "t:f:r:w:b:l:n:h", long_options, &long_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "t:f:r:w:b:l:n:mp:c:h", long_options, &long_index)) != -1) {
         switch (opt) {
         case 't':
             bench_args->nthreads = atoi(optarg);
@@ -71,6 +80,15 @@ void synchParseArguments(SynchBenchArgs *bench_args, int argc, char *argv[]) {
         case 'n':
             bench_args->numa_nodes = atoi(optarg);
             break;
+        case 'm':
+            bench_args->report_memory = true;
+            break;
+        case 'p':
+            bench_args->producers = atoi(optarg);
+            break;
+        case 'c':
+            bench_args->combining_latency = atol(optarg);
+            break;
         case 'h':
             printHelp(argv[0]);
             exit(EXIT_SUCCESS);
@@ -87,6 +105,10 @@ void synchParseArguments(SynchBenchArgs *bench_args, int argc, char *argv[]) {
     }
     // Set the correct number for total number of threads
     if (bench_args->fibers_per_thread != SYNCH_DONT_USE_UTHREADS) bench_args->nthreads *= bench_args->fibers_per_thread;
+    if (bench_args->producers >= bench_args->nthreads) {
+        fprintf(stderr, "ERROR: the number of producers should be lower than the number of threads\n");
+        exit(EXIT_FAILURE);
+    }
 
     bench_args->total_runs = bench_args->runs;
     bench_args->runs /= bench_args->nthreads;
@@ -0,0 +1,110 @@
+#include <string.h>
+
+#include <ebr.h>
+
+static void EBRReclaim(SynchEBRStruct *ebr, SynchEBRThreadState *th_state, SynchEBRLimbo *limbo);
+static void EBRTryAdvance(SynchEBRStruct *ebr);
+
+// A node of another thread is pushed to its return slot; since the owner removes all the nodes at once, the push does not suffer from ABA.
+static void EBRReclaim(SynchEBRStruct *ebr, SynchEBRThreadState *th_state, SynchEBRLimbo *limbo) {
+    uint32_t i;
+
+    for (i = 0; i < limbo->size; i++) {
+        void *obj = limbo->objs[i], *top;
+        SynchEBRReturnSlot *owner;
+
+        if (limbo->owners[i] == th_state->pid) {
+            synchRecycleObj(th_state->pool, obj);
+            continue;
+        }
+        owner = &ebr->returns[limbo->owners[i]];
+        do {
+            top = owner->returned;
+            *(void **)obj = top;
+        } while (!synchCASPTR(&owner->returned, top, obj));
+    }
+    th_state->reclaimed += limbo->size;
+    limbo->size = 0;
+}
+
+// The global epoch is advanced only in case that every active thread has announced it.
+static void EBRTryAdvance(SynchEBRStruct *ebr) {
+    uint64_t epoch = ebr->epoch;
+    uint32_t i;
+
+    for (i = 0; i < ebr->nthreads; i++) {
+        uint64_t announced = ebr->slots[i].epoch;
+
+        if (announced != SYNCH_EBR_INACTIVE && (announced >> 1) != epoch)
+            return;
+    }
+    synchCAS64(&ebr->epoch, epoch, epoch + 1);
+}
+
+void synchEBRInit(SynchEBRStruct *ebr, uint32_t nthreads) {
+    uint32_t i;
+
+    ebr->epoch = 1;
+    ebr->nthreads = nthreads;
+    ebr->slots = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(SynchEBRSlot));
+    ebr->returns = synchGetAlignedMemory(CACHE_LINE_SIZE, nthreads * sizeof(SynchEBRReturnSlot));
+    for (i = 0; i < nthreads; i++) {
+        ebr->slots[i].epoch = SYNCH_EBR_INACTIVE;
+        ebr->returns[i].returned = NULL;
+    }
+    synchFullFence();
+}
+
+void synchEBRThreadStateInit(SynchEBRStruct *ebr, SynchEBRThreadState *th_state, SynchPoolStruct *pool, int pid) {
+    int i;
+
+    th_state->slot = &ebr->slots[pid];
+    th_state->returned = &ebr->returns[pid];
+    th_state->pool = pool;
+    th_state->pid = pid;
+    for (i = 0; i < SYNCH_EBR_EPOCHS; i++) {
+        th_state->limbo[i].capacity = 2 * SYNCH_EBR_RETIRE_THRESHOLD;
+        th_state->limbo[i].objs = synchGetMemory(th_state->limbo[i].capacity * sizeof(void *));
+        th_state->limbo[i].owners = synchGetMemory(th_state->limbo[i].capacity * sizeof(int32_t));
+        th_state->limbo[i].size = 0;
+        th_state->limbo[i].epoch = 0;
+    }
+    th_state->retired = 0;
+    th_state->reclaimed = 0;
+}
+
+void synchEBRRetire(SynchEBRStruct *ebr, SynchEBRThreadState *th_state, void *obj, int32_t owner) {
+    uint64_t epoch = ebr->epoch;
+    SynchEBRLimbo *limbo = &th_state->limbo[epoch % SYNCH_EBR_EPOCHS];
+    int i;
+
+    if (limbo->epoch != epoch) {                                                        // the list stores nodes retired at least SYNCH_EBR_EPOCHS epochs ago
+        EBRReclaim(ebr, th_state, limbo);
+        limbo->epoch = epoch;
+    }
+    if (limbo->size == limbo->capacity) {                                               // some thread stays in the same epoch for long
+        void **objs = synchGetMemory(2 * limbo->capacity * sizeof(void *));
+        int32_t *owners = synchGetMemory(2 * limbo->capacity * sizeof(int32_t));
+
+        memcpy(objs, limbo->objs, limbo->size * sizeof(void *));
+        memcpy(owners, limbo->owners, limbo->size * sizeof(int32_t));
+        synchFreeMemory(limbo->objs, limbo->capacity * sizeof(void *));
+        synchFreeMemory(limbo->owners, limbo->capacity * sizeof(int32_t));
+        limbo->objs = objs;
+        limbo->owners = owners;
+        limbo->capacity *= 2;
+    }
+    limbo->objs[limbo->size] = obj;
+    limbo->owners[limbo->size++] = owner;
+
+    if (++th_state->retired >= SYNCH_EBR_RETIRE_THRESHOLD) {
+        th_state->retired = 0;
+        EBRTryAdvance(ebr);
+        epoch = ebr->epoch;
+        // the nodes retired at epoch e are not accessible by any thread after the global epoch reaches e + 2
+        for (i = 0; i < SYNCH_EBR_EPOCHS; i++) {
+            if (th_state->limbo[i].epoch + 2 <= epoch)
+                EBRReclaim(ebr, th_state, &th_state->limbo[i]);
+        }
+    }
+}
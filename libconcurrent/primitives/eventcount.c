@@ -0,0 +1,69 @@
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <limits.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <eventcount.h>
+#include <threadtools.h>
+
+static bool EventCountExpired(const struct timespec *deadline);
+
+static bool EventCountExpired(const struct timespec *deadline) {
+    struct timespec now;
+
+    if (deadline == NULL)
+        return false;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+void synchEventCountInit(SynchEventCount *ec) {
+    ec->key = 0;
+    ec->waiters = 0;
+    synchFullFence();
+}
+
+bool synchEventCountWait(SynchEventCount *ec, uint32_t key, const struct timespec *deadline) {
+    bool expired = false;
+    int i;
+
+    for (i = 0; i < SYNCH_EVENTCOUNT_SPINS && ec->key == key; i++)
+        synchResched();
+    while (ec->key == key) {
+        if (EventCountExpired(deadline)) {
+            expired = true;
+            break;
+        }
+        if (synchIsFiberScheduled()) {
+            synchResched();
+        } else {
+            // FUTEX_WAIT_BITSET takes an absolute timeout; it returns immediately in case that the key has changed
+            if (syscall(SYS_futex, &ec->key, FUTEX_WAIT_BITSET_PRIVATE, key, deadline, NULL, FUTEX_BITSET_MATCH_ANY) != 0 &&
+                errno == ETIMEDOUT) {
+                expired = true;
+                break;
+            }
+        }
+    }
+    synchFAA32(&ec->waiters, -1);
+
+    return !expired;
+}
+
+void synchEventCountWake(SynchEventCount *ec) {
+    synchFAA32(&ec->key, 1);
+    syscall(SYS_futex, &ec->key, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+void synchEventCountDeadline(struct timespec *deadline, uint64_t timeout_ns) {
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout_ns / 1000000000ULL;
+    deadline->tv_nsec += timeout_ns % 1000000000ULL;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
@@ -0,0 +1,66 @@
+#include <stdio.h>
+
+#include <helpbound.h>
+
+void synchHelpBoundInit(SynchHelpBound *hb, uint32_t bound) {
+    hb->fixed_bound = (bound > 0) ? bound : 1;
+    hb->bound = hb->fixed_bound;
+    hb->min_bound = hb->bound;
+    hb->max_bound = hb->bound;
+    hb->target_ns = 0;
+    hb->rounds = 0;
+    hb->requests = 0;
+    hb->over_target = 0;
+    hb->total_ns = 0;
+    hb->max_round_ns = 0;
+}
+
+void synchHelpBoundSetPolicy(SynchHelpBound *hb, uint64_t target_ns, uint32_t min_bound, uint32_t max_bound) {
+    uint32_t fixed = hb->fixed_bound;
+
+    if (target_ns == 0) {
+        synchHelpBoundInit(hb, fixed);
+        return;
+    }
+    if (min_bound == SYNCH_HELP_BOUND_DEFAULT)
+        min_bound = 1;
+    if (max_bound == SYNCH_HELP_BOUND_DEFAULT)
+        max_bound = SYNCH_HELP_BOUND_MAX_FACTOR * fixed;
+    if (max_bound < min_bound)
+        max_bound = min_bound;
+    hb->min_bound = min_bound;
+    hb->max_bound = max_bound;
+    if (fixed < min_bound)
+        hb->bound = min_bound;
+    else if (fixed > max_bound)
+        hb->bound = max_bound;
+    else
+        hb->bound = fixed;
+    hb->target_ns = target_ns;
+    synchFullFence();
+}
+
+void synchHelpBoundAdapt(SynchHelpBound *hb, uint64_t round_ns, uint32_t served) {
+    uint32_t bound = hb->bound;
+
+    hb->rounds++;
+    hb->requests += served;
+    hb->total_ns += round_ns;
+    if (round_ns > hb->max_round_ns)
+        hb->max_round_ns = round_ns;
+
+    if (round_ns > hb->target_ns) {
+        hb->over_target++;
+        bound -= (bound / 4 > 0) ? bound / 4 : 1;
+        hb->bound = (bound > hb->min_bound) ? bound : hb->min_bound;
+    } else if (served >= bound && round_ns < hb->target_ns / 2) {
+        bound += (bound / 8 > 0) ? bound / 8 : 1;
+        hb->bound = (bound < hb->max_bound) ? bound : hb->max_bound;
+    }
+}
+
+void synchPrintHelpStats(SynchHelpBound *stats) {
+    fprintf(stderr, "help bound: %u (min: %u, max: %u)\trounds: %lu\taverage round: %lu (ns)\tlongest round: %lu (ns)\trounds over target: %lu\n",
+            stats->bound, stats->min_bound, stats->max_bound, stats->rounds,
+            (stats->rounds != 0) ? stats->total_ns / stats->rounds : 0, stats->max_round_ns, stats->over_target);
+}
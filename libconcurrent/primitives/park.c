@@ -0,0 +1,42 @@
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <park.h>
+#include <threadtools.h>
+
+void synchParkWaitSlow(volatile uint32_t *locked) {
+#ifndef SYNCH_PARKING_DISABLE
+    if (!synchIsFiberScheduled() && synchIsSystemOversubscribed()) {
+        int i;
+
+        for (i = 0; i < SYNCH_PARK_SPINS && *locked != SYNCH_PARK_UNLOCKED; i++)
+            synchResched();
+        while (*locked != SYNCH_PARK_UNLOCKED) {
+            if (*locked == SYNCH_PARK_PARKED || synchCAS32(locked, SYNCH_PARK_LOCKED, SYNCH_PARK_PARKED))
+                synchParkSleep(locked);
+        }
+        return;
+    }
+#endif
+    // a fiber yields the CPU to the other fibers, while a thread that has a core of its own spins (see synchResched)
+    while (*locked != SYNCH_PARK_UNLOCKED)
+        synchResched();
+}
+
+void synchParkSleep(volatile uint32_t *word) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, SYNCH_PARK_PARKED, NULL, NULL, 0);
+}
+
+void synchParkWake(volatile uint32_t *locked) {
+    syscall(SYS_futex, locked, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+void synchParkWakeAll(SynchParkWakeList *wl) {
+    uint32_t i;
+
+    for (i = 0; i < wl->size; i++)
+        synchParkWake(wl->words[i]);
+    wl->size = 0;
+}
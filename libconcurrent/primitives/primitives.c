@@ -4,9 +4,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #ifdef SYNCH_NUMA_SUPPORT
 #    include <numa.h>
+#    include <numaif.h>
 #endif
 
 #define MAX_VENDOR_STR_SIZE 64
@@ -68,6 +70,15 @@ inline void *__SWAP(void *A, void *B) {
     return B;
 }
 
+inline uint32_t __SWAP32(volatile uint32_t *A, uint32_t B) {
+    asm volatile("lock;"
+                 "xchgl %0, %1"
+                 : "=r"(B), "=m"(*A)
+                 : "0"(B), "m"(*A)
+                 : "memory");
+    return B;
+}
+
 inline int64_t __FAA64(volatile int64_t *A, int64_t B) {
     asm volatile("lock;"
                  "xaddq %0, %1"
@@ -175,6 +186,44 @@ inline void *synchGetAlignedMemory(size_t align, size_t size) {
         return p;
 }
 
+inline void *synchGetMemoryOnNumaNode(size_t size, int32_t numa_node) {
+    void *p;
+
+#ifdef SYNCH_NUMA_SUPPORT
+    p = numa_alloc_onnode(size, numa_node);
+#else
+    p = (void *)memalign(sysconf(_SC_PAGESIZE), size);
+#endif
+
+    if (p == NULL) {
+        perror("memory allocation fail");
+        exit(EXIT_FAILURE);
+    } else
+        return p;
+}
+
+inline void synchMoveMemoryToNumaNode(void *ptr, size_t size, int32_t numa_node) {
+#ifdef SYNCH_NUMA_SUPPORT
+    long page_size = sysconf(_SC_PAGESIZE);
+    unsigned long i, count = (size + page_size - 1) / page_size;
+    void **pages = malloc(count * sizeof(void *));
+    int *nodes = malloc(count * sizeof(int));
+    int *status = malloc(count * sizeof(int));
+
+    numa_tonode_memory(ptr, size, numa_node);                   // pages that are not touched yet
+    if (pages != NULL && nodes != NULL && status != NULL) {
+        for (i = 0; i < count; i++) {
+            pages[i] = ptr + i * page_size;
+            nodes[i] = numa_node;
+        }
+        numa_move_pages(0, count, pages, nodes, status, MPOL_MF_MOVE);
+    }
+    free(pages);
+    free(nodes);
+    free(status);
+#endif
+}
+
 inline void synchFreeMemory(void *ptr, size_t size) {
 #ifdef SYNCH_NUMA_SUPPORT
     numa_free(ptr, size);
@@ -192,6 +241,28 @@ inline int64_t synchGetTimeMillis(void) {
     } else return tm.tv_sec*1000LL + tm.tv_nsec/1000000LL;
 }
 
+inline int64_t synchGetTimeNanos(void) {
+    struct timespec tm;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &tm) == -1) {
+        perror("clock_gettime");
+        return 0;
+    } else return tm.tv_sec*1000000000LL + tm.tv_nsec;
+}
+
+int64_t synchGetResidentMemory(void) {
+    FILE *statm = fopen("/proc/self/statm", "r");
+    long size, resident;
+
+    if (statm == NULL)
+        return -1;
+    if (fscanf(statm, "%ld %ld", &size, &resident) != 2)
+        resident = -1;
+    fclose(statm);
+
+    return resident < 0 ? -1 : (int64_t)resident * sysconf(_SC_PAGESIZE);
+}
+
 inline uint64_t synchGetMachineModel(void) {
     if (__machine_model != UNINITIALIZED_MACHINE_MODEL)
         return __machine_model;
@@ -294,6 +365,28 @@ inline void *_SWAP(void *A, void *B) {
 #endif
 }
 
+inline uint32_t _SWAP32(volatile uint32_t *A, uint32_t B) {
+#if defined(SYNCH_EMULATE_SWAP)
+    uint32_t old_val;
+
+    while (true) {
+        old_val = *A;
+        if (*A == old_val && synchCAS32(A, old_val, B) == true) break;
+    }
+#    ifdef DEBUG
+    __executed_swap++;
+#    endif
+    return old_val;
+#else
+#    ifdef DEBUG
+    __executed_swap++;
+    return __SWAP32(A, B);
+#    else
+    return __SWAP32(A, B);
+#    endif
+#endif
+}
+
 inline int32_t _FAA32(volatile int32_t *A, int32_t B) {
 #if defined(SYNCH_EMULATE_FAA)
 #    warning Fetch&Add instructions are simulated!
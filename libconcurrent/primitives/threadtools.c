@@ -267,3 +267,7 @@ inline void synchResched(void) {
 inline bool synchIsSystemOversubscribed(void) {
     return __system_oversubscription;
 }
+
+inline bool synchIsFiberScheduled(void) {
+    return __uthread_sched;
+}
@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <topology.h>
+#include <threadtools.h>
+
+#ifdef SYNCH_NUMA_SUPPORT
+#    include <numa.h>
+#endif
+
+#define SYSFS_CPU_PATH        "/sys/devices/system/cpu"
+#define SYSFS_MAX_CACHE_INDEX 10
+#define SYSFS_MAX_PATH        256
+
+typedef struct TopologyCandidate {
+    const char *name;
+    uint32_t *raw;
+    uint32_t ndomains;
+} TopologyCandidate;
+
+// Reads the first integer of a sysfs file, i.e. the lowest processing element of a cpulist
+static bool TopologyReadFirst(const char *path, uint32_t *value) {
+    FILE *file = fopen(path, "r");
+    unsigned int v;
+    bool ok;
+
+    if (file == NULL)
+        return false;
+    ok = (fscanf(file, "%u", &v) == 1);
+    fclose(file);
+    if (ok)
+        *value = v;
+    return ok;
+}
+
+static bool TopologyReadCpuFile(uint32_t cpu, const char *file, uint32_t *value) {
+    char path[SYSFS_MAX_PATH];
+
+    snprintf(path, SYSFS_MAX_PATH, SYSFS_CPU_PATH "/cpu%u/%s", cpu, file);
+    return TopologyReadFirst(path, value);
+}
+
+static bool TopologyReadCache(uint32_t cpu, uint32_t cache_level, uint32_t *value) {
+    char path[SYSFS_MAX_PATH];
+    uint32_t i, level;
+
+    for (i = 0; i < SYSFS_MAX_CACHE_INDEX; i++) {
+        snprintf(path, SYSFS_MAX_PATH, SYSFS_CPU_PATH "/cpu%u/cache/index%u/level", cpu, i);
+        if (!TopologyReadFirst(path, &level))
+            return false;
+        if (level == cache_level) {
+            snprintf(path, SYSFS_MAX_PATH, SYSFS_CPU_PATH "/cpu%u/cache/index%u/shared_cpu_list", cpu, i);
+            return TopologyReadFirst(path, value);
+        }
+    }
+    return false;
+}
+
+static bool TopologyReadRaw(const char *name, uint32_t cpu, uint32_t *value) {
+    if (strcmp(name, "smt") == 0) {
+        return TopologyReadCpuFile(cpu, "topology/thread_siblings_list", value);
+    } else if (strcmp(name, "l2") == 0) {
+        return TopologyReadCache(cpu, 2, value);
+    } else if (strcmp(name, "l3") == 0) {
+        return TopologyReadCache(cpu, 3, value);
+    } else if (strcmp(name, "die") == 0) {
+        return TopologyReadCpuFile(cpu, "topology/die_cpus_list", value);
+    } else if (strcmp(name, "numa") == 0) {
+#ifdef SYNCH_NUMA_SUPPORT
+        int node = numa_node_of_cpu(cpu);
+
+        *value = (uint32_t)node;
+        return node >= 0;
+#else
+        return false;
+#endif
+    } else {
+        return TopologyReadCpuFile(cpu, "topology/package_cpus_list", value) ||
+               TopologyReadCpuFile(cpu, "topology/core_siblings_list", value);
+    }
+}
+
+// Maps the pairs (raw[cpu], parent[cpu]) to the integers {0, ..., n-1} and returns n
+static uint32_t TopologyNormalize(uint32_t ncpus, const uint32_t *raw, const uint32_t *parent, uint32_t *domains) {
+    uint32_t cpu, prev, n = 0;
+
+    for (cpu = 0; cpu < ncpus; cpu++) {
+        for (prev = 0; prev < cpu; prev++) {
+            if (raw[prev] == raw[cpu] && (parent == NULL || parent[prev] == parent[cpu]))
+                break;
+        }
+        domains[cpu] = (prev < cpu) ? domains[prev] : n++;
+    }
+    return n;
+}
+
+void synchTopologyInit(SynchTopology *topology) {
+    static const char *names[] = {"smt", "l2", "l3", "die", "numa", "package"};
+    const uint32_t ncandidates = sizeof(names) / sizeof(names[0]);
+    TopologyCandidate candidates[sizeof(names) / sizeof(names[0])], tmp;
+    uint32_t levels[SYNCH_TOPOLOGY_MAX_LEVELS][2];                      // {candidate, number of domains}
+    uint32_t ncpus = synchGetNCores();
+    uint32_t *domains = malloc(ncpus * ncandidates * sizeof(uint32_t)); // the refined domains, coarsest level first
+    uint32_t i, j, cpu, n, kept = 0, nvalid = 0;
+
+    topology->ncpus = ncpus;
+    topology->nlevels = 0;
+    topology->domains = NULL;
+    topology->detected = true;
+    if (domains == NULL)
+        return;
+
+    for (i = 0; i < ncandidates; i++) {
+        TopologyCandidate *c = &candidates[nvalid];
+
+        c->name = names[i];
+        c->raw = malloc(ncpus * sizeof(uint32_t));
+        if (c->raw == NULL)
+            continue;
+        for (cpu = 0; cpu < ncpus && TopologyReadRaw(c->name, cpu, &c->raw[cpu]); cpu++)
+            ;
+        c->ndomains = (cpu == ncpus) ? TopologyNormalize(ncpus, c->raw, NULL, domains) : 0;
+        if (c->ndomains > 1 && c->ndomains < ncpus)
+            nvalid++;
+        else
+            free(c->raw);
+    }
+
+    // The coarser candidates come first; the order of names is kept for candidates with equal number of domains
+    for (i = 1; i < nvalid; i++) {
+        for (j = i; j > 0 && candidates[j - 1].ndomains > candidates[j].ndomains; j--) {
+            tmp = candidates[j];
+            candidates[j] = candidates[j - 1];
+            candidates[j - 1] = tmp;
+        }
+    }
+
+    // Each candidate is refined by the last kept coarser level, thus the kept levels are nested
+    for (i = 0; i < nvalid && kept < SYNCH_TOPOLOGY_MAX_LEVELS; i++) {
+        uint32_t *parent = (kept > 0) ? &domains[(kept - 1) * ncpus] : NULL;
+
+        n = TopologyNormalize(ncpus, candidates[i].raw, parent, &domains[kept * ncpus]);
+        if (n < ncpus && (kept == 0 || n > levels[kept - 1][1])) {
+            levels[kept][0] = i;
+            levels[kept][1] = n;
+            kept++;
+        }
+    }
+
+    if (kept > 0) {
+        topology->domains = malloc(kept * ncpus * sizeof(uint32_t));
+        if (topology->domains != NULL) {
+            topology->nlevels = kept;
+            for (i = 0; i < kept; i++) {
+                j = kept - 1 - i;                                       // the finest level comes first
+                topology->ndomains[i] = levels[j][1];
+                topology->names[i] = candidates[levels[j][0]].name;
+                memcpy(&topology->domains[i * ncpus], &domains[j * ncpus], ncpus * sizeof(uint32_t));
+            }
+        }
+    }
+    for (i = 0; i < nvalid; i++)
+        free(candidates[i].raw);
+    free(domains);
+}
+
+void synchTopologyInitUniform(SynchTopology *topology, uint32_t ncpus, uint32_t nlevels, const uint32_t *sizes) {
+    uint32_t i, cpu, size;
+
+    if (nlevels > SYNCH_TOPOLOGY_MAX_LEVELS)
+        nlevels = SYNCH_TOPOLOGY_MAX_LEVELS;
+    topology->ncpus = ncpus;
+    topology->nlevels = nlevels;
+    topology->detected = false;
+    topology->domains = malloc((nlevels > 0 ? nlevels : 1) * ncpus * sizeof(uint32_t));
+    if (topology->domains == NULL) {
+        perror("memory allocation fail");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < nlevels; i++) {
+        size = (sizes[i] > 0) ? sizes[i] : 1;
+        topology->ndomains[i] = ncpus / size + (ncpus % size == 0 ? 0 : 1);
+        topology->names[i] = "uniform";
+        for (cpu = 0; cpu < ncpus; cpu++)
+            topology->domains[i * ncpus + cpu] = cpu / size;
+    }
+}
+
+void synchTopologyCopy(SynchTopology *dst, const SynchTopology *src) {
+    size_t size = src->nlevels * src->ncpus * sizeof(uint32_t);
+
+    *dst = *src;
+    dst->domains = NULL;
+    if (src->nlevels > 0) {
+        dst->domains = malloc(size);
+        if (dst->domains == NULL) {
+            perror("memory allocation fail");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(dst->domains, src->domains, size);
+    }
+}
+
+void synchTopologyDestroy(SynchTopology *topology) {
+    free(topology->domains);
+    topology->domains = NULL;
+    topology->nlevels = 0;
+}
+
+void synchTopologyPrint(const SynchTopology *topology) {
+    uint32_t i;
+
+    fprintf(stderr, "topology: %u processing elements", topology->ncpus);
+    for (i = 0; i < topology->nlevels; i++)
+        fprintf(stderr, "\tlevel %u: %s (%u domains)", i, topology->names[i], topology->ndomains[i]);
+    fprintf(stderr, "\n");
+}
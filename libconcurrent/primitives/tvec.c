@@ -0,0 +1,294 @@
+#include <tvec.h>
+
+#if defined(__GNUC__) && (defined(__amd64__) || defined(__x86_64__))
+#    define _TVEC_X86_KERNELS_
+#    include <immintrin.h>
+#    if defined(__clang__) || __GNUC__ >= 8
+#        define _TVEC_AVX512_KERNELS_
+#    endif
+#elif defined(__GNUC__) && defined(__aarch64__)
+#    define _TVEC_NEON_KERNELS_
+#    include <arm_neon.h>
+#endif
+
+// Scalar kernels
+// --------------
+
+static void TVecXorScalar(bitword_t *res, const bitword_t *tv1, const bitword_t *tv2, uint32_t cells) {
+    uint32_t i;
+
+    LOOP(res[i] = tv1[i] ^ tv2[i], i, cells);
+}
+
+static void TVecAndScalar(bitword_t *res, const bitword_t *tv1, const bitword_t *tv2, uint32_t cells) {
+    uint32_t i;
+
+    LOOP(res[i] = tv1[i] & tv2[i], i, cells);
+}
+
+static void TVecOrScalar(bitword_t *res, const bitword_t *tv1, const bitword_t *tv2, uint32_t cells) {
+    uint32_t i;
+
+    LOOP(res[i] = tv1[i] | tv2[i], i, cells);
+}
+
+static void TVecCopyScalar(bitword_t *dest, const bitword_t *src, uint32_t cells) {
+    memcpy(dest, src, cells * sizeof(bitword_t));
+}
+
+static int TVecCountBitsScalar(const bitword_t *tv, uint32_t cells) {
+    uint32_t i;
+    int count = 0;
+
+    LOOP(count += synchNonZeroBits(tv[i]), i, cells);
+
+    return count;
+}
+
+#ifdef _TVEC_X86_KERNELS_
+// AVX2 kernels
+// ------------
+// Cells are not guaranteed to be aligned to 32 bytes, thus only unaligned loads/stores are used.
+
+#    define _TVEC_AVX2_BINARY_OP_(NAME, OP, SOP)                                                                         \
+        __attribute__((target("avx2"))) static void NAME(bitword_t *res, const bitword_t *tv1, const bitword_t *tv2,     \
+                                                         uint32_t cells) {                                               \
+            uint32_t i = 0;                                                                                              \
+                                                                                                                         \
+            for (; i + 4 <= cells; i += 4) {                                                                             \
+                __m256i a = _mm256_loadu_si256((const __m256i *)(tv1 + i));                                              \
+                __m256i b = _mm256_loadu_si256((const __m256i *)(tv2 + i));                                              \
+                _mm256_storeu_si256((__m256i *)(res + i), OP(a, b));                                                     \
+            }                                                                                                            \
+            for (; i < cells; i++)                                                                                       \
+                res[i] = tv1[i] SOP tv2[i];                                                                              \
+        }
+
+_TVEC_AVX2_BINARY_OP_(TVecXorAVX2, _mm256_xor_si256, ^)
+_TVEC_AVX2_BINARY_OP_(TVecAndAVX2, _mm256_and_si256, &)
+_TVEC_AVX2_BINARY_OP_(TVecOrAVX2, _mm256_or_si256, |)
+
+__attribute__((target("avx2"))) static void TVecCopyAVX2(bitword_t *dest, const bitword_t *src, uint32_t cells) {
+    uint32_t i = 0;
+
+    for (; i + 4 <= cells; i += 4)
+        _mm256_storeu_si256((__m256i *)(dest + i), _mm256_loadu_si256((const __m256i *)(src + i)));
+    for (; i < cells; i++)
+        dest[i] = src[i];
+}
+
+// Population count based on nibble lookups (i.e., W. Mula's algorithm): vpshufb counts the bits of each nibble
+// and vpsadbw sums the counts of the 8 bytes of each 64-bit lane.
+__attribute__((target("avx2"))) static int TVecCountBitsAVX2(const bitword_t *tv, uint32_t cells) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t i = 0;
+    int count;
+
+    for (; i + 4 <= cells; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(tv + i));
+        __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+        __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+    count = _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) + _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3);
+    for (; i < cells; i++)
+        count += synchNonZeroBits(tv[i]);
+
+    return count;
+}
+
+#    ifdef _TVEC_AVX512_KERNELS_
+// AVX-512 kernels
+// ---------------
+// The remaining (less than 8) cells of copy and count are handled by masked loads/stores. The binary operations
+// avoid masked stores, since their results are usually loaded right after (i.e. a masked store is not forwarded).
+
+#        define _TVEC_AVX512_BINARY_OP_(NAME, OP, OP256, SOP)                                                            \
+            __attribute__((target("avx512f"))) static void NAME(bitword_t *res, const bitword_t *tv1,                    \
+                                                                const bitword_t *tv2, uint32_t cells) {                  \
+                uint32_t i = 0;                                                                                          \
+                                                                                                                         \
+                for (; i + 8 <= cells; i += 8) {                                                                         \
+                    __m512i a = _mm512_loadu_si512((const void *)(tv1 + i));                                             \
+                    __m512i b = _mm512_loadu_si512((const void *)(tv2 + i));                                             \
+                    _mm512_storeu_si512((void *)(res + i), OP(a, b));                                                    \
+                }                                                                                                        \
+                if (i + 4 <= cells) {                                                                                    \
+                    __m256i a = _mm256_loadu_si256((const __m256i *)(tv1 + i));                                          \
+                    __m256i b = _mm256_loadu_si256((const __m256i *)(tv2 + i));                                          \
+                    _mm256_storeu_si256((__m256i *)(res + i), OP256(a, b));                                              \
+                    i += 4;                                                                                              \
+                }                                                                                                        \
+                for (; i < cells; i++)                                                                                   \
+                    res[i] = tv1[i] SOP tv2[i];                                                                          \
+            }
+
+_TVEC_AVX512_BINARY_OP_(TVecXorAVX512, _mm512_xor_si512, _mm256_xor_si256, ^)
+_TVEC_AVX512_BINARY_OP_(TVecAndAVX512, _mm512_and_si512, _mm256_and_si256, &)
+_TVEC_AVX512_BINARY_OP_(TVecOrAVX512, _mm512_or_si512, _mm256_or_si256, |)
+
+__attribute__((target("avx512f"))) static void TVecCopyAVX512(bitword_t *dest, const bitword_t *src, uint32_t cells) {
+    uint32_t i = 0;
+
+    for (; i + 8 <= cells; i += 8)
+        _mm512_storeu_si512((void *)(dest + i), _mm512_loadu_si512((const void *)(src + i)));
+    if (i < cells) {
+        __mmask8 m = (__mmask8)((1U << (cells - i)) - 1);
+        _mm512_mask_storeu_epi64((void *)(dest + i), m, _mm512_maskz_loadu_epi64(m, (const void *)(src + i)));
+    }
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq"))) static int TVecCountBitsAVX512(const bitword_t *tv, uint32_t cells) {
+    __m512i acc = _mm512_setzero_si512();
+    uint32_t i = 0;
+
+    for (; i + 8 <= cells; i += 8)
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512((const void *)(tv + i))));
+    if (i < cells) {
+        __mmask8 m = (__mmask8)((1U << (cells - i)) - 1);
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(m, (const void *)(tv + i))));
+    }
+
+    return (int)_mm512_reduce_add_epi64(acc);
+}
+#    endif
+#endif
+
+#ifdef _TVEC_NEON_KERNELS_
+// NEON kernels
+// ------------
+
+#    define _TVEC_NEON_BINARY_OP_(NAME, OP, SOP)                                                                         \
+        static void NAME(bitword_t *res, const bitword_t *tv1, const bitword_t *tv2, uint32_t cells) {                   \
+            uint32_t i = 0;                                                                                              \
+                                                                                                                         \
+            for (; i + 2 <= cells; i += 2)                                                                               \
+                vst1q_u64((uint64_t *)(res + i), OP(vld1q_u64((const uint64_t *)(tv1 + i)),                              \
+                                                    vld1q_u64((const uint64_t *)(tv2 + i))));                            \
+            for (; i < cells; i++)                                                                                       \
+                res[i] = tv1[i] SOP tv2[i];                                                                              \
+        }
+
+_TVEC_NEON_BINARY_OP_(TVecXorNEON, veorq_u64, ^)
+_TVEC_NEON_BINARY_OP_(TVecAndNEON, vandq_u64, &)
+_TVEC_NEON_BINARY_OP_(TVecOrNEON, vorrq_u64, |)
+
+static void TVecCopyNEON(bitword_t *dest, const bitword_t *src, uint32_t cells) {
+    uint32_t i = 0;
+
+    for (; i + 2 <= cells; i += 2)
+        vst1q_u64((uint64_t *)(dest + i), vld1q_u64((const uint64_t *)(src + i)));
+    for (; i < cells; i++)
+        dest[i] = src[i];
+}
+
+static int TVecCountBitsNEON(const bitword_t *tv, uint32_t cells) {
+    uint32_t i = 0;
+    int count = 0;
+
+    for (; i + 2 <= cells; i += 2)
+        count += vaddlvq_u8(vcntq_u8(vreinterpretq_u8_u64(vld1q_u64((const uint64_t *)(tv + i)))));
+    for (; i < cells; i++)
+        count += synchNonZeroBits(tv[i]);
+
+    return count;
+}
+#endif
+
+TVecKernels synchTVecKernels = {TVEC_KERNELS_SCALAR, TVecXorScalar, TVecAndScalar, TVecOrScalar, TVecCopyScalar, TVecCountBitsScalar};
+
+bool synchTVecKernelsSupported(int kernels) {
+#ifdef _TVEC_X86_KERNELS_
+    __builtin_cpu_init();                                           // it may be called before the constructors of libgcc
+#endif
+    switch (kernels) {
+    case TVEC_KERNELS_SCALAR:
+        return true;
+#ifdef _TVEC_X86_KERNELS_
+    case TVEC_KERNELS_AVX2:
+        return __builtin_cpu_supports("avx2");
+#    ifdef _TVEC_AVX512_KERNELS_
+    case TVEC_KERNELS_AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+#    endif
+#endif
+#ifdef _TVEC_NEON_KERNELS_
+    case TVEC_KERNELS_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+bool synchTVecSetKernels(int kernels) {
+    TVecKernels k = {TVEC_KERNELS_SCALAR, TVecXorScalar, TVecAndScalar, TVecOrScalar, TVecCopyScalar, TVecCountBitsScalar};
+
+    if (!synchTVecKernelsSupported(kernels))
+        return false;
+    switch (kernels) {
+#ifdef _TVEC_X86_KERNELS_
+    case TVEC_KERNELS_AVX2:
+        k.xor_cells = TVecXorAVX2;
+        k.and_cells = TVecAndAVX2;
+        k.or_cells = TVecOrAVX2;
+        k.copy_cells = TVecCopyAVX2;
+        k.count_bits = TVecCountBitsAVX2;
+        break;
+#    ifdef _TVEC_AVX512_KERNELS_
+    case TVEC_KERNELS_AVX512:
+        k.xor_cells = TVecXorAVX512;
+        k.and_cells = TVecAndAVX512;
+        k.or_cells = TVecOrAVX512;
+        k.copy_cells = TVecCopyAVX512;
+        k.count_bits = TVecCountBitsAVX512;
+        break;
+#    endif
+#endif
+#ifdef _TVEC_NEON_KERNELS_
+    case TVEC_KERNELS_NEON:
+        k.xor_cells = TVecXorNEON;
+        k.and_cells = TVecAndNEON;
+        k.or_cells = TVecOrNEON;
+        k.copy_cells = TVecCopyNEON;
+        k.count_bits = TVecCountBitsNEON;
+        break;
+#endif
+    default:
+        break;
+    }
+    k.kernels = kernels;
+    synchTVecKernels = k;
+    synchFullFence();
+
+    return true;
+}
+
+int synchTVecGetKernels(void) {
+    return synchTVecKernels.kernels;
+}
+
+const char *synchTVecKernelsName(int kernels) {
+    switch (kernels) {
+    case TVEC_KERNELS_SCALAR:
+        return "scalar";
+    case TVEC_KERNELS_AVX2:
+        return "avx2";
+    case TVEC_KERNELS_AVX512:
+        return "avx512";
+    case TVEC_KERNELS_NEON:
+        return "neon";
+    default:
+        return "unknown";
+    }
+}
+
+// Selects the best set of kernels supported by the running processor, before main starts.
+__attribute__((constructor)) static void TVecKernelsInit(void) {
+    if (synchTVecSetKernels(TVEC_KERNELS_AVX512) || synchTVecSetKernels(TVEC_KERNELS_AVX2) || synchTVecSetKernels(TVEC_KERNELS_NEON))
+        return;
+    synchTVecSetKernels(TVEC_KERNELS_SCALAR);
+}
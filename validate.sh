@@ -33,10 +33,12 @@ function usage()
 COLOR_PASS="[ \e[32mPASS\e[39m ]"
 COLOR_FAIL="[ \e[31mFAIL\e[39m ]"
 
-declare -a uobjects=(  "ccsynchbench.run"                     "dsmsynchbench.run" "hsynchbench.run" "oscibench.run"      "simbench.run"      "fcbench.run"      "oyamabench.run" "mcsbench.run" "clhbench.run" "pthreadsbench.run" "fadbench.run")
-declare -a queues=(    "ccqueuebench.run" "clhqueuebench.run" "dsmqueuebench.run" "hqueuebench.run" "osciqueuebench.run" "simqueuebench.run" "fcqueuebench.run" "lcrqbench.run")
-declare -a stacks=(    "ccstackbench.run" "clhstackbench.run" "dsmstackbench.run" "hstackbench.run" "oscistackbench.run" "simstackbench.run" "fcstackbench.run")
+declare -a uobjects=(  "ccsynchbench.run" "ccsynchbatchbench.run" "dsmsynchbench.run" "dsmsynchbatchbench.run" "hsynchbench.run" "hsynchbatchbench.run" "mhsynchbench.run" "asyncbench.run" "oscibench.run"      "simbench.run" "simbatchbench.run" "simdeltabench.run" "simreadbench.run" "simdynbench.run" "simshardbench.run" "fcbench.run"      "oyamabench.run" "mcsbench.run" "clhbench.run" "pthreadsbench.run" "fadbench.run" "blockingbench.run")
+declare -a queues=(    "ccqueuebench.run" "clhqueuebench.run" "dsmqueuebench.run" "hqueuebench.run" "osciqueuebench.run" "simqueuebench.run" "simqueuebatchbench.run" "simbqueuebench.run" "fcqueuebench.run" "lcrqbench.run" "lcrqbatchbench.run")
+declare -a stacks=(    "ccstackbench.run" "clhstackbench.run" "dsmstackbench.run" "hstackbench.run" "oscistackbench.run" "simstackbench.run" "fcstackbench.run" "ebstackbench.run")
 declare -a hashtables=("clhhashbench.run" "dsmhashbench.run")
+# the objects whose waiters park (see park.h); they are validated once more with twice as many threads as cores
+declare -a parking=(   "ccsynchbench.run" "ccsynchbatchbench.run" "dsmsynchbench.run" "dsmsynchbatchbench.run" "hsynchbench.run" "hsynchbatchbench.run" "mhsynchbench.run" "asyncbench.run" "fcbench.run")
 
 if [ "$1" = "--help" ] || [ "$1" = "-h" ]; then
     usage;
@@ -219,6 +221,40 @@ for PTHREADS in "${PTHREADS_ARRAY[@]}"; do
     done
 done
 
+# The waiters park without yielding the CPU first (i.e. SYNCH_PARK_SPINS is 0) and the threads outnumber the cores,
+# thus almost every wait of a combining round races with the unlock of its node (see synchParkUnlock).
+# A coverage build is not rebuilt, since its coverage data would be lost.
+OVERSUB_PTHREADS=$((2 * $(getconf _NPROCESSORS_ONLN)))
+printf "\n\e[36mValidating parking for %3d thread(s)\n" $OVERSUB_PTHREADS
+echo -e "=====================================\e[39m"
+if [ $CODECOV -eq 0 ]; then
+    echo -ne "Compiling the sources with SYNCH_PARK_SPINS=0...\t\t\t\t"
+    if make clean debug DEBUG_ARGS="-DSYNCH_PARK_SPINS=0" &>> $BUILD_LOG; then
+        echo -e $COLOR_PASS
+    else
+        echo -e $COLOR_FAIL
+        echo -e "\nCheck" $BUILD_LOG "for the build error-log."
+        PASS_STATUS=0
+    fi
+fi
+
+runs=$(($RUNS_PER_THREAD * $OVERSUB_PTHREADS))
+for bench in "${parking[@]}"; do
+    printf "Validating %-20s \t\t\t\t\t" $bench
+    # fibers never park, thus they are not used here
+    timeout 600 $BIN_PATH/$bench -t $OVERSUB_PTHREADS -r $runs $WORKLOAD $NUMA_NODES > $RES_FILE 2>&1
+    state=$(fgrep "Object state: " $RES_FILE)
+    state=${state/#"DEBUG: Object state: "}
+    if [ "$state" = "$runs" ]; then
+        echo -e $COLOR_PASS
+    else
+        echo -e $COLOR_FAIL
+        echo "Expected state: " $runs
+        echo "Invalid state (a waiter may have missed its wake-up): " $state
+        PASS_STATUS=0
+    fi
+done
+
 rm -f $RES_FILE
 
 if [ $PASS_STATUS -eq 1 ]; then